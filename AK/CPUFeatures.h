@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+#include <AK/Types.h>
+
+#if AK_IS_ARCH_X86_64()
+#    include <cpuid.h>
+#endif
+
+namespace AK {
+
+// Instruction set extensions that userspace code may pick optimized code paths for at runtime.
+// Code using these must be compiled with the matching [[gnu::target(...)]] attribute.
+struct CPUFeatures {
+    bool sse2 { false };
+    bool ssse3 { false };
+    bool sse41 { false };
+    bool sse42 { false };
+    bool pclmul { false };
+    bool aes { false };
+    bool avx2 { false };
+    bool sha { false };
+};
+
+namespace Detail {
+
+inline CPUFeatures detect_cpu_features()
+{
+    CPUFeatures features;
+#if AK_IS_ARCH_X86_64()
+    u32 eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+        return features;
+
+    features.sse2 = edx & (1 << 26);
+    features.ssse3 = ecx & (1 << 9);
+    features.sse41 = ecx & (1 << 19);
+    features.sse42 = ecx & (1 << 20);
+    features.pclmul = ecx & (1 << 1);
+    features.aes = ecx & (1 << 25);
+
+    // AVX registers are only usable if the OS saves them on context switches (OSXSAVE + XCR0 bits 1 and 2).
+    bool os_saves_avx_state = false;
+    if (ecx & (1 << 27)) {
+        u32 xcr0_low, xcr0_high;
+        asm volatile("xgetbv"
+                     : "=a"(xcr0_low), "=d"(xcr0_high)
+                     : "c"(0));
+        os_saves_avx_state = (xcr0_low & 0b110) == 0b110;
+    }
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0) {
+        features.avx2 = os_saves_avx_state && (ebx & (1 << 5));
+        features.sha = ebx & (1 << 29);
+    }
+#endif
+    return features;
+}
+
+}
+
+inline CPUFeatures const& cpu_features()
+{
+    static CPUFeatures const features = Detail::detect_cpu_features();
+    return features;
+}
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::cpu_features;
+using AK::CPUFeatures;
+#endif
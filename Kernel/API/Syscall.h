@@ -62,6 +62,7 @@ enum class NeedsBigProcessLock {
     S(clock_settime, NeedsBigProcessLock::No)              \
     S(close, NeedsBigProcessLock::No)                      \
     S(connect, NeedsBigProcessLock::No)                    \
+    S(copy_file_range, NeedsBigProcessLock::No)            \
     S(create_inode_watcher, NeedsBigProcessLock::No)       \
     S(create_thread, NeedsBigProcessLock::Yes)             \
     S(dbgputstr, NeedsBigProcessLock::No)                  \
@@ -272,6 +273,15 @@ struct SC_clock_nanosleep_params {
     struct timespec* remaining_sleep;
 };
 
+struct SC_copy_file_range_params {
+    int fd_in;
+    i64* offset_in;
+    int fd_out;
+    i64* offset_out;
+    size_t size;
+    u32 flags;
+};
+
 struct SC_clock_getres_params {
     int clock_id;
     struct timespec* result;
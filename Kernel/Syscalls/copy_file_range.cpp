@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t copy_buffer_size = 256 * KiB;
+
+static ErrorOr<Optional<off_t>> copy_offset_from_user(i64* user_offset)
+{
+    if (!user_offset)
+        return Optional<off_t> {};
+    i64 offset;
+    TRY(copy_from_user(&offset, user_offset));
+    if (offset < 0)
+        return EINVAL;
+    return Optional<off_t> { offset };
+}
+
+// Copies data between two files without it ever going through userspace. Both files have to be on the same file system.
+ErrorOr<FlatPtr> Process::sys$copy_file_range(Userspace<Syscall::SC_copy_file_range_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+    if (params.flags != 0)
+        return EINVAL;
+    if (params.size > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto source = TRY(open_file_description(params.fd_in));
+    auto destination = TRY(open_file_description(params.fd_out));
+    if (!source->is_readable() || !destination->is_writable() || destination->should_append())
+        return EBADF;
+
+    auto* source_inode = source->inode();
+    auto* destination_inode = destination->inode();
+    if (!source_inode || !destination_inode)
+        return EINVAL;
+    if (!source_inode->metadata().is_regular_file() || !destination_inode->metadata().is_regular_file())
+        return EINVAL;
+    if (source_inode->fsid() != destination_inode->fsid())
+        return EXDEV;
+
+    auto source_offset = TRY(copy_offset_from_user(params.offset_in));
+    auto destination_offset = TRY(copy_offset_from_user(params.offset_out));
+    if (params.size == 0)
+        return 0;
+
+    // Copying a range of a file onto an overlapping range of the same file would read back what was just written.
+    if (source_inode == destination_inode) {
+        u64 source_start = source_offset.value_or(source->offset());
+        u64 destination_start = destination_offset.value_or(destination->offset());
+        if (source_start < destination_start + params.size && destination_start < source_start + params.size)
+            return EINVAL;
+    }
+
+    auto buffer = TRY(KBuffer::try_create_with_size("copy_file_range"sv, min(params.size, copy_buffer_size)));
+    auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+
+    size_t total_copied = 0;
+    auto copy = [&]() -> ErrorOr<void> {
+        while (total_copied < params.size) {
+            auto size_to_copy = min(params.size - total_copied, buffer->size());
+            auto nread = source_offset.has_value()
+                ? TRY(source->read(kernel_buffer, *source_offset + total_copied, size_to_copy))
+                : TRY(source->read(kernel_buffer, size_to_copy));
+            if (nread == 0)
+                break;
+
+            auto nwritten = TRY(do_write(*destination, kernel_buffer, nread, destination_offset.map([&](auto offset) { return static_cast<off_t>(offset + total_copied); })));
+            total_copied += nwritten;
+            if (nwritten < nread)
+                break;
+        }
+        return {};
+    };
+
+    auto result = copy();
+    // Like read() and write(), report how much was copied before an error happened.
+    if (result.is_error() && total_copied == 0)
+        return result.release_error();
+
+    if (source_offset.has_value()) {
+        i64 new_offset = *source_offset + total_copied;
+        TRY(copy_to_user(params.offset_in, &new_offset));
+    }
+    if (destination_offset.has_value()) {
+        i64 new_offset = *destination_offset + total_copied;
+        TRY(copy_to_user(params.offset_out, &new_offset));
+    }
+    return total_copied;
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+static int create_file_with_contents(Span<char> pattern, StringView contents)
+{
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    EXPECT_EQ(MUST(Core::System::write(fd, contents.bytes())), static_cast<ssize_t>(contents.length()));
+    MUST(Core::System::lseek(fd, 0, SEEK_SET));
+    return fd;
+}
+
+TEST_CASE(copy_between_files)
+{
+    char source_pattern[] = "/tmp/copy_file_range_source.XXXXXX";
+    char destination_pattern[] = "/tmp/copy_file_range_destination.XXXXXX";
+    auto source_fd = create_file_with_contents(source_pattern, "Well hello friends!"sv);
+    auto destination_fd = create_file_with_contents(destination_pattern, ""sv);
+
+    EXPECT_EQ(MUST(Core::System::copy_file_range(source_fd, destination_fd, 1024)), 19u);
+    // The file offsets moved along with the copy.
+    EXPECT_EQ(MUST(Core::System::lseek(source_fd, 0, SEEK_CUR)), 19);
+    EXPECT_EQ(MUST(Core::System::copy_file_range(source_fd, destination_fd, 1024)), 0u);
+
+    char buffer[32] {};
+    EXPECT_EQ(pread(destination_fd, buffer, sizeof(buffer), 0), 19);
+    EXPECT_EQ(StringView(buffer, 19), "Well hello friends!"sv);
+
+    // Explicit offsets are used and updated instead of the file offsets.
+    off_t source_offset = 5;
+    off_t destination_offset = 0;
+    EXPECT_EQ(copy_file_range(source_fd, &source_offset, destination_fd, &destination_offset, 5, 0), 5);
+    EXPECT_EQ(source_offset, 10);
+    EXPECT_EQ(destination_offset, 5);
+    EXPECT_EQ(pread(destination_fd, buffer, sizeof(buffer), 0), 19);
+    EXPECT_EQ(StringView(buffer, 19), "hellohello friends!"sv);
+
+    MUST(Core::System::unlink({ source_pattern, strlen(source_pattern) }));
+    MUST(Core::System::unlink({ destination_pattern, strlen(destination_pattern) }));
+    MUST(Core::System::close(source_fd));
+    MUST(Core::System::close(destination_fd));
+}
+
+TEST_CASE(copy_within_the_same_file)
+{
+    char pattern[] = "/tmp/copy_file_range_same.XXXXXX";
+    auto fd = create_file_with_contents(pattern, "0123456789"sv);
+
+    // Overlapping ranges are rejected.
+    off_t source_offset = 0;
+    off_t destination_offset = 5;
+    EXPECT_EQ(copy_file_range(fd, &source_offset, fd, &destination_offset, 10, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Both sides use the same file offset when no offsets are given.
+    EXPECT_EQ(copy_file_range(fd, nullptr, fd, nullptr, 5, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Ranges that don't overlap are fine.
+    source_offset = 0;
+    destination_offset = 5;
+    EXPECT_EQ(copy_file_range(fd, &source_offset, fd, &destination_offset, 5, 0), 5);
+
+    char buffer[16] {};
+    EXPECT_EQ(pread(fd, buffer, sizeof(buffer), 0), 10);
+    EXPECT_EQ(StringView(buffer, 10), "0123401234"sv);
+
+    MUST(Core::System::unlink({ pattern, strlen(pattern) }));
+    MUST(Core::System::close(fd));
+}
@@ -7,6 +7,7 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/Array.h>
+#include <AK/MemoryStream.h>
 #include <AK/Random.h>
 #include <LibCompress/Gzip.h>
 
@@ -107,3 +108,59 @@ TEST_CASE(gzip_truncated_uncompressed_block)
     auto const decompressed_or_error = Compress::GzipDecompressor::decompress_all(compressed);
     EXPECT(decompressed_or_error.is_error());
 }
+
+static ByteBuffer make_compressible_input(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    // Repeat a random "vocabulary" so that back references across chunk boundaries are worth something.
+    auto vocabulary = ByteBuffer::create_uninitialized(4096).release_value();
+    fill_with_random(vocabulary);
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = vocabulary[(i * 7 + i / 4096) % vocabulary.size()];
+    return buffer;
+}
+
+TEST_CASE(gzip_parallel_round_trip)
+{
+    auto original = make_compressible_input(3 * Compress::GzipCompressor::parallel_chunk_size + 1234);
+
+    AllocatingMemoryStream output_stream;
+    MUST(Compress::GzipCompressor::compress_in_parallel(original, output_stream, 4));
+    auto compressed = MUST(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+    MUST(output_stream.read_until_filled(compressed));
+
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed);
+    EXPECT(!uncompressed.is_error());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(gzip_parallel_round_trip_small_inputs)
+{
+    for (size_t size : { 0, 1, 1000 }) {
+        auto original = make_compressible_input(size);
+
+        AllocatingMemoryStream output_stream;
+        MUST(Compress::GzipCompressor::compress_in_parallel(original, output_stream, 4));
+        auto compressed = MUST(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+        MUST(output_stream.read_until_filled(compressed));
+
+        auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed);
+        EXPECT(!uncompressed.is_error());
+        EXPECT(uncompressed.value() == original);
+    }
+}
+
+static constexpr size_t benchmark_input_size = 16 * MiB;
+
+BENCHMARK_CASE(gzip_compress_single_thread)
+{
+    auto original = make_compressible_input(benchmark_input_size);
+    MUST(Compress::GzipCompressor::compress_all(original));
+}
+
+BENCHMARK_CASE(gzip_compress_four_threads)
+{
+    auto original = make_compressible_input(benchmark_input_size);
+    AllocatingMemoryStream output_stream;
+    MUST(Compress::GzipCompressor::compress_in_parallel(original, output_stream, 4));
+}
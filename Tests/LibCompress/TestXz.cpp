@@ -7,6 +7,7 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/MemoryStream.h>
+#include <AK/StringBuilder.h>
 #include <LibCompress/Xz.h>
 
 TEST_CASE(lzma2_compressed_without_settings_after_uncompressed)
@@ -1891,3 +1892,132 @@ TEST_CASE(xz_utils_unsupported_filter_flags_3)
     auto buffer_or_error = decompressor->read_until_eof(PAGE_SIZE);
     EXPECT(buffer_or_error.is_error());
 }
+
+// Created using `xz -T2 --block-size=2KiB --check=crc32`, from the output of `multi_block_test_data()`.
+static Array<u8, 788> const multi_block_compressed {
+    0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00, 0x00, 0x01, 0x69, 0x22, 0xDE, 0x36, 0x03, 0xC0, 0xA1, 0x01,
+    0x80, 0x10, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x37, 0xA3, 0x04, 0x4C, 0xE0, 0x07, 0xFF, 0x00,
+    0x99, 0x5D, 0x00, 0x2A, 0x1A, 0x09, 0x27, 0x64, 0x1C, 0x87, 0x8D, 0x42, 0x8F, 0x2F, 0xC9, 0xB3,
+    0x0F, 0x12, 0x50, 0xE3, 0x7D, 0xD7, 0xDC, 0x04, 0x24, 0x83, 0xB0, 0xFE, 0xAC, 0x2B, 0x09, 0x88,
+    0xF2, 0xCB, 0x6B, 0xD0, 0x04, 0x82, 0xC5, 0xE7, 0xAD, 0x70, 0x81, 0xAD, 0xC8, 0x5A, 0x75, 0x79,
+    0x38, 0xC3, 0x73, 0xB3, 0x17, 0x44, 0xBD, 0x90, 0x24, 0x1F, 0xA0, 0x4A, 0x6F, 0xB9, 0xD6, 0x72,
+    0x82, 0x61, 0xB3, 0xE5, 0x67, 0x75, 0x94, 0xE0, 0xC6, 0xA6, 0xF6, 0x14, 0xCD, 0xB3, 0x82, 0xE2,
+    0xAD, 0x91, 0xDE, 0x60, 0xAE, 0x15, 0xC8, 0xF7, 0xDE, 0xA0, 0x68, 0x52, 0x8E, 0x35, 0x16, 0xF8,
+    0x04, 0xD2, 0x7E, 0x39, 0xF5, 0x20, 0x5D, 0x27, 0xDB, 0x7E, 0xDF, 0x4F, 0x02, 0x78, 0x98, 0xD6,
+    0x46, 0xF5, 0xFB, 0x69, 0x82, 0x46, 0x50, 0x91, 0xB8, 0x62, 0xF0, 0xEF, 0x10, 0xD8, 0xFD, 0x44,
+    0x7D, 0xE6, 0xFB, 0x8A, 0x65, 0xFB, 0x08, 0x57, 0x79, 0x54, 0x80, 0x18, 0xB7, 0x16, 0x9E, 0x6D,
+    0xBE, 0xF8, 0x7A, 0xB3, 0xBF, 0xC5, 0x81, 0x90, 0xA7, 0x55, 0x37, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xB0, 0x2C, 0xD1, 0x62, 0x03, 0xC0, 0xB5, 0x01, 0x80, 0x10, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00,
+    0xA5, 0x82, 0x41, 0x62, 0xE0, 0x07, 0xFF, 0x00, 0xAD, 0x5D, 0x00, 0x39, 0x08, 0x03, 0x03, 0x78,
+    0xDC, 0xD0, 0xD6, 0x15, 0x56, 0x66, 0xCC, 0x86, 0x16, 0x03, 0x93, 0x93, 0x82, 0x62, 0xCD, 0x98,
+    0xA0, 0x0A, 0x20, 0x99, 0x3C, 0x7F, 0x37, 0xA6, 0x9F, 0x1F, 0x54, 0xC8, 0x17, 0xF7, 0xEA, 0x55,
+    0x39, 0xB8, 0x57, 0x8F, 0xA0, 0x53, 0xFF, 0x14, 0xE6, 0xD2, 0x57, 0x0A, 0xA7, 0xEE, 0x81, 0x8A,
+    0x5C, 0x45, 0xD0, 0x82, 0x78, 0x33, 0x08, 0x0B, 0xD4, 0xA8, 0xA9, 0x8C, 0x50, 0x5A, 0x7F, 0xDF,
+    0x87, 0x35, 0x7C, 0x20, 0x01, 0xD3, 0xFA, 0xC0, 0x61, 0x86, 0x63, 0xBC, 0xF2, 0x8C, 0x80, 0xB1,
+    0x2E, 0x25, 0x72, 0xC6, 0xD9, 0x62, 0xD8, 0x4D, 0xF6, 0x50, 0xBD, 0x21, 0x38, 0xA8, 0x6B, 0xA5,
+    0x23, 0x7F, 0x8E, 0xF9, 0x2F, 0x56, 0xDA, 0xAE, 0x34, 0x08, 0x26, 0xC4, 0x9C, 0x2A, 0xC1, 0x17,
+    0xBE, 0x8E, 0x79, 0x7B, 0x95, 0x88, 0x93, 0xD0, 0x2C, 0xBC, 0x96, 0x5D, 0xEA, 0x3D, 0x00, 0x55,
+    0xB6, 0xBA, 0x7E, 0x7C, 0x86, 0xD4, 0x5A, 0xA3, 0xDF, 0x51, 0x93, 0xBD, 0xEB, 0xF9, 0x66, 0xE4,
+    0x87, 0x37, 0x9E, 0x79, 0x35, 0x15, 0x64, 0xDB, 0x2A, 0xF9, 0xEC, 0x4D, 0x02, 0xC2, 0x62, 0xCD,
+    0x2A, 0x7A, 0x42, 0x10, 0x33, 0x76, 0x8A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x5F, 0x29, 0x5C,
+    0x03, 0xC0, 0xAE, 0x01, 0x80, 0x10, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0xBA, 0xF8, 0x0F, 0xBD,
+    0xE0, 0x07, 0xFF, 0x00, 0xA6, 0x5D, 0x00, 0x39, 0x88, 0x09, 0x86, 0xD4, 0x1F, 0x45, 0xB8, 0x21,
+    0x6C, 0x56, 0x83, 0xA8, 0x38, 0x9B, 0x47, 0xAB, 0xDD, 0xE8, 0xD4, 0x8B, 0xFE, 0xB4, 0x90, 0xB6,
+    0x28, 0xF8, 0xB3, 0x1E, 0x82, 0x89, 0x07, 0x17, 0x07, 0x5B, 0x25, 0x18, 0x8D, 0x67, 0xE4, 0xF8,
+    0xEB, 0xCE, 0x1E, 0x02, 0x80, 0x9E, 0xFB, 0x5D, 0xB7, 0x93, 0xA8, 0xEB, 0xA2, 0x68, 0xBE, 0xED,
+    0x73, 0xA4, 0x41, 0x66, 0x45, 0x41, 0x5A, 0x57, 0xC0, 0x2C, 0x7D, 0x85, 0x9A, 0xBD, 0x8F, 0xDD,
+    0xE0, 0xB7, 0xC3, 0xBA, 0x8D, 0xC1, 0x22, 0x8E, 0x9A, 0x11, 0x68, 0x2A, 0x63, 0x77, 0x47, 0x52,
+    0x99, 0xC0, 0x4C, 0x78, 0x76, 0xD2, 0xD2, 0x8E, 0x76, 0xC2, 0xAC, 0x85, 0xAC, 0x2E, 0xC0, 0xD0,
+    0xDF, 0x1F, 0x5A, 0x7D, 0xFF, 0x0F, 0xFC, 0x14, 0x47, 0x8C, 0x64, 0x9C, 0x03, 0xAC, 0x76, 0xAF,
+    0x87, 0x5F, 0xF8, 0xA8, 0x83, 0xF9, 0x44, 0x5F, 0xF1, 0x1E, 0x62, 0x84, 0x6B, 0xC8, 0xF7, 0x5F,
+    0xF3, 0x08, 0x06, 0x21, 0xAC, 0x19, 0x18, 0x33, 0xA9, 0x32, 0x27, 0x2B, 0x3F, 0x8D, 0x5A, 0x66,
+    0x09, 0xF0, 0x05, 0x49, 0xAB, 0x8B, 0x25, 0xCB, 0x56, 0x84, 0x6F, 0x4B, 0x48, 0x00, 0x00, 0x00,
+    0xE4, 0xED, 0x8E, 0x14, 0x03, 0xC0, 0x88, 0x01, 0xDE, 0x09, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00,
+    0xC4, 0xB3, 0xA6, 0x4D, 0xE0, 0x04, 0xDD, 0x00, 0x80, 0x5D, 0x00, 0x10, 0x1A, 0x4A, 0x62, 0x03,
+    0x10, 0xA4, 0xEE, 0xC5, 0xEC, 0x9E, 0xF8, 0xEE, 0xA5, 0x2E, 0x07, 0xC8, 0xF2, 0x57, 0x8D, 0x5E,
+    0xBB, 0xFF, 0x3C, 0xB6, 0x4E, 0xA1, 0x1B, 0x49, 0x8A, 0x48, 0xC0, 0x5D, 0x9C, 0xB5, 0x53, 0x00,
+    0x3A, 0xE4, 0x61, 0x81, 0x5C, 0x1D, 0xFF, 0x32, 0xCB, 0x3C, 0x67, 0x26, 0x11, 0xEC, 0x54, 0x81,
+    0xC8, 0x68, 0xA7, 0xE6, 0xD5, 0xD3, 0x0E, 0xA7, 0x39, 0xC8, 0x7A, 0x8B, 0x11, 0x3E, 0x94, 0x69,
+    0xE8, 0x95, 0x1F, 0x98, 0x6F, 0x28, 0x4E, 0x22, 0x18, 0xE2, 0xA5, 0x78, 0xFD, 0x86, 0x20, 0xA9,
+    0x0B, 0x6C, 0x19, 0xB3, 0x95, 0x27, 0x8F, 0x0B, 0xAA, 0x4B, 0x12, 0x21, 0x58, 0xC9, 0x15, 0xEC,
+    0x64, 0x90, 0x2E, 0x88, 0xDC, 0x07, 0xAA, 0xD9, 0x8D, 0x4C, 0x0D, 0xEA, 0xA1, 0x31, 0xD0, 0x3E,
+    0x2E, 0x79, 0xAC, 0x0E, 0x24, 0xD2, 0x3C, 0x9B, 0x12, 0x95, 0xA8, 0x00, 0x17, 0x1D, 0x66, 0x6E,
+    0x00, 0x04, 0xB5, 0x01, 0x80, 0x10, 0xC9, 0x01, 0x80, 0x10, 0xC2, 0x01, 0x80, 0x10, 0x9C, 0x01,
+    0xDE, 0x09, 0x00, 0x00, 0x42, 0x00, 0x81, 0xFE, 0x86, 0x00, 0x08, 0x96, 0x05, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x59, 0x5A,
+};
+
+static ByteBuffer multi_block_test_data()
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 300; i++)
+        builder.appendff("This is line number {}.\n", i);
+    return MUST(builder.to_byte_buffer());
+}
+
+static ErrorOr<ByteBuffer> decompress_in_parallel(ReadonlyBytes compressed, size_t thread_count, size_t max_buffered_size = 256 * MiB)
+{
+    FixedMemoryStream input { compressed };
+    AllocatingMemoryStream output;
+    TRY(Compress::XzDecompressor::decompress_in_parallel(input, output, thread_count, max_buffered_size));
+    return output.read_until_eof();
+}
+
+TEST_CASE(parallel_multiple_blocks)
+{
+    auto expected = multi_block_test_data();
+
+    for (size_t thread_count : Array<size_t, 4> { 1, 2, 3, 8 }) {
+        auto buffer = TRY_OR_FAIL(decompress_in_parallel(multi_block_compressed, thread_count));
+        EXPECT_EQ(buffer.span(), expected.span());
+    }
+
+    // A limit that is smaller than a single block has to still make progress.
+    auto buffer = TRY_OR_FAIL(decompress_in_parallel(multi_block_compressed, 4, 1));
+    EXPECT_EQ(buffer.span(), expected.span());
+}
+
+TEST_CASE(parallel_multiple_streams_with_padding)
+{
+    auto compressed = MUST(ByteBuffer::copy(multi_block_compressed));
+    MUST(compressed.try_append("\0\0\0\0"sv.bytes()));
+    MUST(compressed.try_append(multi_block_compressed));
+    MUST(compressed.try_append("\0\0\0\0\0\0\0\0"sv.bytes()));
+
+    auto expected = multi_block_test_data();
+    MUST(expected.try_append(expected.bytes()));
+
+    auto buffer = TRY_OR_FAIL(decompress_in_parallel(compressed, 4));
+    EXPECT_EQ(buffer.span(), expected.span());
+
+    // The sequential decoder has to agree.
+    auto stream = MUST(try_make<FixedMemoryStream>(compressed.bytes()));
+    auto decompressor = MUST(Compress::XzDecompressor::create(move(stream)));
+    auto sequential_buffer = TRY_OR_FAIL(decompressor->read_until_eof(PAGE_SIZE));
+    EXPECT_EQ(sequential_buffer.span(), expected.span());
+}
+
+TEST_CASE(parallel_rejects_corrupted_input)
+{
+    // Misaligned stream padding.
+    auto compressed = MUST(ByteBuffer::copy(multi_block_compressed));
+    MUST(compressed.try_append("\0\0"sv.bytes()));
+    EXPECT(decompress_in_parallel(compressed, 4).is_error());
+
+    // Leading stream padding.
+    compressed = MUST(ByteBuffer::copy("\0\0\0\0"sv.bytes()));
+    MUST(compressed.try_append(multi_block_compressed));
+    EXPECT(decompress_in_parallel(compressed, 4).is_error());
+
+    // Damaged header of the first block.
+    compressed = MUST(ByteBuffer::copy(multi_block_compressed));
+    compressed[13] ^= 0x01;
+    EXPECT(decompress_in_parallel(compressed, 4).is_error());
+
+    // Damaged index.
+    compressed = MUST(ByteBuffer::copy(multi_block_compressed));
+    compressed[compressed.size() - 20] ^= 0x01;
+    EXPECT(decompress_in_parallel(compressed, 4).is_error());
+
+    EXPECT(decompress_in_parallel({}, 4).is_error());
+}
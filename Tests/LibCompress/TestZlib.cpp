@@ -7,6 +7,7 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/Array.h>
+#include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
 
 TEST_CASE(zlib_decompress_simple)
@@ -77,3 +78,24 @@ TEST_CASE(zlib_decompress_with_missing_end_bits)
     EXPECT(maybe_decompressed.has_value());
     EXPECT_EQ(maybe_decompressed.value().span(), decompressed.span());
 }
+
+TEST_CASE(zlib_compress_in_parallel)
+{
+    auto original = MUST(ByteBuffer::create_uninitialized(3 * Compress::DeflateCompressor::parallel_chunk_size + 1234));
+    for (size_t i = 0; i < original.size(); ++i)
+        original[i] = (i * 7 + i / 4096) % 251;
+
+    for (size_t thread_count : { 1, 4 }) {
+        auto compressed = MUST(Compress::ZlibCompressor::compress_all_in_parallel(original, thread_count));
+        auto decompressed = Compress::ZlibDecompressor::decompress_all(compressed);
+        EXPECT(decompressed.has_value());
+        EXPECT_EQ(decompressed.value().span(), original.span());
+
+        // The checksum of the whole input is stored after the deflate stream, just like in the single-threaded output.
+        auto compressed_on_one_thread = MUST(Compress::ZlibCompressor::compress_all(original));
+        EXPECT_EQ(compressed.span().slice_from_end(4), compressed_on_one_thread.span().slice_from_end(4));
+    }
+
+    auto compressed_empty_input = MUST(Compress::ZlibCompressor::compress_all_in_parallel({}, 4));
+    EXPECT(Compress::ZlibDecompressor::decompress_all(compressed_empty_input).value().is_empty());
+}
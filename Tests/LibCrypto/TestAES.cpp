@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
@@ -454,3 +455,70 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_CBC_round_trip_all_key_sizes)
+{
+    auto plaintext = ByteBuffer::create_uninitialized(4099).release_value();
+    fill_with_random(plaintext);
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    fill_with_random(iv);
+
+    for (size_t key_bits : Array<size_t, 3> { 128, 192, 256 }) {
+        auto key = ByteBuffer::create_uninitialized(key_bits / 8).release_value();
+        fill_with_random(key);
+
+        Crypto::Cipher::AESCipher::CBCMode encryptor(key, key_bits, Crypto::Cipher::Intent::Encryption);
+        auto ciphertext = encryptor.create_aligned_buffer(plaintext.size()).release_value();
+        auto ciphertext_span = ciphertext.bytes();
+        encryptor.encrypt(plaintext, ciphertext_span, iv);
+
+        Crypto::Cipher::AESCipher::CBCMode decryptor(key, key_bits, Crypto::Cipher::Intent::Decryption);
+        auto decrypted = decryptor.create_aligned_buffer(ciphertext_span.size()).release_value();
+        auto decrypted_span = decrypted.bytes();
+        decryptor.decrypt(ciphertext_span, decrypted_span, iv);
+
+        EXPECT_EQ(decrypted_span, plaintext.bytes());
+    }
+}
+
+static constexpr size_t benchmark_input_size = 4 * MiB;
+
+BENCHMARK_CASE(benchmark_AES_CBC_encrypt)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto out = cipher.create_aligned_buffer(input.size()).release_value();
+    auto out_span = out.bytes();
+    cipher.encrypt(input, out_span, iv);
+}
+
+BENCHMARK_CASE(benchmark_AES_CBC_decrypt)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Decryption);
+    auto out = cipher.create_aligned_buffer(input.size()).release_value();
+    auto out_span = out.bytes();
+    cipher.decrypt(input, out_span, iv);
+}
+
+BENCHMARK_CASE(benchmark_AES_CTR_encrypt)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    Crypto::Cipher::AESCipher::CTRMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto out = ByteBuffer::create_uninitialized(input.size()).release_value();
+    auto out_span = out.bytes();
+    cipher.encrypt(input, out_span, iv);
+}
+
+BENCHMARK_CASE(benchmark_AES_GCM_encrypt)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto out = ByteBuffer::create_uninitialized(input.size()).release_value();
+    auto out_span = out.bytes();
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    cipher.encrypt(input, out_span, "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"_b, {}, tag);
+}
@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/Random.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibTest/TestCase.h>
@@ -33,3 +36,97 @@ TEST_CASE(test_crc32)
     do_test(DeprecatedString("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(DeprecatedString("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+static ByteBuffer make_random_buffer(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    fill_with_random(buffer);
+    return buffer;
+}
+
+static u32 reference_adler32(ReadonlyBytes data)
+{
+    u32 a = 1;
+    u32 b = 0;
+    for (auto byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static u32 reference_crc32(ReadonlyBytes data)
+{
+    u32 state = ~0u;
+    for (auto byte : data) {
+        state ^= byte;
+        for (size_t i = 0; i < 8; ++i)
+            state = (state >> 1) ^ ((state & 1) * 0xEDB88320);
+    }
+    return ~state;
+}
+
+TEST_CASE(test_checksums_match_reference_for_all_lengths_and_alignments)
+{
+    auto buffer = make_random_buffer(600);
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t length = 0; offset + length <= buffer.size(); length += (length < 130 ? 1 : 37)) {
+            auto data = buffer.bytes().slice(offset, length);
+            EXPECT_EQ(Crypto::Checksum::CRC32(data).digest(), reference_crc32(data));
+            EXPECT_EQ(Crypto::Checksum::Adler32(data).digest(), reference_adler32(data));
+        }
+    }
+}
+
+TEST_CASE(test_checksums_match_reference_for_large_inputs)
+{
+    // Large enough to require several intermediate reductions of the Adler-32 sums.
+    auto buffer = make_random_buffer(100'000);
+    EXPECT_EQ(Crypto::Checksum::CRC32(buffer).digest(), reference_crc32(buffer));
+    EXPECT_EQ(Crypto::Checksum::Adler32(buffer).digest(), reference_adler32(buffer));
+
+    buffer.bytes().fill(0xff);
+    EXPECT_EQ(Crypto::Checksum::Adler32(buffer).digest(), reference_adler32(buffer));
+
+    // Updating piecewise must give the same result as updating all at once.
+    Crypto::Checksum::CRC32 crc32;
+    Crypto::Checksum::Adler32 adler32;
+    for (size_t offset = 0; offset < buffer.size(); offset += 777) {
+        auto piece = buffer.bytes().slice(offset, min<size_t>(777, buffer.size() - offset));
+        crc32.update(piece);
+        adler32.update(piece);
+    }
+    EXPECT_EQ(crc32.digest(), reference_crc32(buffer));
+    EXPECT_EQ(adler32.digest(), reference_adler32(buffer));
+}
+
+TEST_CASE(test_checksum_combine)
+{
+    auto buffer = make_random_buffer(10'000);
+    for (size_t split : Array<size_t, 7> { 0, 1, 63, 64, 4096, 9999, 10'000 }) {
+        auto first = buffer.bytes().trim(split);
+        auto second = buffer.bytes().slice(split);
+
+        auto crc32 = Crypto::Checksum::CRC32::combine(Crypto::Checksum::CRC32(first).digest(), Crypto::Checksum::CRC32(second).digest(), second.size());
+        EXPECT_EQ(crc32, Crypto::Checksum::CRC32(buffer).digest());
+
+        auto adler32 = Crypto::Checksum::Adler32::combine(Crypto::Checksum::Adler32(first).digest(), Crypto::Checksum::Adler32(second).digest(), second.size());
+        EXPECT_EQ(adler32, Crypto::Checksum::Adler32(buffer).digest());
+    }
+}
+
+static constexpr size_t benchmark_buffer_size = 16 * MiB;
+
+BENCHMARK_CASE(benchmark_crc32)
+{
+    auto buffer = make_random_buffer(benchmark_buffer_size);
+    for (size_t i = 0; i < 16; ++i)
+        EXPECT_NE(Crypto::Checksum::CRC32(buffer).digest(), 0u);
+}
+
+BENCHMARK_CASE(benchmark_adler32)
+{
+    auto buffer = make_random_buffer(benchmark_buffer_size);
+    for (size_t i = 0; i < 16; ++i)
+        EXPECT_NE(Crypto::Checksum::Adler32(buffer).digest(), 0u);
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/Hash/MD5.h>
@@ -268,3 +269,102 @@ TEST_CASE(test_ghash_galois_field_multiply2)
     Crypto::Authentication::galois_multiply(z, x, y);
     EXPECT(memcmp(result, z, 4 * sizeof(u32)) == 0);
 }
+
+static ByteBuffer million_as()
+{
+    auto buffer = ByteBuffer::create_uninitialized(1'000'000).release_value();
+    buffer.bytes().fill('a');
+    return buffer;
+}
+
+TEST_CASE(test_SHA1_hash_million_as)
+{
+    u8 result[] {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+    };
+    auto input = million_as();
+    auto digest = Crypto::Hash::SHA1::hash(input);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+
+    // Feed the data in pieces that do not line up with the block size.
+    Crypto::Hash::SHA1 hasher;
+    for (size_t offset = 0; offset < input.size(); offset += 1000)
+        hasher.update(input.bytes().slice(offset, 1000));
+    digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_million_as)
+{
+    u8 result[] {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+    };
+    auto input = million_as();
+    auto digest = Crypto::Hash::SHA256::hash(input);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+
+    Crypto::Hash::SHA256 hasher;
+    for (size_t offset = 0; offset < input.size(); offset += 1000)
+        hasher.update(input.bytes().slice(offset, 1000));
+    digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+// A straightforward bitwise implementation, to check the accelerated code path against.
+static void reference_galois_multiply(u32 (&z)[4], u32 const (&_x)[4], u32 const (&_y)[4])
+{
+    u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
+    u32 result[4] { 0, 0, 0, 0 };
+    for (int i = 0; i < 128; ++i) {
+        if ((_y[i / 32] >> (31 - i % 32)) & 1) {
+            for (size_t j = 0; j < 4; ++j)
+                result[j] ^= x[j];
+        }
+        bool carry = x[3] & 1;
+        x[3] = (x[3] >> 1) | (x[2] << 31);
+        x[2] = (x[2] >> 1) | (x[1] << 31);
+        x[1] = (x[1] >> 1) | (x[0] << 31);
+        x[0] >>= 1;
+        if (carry)
+            x[0] ^= 0xe1000000;
+    }
+    for (size_t j = 0; j < 4; ++j)
+        z[j] = result[j];
+}
+
+TEST_CASE(test_ghash_galois_field_multiply_random)
+{
+    for (size_t i = 0; i < 1000; ++i) {
+        u32 x[4], y[4], z[4], expected[4];
+        fill_with_random({ reinterpret_cast<u8*>(x), sizeof(x) });
+        fill_with_random({ reinterpret_cast<u8*>(y), sizeof(y) });
+
+        Crypto::Authentication::galois_multiply(z, x, y);
+        reference_galois_multiply(expected, x, y);
+        EXPECT(memcmp(expected, z, sizeof(z)) == 0);
+    }
+}
+
+static constexpr size_t benchmark_input_size = 16 * MiB;
+
+BENCHMARK_CASE(benchmark_SHA1)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    auto digest = Crypto::Hash::SHA1::hash(input);
+    EXPECT_NE(digest.data[0] | digest.data[1], 0);
+}
+
+BENCHMARK_CASE(benchmark_SHA256)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    auto digest = Crypto::Hash::SHA256::hash(input);
+    EXPECT_NE(digest.data[0] | digest.data[1], 0);
+}
+
+BENCHMARK_CASE(benchmark_ghash)
+{
+    auto input = ByteBuffer::create_zeroed(benchmark_input_size).release_value();
+    Crypto::Authentication::GHash ghash("WellHelloFriends");
+    auto tag = ghash.process({}, input);
+    EXPECT_NE(tag.data[0] | tag.data[1], 0);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibDNS/Packet.h>
+#include <LibTest/TestCase.h>
+
+static ByteBuffer make_response()
+{
+    DNS::Packet response;
+    response.set_is_response();
+    response.set_id(1234);
+    response.set_code(DNS::Packet::Code::NOERROR);
+    DNS::Name name { "serenityos.org" };
+    response.add_question({ name, DNS::RecordType::A, DNS::RecordClass::IN, false });
+    response.add_answer({ name, DNS::RecordType::A, DNS::RecordClass::IN, 300, DeprecatedString { "\x7f\x00\x00\x01", 4 }, false });
+    return MUST(response.to_byte_buffer());
+}
+
+TEST_CASE(round_trip)
+{
+    auto buffer = make_response();
+    auto packet = DNS::Packet::from_raw_packet(buffer.data(), buffer.size());
+    EXPECT(packet.has_value());
+    EXPECT_EQ(packet->id(), 1234);
+    EXPECT_EQ(packet->question_count(), 1);
+    EXPECT_EQ(packet->answer_count(), 1);
+    EXPECT_EQ(packet->answers()[0].type(), DNS::RecordType::A);
+    EXPECT_EQ(packet->answers()[0].ttl(), 300u);
+    EXPECT_EQ(packet->answers()[0].record_data(), DeprecatedString("\x7f\x00\x00\x01", 4));
+}
+
+TEST_CASE(truncated_packets_are_rejected)
+{
+    auto buffer = make_response();
+    for (size_t size = 0; size < buffer.size(); ++size) {
+        // Copy into an exactly-sized buffer, so that reading past the end is caught by sanitizers.
+        auto truncated = MUST(ByteBuffer::copy(buffer.bytes().trim(size)));
+        EXPECT(!DNS::Packet::from_raw_packet(truncated.data(), truncated.size()).has_value());
+    }
+}
+
+TEST_CASE(record_data_length_past_end_is_rejected)
+{
+    auto buffer = make_response();
+    // The A record ends with its 16-bit data length and 4 bytes of data.
+    buffer[buffer.size() - 6] = 0xff;
+    buffer[buffer.size() - 5] = 0xff;
+    EXPECT(!DNS::Packet::from_raw_packet(buffer.data(), buffer.size()).has_value());
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Time.h>
+#include <LibCore/System.h>
+#include <LibDNS/NameserverQuery.h>
+#include <LibDNS/Packet.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Thread.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+
+// A nameserver on the loopback interface that answers every query the way the test tells it to.
+class FakeNameserver {
+public:
+    enum class Behavior {
+        Answer,
+        NameDoesNotExist,
+        // Keep sending responses to the wrong query ID, and garbage, but never an answer.
+        Junk,
+        JunkThenAnswer,
+    };
+
+    static ErrorOr<NonnullOwnPtr<FakeNameserver>> create(int family, Behavior behavior)
+    {
+        auto fd = TRY(Core::System::socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0));
+        sockaddr_storage address {};
+        socklen_t address_length = 0;
+        if (family == AF_INET) {
+            auto& address_in = *reinterpret_cast<sockaddr_in*>(&address);
+            address_in.sin_family = AF_INET;
+            address_in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address_length = sizeof(sockaddr_in);
+        } else {
+            auto& address_in6 = *reinterpret_cast<sockaddr_in6*>(&address);
+            address_in6.sin6_family = AF_INET6;
+            address_in6.sin6_addr = in6addr_loopback;
+            address_length = sizeof(sockaddr_in6);
+        }
+        if (auto result = Core::System::bind(fd, reinterpret_cast<sockaddr*>(&address), address_length); result.is_error()) {
+            (void)Core::System::close(fd);
+            return result.release_error();
+        }
+        TRY(Core::System::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_length));
+
+        u16 port = family == AF_INET ? ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port) : ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+        auto nameserver = adopt_own(*new FakeNameserver(fd, behavior));
+        nameserver->m_address = family == AF_INET ? DeprecatedString::formatted("127.0.0.1:{}", port) : DeprecatedString::formatted("[::1]:{}", port);
+        nameserver->m_thread = Threading::Thread::construct([nameserver = nameserver.ptr()] { return nameserver->serve(); });
+        nameserver->m_thread->start();
+        return nameserver;
+    }
+
+    ~FakeNameserver()
+    {
+        m_should_stop.store(true);
+        (void)m_thread->join();
+        (void)Core::System::close(m_fd);
+    }
+
+    DeprecatedString const& address() const { return m_address; }
+    size_t query_count() const { return m_query_count.load(); }
+
+private:
+    FakeNameserver(int fd, Behavior behavior)
+        : m_fd(fd)
+        , m_behavior(behavior)
+    {
+    }
+
+    void send_to_peer(DNS::Packet const& packet)
+    {
+        auto buffer = MUST(packet.to_byte_buffer());
+        (void)Core::System::sendto(m_fd, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr const*>(&m_peer), m_peer_length);
+    }
+
+    void send_junk(DNS::Packet const& query)
+    {
+        DNS::Packet wrong_id;
+        wrong_id.set_is_response();
+        wrong_id.set_id(query.id() + 1);
+        for (auto& question : query.questions())
+            wrong_id.add_question(question);
+        send_to_peer(wrong_id);
+
+        u8 garbage[] = { 0xde, 0xad, 0xbe, 0xef, 0x00, 0x01 };
+        (void)Core::System::sendto(m_fd, garbage, sizeof(garbage), 0, reinterpret_cast<sockaddr const*>(&m_peer), m_peer_length);
+    }
+
+    void respond(DNS::Packet const& query)
+    {
+        DNS::Packet response;
+        response.set_is_response();
+        response.set_id(query.id());
+        for (auto& question : query.questions())
+            response.add_question(question);
+        if (m_behavior == Behavior::NameDoesNotExist) {
+            response.set_code(DNS::Packet::Code::NXDOMAIN);
+        } else {
+            response.set_code(DNS::Packet::Code::NOERROR);
+            auto& question = query.questions().first();
+            response.add_answer({ question.name(), DNS::RecordType::CNAME, DNS::RecordClass::IN, 60, "alias.example", false });
+            response.add_answer({ question.name(), DNS::RecordType::A, DNS::RecordClass::IN, 60, DeprecatedString { "\x0a\x00\x00\x2a", 4 }, false });
+        }
+        send_to_peer(response);
+    }
+
+    intptr_t serve()
+    {
+        Optional<DNS::Packet> last_query;
+        while (!m_should_stop.load()) {
+            pollfd poll_fd { m_fd, POLLIN, 0 };
+            auto rc = Core::System::poll({ &poll_fd, 1 }, 20);
+            if (!rc.is_error() && rc.value() > 0) {
+                u8 buffer[512];
+                m_peer_length = sizeof(m_peer);
+                auto nrecv = Core::System::recvfrom(m_fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&m_peer), &m_peer_length);
+                if (nrecv.is_error())
+                    continue;
+                auto query = DNS::Packet::from_raw_packet(buffer, nrecv.value());
+                if (!query.has_value() || !query->is_query() || query->question_count() != 1)
+                    continue;
+                ++m_query_count;
+                last_query = query.release_value();
+
+                if (m_behavior == Behavior::JunkThenAnswer) {
+                    for (int i = 0; i < 5; ++i)
+                        send_junk(*last_query);
+                }
+                if (m_behavior != Behavior::Junk)
+                    respond(*last_query);
+            }
+            if (m_behavior == Behavior::Junk && last_query.has_value())
+                send_junk(*last_query);
+        }
+        return 0;
+    }
+
+    int m_fd { -1 };
+    Behavior m_behavior;
+    DeprecatedString m_address;
+    RefPtr<Threading::Thread> m_thread;
+    Atomic<bool> m_should_stop { false };
+    Atomic<size_t> m_query_count { 0 };
+    sockaddr_storage m_peer {};
+    socklen_t m_peer_length { 0 };
+};
+
+TEST_CASE(answer)
+{
+    auto nameserver = MUST(FakeNameserver::create(AF_INET, FakeNameserver::Behavior::Answer));
+    Vector<DeprecatedString> nameservers { nameserver->address() };
+
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::Answered);
+    EXPECT_EQ(result.answers.size(), 1u);
+    EXPECT_EQ(result.answers[0].type(), DNS::RecordType::A);
+    EXPECT_EQ(result.answers[0].record_data(), DeprecatedString("\x0a\x00\x00\x2a", 4));
+    // The CNAME is handed back for caching, even though it doesn't answer the question.
+    EXPECT_EQ(result.records.size(), 2u);
+}
+
+TEST_CASE(name_does_not_exist)
+{
+    auto nameserver = MUST(FakeNameserver::create(AF_INET, FakeNameserver::Behavior::NameDoesNotExist));
+    Vector<DeprecatedString> nameservers { nameserver->address() };
+
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "nonexistent.serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::NameDoesNotExist);
+    EXPECT(result.answers.is_empty());
+    // Without an SOA record the negative response must not be cached.
+    EXPECT(!result.negative_ttl.has_value());
+}
+
+TEST_CASE(unrelated_packets_do_not_extend_the_deadline)
+{
+    auto nameserver = MUST(FakeNameserver::create(AF_INET, FakeNameserver::Behavior::Junk));
+    Vector<DeprecatedString> nameservers { nameserver->address() };
+
+    auto start = Time::now_monotonic();
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers, Time::from_milliseconds(1500)));
+    auto elapsed = Time::now_monotonic() - start;
+
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::NoResponse);
+    EXPECT(elapsed >= Time::from_milliseconds(1500));
+    EXPECT(elapsed < Time::from_seconds(3));
+    // We resent the query once a second while waiting.
+    EXPECT(nameserver->query_count() >= 2);
+}
+
+TEST_CASE(answer_after_junk)
+{
+    auto nameserver = MUST(FakeNameserver::create(AF_INET, FakeNameserver::Behavior::JunkThenAnswer));
+    Vector<DeprecatedString> nameservers { nameserver->address() };
+
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::Answered);
+    EXPECT_EQ(result.answers.size(), 1u);
+}
+
+TEST_CASE(unusable_nameservers_are_skipped)
+{
+    auto nameserver = MUST(FakeNameserver::create(AF_INET, FakeNameserver::Behavior::Answer));
+    Vector<DeprecatedString> nameservers { "not-an-address", "1.2.3.4:99999", nameserver->address() };
+
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::Answered);
+}
+
+TEST_CASE(no_usable_nameservers)
+{
+    Vector<DeprecatedString> nameservers { "not-an-address" };
+
+    auto start = Time::now_monotonic();
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::NoResponse);
+    // There is nothing to wait for.
+    EXPECT(Time::now_monotonic() - start < Time::from_seconds(1));
+}
+
+TEST_CASE(ipv6_nameserver)
+{
+    auto nameserver_or_error = FakeNameserver::create(AF_INET6, FakeNameserver::Behavior::Answer);
+    if (nameserver_or_error.is_error()) {
+        warnln("Skipping, no IPv6 loopback: {}", nameserver_or_error.error());
+        return;
+    }
+    auto nameserver = nameserver_or_error.release_value();
+    Vector<DeprecatedString> nameservers { nameserver->address() };
+
+    auto result = MUST(DNS::query_nameservers(DNS::Name { "serenityos.org" }, DNS::RecordType::A, nameservers));
+    EXPECT_EQ(result.outcome, DNS::NameserverQueryResult::Outcome::Answered);
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/QuickSort.h>
+#include <LibCore/File.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/DirectoryWalker.h>
+#include <LibFileSystem/TempFile.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <unistd.h>
+
+using FileSystem::DirectoryWalker;
+
+struct WalkResult {
+    Vector<DeprecatedString> paths;
+    Vector<size_t> depths;
+    Vector<DeprecatedString> error_paths;
+    Vector<int> error_codes;
+};
+
+static WalkResult walk(DirectoryWalker& walker, StringView root_path)
+{
+    WalkResult result;
+    walker.on_entry = [&](auto const& entry) -> ErrorOr<void> {
+        result.paths.append(entry.path.substring_view(root_path.length()));
+        result.depths.append(entry.depth);
+        return {};
+    };
+    walker.on_error = [&](auto const& path, Error error) -> ErrorOr<void> {
+        result.error_paths.append(path.substring_view(min(root_path.length(), path.length())));
+        result.error_codes.append(error.code());
+        return {};
+    };
+    MUST(walker.walk(root_path));
+    return result;
+}
+
+static void create_file(StringView path)
+{
+    (void)MUST(Core::File::open(path, Core::File::OpenMode::Write));
+}
+
+// Four directories of eight files each, and a few more directories nested inside the first one.
+static NonnullOwnPtr<FileSystem::TempFile> create_tree()
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    for (size_t i = 0; i < 4; ++i) {
+        auto subdirectory = DeprecatedString::formatted("{}/dir{}", directory->path(), i);
+        MUST(Core::System::mkdir(subdirectory, 0755));
+        for (size_t j = 0; j < 8; ++j)
+            create_file(DeprecatedString::formatted("{}/file{}", subdirectory, j));
+    }
+    auto nested = DeprecatedString::formatted("{}/dir0", directory->path());
+    for (size_t i = 0; i < 5; ++i) {
+        nested = DeprecatedString::formatted("{}/nested", nested);
+        MUST(Core::System::mkdir(nested, 0755));
+        create_file(DeprecatedString::formatted("{}/file", nested));
+    }
+    return directory;
+}
+
+static bool parents_come_first(WalkResult const& result)
+{
+    HashMap<DeprecatedString, size_t> positions;
+    for (size_t i = 0; i < result.paths.size(); ++i)
+        positions.set(result.paths[i], i);
+    for (size_t i = 0; i < result.paths.size(); ++i) {
+        auto const& path = result.paths[i];
+        auto slash = path.find_last('/');
+        if (!slash.has_value() || *slash == 0)
+            continue;
+        auto parent = positions.get(path.substring_view(0, *slash));
+        if (!parent.has_value() || *parent >= i)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE(depth_first_order_does_not_depend_on_thread_count)
+{
+    auto directory = create_tree();
+
+    DirectoryWalker walker;
+    auto sequential = walk(walker, directory->path());
+    // The root, 4 directories with 8 files each, and 5 nested directories with a file each.
+    EXPECT_EQ(sequential.paths.size(), 1u + 4 * 9 + 5 * 2);
+    EXPECT_EQ(sequential.paths[0], ""sv);
+    EXPECT_EQ(sequential.depths[0], 0u);
+    EXPECT(parents_come_first(sequential));
+    EXPECT(sequential.error_paths.is_empty());
+
+    for (size_t thread_count : { 2, 4, 16 }) {
+        walker.set_thread_count(thread_count);
+        auto parallel = walk(walker, directory->path());
+        EXPECT_EQ(parallel.paths, sequential.paths);
+        EXPECT_EQ(parallel.depths, sequential.depths);
+    }
+}
+
+TEST_CASE(unordered_walk_finds_everything)
+{
+    auto directory = create_tree();
+
+    DirectoryWalker walker;
+    auto expected = walk(walker, directory->path()).paths;
+    quick_sort(expected);
+
+    walker.set_order(DirectoryWalker::Order::Unordered);
+    for (size_t thread_count : { 1, 4 }) {
+        walker.set_thread_count(thread_count);
+        auto result = walk(walker, directory->path());
+        EXPECT(parents_come_first(result));
+        quick_sort(result.paths);
+        EXPECT_EQ(result.paths, expected);
+    }
+}
+
+TEST_CASE(stopping_the_walk)
+{
+    auto directory = create_tree();
+
+    for (size_t thread_count : { 1, 4 }) {
+        DirectoryWalker walker;
+        walker.set_thread_count(thread_count);
+        size_t entry_count = 0;
+        walker.on_entry = [&](auto const&) -> ErrorOr<void> {
+            if (++entry_count == 10)
+                return Error::from_errno(ECANCELED);
+            return {};
+        };
+        auto result = walker.walk(directory->path().to_deprecated_string());
+        EXPECT(result.is_error());
+        EXPECT_EQ(result.error().code(), ECANCELED);
+        EXPECT_EQ(entry_count, 10u);
+    }
+}
+
+TEST_CASE(errors)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+
+    DirectoryWalker walker;
+    auto missing_path = DeprecatedString::formatted("{}/missing", directory->path());
+    auto result = walk(walker, missing_path);
+    EXPECT(result.paths.is_empty());
+    EXPECT_EQ(result.error_codes, Vector<int> { ENOENT });
+
+    // Without an error callback, errors don't stop the walk.
+    walker.on_error = nullptr;
+    walker.on_entry = [](auto const&) -> ErrorOr<void> { return {}; };
+    MUST(walker.walk(missing_path));
+
+    // A symlink that can't be followed is reported as the link itself.
+    MUST(Core::System::symlink("missing"sv, DeprecatedString::formatted("{}/dangling", directory->path())));
+    walker.set_follow_symlinks(DirectoryWalker::FollowSymlinks::Yes);
+    result = walk(walker, directory->path());
+    EXPECT_EQ(result.paths, (Vector<DeprecatedString> { "", "/dangling" }));
+    EXPECT(result.error_paths.is_empty());
+
+    // Root can read any directory, so there's no unreadable directory to find.
+    if (geteuid() == 0)
+        return;
+    auto unreadable_path = DeprecatedString::formatted("{}/unreadable", directory->path());
+    MUST(Core::System::mkdir(unreadable_path, 0));
+    for (size_t thread_count : { 1, 4 }) {
+        walker.set_thread_count(thread_count);
+        result = walk(walker, directory->path());
+        EXPECT_EQ(result.error_paths, Vector<DeprecatedString> { "/unreadable" });
+        EXPECT_EQ(result.error_codes, Vector<int> { EACCES });
+    }
+    MUST(Core::System::rmdir(unreadable_path));
+}
+
+TEST_CASE(symlink_loops)
+{
+    auto directory = create_tree();
+    auto root_path = directory->path().to_deprecated_string();
+    // One link back to the root, one to its own directory, and one that goes around through another directory.
+    MUST(Core::System::symlink(root_path, DeprecatedString::formatted("{}/dir1/to_root", root_path)));
+    MUST(Core::System::symlink("."sv, DeprecatedString::formatted("{}/dir2/to_self", root_path)));
+    MUST(Core::System::symlink("../../dir3"sv, DeprecatedString::formatted("{}/dir0/nested/to_dir3", root_path)));
+    MUST(Core::System::symlink("../dir0/nested"sv, DeprecatedString::formatted("{}/dir3/to_nested", root_path)));
+
+    DirectoryWalker walker;
+    walker.set_follow_symlinks(DirectoryWalker::FollowSymlinks::Yes);
+    for (auto order : { DirectoryWalker::Order::DepthFirst, DirectoryWalker::Order::Unordered }) {
+        walker.set_order(order);
+        for (size_t thread_count : { 1, 4 }) {
+            walker.set_thread_count(thread_count);
+            auto result = walk(walker, root_path);
+            quick_sort(result.error_paths);
+            EXPECT_EQ(result.error_paths, (Vector<DeprecatedString> {
+                                              "/dir0/nested/to_dir3/to_nested",
+                                              "/dir1/to_root",
+                                              "/dir2/to_self",
+                                              "/dir3/to_nested/to_dir3",
+                                          }));
+            for (auto code : result.error_codes)
+                EXPECT_EQ(code, ELOOP);
+            // Everything is still found, once through the links that don't lead back up.
+            EXPECT(result.paths.contains_slow("/dir0/nested/to_dir3/file0"sv));
+            EXPECT(result.paths.contains_slow("/dir3/to_nested/nested/file"sv));
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/File.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/FileSystem.h>
+#include <LibFileSystem/TempFile.h>
+#include <LibTest/TestCase.h>
+#include <sys/stat.h>
+
+static void write_file(StringView path, StringView contents, mode_t mode = 0644)
+{
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Write, mode));
+    MUST(file->write_until_depleted(contents.bytes()));
+    MUST(Core::System::chmod(path, mode));
+}
+
+static DeprecatedString read_file(StringView path)
+{
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Read));
+    return DeprecatedString { MUST(file->read_until_eof()).bytes() };
+}
+
+static ErrorOr<void> copy_file(StringView destination_path, StringView source_path)
+{
+    auto source = TRY(Core::File::open(source_path, Core::File::OpenMode::Read));
+    auto source_stat = TRY(Core::System::fstat(source->fd()));
+    return FileSystem::copy_file(destination_path, source_path, source_stat, *source);
+}
+
+TEST_CASE(copy_file)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto source_path = MUST(String::formatted("{}/source", directory->path()));
+    auto destination_path = MUST(String::formatted("{}/destination", directory->path()));
+    write_file(source_path, "Well hello friends!"sv);
+    write_file(destination_path, "This is longer than the source, and should be gone after copying."sv);
+
+    MUST(copy_file(destination_path, source_path));
+    EXPECT_EQ(read_file(destination_path), "Well hello friends!"sv);
+
+    // Copying into a directory puts the file inside it.
+    auto subdirectory_path = MUST(String::formatted("{}/subdirectory", directory->path()));
+    MUST(Core::System::mkdir(subdirectory_path, 0755));
+    MUST(copy_file(subdirectory_path, source_path));
+    EXPECT_EQ(read_file(MUST(String::formatted("{}/source", subdirectory_path))), "Well hello friends!"sv);
+}
+
+TEST_CASE(copy_file_onto_itself)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto source_path = MUST(String::formatted("{}/source", directory->path()));
+    write_file(source_path, "Well hello friends!"sv);
+
+    auto result = copy_file(source_path, source_path);
+    EXPECT(result.is_error());
+    EXPECT_EQ(read_file(source_path), "Well hello friends!"sv);
+
+    // The same file under another name, and the same file inside the destination directory.
+    auto link_path = MUST(String::formatted("{}/link", directory->path()));
+    MUST(Core::System::link(source_path, link_path));
+    EXPECT(copy_file(link_path, source_path).is_error());
+    EXPECT(copy_file(directory->path(), source_path).is_error());
+    EXPECT_EQ(read_file(source_path), "Well hello friends!"sv);
+}
+
+TEST_CASE(copy_directory_on_several_threads)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto source_path = MUST(String::formatted("{}/source", directory->path()));
+    MUST(Core::System::mkdir(source_path, 0777));
+    MUST(Core::System::chmod(source_path, 0777));
+    for (size_t i = 0; i < 4; ++i) {
+        auto subdirectory_path = MUST(String::formatted("{}/dir{}", source_path, i));
+        MUST(Core::System::mkdir(subdirectory_path, 0777));
+        MUST(Core::System::chmod(subdirectory_path, 0777));
+        for (size_t j = 0; j < 16; ++j)
+            write_file(MUST(String::formatted("{}/file{}", subdirectory_path, j)), MUST(String::formatted("file {} of dir{}", j, i)), 0777);
+    }
+
+    auto old_umask = umask(022);
+    auto destination_path = MUST(String::formatted("{}/destination", directory->path()));
+    auto source_stat = MUST(Core::System::stat(source_path));
+    auto result = FileSystem::copy_directory(destination_path, source_path, source_stat, FileSystem::LinkMode::Disallowed, FileSystem::PreserveMode::Nothing, FileSystem::UseHelperThreads::Yes);
+    // Every copy saw the same umask, and it was left as it was.
+    EXPECT_EQ(umask(old_umask), static_cast<mode_t>(022));
+    MUST(result);
+
+    EXPECT_EQ(MUST(Core::System::stat(destination_path)).st_mode & 07777, static_cast<mode_t>(0755));
+    for (size_t i = 0; i < 4; ++i) {
+        auto subdirectory_path = MUST(String::formatted("{}/dir{}", destination_path, i));
+        EXPECT_EQ(MUST(Core::System::stat(subdirectory_path)).st_mode & 07777, static_cast<mode_t>(0755));
+        for (size_t j = 0; j < 16; ++j) {
+            auto file_path = MUST(String::formatted("{}/file{}", subdirectory_path, j));
+            EXPECT_EQ(MUST(Core::System::stat(file_path)).st_mode & 07777, static_cast<mode_t>(0755));
+            EXPECT_EQ(read_file(file_path), DeprecatedString::formatted("file {} of dir{}", j, i));
+        }
+    }
+}
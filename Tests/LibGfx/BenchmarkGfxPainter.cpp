@@ -6,9 +6,11 @@
 
 #include <LibTest/TestCase.h>
 
+#include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/FontDatabase.h>
 #include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
 #include <stdio.h>
 
 BENCHMARK_CASE(diagonal_lines)
@@ -52,3 +54,107 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(fill_with_alpha)
+{
+    int const run_count = 200;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.fill_rect(bitmap->rect(), Color(Color::Blue).with_alpha(100));
+    }
+}
+
+BENCHMARK_CASE(fill_with_translucent_gradient)
+{
+    int const run_count = 50;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.fill_rect_with_gradient(bitmap->rect(), Color(Color::Blue).with_alpha(50), Color(Color::Red).with_alpha(200));
+    }
+}
+
+BENCHMARK_CASE(blit_with_opacity)
+{
+    int const run_count = 100;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    source->fill(Color::Red);
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, source, source->rect(), 0.5f);
+    }
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    int const run_count = 100;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter(source).fill_rect_with_gradient(source->rect(), Color(Color::Blue).with_alpha(50), Color(Color::Red).with_alpha(200));
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(draw_scaled_bitmap_with_bilinear_blending)
+{
+    int const run_count = 20;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { bitmap_size / 3, bitmap_size / 3 }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter(source).fill_rect_with_gradient(source->rect(), Color(Color::Blue).with_alpha(50), Color(Color::Red).with_alpha(200));
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.draw_scaled_bitmap(bitmap->rect(), source, source->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
+    }
+}
+
+BENCHMARK_CASE(fill_path_antialiased)
+{
+    int const run_count = 50;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    bitmap->fill(Color::White);
+    Gfx::Painter painter(bitmap);
+    Gfx::AntiAliasingPainter aa_painter(painter);
+
+    // A star with many points, which crosses itself and has plenty of edges on every row.
+    Gfx::Path path;
+    int const point_count = 101;
+    for (int i = 0; i < point_count; i++) {
+        auto angle = i * 50 * 2 * AK::Pi<float> / point_count;
+        Gfx::FloatPoint point { bitmap_size / 2 + cosf(angle) * bitmap_size * 0.45f, bitmap_size / 2 + sinf(angle) * bitmap_size * 0.45f };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+
+    for (int run = 0; run < run_count; run++) {
+        aa_painter.fill_path(path, Color(Color::Blue).with_alpha(200), Gfx::Painter::WindingRule::EvenOdd);
+    }
+}
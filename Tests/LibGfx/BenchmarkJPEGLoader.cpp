@@ -4,9 +4,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibGfx/ImageFormats/JPEGLoader.h>
 #include <LibTest/TestCase.h>
+#include <sys/resource.h>
 
 #ifdef AK_OS_SERENITY
 #    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
@@ -18,31 +20,50 @@
 //        https://github.com/llvm/llvm-project/commit/fd86789962964a98157e8159c3d95cdc241942e3
 // clang-format off
 auto small_image = Core::File::open(TEST_INPUT("rgb24.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto big_image = Core::File::open(TEST_INPUT("big_image.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+auto progressive_image = Core::File::open(TEST_INPUT("successive_approximation.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto rgb_image = Core::File::open(TEST_INPUT("rgb_components.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto several_scans = Core::File::open(TEST_INPUT("several_scans.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 // clang-format on
 
+// Decodes the image a few times and reports how many megapixels were decoded per second, along with the peak memory
+// use of the process so far (where the system keeps track of it).
+static void decode_and_report(StringView name, ReadonlyBytes data)
+{
+    static constexpr int run_count = 10;
+
+    Gfx::IntSize size;
+    auto timer = Core::ElapsedTimer::start_new();
+    for (int run = 0; run < run_count; run++) {
+        auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(data));
+        size = MUST(plugin_decoder->frame(0)).image->size();
+    }
+    auto elapsed_microseconds = max<i64>(timer.elapsed_time().to_microseconds(), 1);
+    auto megapixels_per_second = static_cast<double>(size.width()) * size.height() * run_count / elapsed_microseconds;
+
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    if (usage.ru_maxrss > 0)
+        outln("{}: {}x{}, {:.1} MP/s, peak memory {} KiB", name, size.width(), size.height(), megapixels_per_second, usage.ru_maxrss);
+    else
+        outln("{}: {}x{}, {:.1} MP/s", name, size.width(), size.height(), megapixels_per_second);
+}
+
 BENCHMARK_CASE(small_image)
 {
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(small_image));
-    MUST(plugin_decoder->frame(0));
+    decode_and_report("small_image"sv, small_image);
 }
 
-BENCHMARK_CASE(big_image)
+BENCHMARK_CASE(progressive_image)
 {
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(big_image));
-    MUST(plugin_decoder->frame(0));
+    decode_and_report("progressive_image"sv, progressive_image);
 }
 
 BENCHMARK_CASE(rgb_image)
 {
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(rgb_image));
-    MUST(plugin_decoder->frame(0));
+    decode_and_report("rgb_image"sv, rgb_image);
 }
 
 BENCHMARK_CASE(several_scans)
 {
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(several_scans));
-    MUST(plugin_decoder->frame(0));
+    decode_and_report("several_scans"sv, several_scans);
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Random.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Blending.h>
+#include <LibGfx/Painter.h>
+#include <LibTest/TestCase.h>
+
+// Runs of opaque destination pixels take the vectorized path, while translucent ones fall back to Color::blend().
+static Vector<Gfx::ARGB32> make_destination_pixels(size_t count)
+{
+    Vector<Gfx::ARGB32> pixels;
+    for (size_t i = 0; i < count; ++i) {
+        auto pixel = get_random<Gfx::ARGB32>();
+        if ((i / 13) % 3 != 0)
+            pixel |= 0xff000000;
+        pixels.append(pixel);
+    }
+    return pixels;
+}
+
+static Vector<Gfx::ARGB32> make_source_pixels(size_t count)
+{
+    Vector<Gfx::ARGB32> pixels;
+    for (size_t i = 0; i < count; ++i) {
+        auto pixel = get_random<Gfx::ARGB32>();
+        // Make sure the special cases of Color::blend() are covered.
+        if (i % 7 == 0)
+            pixel |= 0xff000000;
+        else if (i % 7 == 1)
+            pixel &= 0x00ffffff;
+        pixels.append(pixel);
+    }
+    return pixels;
+}
+
+TEST_CASE(blend_pixels_matches_color_blend)
+{
+    for (size_t count : { 0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 1000 }) {
+        auto destination = make_destination_pixels(count);
+        auto source = make_source_pixels(count);
+
+        auto blended = destination;
+        Gfx::blend_pixels(blended.span(), source.span());
+        for (size_t i = 0; i < count; ++i)
+            EXPECT_EQ(blended[i], Color::from_argb(destination[i]).blend(Color::from_argb(source[i])).value());
+
+        for (auto color : { Color(10, 200, 30, 77), Color(255, 255, 255, 1), Color(0, 0, 0, 254) }) {
+            blended = destination;
+            Gfx::blend_pixels(blended.span(), color);
+            for (size_t i = 0; i < count; ++i)
+                EXPECT_EQ(blended[i], Color::from_argb(destination[i]).blend(color).value());
+        }
+    }
+}
+
+TEST_CASE(blend_pixels_with_opacity_matches_color_blend)
+{
+    size_t const count = 1000;
+    auto destination = make_destination_pixels(count);
+    auto source = make_source_pixels(count);
+
+    Gfx::BlendWithOpacityOptions options;
+    for (size_t alpha = 0; alpha < options.alpha_map.size(); ++alpha)
+        options.alpha_map[alpha] = alpha * 2 / 3;
+
+    for (bool swap_red_and_blue : { false, true }) {
+        for (bool opaque_destination : { false, true }) {
+            options.swap_red_and_blue = swap_red_and_blue;
+            options.opaque_destination = opaque_destination;
+
+            auto blended = destination;
+            Gfx::blend_pixels(blended.span(), source.span(), options);
+            for (size_t i = 0; i < count; ++i) {
+                auto destination_color = opaque_destination ? Color::from_rgb(destination[i]) : Color::from_argb(destination[i]);
+                auto source_color = Color::from_argb(source[i]);
+                if (swap_red_and_blue)
+                    source_color = Color(source_color.blue(), source_color.green(), source_color.red(), source_color.alpha());
+                source_color.set_alpha(options.alpha_map[source_color.alpha()]);
+                EXPECT_EQ(blended[i], destination_color.blend(source_color).value());
+            }
+        }
+    }
+}
+
+TEST_CASE(blend_coverage_matches_multiplied_glyph_pixels)
+{
+    size_t const count = 1000;
+    auto destination = make_destination_pixels(count);
+    Vector<u8> coverage;
+    for (size_t i = 0; i < count; ++i)
+        coverage.append(i % 5 == 0 ? 0 : i % 5 == 1 ? 255 : get_random<u8>());
+
+    for (auto color : { Color(10, 200, 30), Color(40, 80, 120, 100) }) {
+        auto blended = destination;
+        Gfx::blend_coverage(blended.span(), coverage.span(), color);
+        for (size_t i = 0; i < count; ++i) {
+            auto glyph_pixel = Color(Color::White).with_alpha(coverage[i]).multiply(color);
+            EXPECT_EQ(blended[i], Color::from_argb(destination[i]).blend(glyph_pixel).value());
+        }
+    }
+}
+
+TEST_CASE(translucent_fill_matches_color_blend)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { 37, 5 }));
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x)
+            bitmap->set_pixel(x, y, Color::from_argb(y % 2 ? get_random<Gfx::ARGB32>() : get_random<Gfx::ARGB32>() | 0xff000000));
+    }
+    auto original = MUST(bitmap->clone());
+
+    Color color(40, 80, 120, 100);
+    Gfx::Painter painter(bitmap);
+    painter.fill_rect({ 3, 1, 30, 3 }, color);
+
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x) {
+            auto expected = original->get_pixel(x, y);
+            if (x >= 3 && x < 33 && y >= 1 && y < 4)
+                expected = expected.blend(color);
+            EXPECT_EQ(bitmap->get_pixel(x, y), expected);
+        }
+    }
+}
@@ -8,6 +8,7 @@
 #include <AK/Utf8View.h>
 #include <LibGfx/Font/BitmapFont.h>
 #include <LibGfx/Font/FontDatabase.h>
+#include <LibGfx/Font/GlyphAtlas.h>
 #include <LibTest/TestCase.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -167,3 +168,62 @@ TEST_CASE(test_character_set_masking)
     EXPECT(!masked_font.value()->glyph_index(0x0100).has_value());
     EXPECT(masked_font.value()->glyph_index(0xFFFD).value() == 0x1FD);
 }
+
+static NonnullRefPtr<Gfx::Bitmap> create_glyph_bitmap(Gfx::IntSize size, u8 alpha)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size));
+    bitmap->fill(Color(Color::White).with_alpha(alpha));
+    return bitmap;
+}
+
+TEST_CASE(test_glyph_atlas)
+{
+    Gfx::GlyphAtlas atlas;
+    auto font_id = Gfx::GlyphAtlas::allocate_font_id();
+    Gfx::GlyphAtlasKey key { font_id, 1, { 0, 0 } };
+    EXPECT(!atlas.find(key).has_value());
+
+    auto entry = atlas.add(key, create_glyph_bitmap({ 7, 11 }, 123));
+    EXPECT(entry.has_value());
+    EXPECT_EQ(entry->rect.size(), Gfx::IntSize(7, 11));
+    EXPECT_EQ(entry->page->scanline(entry->rect.y() + 10)[entry->rect.x() + 6], 123);
+    EXPECT_EQ(atlas.find(key)->rect, entry->rect);
+
+    // Glyphs at other subpixel offsets are separate entries, and don't overlap.
+    auto other_entry = atlas.add({ font_id, 1, { 1, 0 } }, create_glyph_bitmap({ 7, 11 }, 45));
+    EXPECT(!other_entry->rect.intersects(entry->rect));
+
+    // Glyphs without any coverage are remembered as such.
+    auto empty_entry = atlas.add({ font_id, 2, { 0, 0 } }, nullptr);
+    EXPECT(empty_entry.has_value());
+    EXPECT(!empty_entry->page);
+
+    EXPECT(!atlas.add({ font_id, 3, { 0, 0 } }, create_glyph_bitmap({ Gfx::GlyphAtlas::max_glyph_size + 1, 1 }, 255)).has_value());
+
+    atlas.remove_glyphs_of_font(font_id);
+    EXPECT(!atlas.find(key).has_value());
+    // The pages of removed glyphs stay alive for as long as entries on them are held.
+    EXPECT_EQ(entry->page->scanline(entry->rect.y())[entry->rect.x()], 123);
+}
+
+TEST_CASE(test_glyph_atlas_evicts_least_recently_used_page)
+{
+    Gfx::GlyphAtlas atlas;
+    auto font_id = Gfx::GlyphAtlas::allocate_font_id();
+    auto glyph_size = Gfx::GlyphAtlas::max_glyph_size;
+    auto glyphs_per_page = static_cast<u32>((Gfx::GlyphAtlas::page_size / glyph_size) * (Gfx::GlyphAtlas::page_size / glyph_size));
+    auto glyph = create_glyph_bitmap({ glyph_size, glyph_size }, 255);
+
+    u32 glyph_id = 0;
+    for (; glyph_id < glyphs_per_page * Gfx::GlyphAtlas::max_page_count; ++glyph_id)
+        EXPECT(atlas.add({ font_id, glyph_id, { 0, 0 } }, glyph).has_value());
+    EXPECT_EQ(atlas.page_count(), Gfx::GlyphAtlas::max_page_count);
+
+    // Using a glyph on the first page makes the second page the least recently used one.
+    EXPECT(atlas.find({ font_id, 0, { 0, 0 } }).has_value());
+    EXPECT(atlas.add({ font_id, glyph_id, { 0, 0 } }, glyph).has_value());
+    EXPECT_EQ(atlas.page_count(), Gfx::GlyphAtlas::max_page_count);
+    EXPECT(atlas.find({ font_id, 0, { 0, 0 } }).has_value());
+    EXPECT(!atlas.find({ font_id, glyphs_per_page, { 0, 0 } }).has_value());
+    EXPECT(atlas.find({ font_id, glyphs_per_page * 2, { 0, 0 } }).has_value());
+}
@@ -178,6 +178,75 @@ TEST_CASE(test_jpeg_sof2_12bits)
     EXPECT_EQ(frame.image->size(), Gfx::IntSize(320, 240));
 }
 
+TEST_CASE(test_jpeg_decode_to_ideal_size)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("several_scans.jpg"sv)));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    EXPECT(plugin_decoder->initialize());
+
+    // The largest of 1/2, 1/4 and 1/8 of the image that is still at least as big as the ideal size.
+    auto frame = MUST(plugin_decoder->frame(0, Gfx::IntSize { 100, 100 }));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(148, 200));
+    auto scaled_down = frame.image;
+
+    frame = MUST(plugin_decoder->frame(0, Gfx::IntSize { 50, 50 }));
+    EXPECT_EQ(frame.image, scaled_down);
+
+    // Asking for a larger image decodes it again.
+    frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(592, 800));
+
+    // Every pixel is about the average of the pixels it covers.
+    for (int y = 0; y < scaled_down->height(); y += 37) {
+        for (int x = 0; x < scaled_down->width(); x += 23) {
+            int red = 0;
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++)
+                    red += frame.image->get_pixel(x * 4 + j, y * 4 + i).red();
+            }
+            EXPECT(abs(scaled_down->get_pixel(x, y).red() - red / 16) <= 2);
+        }
+    }
+}
+
+TEST_CASE(test_jpeg_icc_data_outlives_decoding_again)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("icc-v4.jpg"sv)));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    EXPECT(plugin_decoder->initialize());
+
+    (void)MUST(plugin_decoder->frame(0, Gfx::IntSize { 1, 1 }));
+    auto icc_data = MUST(plugin_decoder->icc_data());
+    EXPECT(icc_data.has_value());
+    auto icc_copy = MUST(ByteBuffer::copy(*icc_data));
+
+    // Decoding at full size starts over with a new context, the bytes handed out before must still be valid.
+    (void)MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(*icc_data, icc_copy.bytes());
+    EXPECT_EQ(MUST(plugin_decoder->icc_data())->data(), icc_data->data());
+}
+
+TEST_CASE(test_jpeg_incomplete_data)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("icc-v4.jpg"sv)));
+    auto full_image = MUST(MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()))->frame(0)).image;
+
+    // Not even the start of the frame has arrived.
+    EXPECT(!Gfx::ImageDecoder::try_create_for_incomplete_bytes(file->bytes().trim(2)));
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_incomplete_bytes(file->bytes().trim(file->bytes().size() / 2));
+    EXPECT(decoder);
+    EXPECT_EQ(decoder->size(), Gfx::IntSize(400, 400));
+    auto frame = MUST(decoder->incomplete_first_frame());
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(400, 400));
+
+    // The top of the image is there, the bottom hasn't arrived yet.
+    for (int x = 0; x < 400; x += 7) {
+        EXPECT_EQ(frame.image->get_pixel(x, 0), full_image->get_pixel(x, 0));
+        EXPECT_EQ(frame.image->get_pixel(x, 399), Gfx::Color(Gfx::Color::Black));
+    }
+}
+
 TEST_CASE(test_pbm)
 {
     auto file = MUST(Core::MappedFile::map(TEST_INPUT("buggie-raw.pbm"sv)));
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/ImageFormats/PNGLoader.h>
+#include <LibGfx/ImageFormats/PNGWriter.h>
+#include <LibTest/TestCase.h>
+
+// Smooth gradients with some noise on top, so that every PNG filter gets picked for some rows.
+static NonnullRefPtr<Gfx::Bitmap> create_test_bitmap(Gfx::IntSize size)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size));
+    u32 noise = 1;
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            noise = noise * 1103515245 + 12345;
+            auto speckle = (y % 7 == 0) ? (noise >> 16) & 0xff : 0;
+            bitmap->set_pixel(x, y, Color(x * 255 / size.width(), (y * 3) & 0xff, (x + y + speckle) & 0xff, 255 - (x ^ y) % 64));
+        }
+    }
+    return bitmap;
+}
+
+static void expect_round_trip(Gfx::Bitmap const& bitmap, Gfx::PNGWriter::Options const& options)
+{
+    auto encoded = MUST(Gfx::PNGWriter::encode(bitmap, options));
+    auto plugin_decoder = MUST(Gfx::PNGImageDecoderPlugin::create(encoded));
+    auto decoded = MUST(plugin_decoder->frame(0)).image;
+    EXPECT_EQ(decoded->size(), bitmap.size());
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x)
+            EXPECT_EQ(decoded->get_pixel(x, y), bitmap.get_pixel(x, y));
+    }
+}
+
+TEST_CASE(png_round_trip)
+{
+    auto bitmap = create_test_bitmap({ 97, 61 });
+    expect_round_trip(*bitmap, {});
+}
+
+TEST_CASE(png_round_trip_on_several_threads)
+{
+    // Large enough for the compressed data to be split into several chunks.
+    auto bitmap = create_test_bitmap({ 300, 500 });
+    Gfx::PNGWriter::Options options;
+    for (size_t thread_count : { 2, 3, 8 }) {
+        options.thread_count = thread_count;
+        expect_round_trip(*bitmap, options);
+    }
+
+    // More threads than rows.
+    auto small_bitmap = create_test_bitmap({ 5, 3 });
+    options.thread_count = 4;
+    expect_round_trip(*small_bitmap, options);
+}
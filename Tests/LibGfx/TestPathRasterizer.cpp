@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/AntiAliasingPainter.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+#include <LibGfx/PathRasterizer.h>
+#include <LibTest/TestCase.h>
+
+static constexpr Gfx::IntSize rasterizer_size { 12, 10 };
+
+static Gfx::Path rectangle_path(Gfx::FloatRect const& rect)
+{
+    auto right = rect.x() + rect.width();
+    auto bottom = rect.y() + rect.height();
+    Gfx::Path path;
+    path.move_to(rect.location());
+    path.line_to({ right, rect.y() });
+    path.line_to({ right, bottom });
+    path.line_to({ rect.x(), bottom });
+    path.close();
+    return path;
+}
+
+// Returns the coverage of every pixel, as collected from the rows the rasterizer emits.
+static Vector<u8> rasterize(Gfx::Path const& path, Gfx::Painter::WindingRule winding_rule = Gfx::Painter::WindingRule::Nonzero)
+{
+    Gfx::PathRasterizer rasterizer(rasterizer_size);
+    rasterizer.draw_path(path);
+
+    Vector<u8> pixels;
+    pixels.resize(rasterizer_size.area());
+    rasterizer.accumulate_rows(winding_rule, [&](int y, int x, ReadonlySpan<u8> coverage, u8 coverage_of_rest_of_row) {
+        auto* row = pixels.data() + y * rasterizer_size.width();
+        for (size_t i = 0; i < coverage.size(); ++i)
+            row[x + i] = coverage[i];
+        for (int i = x + coverage.size(); i < rasterizer_size.width(); ++i)
+            row[i] = coverage_of_rest_of_row;
+    });
+    return pixels;
+}
+
+static u8 pixel(Vector<u8> const& pixels, int x, int y)
+{
+    return pixels[y * rasterizer_size.width() + x];
+}
+
+TEST_CASE(rectangle_on_pixel_boundaries)
+{
+    auto pixels = rasterize(rectangle_path({ 2, 3, 4, 5 }));
+    for (int y = 0; y < rasterizer_size.height(); ++y) {
+        for (int x = 0; x < rasterizer_size.width(); ++x) {
+            bool inside = x >= 2 && x < 6 && y >= 3 && y < 8;
+            EXPECT_EQ(pixel(pixels, x, y), inside ? 255 : 0);
+        }
+    }
+}
+
+TEST_CASE(partially_covered_pixels)
+{
+    auto pixels = rasterize(rectangle_path({ 2.5f, 3, 4, 2.25f }));
+    EXPECT_EQ(pixel(pixels, 1, 3), 0);
+    EXPECT_EQ(pixel(pixels, 2, 3), 127);
+    EXPECT_EQ(pixel(pixels, 3, 3), 255);
+    EXPECT_EQ(pixel(pixels, 6, 3), 127);
+    EXPECT_EQ(pixel(pixels, 7, 3), 0);
+    EXPECT_EQ(pixel(pixels, 4, 5), 63);
+    EXPECT_EQ(pixel(pixels, 4, 6), 0);
+}
+
+TEST_CASE(diagonal_edge)
+{
+    Gfx::Path path;
+    path.move_to({ 0, 0 });
+    path.line_to({ 8, 8 });
+    path.line_to({ 0, 8 });
+    path.close();
+    auto pixels = rasterize(path);
+    for (int y = 0; y < 8; ++y) {
+        EXPECT_EQ(pixel(pixels, y, y), 127);
+        if (y > 0)
+            EXPECT_EQ(pixel(pixels, y - 1, y), 255);
+        EXPECT_EQ(pixel(pixels, y + 1, y), 0);
+    }
+}
+
+TEST_CASE(winding_rules)
+{
+    // Two squares winding the same way, one inside the other.
+    auto path = rectangle_path({ 1, 1, 8, 8 });
+    path.append_path(rectangle_path({ 3, 3, 4, 4 }));
+
+    auto nonzero = rasterize(path, Gfx::Painter::WindingRule::Nonzero);
+    EXPECT_EQ(pixel(nonzero, 2, 2), 255);
+    EXPECT_EQ(pixel(nonzero, 4, 4), 255);
+
+    auto even_odd = rasterize(path, Gfx::Painter::WindingRule::EvenOdd);
+    EXPECT_EQ(pixel(even_odd, 2, 2), 255);
+    EXPECT_EQ(pixel(even_odd, 4, 4), 0);
+    EXPECT_EQ(pixel(even_odd, 7, 7), 255);
+    EXPECT_EQ(pixel(even_odd, 9, 9), 0);
+}
+
+TEST_CASE(lines_outside_are_clipped)
+{
+    auto pixels = rasterize(rectangle_path({ -5, -5, 10, 30 }));
+    for (int y = 0; y < rasterizer_size.height(); ++y) {
+        for (int x = 0; x < rasterizer_size.width(); ++x)
+            EXPECT_EQ(pixel(pixels, x, y), x < 5 ? 255 : 0);
+    }
+
+    // Slanted lines that leave the rasterizer on the left still cover everything right of them.
+    Gfx::Path path;
+    path.move_to({ -10, 0 });
+    path.line_to({ 30, 0 });
+    path.line_to({ 30, 10 });
+    path.line_to({ -10, 10 });
+    path.line_to({ 10, 5 });
+    path.close();
+    pixels = rasterize(path);
+    EXPECT_EQ(pixel(pixels, 0, 0), 255);
+    EXPECT_EQ(pixel(pixels, 11, 9), 255);
+    EXPECT_EQ(pixel(pixels, 5, 5), 0);
+    EXPECT_EQ(pixel(pixels, 0, 5), 0);
+}
+
+TEST_CASE(open_subpaths_are_closed)
+{
+    Gfx::Path open_path;
+    open_path.move_to({ 1, 1 });
+    open_path.line_to({ 9, 2 });
+    open_path.line_to({ 4, 8 });
+
+    auto closed_path = open_path;
+    closed_path.close();
+
+    EXPECT_EQ(rasterize(open_path), rasterize(closed_path));
+}
+
+TEST_CASE(rasterizer_can_be_reused)
+{
+    Gfx::PathRasterizer rasterizer(rasterizer_size);
+    rasterizer.draw_path(rectangle_path({ 1, 1, 4, 4 }));
+    rasterizer.accumulate_rows(Gfx::Painter::WindingRule::Nonzero, [](int, int, ReadonlySpan<u8>, u8) {});
+
+    rasterizer.draw_path(rectangle_path({ 6, 6, 2, 2 }));
+    int row_count = 0;
+    rasterizer.accumulate_rows(Gfx::Painter::WindingRule::Nonzero, [&](int y, int x, ReadonlySpan<u8> coverage, u8 coverage_of_rest_of_row) {
+        ++row_count;
+        EXPECT(y == 6 || y == 7);
+        EXPECT_EQ(x, 6);
+        // The span may extend into the pixels right of the square, which aren't covered.
+        EXPECT(coverage.size() >= 2);
+        for (size_t i = 0; i < coverage.size(); ++i)
+            EXPECT_EQ(coverage[i], i < 2 ? 255 : 0);
+        EXPECT_EQ(coverage_of_rest_of_row, 0);
+    });
+    EXPECT_EQ(row_count, 2);
+}
+
+TEST_CASE(glyph_bitmap)
+{
+    Gfx::PathRasterizer rasterizer(rasterizer_size);
+    rasterizer.draw_path(rectangle_path({ 2, 2, 3, 3 }));
+    auto bitmap = rasterizer.accumulate();
+    EXPECT(bitmap);
+    EXPECT_EQ(bitmap->get_pixel(3, 3), Color(255, 255, 255, 255));
+    EXPECT_EQ(bitmap->get_pixel(6, 3).alpha(), 0);
+    EXPECT_EQ(bitmap->get_pixel(0, 0).alpha(), 0);
+}
+
+TEST_CASE(painter_fills_path_with_translation_and_clip)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 40, 30 }));
+    bitmap->fill(Color::White);
+    Gfx::Painter painter(bitmap);
+    painter.translate(10, 5);
+    painter.add_clip_rect({ 0, 0, 8, 100 });
+    painter.fill_path(rectangle_path({ 2, 2, 10, 10 }), Color::Red);
+
+    EXPECT_EQ(bitmap->get_pixel(11, 6), Color(Color::White));
+    EXPECT_EQ(bitmap->get_pixel(12, 7), Color(Color::Red));
+    EXPECT_EQ(bitmap->get_pixel(17, 16), Color(Color::Red));
+    // Clipped away on the right, and below the path.
+    EXPECT_EQ(bitmap->get_pixel(18, 7), Color(Color::White));
+    EXPECT_EQ(bitmap->get_pixel(12, 17), Color(Color::White));
+}
+
+TEST_CASE(antialiased_fill_path_blends_edges)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 20, 20 }));
+    bitmap->fill(Color::White);
+    Gfx::Painter painter(bitmap);
+    Gfx::AntiAliasingPainter aa_painter(painter);
+    aa_painter.fill_path(rectangle_path({ 2.5f, 2, 10, 10 }), Color::Black);
+
+    EXPECT_EQ(bitmap->get_pixel(1, 5), Color(Color::White));
+    EXPECT_EQ(bitmap->get_pixel(5, 5), Color(Color::Black));
+    auto edge = bitmap->get_pixel(2, 5);
+    EXPECT(edge.red() > 100 && edge.red() < 156);
+    EXPECT_EQ(bitmap->get_pixel(12, 5), edge);
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Time.h>
+#include <ImageDecoder/ConnectionFromClient.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/MappedFile.h>
+#include <LibCore/Socket.h>
+#include <LibCore/System.h>
+#include <LibGfx/Bitmap.h>
+#include <LibImageDecoderClient/Client.h>
+#include <LibImageDecoderClient/StreamingImage.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Thread.h>
+#include <sys/socket.h>
+
+#ifdef AK_OS_SERENITY
+#    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
+#else
+#    define TEST_INPUT(x) ("../LibGfx/test-inputs/" x)
+#endif
+
+// The server runs on a thread of its own, as it would in its own process, since the client waits for some of its
+// replies. It stops once the client disconnects.
+class ImageDecoderTestConnection {
+public:
+    ImageDecoderTestConnection()
+    {
+        // File descriptors are sent over a socket of their own, see ConnectionBase::fd_passing_socket().
+        int fds[2];
+        int fd_passing_fds[2];
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fds));
+        MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fd_passing_fds));
+        m_server_thread = Threading::Thread::construct([server_fd = fds[0], server_fd_passing_fd = fd_passing_fds[0]]() -> intptr_t {
+            Core::EventLoop loop;
+            auto server = MUST(ImageDecoder::ConnectionFromClient::try_create(MUST(Core::LocalSocket::adopt_fd(server_fd))));
+            server->set_fd_passing_socket(MUST(Core::LocalSocket::adopt_fd(server_fd_passing_fd)));
+            return loop.exec();
+        });
+        m_server_thread->start();
+
+        auto client_socket = MUST(Core::LocalSocket::adopt_fd(fds[1]));
+        MUST(client_socket->set_blocking(true));
+        m_client = adopt_ref(*new ImageDecoderClient::Client(move(client_socket)));
+        m_client->set_fd_passing_socket(MUST(Core::LocalSocket::adopt_fd(fd_passing_fds[1])));
+    }
+
+    ~ImageDecoderTestConnection()
+    {
+        // Only disconnecting makes the server quit its event loop.
+        m_client->shutdown();
+        (void)m_server_thread->join();
+    }
+
+    ImageDecoderClient::Client* operator->() { return m_client; }
+
+private:
+    RefPtr<ImageDecoderClient::Client> m_client;
+    RefPtr<Threading::Thread> m_server_thread;
+};
+
+static bool run_event_loop_until(Function<bool()> condition, Time timeout = Time::from_seconds(10))
+{
+    auto deadline = Time::now_monotonic() + timeout;
+    while (!condition()) {
+        if (Time::now_monotonic() > deadline)
+            return false;
+        if (Core::EventLoop::current().pump(Core::EventLoop::WaitMode::PollForEvents) == 0)
+            usleep(1000);
+    }
+    return true;
+}
+
+static void send_in_chunks(ImageDecoderClient::StreamingImage& image, ReadonlyBytes data, size_t chunk_size)
+{
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+        EXPECT(image.append_encoded_data(data.slice(offset, min(chunk_size, data.size() - offset))));
+        // Let the server get to the data before the next chunk, as it would if the data came in slowly.
+        Core::EventLoop::current().pump(Core::EventLoop::WaitMode::PollForEvents);
+    }
+    EXPECT(image.finish_encoded_data());
+}
+
+TEST_CASE(image_arrives_a_chunk_at_a_time)
+{
+    Core::EventLoop loop;
+    ImageDecoderTestConnection connection;
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("icc-v4.jpg"sv)));
+
+    auto image = connection->start_decoding_image();
+    EXPECT(image);
+
+    Vector<Gfx::IntSize> sizes;
+    Vector<NonnullRefPtr<Gfx::Bitmap>> incomplete_frames;
+    Optional<ImageDecoderClient::Frame> first_frame;
+    image->on_size = [&](auto size) { sizes.append(size); };
+    image->on_incomplete_frame_decoded = [&](auto bitmap) {
+        EXPECT(!first_frame.has_value());
+        incomplete_frames.append(bitmap);
+    };
+    image->on_frame_decoded = [&](u32 index, auto const& frame) {
+        EXPECT_EQ(index, 0u);
+        first_frame = frame;
+    };
+    image->on_failure = [] { FAIL("Decoding failed"); };
+
+    send_in_chunks(*image, file->bytes(), 2 * KiB);
+    EXPECT(run_event_loop_until([&] { return first_frame.has_value(); }));
+
+    // The size is only sent once, and the first frame shows up before all of the data is there.
+    EXPECT_EQ(sizes.size(), 1u);
+    EXPECT_EQ(sizes[0], Gfx::IntSize(400, 400));
+    EXPECT(!incomplete_frames.is_empty());
+    for (auto& bitmap : incomplete_frames)
+        EXPECT_EQ(bitmap->size(), Gfx::IntSize(400, 400));
+
+    EXPECT(!image->is_animated());
+    EXPECT_EQ(image->frame_count(), 1u);
+    EXPECT_EQ(first_frame->bitmap->size(), Gfx::IntSize(400, 400));
+    EXPECT(image->frame(0).has_value());
+}
+
+TEST_CASE(animation_frames_are_decoded_when_asked_for)
+{
+    Core::EventLoop loop;
+    ImageDecoderTestConnection connection;
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("download-animation.gif"sv)));
+
+    auto image = connection->start_decoding_image();
+    Vector<u32> decoded_frames;
+    image->on_frame_decoded = [&](u32 index, auto const&) { decoded_frames.append(index); };
+    image->on_failure = [] { FAIL("Decoding failed"); };
+
+    send_in_chunks(*image, file->bytes(), 1 * KiB);
+    EXPECT(run_event_loop_until([&] { return !decoded_frames.is_empty(); }));
+    EXPECT(image->is_animated());
+    EXPECT(image->frame_count() > 2);
+
+    // Only the first frame is decoded without being asked for.
+    EXPECT_EQ(decoded_frames, Vector<u32> { 0 });
+    EXPECT(!image->frame(2).has_value());
+    EXPECT(run_event_loop_until([&] { return decoded_frames.size() == 2; }));
+    EXPECT_EQ(decoded_frames[1], 2u);
+    EXPECT(image->frame(2).has_value());
+}
+
+TEST_CASE(undecodable_animation_frame)
+{
+    Core::EventLoop loop;
+    ImageDecoderTestConnection connection;
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("extended-lossless-animated.webp"sv)));
+
+    // Break the signature of the last frame's VP8L chunk, so that only that frame can't be decoded.
+    auto data = MUST(ByteBuffer::copy(file->bytes()));
+    auto last_frame_signature_offset = 4230u;
+    EXPECT_EQ(data[last_frame_signature_offset], 0x2f);
+    data[last_frame_signature_offset] = 0;
+
+    auto image = connection->start_decoding_image();
+    Vector<u32> decoded_frames;
+    Vector<u32> failed_frames;
+    image->on_frame_decoded = [&](u32 index, auto const&) { decoded_frames.append(index); };
+    image->on_frame_failed = [&](u32 index) { failed_frames.append(index); };
+    image->on_failure = [] { FAIL("Decoding failed"); };
+
+    send_in_chunks(*image, data, 1 * KiB);
+    EXPECT(run_event_loop_until([&] { return !decoded_frames.is_empty(); }));
+    EXPECT_EQ(image->frame_count(), 8u);
+
+    EXPECT(!image->frame(7).has_value());
+    EXPECT(run_event_loop_until([&] { return !failed_frames.is_empty(); }));
+    EXPECT_EQ(failed_frames, Vector<u32> { 7 });
+
+    // The frames that were decoded before are kept, and the broken one isn't asked for again.
+    EXPECT(image->frame(0).has_value());
+    EXPECT(!image->frame(7).has_value());
+    EXPECT(!run_event_loop_until([&] { return failed_frames.size() > 1; }, Time::from_milliseconds(500)));
+}
+
+TEST_CASE(undecodable_image)
+{
+    Core::EventLoop loop;
+    ImageDecoderTestConnection connection;
+
+    auto image = connection->start_decoding_image();
+    bool did_fail = false;
+    image->on_failure = [&] { did_fail = true; };
+
+    EXPECT(image->append_encoded_data("this is not an image"sv.bytes()));
+    EXPECT(image->finish_encoded_data());
+    EXPECT(run_event_loop_until([&] { return did_fail; }));
+
+    // The server forgot about the image, so the client has too.
+    EXPECT(!image->append_encoded_data("more"sv.bytes()));
+}
+
+TEST_CASE(images_are_not_kept_alive_by_the_client)
+{
+    Core::EventLoop loop;
+    ImageDecoderTestConnection connection;
+
+    auto image = connection->start_decoding_image();
+    EXPECT(image->append_encoded_data("partial"sv.bytes()));
+    WeakPtr<ImageDecoderClient::StreamingImage> weak_image = image->make_weak_ptr();
+    image = nullptr;
+    EXPECT(!weak_image);
+}
@@ -12,6 +12,8 @@
 #include <LibRegex/Regex.h>
 #include <LibRegex/RegexDebug.h>
 #include <LibRegex/RegexMatcher.h>
+#include <LibRegex/RegexPrefilter.h>
+#include <LibThreading/Thread.h>
 #include <stdio.h>
 
 static ECMAScriptOptions match_test_api_options(const ECMAScriptOptions options)
@@ -1135,3 +1137,294 @@ TEST_CASE(inversion_state_in_char_class)
         EXPECT_EQ(result.capture_group_matches.first()[1].view.to_deprecated_string(), "}"sv);
     }
 }
+
+TEST_CASE(pathological_backtracking)
+{
+    // These take exponential time to fail with a backtracking matcher, but are matched in linear time without one.
+    Array patterns {
+        "(a|a)*b"sv,
+        "(a*)*b"sv,
+        "(?:a|aa)+b"sv,
+        "(a?){25}a{25}b"sv,
+    };
+    auto subject = DeprecatedString::repeated('a', 10'000);
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern);
+        auto result = re.match(subject);
+        EXPECT_EQ(result.success, false);
+    }
+
+    Regex<ECMA262> re("(a|a)*b"sv, ECMAScriptFlags::Global);
+    auto result = re.match(DeprecatedString::formatted("{}b{}b", DeprecatedString::repeated('a', 1000), DeprecatedString::repeated('a', 1000)));
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.size(), 2u);
+    EXPECT_EQ(result.matches[0].view.length(), 1001u);
+    EXPECT_EQ(result.matches[1].global_offset, 1001u);
+    EXPECT_EQ(result.capture_group_matches[1][0].view.to_deprecated_string(), "a"sv);
+}
+
+TEST_CASE(empty_loop_iteration)
+{
+    // A loop iteration that matches the empty string ends the loop, instead of trying the other alternatives.
+    Regex<ECMA262> re("(\\b|.)*"sv, ECMAScriptFlags::Global);
+    auto result = re.match(" 1"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.size(), 3u);
+    EXPECT_EQ(result.matches[0].view.to_deprecated_string(), " "sv);
+    EXPECT_EQ(result.capture_group_matches[0][0].view.to_deprecated_string(), ""sv);
+    EXPECT_EQ(result.capture_group_matches[0][0].global_offset, 1u);
+}
+
+TEST_CASE(nfa_captures)
+{
+    struct {
+        StringView pattern;
+        StringView subject;
+        StringView match;
+        Vector<StringView> captures;
+    } tests[] = {
+        { "(a+)(b+)?c"sv, "xaac"sv, "aac"sv, { "aa"sv } },
+        { "(?:(a)|(b))+"sv, "ab"sv, "ab"sv, { "b"sv } },
+        { "(\\w+)@(\\w+)\\.com"sv, "mail bob@example.com now"sv, "bob@example.com"sv, { "bob"sv, "example"sv } },
+        { "([ab]*?)(b+)"sv, "aabbb"sv, "aabbb"sv, { "aa"sv, "bbb"sv } },
+        { "(x)?(y){2}"sv, "yyy"sv, "yy"sv, { "y"sv } },
+    };
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern, ECMAScriptFlags::Global);
+        auto result = re.match(test.subject);
+        EXPECT_EQ(result.success, true);
+        if (!result.success)
+            continue;
+        EXPECT_EQ(result.matches[0].view.to_deprecated_string(), test.match);
+        EXPECT_EQ(result.capture_group_matches[0].size(), test.captures.size());
+        for (size_t i = 0; i < min(test.captures.size(), result.capture_group_matches[0].size()); ++i)
+            EXPECT_EQ(result.capture_group_matches[0][i].view.to_deprecated_string(), test.captures[i]);
+    }
+}
+
+TEST_CASE(nfa_dfa_cache_reset_with_counters)
+{
+    // Every repetition count is a DFA state of its own, so this fills up the DFA cache, which has to be reset
+    // (repetition counters included) in the middle of the match.
+    Regex<ECMA262> re("x[ab]{2500}c"sv);
+    StringBuilder builder;
+    builder.append('x');
+    for (size_t i = 0; i < 1250; ++i)
+        builder.append("ab"sv);
+    auto subject = builder.to_deprecated_string();
+
+    EXPECT_EQ(re.match(DeprecatedString::formatted("{}c", subject)).success, true);
+    EXPECT_EQ(re.match(DeprecatedString::formatted("{}bc", subject)).success, false);
+    EXPECT_EQ(re.match(DeprecatedString::formatted("{}", subject)).success, false);
+}
+
+TEST_CASE(match_on_other_threads)
+{
+    // Every thread executes its own opcode instances, including for a regex that was compiled on another thread.
+    Regex<ECMA262> compiled_here("(\\w+)@(\\w+)\\.com"sv);
+    bool matched_on_other_thread = false;
+    auto thread = Threading::Thread::construct([&] {
+        auto result = compiled_here.search("mail bob@example.com now"sv);
+        matched_on_other_thread = result.success && result.capture_group_matches[0][1].view.to_deprecated_string() == "example"sv;
+        return 0;
+    });
+    thread->start();
+    (void)thread->join();
+    EXPECT(matched_on_other_thread);
+
+    // Separately compiled regexes can be matched at the same time.
+    Array<Atomic<size_t>, 4> match_counts;
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < match_counts.size(); ++i) {
+        threads.append(Threading::Thread::construct([&, i] {
+            Regex<PosixExtended> re("worker-([0-9]+)"sv);
+            for (size_t j = 0; j < 2000; ++j) {
+                auto result = re.search(DeprecatedString::formatted("request {} from worker-{}", j, i));
+                if (result.success && result.capture_group_matches[0][0].view.to_deprecated_string() == DeprecatedString::number(i))
+                    ++match_counts[i];
+            }
+            return 0;
+        }));
+        threads.last()->start();
+    }
+    for (auto& thread : threads)
+        (void)thread->join();
+    for (auto& count : match_counts)
+        EXPECT_EQ(count.load(), 2000u);
+}
+
+static DeprecatedString make_log_lines(size_t count)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < count; ++i) {
+        builder.appendff("2023-05-{:02} 12:{:02}:{:02} [{}] worker-{}: request {} from 10.0.{}.{} took {}ms\n",
+            i % 28 + 1, i % 60, (i * 7) % 60, i % 97 == 0 ? "ERROR" : "INFO", i % 8, i, i % 256, (i * 13) % 256, (i * 37) % 1000);
+    }
+    return builder.to_deprecated_string();
+}
+
+static auto g_log_lines = make_log_lines(20'000);
+
+BENCHMARK_CASE(log_search_performance)
+{
+    Array patterns {
+        "\\[ERROR\\] worker-\\d+"sv,
+        "(\\d+\\.){3}\\d+ took \\d{3}ms"sv,
+        "request (\\d+) from [^ ]+ took 9\\d\\dms"sv,
+        "(?:GET|POST|PUT) /api"sv,
+    };
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern, ECMAScriptFlags::Global);
+        auto result = re.match(g_log_lines);
+        EXPECT(result.success || pattern.starts_with("(?:GET"sv));
+    }
+}
+
+TEST_CASE(literal_search)
+{
+    // Check the vectorized search against a naive one, around the edges of the vectors.
+    auto haystack = DeprecatedString::repeated('a', 100);
+    for (auto needle : { "b"sv, "ab"sv, "ba"sv, "bab"sv, "abcdefghijklmnopqrstuvwxyz"sv }) {
+        for (size_t position = 0; position + needle.length() <= 100; ++position) {
+            StringBuilder builder;
+            builder.append(haystack.substring_view(0, position));
+            builder.append(needle);
+            builder.append(haystack.substring_view(0, 100 - position - needle.length()));
+            auto string = builder.to_deprecated_string();
+
+            auto expected = string.view().find(needle);
+            EXPECT_EQ(regex::find_literal(string.bytes(), needle.bytes()), expected);
+            for (size_t length = needle.length(); length < 100; length += 7)
+                EXPECT_EQ(regex::find_literal(string.bytes().trim(length), needle.bytes()), string.substring_view(0, length).find(needle));
+        }
+    }
+}
+
+TEST_CASE(literal_prefilter)
+{
+    struct {
+        StringView pattern;
+        StringView expected_literal;
+        bool is_prefix;
+    } tests[] = {
+        { "foo\\d+"sv, "foo"sv, true },
+        { "(?:ab)+c"sv, "ab"sv, true },
+        { "\\d+ took \\d+ms"sv, " took "sv, false },
+        { "^\\[ERROR\\] worker"sv, "[ERROR] worker"sv, true },
+        { "a(bc)?d"sv, "a"sv, true },
+        { "x*yz"sv, "yz"sv, false },
+        { "foo|bar"sv, {}, false },
+        { "a*"sv, {}, false },
+        { "(?<=x)abc"sv, {}, false },
+        { "(?!abc)abd"sv, {}, false },
+    };
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern);
+        auto prefilter = regex::LiteralPrefilter::try_create(re.parser_result.bytecode);
+        EXPECT_EQ(prefilter.has_value(), !test.expected_literal.is_null());
+        if (!prefilter.has_value())
+            continue;
+        EXPECT_EQ(StringView { prefilter->literal() }, test.expected_literal);
+        EXPECT_EQ(prefilter->is_prefix(), test.is_prefix);
+    }
+
+    // Matches are still found around the literal.
+    Regex<ECMA262> re("\\w+ took (\\d+)ms"sv, ECMAScriptFlags::Global);
+    auto result = re.match("a took 1s, bb took 22ms, c took 333ms"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.size(), 2u);
+    EXPECT_EQ(result.matches[0].view.to_deprecated_string(), "bb took 22ms"sv);
+    EXPECT_EQ(result.capture_group_matches[1][0].view.to_deprecated_string(), "333"sv);
+}
+
+TEST_CASE(compiled_pattern_cache)
+{
+    auto compile_and_match = [](StringView subject, auto flags) {
+        Regex<ECMA262> re("h(e+)llo"sv, flags);
+        EXPECT_EQ(re.parser_result.error, regex::Error::NoError);
+        return re.match(subject);
+    };
+
+    // Compiling the same pattern again reuses the first compilation, which must outlive the regex it came from.
+    Vector<regex::ByteCodeValueType> first_bytecode;
+    {
+        Regex<ECMA262> re("h(e+)llo"sv);
+        for (size_t i = 0; i < re.parser_result.bytecode.size(); ++i)
+            first_bytecode.append(re.parser_result.bytecode.at(i));
+    }
+    Regex<ECMA262> re("h(e+)llo"sv);
+    EXPECT_EQ(re.parser_result.bytecode.size(), first_bytecode.size());
+    for (size_t i = 0; i < first_bytecode.size(); ++i)
+        EXPECT_EQ(re.parser_result.bytecode.at(i), first_bytecode[i]);
+    EXPECT_EQ(re.parser_result.capture_groups_count, 1u);
+    auto result = re.match("heeello"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches[0][0].view.to_deprecated_string(), "eee"sv);
+
+    // The flags are part of what is cached.
+    EXPECT_EQ(compile_and_match("HELLO"sv, ECMAScriptFlags {}).success, false);
+    EXPECT_EQ(compile_and_match("HELLO"sv, ECMAScriptFlags::Insensitive).success, true);
+    EXPECT_EQ(compile_and_match("HELLO"sv, ECMAScriptFlags {}).success, false);
+
+    // Invalid patterns keep failing.
+    for (size_t i = 0; i < 2; ++i) {
+        Regex<ECMA262> invalid("h(e+llo"sv);
+        EXPECT_NE(invalid.parser_result.error, regex::Error::NoError);
+    }
+}
+
+TEST_CASE(compiled_pattern_cache_named_groups)
+{
+    // The names of capture groups point into the pattern, which mustn't be gone by the time a regex with the same
+    // pattern matches, even once the first regex is destroyed and the cache has moved on to other patterns.
+    auto pattern = DeprecatedString::formatted("(?<{}>[[:digit:]]+)", "number"sv);
+    OwnPtr<Regex<PosixExtended>> first = make<Regex<PosixExtended>>(pattern);
+    Regex<PosixExtended> second(DeprecatedString::formatted("(?<{}>[[:digit:]]+)", "number"sv));
+    for (size_t i = 0; i < 100; ++i)
+        Regex<PosixExtended> other(DeprecatedString::formatted("other{}", i));
+    first = nullptr;
+    pattern = {};
+
+    // Reading freed memory doesn't always show, so also check where the name points.
+    auto pattern_characters = second.pattern_value.characters();
+    regex::MatchState state;
+    size_t named_group_count = 0;
+    for (;;) {
+        auto& opcode = second.parser_result.bytecode.get_opcode(state);
+        if (is<regex::OpCode_Exit>(opcode))
+            break;
+        if (is<regex::OpCode_SaveRightNamedCaptureGroup>(opcode)) {
+            auto name = static_cast<regex::OpCode_SaveRightNamedCaptureGroup&>(opcode).name();
+            EXPECT(name.characters_without_null_termination() >= pattern_characters);
+            EXPECT(name.characters_without_null_termination() + name.length() <= pattern_characters + second.pattern_value.length());
+            ++named_group_count;
+        }
+        state.instruction_position += opcode.size();
+    }
+    EXPECT_EQ(named_group_count, 1u);
+
+    auto result = second.match("42"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches[0][0].view.to_deprecated_string(), "42"sv);
+    EXPECT_EQ(result.capture_group_matches[0][0].capture_group_name, "number");
+}
+
+BENCHMARK_CASE(log_grep_performance)
+{
+    // Matching line by line, where almost no line matches.
+    auto lines = g_log_lines.split_view('\n');
+    Array patterns {
+        "\\[ERROR\\] worker-\\d+"sv,
+        "took 99\\dms"sv,
+        "from 10\\.0\\.1\\.\\d+ "sv,
+    };
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern, ECMAScriptFlags::Global);
+        size_t matching_lines = 0;
+        for (auto line : lines) {
+            if (re.has_match(line))
+                ++matching_lines;
+        }
+        EXPECT(matching_lines > 0);
+    }
+}
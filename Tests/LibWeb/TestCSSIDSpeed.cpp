@@ -4,9 +4,38 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashTable.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/AnonymousBuffer.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/EventLoop.h>
+#include <LibGfx/Font/FontDatabase.h>
+#include <LibGfx/Palette.h>
+#include <LibGfx/SystemTheme.h>
 #include <LibTest/TestCase.h>
-
+#include <LibWeb/Bindings/MainThreadVM.h>
+#include <LibWeb/CSS/AncestorFilter.h>
+#include <LibWeb/CSS/StyleComputer.h>
+#include <LibWeb/CSS/StyleProperties.h>
+#include <LibWeb/CSS/StyleValues/ColorStyleValue.h>
+#include <LibWeb/CSS/StyleValues/DisplayStyleValue.h>
 #include <LibWeb/CSS/ValueID.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/BrowsingContext.h>
+#include <LibWeb/HTML/HTMLElement.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Loader/FrameLoader.h>
+#include <LibWeb/Page/Page.h>
+#include <LibWeb/Platform/EventLoopPluginSerenity.h>
+#include <LibWeb/Platform/FontPluginSerenity.h>
+
+#ifdef AK_OS_SERENITY
+#    define RESOURCES_PATH "/res"
+#else
+#    define RESOURCES_PATH "../../Base/res"
+#endif
 
 TEST_CASE(basic)
 {
@@ -25,3 +54,207 @@ BENCHMARK_CASE(value_id_from_string)
         EXPECT_EQ(Web::CSS::value_id_from_string("inline"sv), Web::CSS::ValueID::Inline);
     }
 }
+
+// Just enough of a page to compute styles in, without anything to display it on.
+class StyleRecalcPageClient final : public Web::PageClient {
+public:
+    StyleRecalcPageClient()
+    {
+        auto buffer = MUST(Core::AnonymousBuffer::create_with_size(sizeof(Gfx::SystemTheme)));
+        m_palette_impl = Gfx::PaletteImpl::create_with_anonymous_buffer(buffer);
+        m_page = make<Web::Page>(*this);
+    }
+
+    Web::DOM::Document& document() { return *m_page->top_level_browsing_context().active_document(); }
+
+    virtual Web::Page& page() override { return *m_page; }
+    virtual Web::Page const& page() const override { return *m_page; }
+    virtual bool is_connection_open() const override { return true; }
+    virtual Gfx::Palette palette() const override { return Gfx::Palette(*m_palette_impl); }
+    virtual Web::DevicePixelRect screen_rect() const override { return { 0, 0, 800, 600 }; }
+    virtual float device_pixels_per_css_pixel() const override { return 1.0f; }
+    virtual Web::CSS::PreferredColorScheme preferred_color_scheme() const override { return Web::CSS::PreferredColorScheme::Auto; }
+    virtual void paint(Web::DevicePixelRect const&, Gfx::Bitmap&) override { }
+    virtual void request_file(Web::FileRequest) override { }
+
+private:
+    RefPtr<Gfx::PaletteImpl> m_palette_impl;
+    OwnPtr<Web::Page> m_page;
+};
+
+static StyleRecalcPageClient& page_client()
+{
+    static OwnPtr<StyleRecalcPageClient> s_page_client;
+    if (!s_page_client) {
+        static Core::EventLoop s_event_loop;
+        Gfx::FontDatabase::set_default_fonts_lookup_path(RESOURCES_PATH "/fonts");
+        Web::FrameLoader::set_default_favicon_path(RESOURCES_PATH "/icons/16x16/app-browser.png");
+        Web::Platform::EventLoopPlugin::install(*new Web::Platform::EventLoopPluginSerenity);
+        Web::Platform::FontPlugin::install(*new Web::Platform::FontPluginSerenity);
+        MUST(Web::Bindings::initialize_main_thread_vm());
+        s_page_client = make<StyleRecalcPageClient>();
+    }
+    return *s_page_client;
+}
+
+TEST_CASE(ancestor_filter)
+{
+    auto& document = page_client().document();
+    auto create_element = [&](DeprecatedString const& local_name, DeprecatedString const& id, DeprecatedString const& class_names) {
+        auto element = MUST(document.create_element(local_name, DeprecatedString {}));
+        if (!id.is_empty())
+            MUST(element->set_attribute(Web::HTML::AttributeNames::id, id));
+        MUST(element->set_attribute(Web::HTML::AttributeNames::class_, class_names));
+        return element;
+    };
+    auto section = create_element("section", "main", "content wide");
+    auto paragraph = create_element("p", {}, "note");
+    MUST(section->append_child(paragraph));
+
+    using Web::CSS::AncestorFilter;
+    auto tag_name = [](StringView name) { return AncestorFilter::hash(AncestorFilter::HashKind::TagName, name); };
+    auto id = [](StringView name) { return AncestorFilter::hash(AncestorFilter::HashKind::Id, name); };
+    auto class_name = [](StringView name) { return AncestorFilter::hash(AncestorFilter::HashKind::Class, name); };
+
+    AncestorFilter filter;
+    filter.push_ancestor(*section);
+    EXPECT(filter.is_filtering_ancestors_of(*paragraph));
+    EXPECT(filter.may_contain_all(Array { tag_name("section"sv), id("main"sv), class_name("content"sv), class_name("WIDE"sv) }.span()));
+    EXPECT(!filter.may_contain_all(Array { tag_name("section"sv), class_name("sidebar"sv) }.span()));
+    EXPECT(!filter.may_contain_all(Array { class_name("main"sv) }.span()));
+
+    filter.push_ancestor(*paragraph);
+    EXPECT(!filter.is_filtering_ancestors_of(*paragraph));
+    EXPECT(filter.may_contain_all(Array { tag_name("p"sv), class_name("note"sv), id("main"sv) }.span()));
+
+    filter.pop_ancestor(*paragraph);
+    EXPECT(!filter.may_contain_all(Array { class_name("note"sv) }.span()));
+    EXPECT(filter.may_contain_all(Array { class_name("wide"sv) }.span()));
+
+    filter.pop_ancestor(*section);
+    EXPECT(!filter.may_contain_all(Array { tag_name("section"sv) }.span()));
+    EXPECT(!filter.is_filtering_ancestors_of(*paragraph));
+}
+
+TEST_CASE(style_properties_copy_on_write)
+{
+    auto red = MUST(Web::CSS::ColorStyleValue::create(Color::Red));
+    auto blue = MUST(Web::CSS::ColorStyleValue::create(Color::Blue));
+    auto block = MUST(Web::CSS::DisplayStyleValue::create(Web::CSS::Display::from_short(Web::CSS::Display::Short::Block)));
+    auto inline_block = MUST(Web::CSS::DisplayStyleValue::create(Web::CSS::Display::from_short(Web::CSS::Display::Short::InlineBlock)));
+
+    auto style = Web::CSS::StyleProperties::create();
+    style->set_property(Web::CSS::PropertyID::Color, red);
+    style->set_property(Web::CSS::PropertyID::Display, block);
+
+    auto copy = style->clone();
+    EXPECT(copy->shares_inherited_values_with(*style));
+
+    // `display` isn't inherited, so changing it leaves the inherited values shared.
+    copy->set_property(Web::CSS::PropertyID::Display, inline_block);
+    EXPECT(copy->shares_inherited_values_with(*style));
+    EXPECT_EQ(style->property(Web::CSS::PropertyID::Display).ptr(), block.ptr());
+    EXPECT_EQ(copy->property(Web::CSS::PropertyID::Display).ptr(), inline_block.ptr());
+
+    copy->set_property(Web::CSS::PropertyID::Color, blue);
+    EXPECT(!copy->shares_inherited_values_with(*style));
+    EXPECT_EQ(style->property(Web::CSS::PropertyID::Color).ptr(), red.ptr());
+    EXPECT_EQ(copy->property(Web::CSS::PropertyID::Color).ptr(), blue.ptr());
+}
+
+TEST_CASE(siblings_share_styles)
+{
+    auto& document = page_client().document();
+    MUST(document.body()->set_inner_html(
+        "<style>"
+        "li { color: green; }"
+        "li:nth-child(3) { font-style: italic; }"
+        "li.special { color: red; }"
+        "li[data-wide] { margin-left: 10px; }"
+        "</style>"
+        "<ul><li>1</li><li>2</li><li>3</li><li>4</li>"
+        "<li class=\"special\">5</li><li data-wide>6</li><li style=\"color: blue\">7</li></ul>"sv));
+    document.update_style();
+
+    Vector<Web::CSS::StyleProperties const*> styles;
+    document.for_each_in_inclusive_subtree_of_type<Web::HTML::HTMLElement>([&](auto const& element) {
+        if (element.local_name() == Web::HTML::TagNames::li)
+            styles.append(element.computed_css_values());
+        return IterationDecision::Continue;
+    });
+    EXPECT_EQ(styles.size(), 7u);
+    for (auto const* style : styles)
+        EXPECT(style);
+
+    auto value = [&](size_t index, Web::CSS::PropertyID property_id) {
+        return MUST(styles[index]->property(property_id)->to_string());
+    };
+
+    // Siblings that can't be told apart get the very same style.
+    EXPECT_EQ(styles[0], styles[1]);
+    EXPECT_EQ(styles[0], styles[3]);
+    EXPECT_EQ(value(0, Web::CSS::PropertyID::Color), "rgb(0, 128, 0)"sv);
+    EXPECT_EQ(value(0, Web::CSS::PropertyID::FontStyle), "normal"sv);
+    EXPECT_EQ(value(0, Web::CSS::PropertyID::MarginLeft), "0"sv);
+
+    // A structural pseudo-class, a class, an attribute and an inline style each set a sibling apart.
+    for (size_t index : { 2u, 4u, 5u, 6u })
+        EXPECT_NE(styles[index], styles[0]);
+    EXPECT_EQ(value(2, Web::CSS::PropertyID::FontStyle), "italic"sv);
+    EXPECT_EQ(value(4, Web::CSS::PropertyID::Color), "rgb(255, 0, 0)"sv);
+    EXPECT_EQ(value(5, Web::CSS::PropertyID::MarginLeft), "10px"sv);
+    EXPECT_EQ(value(5, Web::CSS::PropertyID::Color), "rgb(0, 128, 0)"sv);
+    EXPECT_EQ(value(6, Web::CSS::PropertyID::Color), "rgb(0, 0, 255)"sv);
+}
+
+// A long table in a page with a fair number of descendant selectors, most of which match nothing.
+static DeprecatedString style_recalc_test_html()
+{
+    StringBuilder builder;
+    builder.append("<style>"sv);
+    for (int i = 0; i < 100; ++i) {
+        builder.appendff(".sidebar-{} .widget a {{ color: red; }}\n", i);
+        builder.appendff("#panel-{} li > span {{ margin-left: {}px; }}\n", i, i);
+        builder.appendff("article.post-{} p em {{ font-style: normal; }}\n", i);
+        builder.appendff("table.grid tr.row-{} td {{ padding: 1px; }}\n", i);
+    }
+    builder.append("table.grid td.cell { border: 1px solid black; }\n"sv);
+    builder.append("</style><div class=\"content\"><table class=\"grid\">"sv);
+    for (int row = 0; row < 200; ++row) {
+        builder.appendff("<tr class=\"row-{}\">", row);
+        for (int column = 0; column < 10; ++column)
+            builder.appendff("<td class=\"cell\"><span>{}</span></td>", column);
+        builder.append("</tr>"sv);
+    }
+    builder.append("</table></div>"sv);
+    return builder.to_deprecated_string();
+}
+
+BENCHMARK_CASE(style_recalc)
+{
+    auto& document = page_client().document();
+    MUST(document.body()->set_inner_html(style_recalc_test_html()));
+    document.update_style();
+
+    static constexpr int run_count = 10;
+    document.style_computer().reset_selector_matching_statistics();
+    auto timer = Core::ElapsedTimer::start_new();
+    for (int run = 0; run < run_count; ++run) {
+        document.set_needs_full_style_update(true);
+        document.update_style();
+    }
+    outln("Full style recalc: {} us", timer.elapsed_time().to_microseconds() / run_count);
+
+    auto const& statistics = document.style_computer().selector_matching_statistics();
+    outln("Selectors tried: {}, rejected by the ancestor filter: {}, matched: {}",
+        statistics.selectors_tried / run_count, statistics.rejected_by_ancestor_filter / run_count, statistics.selectors_matched / run_count);
+
+    size_t element_count = 0;
+    HashTable<Web::CSS::StyleProperties const*> distinct_styles;
+    document.for_each_in_inclusive_subtree_of_type<Web::DOM::Element>([&](auto const& element) {
+        ++element_count;
+        distinct_styles.set(element.computed_css_values());
+        return IterationDecision::Continue;
+    });
+    outln("{} elements use {} distinct styles", element_count, distinct_styles.size());
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/AnonymousBuffer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Palette.h>
+#include <LibGfx/SystemTheme.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Thread.h>
+#include <LibWeb/Painting/BorderRadiusCornerClipper.h>
+#include <LibWeb/Painting/PaintContext.h>
+#include <LibWeb/Painting/RecordingPainter.h>
+
+static constexpr Gfx::IntSize target_size { 64, 48 };
+
+static NonnullRefPtr<Gfx::Bitmap> create_target()
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, target_size));
+    bitmap->fill(Color::White);
+    return bitmap;
+}
+
+static void expect_same_pixels(Gfx::Bitmap const& a, Gfx::Bitmap const& b)
+{
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x)
+            EXPECT_EQ(a.get_pixel(x, y), b.get_pixel(x, y));
+    }
+}
+
+// Replaying a recording has to leave the target exactly as painting with a Gfx::Painter directly would.
+template<typename PainterType>
+static void paint_scene(PainterType& painter)
+{
+    painter.fill_rect({ 2, 2, 20, 10 }, Color::Red);
+    painter.save();
+    painter.translate(10, 8);
+    painter.add_clip_rect({ 0, 0, 30, 20 });
+    painter.fill_rect({ -5, -5, 50, 50 }, Color(0, 0, 255, 128));
+    painter.draw_line({ 0, 0 }, { 29, 19 }, Color::Green, 2);
+    painter.draw_rect({ 4, 4, 10, 10 }, Color::Black);
+    painter.restore();
+    painter.fill_rect_with_linear_gradient({ 40, 30, 20, 15 }, Array { Gfx::ColorStop { Color::Yellow, 0.0f }, Gfx::ColorStop { Color::Magenta, 1.0f } }, 90.0f);
+}
+
+TEST_CASE(replay_matches_direct_painting)
+{
+    auto expected = create_target();
+    Gfx::Painter direct_painter(expected);
+    paint_scene(direct_painter);
+
+    Web::Painting::RecordingPainter recording_painter(target_size);
+    paint_scene(recording_painter);
+    EXPECT(!recording_painter.is_empty());
+
+    auto replayed = create_target();
+    Gfx::Painter replay_painter(replayed);
+    recording_painter.execute(replay_painter);
+    expect_same_pixels(*expected, *replayed);
+
+    // A recording can be replayed any number of times.
+    auto replayed_again = create_target();
+    Gfx::Painter replay_again_painter(replayed_again);
+    recording_painter.execute(replay_again_painter);
+    expect_same_pixels(*expected, *replayed_again);
+}
+
+TEST_CASE(state_is_tracked_while_recording)
+{
+    Web::Painting::RecordingPainter painter(target_size);
+    EXPECT(painter.is_empty());
+    EXPECT_EQ(painter.clip_rect(), Gfx::IntRect({}, target_size));
+
+    {
+        Web::Painting::RecordingPainterStateSaver saver(painter);
+        painter.translate(5, 7);
+        painter.add_clip_rect({ 0, 0, 100, 10 });
+        EXPECT_EQ(painter.translation(), Gfx::IntPoint(5, 7));
+        EXPECT_EQ(painter.clip_rect(), Gfx::IntRect(5, 7, 59, 10));
+    }
+
+    EXPECT_EQ(painter.translation(), Gfx::IntPoint());
+    EXPECT_EQ(painter.clip_rect(), Gfx::IntRect({}, target_size));
+    EXPECT_EQ(painter.command_count(), 4u);
+}
+
+TEST_CASE(stacking_context_is_composited_with_opacity)
+{
+    Web::Painting::RecordingPainter painter(target_size);
+    painter.fill_rect({ {}, target_size }, Color::White);
+    painter.push_stacking_context({
+        .opacity = 0.5f,
+        .destination_rect = { 10, 10, 20, 20 },
+        .source_size = { 20, 20 },
+        .transformed_destination_size = { 20, 20 },
+        .paint_rect_location = { 10, 10 },
+        .device_pixels_per_css_pixel = 1.0f,
+    });
+    painter.fill_rect({ 10, 10, 20, 20 }, Color::Black);
+    painter.pop_stacking_context();
+
+    auto target = create_target();
+    Gfx::Painter target_painter(target);
+    painter.execute(target_painter);
+
+    EXPECT_EQ(target->get_pixel(5, 5), Color(Color::White));
+    auto composited = target->get_pixel(20, 20);
+    EXPECT(composited.red() > 100 && composited.red() < 156);
+    EXPECT_EQ(composited.red(), composited.green());
+    EXPECT_EQ(composited.red(), composited.blue());
+}
+
+TEST_CASE(tiles_with_rounded_corners_rasterize_the_same_in_parallel)
+{
+    // Every corner clipper samples what is under its corners and blits it back once the contents are painted, which
+    // happens on each of the threads that rasterize tiles of the same display list.
+    static constexpr Gfx::IntSize page_size { 256, 192 };
+    static constexpr int tile_size = 32;
+    static constexpr size_t thread_count = 4;
+
+    Gfx::Palette palette(Gfx::PaletteImpl::create_with_anonymous_buffer(MUST(Core::AnonymousBuffer::create_with_size(sizeof(Gfx::SystemTheme)))));
+    Web::Painting::RecordingPainter recording_painter(page_size);
+    Web::PaintContext context(recording_painter, palette, 1.0f);
+    recording_painter.fill_rect({ {}, page_size }, Color::White);
+    Web::Painting::BorderRadiiData radii { { 10, 10 }, { 14, 6 }, { 8, 16 }, { 20, 20 } };
+    for (int i = 0; i < 12; ++i) {
+        Web::DevicePixelRect rect { (i * 37) % 200, (i * 23) % 140, 50 + i % 3 * 7, 45 + i % 4 * 5 };
+        auto use_cached_bitmap = i % 2 ? Web::Painting::BorderRadiusCornerClipper::UseCachedBitmap::Yes : Web::Painting::BorderRadiusCornerClipper::UseCachedBitmap::No;
+        recording_painter.fill_rect(rect.to_type<int>(), Color(i * 20, 255 - i * 20, 128));
+        Web::Painting::ScopedCornerRadiusClip corner_clip { context, recording_painter, rect, radii, Web::Painting::CornerClip::Outside, use_cached_bitmap };
+        recording_painter.fill_rect_with_linear_gradient(rect.to_type<int>(), Array { Gfx::ColorStop { Color::Blue, 0.0f }, Gfx::ColorStop { Color::Yellow, 1.0f } }, i * 30.0f);
+    }
+
+    auto expected = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, page_size));
+    Gfx::Painter expected_painter(expected);
+    recording_painter.execute(expected_painter);
+
+    Vector<Gfx::IntRect> tile_rects;
+    for (int y = 0; y < page_size.height(); y += tile_size) {
+        for (int x = 0; x < page_size.width(); x += tile_size)
+            tile_rects.append({ x, y, tile_size, tile_size });
+    }
+
+    // Each thread rasterizes every tile a few times over, so the threads are busy with the same clippers at once.
+    static constexpr size_t rounds = 20;
+    Vector<Vector<NonnullRefPtr<Gfx::Bitmap>>> tiles_per_thread;
+    tiles_per_thread.resize(thread_count);
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.append(Threading::Thread::construct([&, &tiles = tiles_per_thread[i]]() -> intptr_t {
+            for (size_t round = 0; round < rounds; ++round) {
+                for (auto const& tile_rect : tile_rects) {
+                    auto tile = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, tile_rect.size()));
+                    Gfx::Painter painter(tile);
+                    painter.translate(-tile_rect.location());
+                    recording_painter.execute(painter);
+                    tiles.append(move(tile));
+                }
+            }
+            return 0;
+        }));
+        threads.last()->start();
+    }
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    size_t mismatched_tile_count = 0;
+    for (auto& tiles : tiles_per_thread) {
+        EXPECT_EQ(tiles.size(), rounds * tile_rects.size());
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            auto const& tile_rect = tile_rects[i % tile_rects.size()];
+            bool tile_matches = true;
+            for (int y = 0; y < tile_size && tile_matches; ++y) {
+                for (int x = 0; x < tile_size && tile_matches; ++x)
+                    tile_matches = tiles[i]->get_pixel(x, y) == expected->get_pixel(tile_rect.x() + x, tile_rect.y() + y);
+            }
+            if (!tile_matches)
+                ++mismatched_tile_count;
+        }
+    }
+    EXPECT_EQ(mismatched_tile_count, 0u);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <WebContent/TileCache.h>
+
+using WebContent::TileCache;
+
+static constexpr int tile_size = TileCache::tile_size;
+
+static TileCache::Tile make_tile(Gfx::IntPoint index)
+{
+    return { index, MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { tile_size, tile_size })) };
+}
+
+TEST_CASE(indices_of_tiles_intersecting)
+{
+    EXPECT(TileCache::indices_of_tiles_intersecting({}).is_empty());
+    EXPECT_EQ(TileCache::indices_of_tiles_intersecting({ 0, 0, tile_size, tile_size }), (Vector<Gfx::IntPoint> { { 0, 0 } }));
+    EXPECT_EQ(TileCache::indices_of_tiles_intersecting({ tile_size - 1, 0, 2, 1 }), (Vector<Gfx::IntPoint> { { 0, 0 }, { 1, 0 } }));
+    // Tiles left of and above the origin don't overlap the first one.
+    EXPECT_EQ(TileCache::indices_of_tiles_intersecting({ -1, -tile_size, 2, 1 }), (Vector<Gfx::IntPoint> { { -1, -1 }, { 0, -1 } }));
+    EXPECT_EQ(TileCache::rect_of_tile({ -1, 2 }), Web::DevicePixelRect(-tile_size, 2 * tile_size, tile_size, tile_size));
+}
+
+TEST_CASE(invalidate_drops_only_the_tiles_it_overlaps)
+{
+    TileCache cache;
+    for (int x = 0; x < 4; ++x)
+        cache.add(make_tile({ x, 0 }), cache.generation());
+    EXPECT_EQ(cache.tile_count(), 4u);
+
+    cache.invalidate({ tile_size + 10, 10, tile_size, 10 });
+    EXPECT(cache.find({ 0, 0 }));
+    EXPECT(!cache.find({ 1, 0 }));
+    EXPECT(!cache.find({ 2, 0 }));
+    EXPECT(cache.find({ 3, 0 }));
+
+    cache.clear();
+    EXPECT_EQ(cache.tile_count(), 0u);
+}
+
+TEST_CASE(tiles_rasterized_while_something_else_was_invalidated)
+{
+    TileCache cache;
+    // The display list for these tiles is recorded, and while they are being rasterized, another part of the page changes.
+    auto generation = cache.generation();
+    cache.invalidate({ 0, 0, 10, 10 });
+    cache.invalidate({ 5 * tile_size, 0, 10, 10 });
+
+    cache.add(make_tile({ 0, 0 }), generation);
+    cache.add(make_tile({ 1, 0 }), generation);
+    cache.add(make_tile({ 4, 0 }), generation);
+    cache.add(make_tile({ 5, 0 }), generation);
+    EXPECT(!cache.find({ 0, 0 }));
+    EXPECT(cache.find({ 1, 0 }));
+    EXPECT(cache.find({ 4, 0 }));
+    EXPECT(!cache.find({ 5, 0 }));
+
+    // Tiles recorded after the invalidation are up to date.
+    cache.add(make_tile({ 0, 0 }), cache.generation());
+    EXPECT(cache.find({ 0, 0 }));
+}
+
+TEST_CASE(tiles_rasterized_while_everything_was_invalidated)
+{
+    TileCache cache;
+    auto generation = cache.generation();
+    cache.clear();
+    cache.add(make_tile({ 0, 0 }), generation);
+    EXPECT_EQ(cache.tile_count(), 0u);
+
+    // So many invalidations happened that the ones from the time of the recording were forgotten.
+    generation = cache.generation();
+    for (int i = 0; i < 100; ++i)
+        cache.invalidate({ 10 * tile_size, i * tile_size, 10, 10 });
+    cache.add(make_tile({ 0, 0 }), generation);
+    EXPECT_EQ(cache.tile_count(), 0u);
+
+    generation = cache.generation();
+    cache.invalidate({ 10 * tile_size, 0, 10, 10 });
+    cache.add(make_tile({ 0, 0 }), generation);
+    EXPECT_EQ(cache.tile_count(), 1u);
+}
+
+TEST_CASE(evict_tiles_far_from)
+{
+    TileCache cache;
+    for (int y = -20; y <= 20; ++y)
+        cache.add(make_tile({ 0, y }), cache.generation());
+
+    // A viewport's worth of tiles is kept above and below.
+    cache.evict_tiles_far_from({ 0, 0, tile_size, tile_size });
+    EXPECT_EQ(cache.tile_count(), 3u);
+    EXPECT(cache.find({ 0, -1 }));
+    EXPECT(cache.find({ 0, 0 }));
+    EXPECT(cache.find({ 0, 1 }));
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Process.h"
+#include <AK/StringBuilder.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/TempFile.h>
+#include <LibTest/Macros.h>
+#include <LibTest/TestCase.h>
+
+static ByteBuffer run_grep(Vector<char const*>&& arguments)
+{
+    MUST(arguments.try_insert(0, "grep"));
+    MUST(arguments.try_append(nullptr));
+    auto grep = MUST(Process::create("grep"sv, arguments.data()));
+    auto [stdout, stderr] = MUST(grep->read_all());
+    auto status = MUST(grep->status());
+    if (status != Process::ProcessResult::DoneWithZeroExitCode)
+        FAIL(DeprecatedString::formatted("grep didn't exit cleanly: status: {}, stdout:{}, stderr: {}", static_cast<int>(status), StringView { stdout.bytes() }, StringView { stderr.bytes() }));
+    return stdout;
+}
+
+static void write_file(StringView path, StringView contents)
+{
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Write));
+    MUST(file->write_until_depleted(contents.bytes()));
+}
+
+// A few directories of files with matches scattered through them, and some files without any.
+static NonnullOwnPtr<FileSystem::TempFile> create_tree()
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    for (size_t i = 0; i < 4; ++i) {
+        auto subdirectory = DeprecatedString::formatted("{}/dir{}", directory->path(), i);
+        MUST(Core::System::mkdir(subdirectory, 0755));
+        for (size_t j = 0; j < 16; ++j) {
+            StringBuilder builder;
+            for (size_t line = 0; line < 200; ++line) {
+                if (j % 3 != 0 && line % (j + 7) == 0)
+                    builder.appendff("needle {} in file {} of dir{}\n", line, j, i);
+                else
+                    builder.appendff("hay {}\n", line);
+            }
+            write_file(DeprecatedString::formatted("{}/file{}", subdirectory, j), builder.string_view());
+        }
+    }
+    return directory;
+}
+
+TEST_CASE(recursive_output_does_not_depend_on_thread_count)
+{
+    auto directory = create_tree();
+    auto path = directory->path().to_deprecated_string();
+
+    auto sequential = run_grep({ "-r", "-n", "-E", "needle [0-9]+ in", path.characters() });
+    EXPECT(!sequential.is_empty());
+
+    for (auto thread_count : { "2", "4", "16" }) {
+        auto parallel = run_grep({ "-r", "-n", "-E", "--threads", thread_count, "needle [0-9]+ in", path.characters() });
+        EXPECT_EQ(StringView { parallel.bytes() }, StringView { sequential.bytes() });
+    }
+}
+
+TEST_CASE(recursive_count_does_not_depend_on_thread_count)
+{
+    auto directory = create_tree();
+    auto path = directory->path().to_deprecated_string();
+
+    auto sequential = run_grep({ "-r", "-c", "needle", path.characters() });
+    auto parallel = run_grep({ "-r", "-c", "--threads", "4", "needle", path.characters() });
+    EXPECT_EQ(StringView { parallel.bytes() }, StringView { sequential.bytes() });
+}
+
+TEST_CASE(every_match_is_found)
+{
+    auto directory = create_tree();
+    auto path = directory->path().to_deprecated_string();
+
+    auto output = run_grep({ "-r", "--threads", "4", "needle", path.characters() });
+    size_t expected_count = 0;
+    for (size_t j = 0; j < 16; ++j) {
+        if (j % 3 != 0)
+            expected_count += (199 / (j + 7) + 1) * 4;
+    }
+    EXPECT_EQ(StringView { output.bytes() }.count("\n"sv), expected_count);
+}
+
+TEST_CASE(files_without_a_size)
+{
+    // Files like these report a size of 0, but still have something in them.
+#ifdef AK_OS_SERENITY
+    auto path = "/sys/kernel/uptime";
+#else
+    auto path = "/proc/uptime";
+#endif
+    auto output = run_grep({ "-c", "-E", "[0-9]", path });
+    EXPECT_EQ(StringView { output.bytes() }, "1\n"sv);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Process.h"
+#include <AK/StringBuilder.h>
+#include <AK/Time.h>
+#include <LibFileSystem/TempFile.h>
+#include <LibTest/Macros.h>
+#include <LibTest/TestCase.h>
+#include <sys/wait.h>
+
+struct SortResult {
+    Process::ProcessResult status;
+    ByteBuffer standard_output;
+};
+
+// Waits for sort to exit by itself, so that a hang shows up as a failure instead of blocking the test forever.
+static SortResult run_sort(Vector<char const*>&& arguments)
+{
+    MUST(arguments.try_insert(0, "sort"));
+    MUST(arguments.try_append(nullptr));
+    auto sort = MUST(Process::create("sort"sv, arguments.data()));
+
+    auto deadline = Time::now_monotonic() + Time::from_seconds(10);
+    auto status = MUST(sort->status(WNOHANG));
+    while (status == Process::ProcessResult::Running && Time::now_monotonic() < deadline) {
+        usleep(10'000);
+        status = MUST(sort->status(WNOHANG));
+    }
+    if (status == Process::ProcessResult::Running) {
+        sort->terminate();
+        FAIL("sort didn't exit within 10 seconds");
+        return { status, {} };
+    }
+
+    auto [stdout, stderr] = MUST(sort->read_all());
+    return { status, move(stdout) };
+}
+
+static DeprecatedString create_input(FileSystem::TempFile const& directory, size_t line_count)
+{
+    auto path = DeprecatedString::formatted("{}/input", directory.path());
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Write));
+    for (size_t i = 0; i < line_count; ++i)
+        MUST(file->write_until_depleted(DeprecatedString::formatted("{}\n", (i * 7919) % line_count).bytes()));
+    return path;
+}
+
+TEST_CASE(parallel)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto input = create_input(*directory, 1000);
+
+    StringBuilder expected;
+    for (size_t i = 0; i < 1000; ++i)
+        expected.appendff("{}\n", i);
+
+    // Everything in memory, and parts sorted through temporary files.
+    auto result = run_sort({ "-n", "--parallel", "4", input.characters() });
+    EXPECT_EQ(result.status, Process::ProcessResult::DoneWithZeroExitCode);
+    EXPECT_EQ(StringView { result.standard_output.bytes() }, expected.string_view());
+
+    result = run_sort({ "-n", "--parallel", "4", "-S", "1K", input.characters() });
+    EXPECT_EQ(result.status, Process::ProcessResult::DoneWithZeroExitCode);
+    EXPECT_EQ(StringView { result.standard_output.bytes() }, expected.string_view());
+}
+
+TEST_CASE(parallel_read_error)
+{
+    // Reading stops with an error while the worker threads are waiting for more to sort, or are still sorting.
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto input = create_input(*directory, 1000);
+    auto missing = DeprecatedString::formatted("{}/missing", directory->path());
+
+    auto result = run_sort({ "-n", "--parallel", "4", input.characters(), missing.characters() });
+    EXPECT_EQ(result.status, Process::ProcessResult::Failed);
+    EXPECT(result.standard_output.is_empty());
+
+    result = run_sort({ "-n", "--parallel", "4", "-S", "1K", input.characters(), missing.characters() });
+    EXPECT_EQ(result.status, Process::ProcessResult::Failed);
+    EXPECT(result.standard_output.is_empty());
+
+    result = run_sort({ "--parallel", "4", missing.characters() });
+    EXPECT_EQ(result.status, Process::ProcessResult::Failed);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Process.h"
+#include <LibArchive/TarStream.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/FileSystem.h>
+#include <LibFileSystem/TempFile.h>
+#include <LibTest/Macros.h>
+#include <LibTest/TestCase.h>
+
+struct Member {
+    enum class Type {
+        File,
+        SymLink,
+        Directory,
+    };
+    Type type;
+    StringView path;
+    // The contents of a file, or the target of a symlink.
+    StringView data {};
+};
+
+static DeprecatedString create_archive(FileSystem::TempFile const& directory, Vector<Member> const& members)
+{
+    auto path = DeprecatedString::formatted("{}/archive.tar", directory.path());
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Write));
+    Archive::TarOutputStream archive(move(file));
+    for (auto const& member : members) {
+        switch (member.type) {
+        case Member::Type::File:
+            MUST(archive.add_file(member.path, 0644, member.data.bytes()));
+            break;
+        case Member::Type::SymLink:
+            MUST(archive.add_link(member.path, 0777, member.data));
+            break;
+        case Member::Type::Directory:
+            MUST(archive.add_directory(member.path, 0755));
+            break;
+        }
+    }
+    MUST(archive.finish());
+    return path;
+}
+
+static Process::ProcessResult run_tar(Vector<char const*>&& arguments)
+{
+    MUST(arguments.try_insert(0, "tar"));
+    MUST(arguments.try_append(nullptr));
+    auto tar = MUST(Process::create("tar"sv, arguments.data()));
+    (void)MUST(tar->read_all());
+    return MUST(tar->status());
+}
+
+static DeprecatedString read_file(StringView path)
+{
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Read));
+    return DeprecatedString { MUST(file->read_until_eof()).bytes() };
+}
+
+TEST_CASE(extract_on_several_threads)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    Vector<Member> members;
+    Vector<DeprecatedString> paths;
+    Vector<DeprecatedString> contents;
+    MUST(members.try_append({ Member::Type::Directory, "dir"sv }));
+    for (size_t i = 0; i < 32; ++i) {
+        paths.append(DeprecatedString::formatted("dir/file{}", i));
+        contents.append(DeprecatedString::repeated('a' + i % 26, i * 1000));
+    }
+    for (size_t i = 0; i < 32; ++i)
+        MUST(members.try_append({ Member::Type::File, paths[i], contents[i] }));
+    // A file that is in the archive twice ends up with the contents of its last copy.
+    MUST(members.try_append({ Member::Type::File, "dir/file0"sv, "replaced"sv }));
+    auto archive_path = create_archive(*directory, members);
+
+    for (auto thread_count : { "1", "4" }) {
+        auto destination_path = DeprecatedString::formatted("{}/destination{}", directory->path(), thread_count);
+        MUST(Core::System::mkdir(destination_path, 0755));
+        EXPECT_EQ(run_tar({ "-x", "--threads", thread_count, "-f", archive_path.characters(), "-C", destination_path.characters() }), Process::ProcessResult::DoneWithZeroExitCode);
+
+        EXPECT_EQ(read_file(DeprecatedString::formatted("{}/dir/file0", destination_path)), "replaced"sv);
+        for (size_t i = 1; i < 32; ++i)
+            EXPECT_EQ(read_file(DeprecatedString::formatted("{}/{}", destination_path, paths[i])), contents[i]);
+    }
+}
+
+TEST_CASE(file_before_symlink_to_its_directory)
+{
+    // The file has to be written before the symlink replaces its directory, or it ends up outside of the destination.
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto outside_path = DeprecatedString::formatted("{}/outside", directory->path());
+    MUST(Core::System::mkdir(outside_path, 0755));
+    auto archive_path = create_archive(*directory, {
+                                                       { Member::Type::File, "x/f"sv, "contents"sv },
+                                                       { Member::Type::SymLink, "x"sv, outside_path },
+                                                   });
+
+    for (auto thread_count : { "1", "4" }) {
+        auto destination_path = DeprecatedString::formatted("{}/destination{}", directory->path(), thread_count);
+        MUST(Core::System::mkdir(destination_path, 0755));
+        // Like extracting sequentially, creating the symlink fails because its directory is already there.
+        EXPECT_EQ(run_tar({ "-x", "--threads", thread_count, "-f", archive_path.characters(), "-C", destination_path.characters() }), Process::ProcessResult::Failed);
+
+        EXPECT_EQ(read_file(DeprecatedString::formatted("{}/x/f", destination_path)), "contents"sv);
+        EXPECT(!FileSystem::is_link(DeprecatedString::formatted("{}/x", destination_path)));
+        EXPECT(!FileSystem::exists(DeprecatedString::formatted("{}/f", outside_path)));
+    }
+}
+
+TEST_CASE(file_after_symlink_to_its_directory)
+{
+    auto directory = MUST(FileSystem::TempFile::create_temp_directory());
+    auto archive_path = create_archive(*directory, {
+                                                       { Member::Type::Directory, "real"sv },
+                                                       { Member::Type::SymLink, "link"sv, "real"sv },
+                                                       { Member::Type::File, "link/f"sv, "contents"sv },
+                                                   });
+
+    for (auto thread_count : { "1", "4" }) {
+        auto destination_path = DeprecatedString::formatted("{}/destination{}", directory->path(), thread_count);
+        MUST(Core::System::mkdir(destination_path, 0755));
+        EXPECT_EQ(run_tar({ "-x", "--threads", thread_count, "-f", archive_path.characters(), "-C", destination_path.characters() }), Process::ProcessResult::DoneWithZeroExitCode);
+
+        EXPECT(FileSystem::is_link(DeprecatedString::formatted("{}/link", destination_path)));
+        EXPECT_EQ(read_file(DeprecatedString::formatted("{}/real/f", destination_path)), "contents"sv);
+    }
+}
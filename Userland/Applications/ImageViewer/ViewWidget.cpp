@@ -35,7 +35,7 @@ ViewWidget::ViewWidget()
 void ViewWidget::clear()
 {
     m_timer->stop();
-    m_decoded_image.clear();
+    stop_decoding_image();
     m_bitmap = nullptr;
     if (on_image_change)
         on_image_change(m_bitmap);
@@ -175,28 +175,81 @@ void ViewWidget::open_file(String const& path, Core::File& file)
 ErrorOr<void> ViewWidget::try_open_file(String const& path, Core::File& file)
 {
     // Spawn a new ImageDecoder service process and connect to it.
-    auto client = TRY(ImageDecoderClient::Client::try_create());
+    if (!m_image_decoder_client)
+        m_image_decoder_client = TRY(ImageDecoderClient::Client::try_create());
+
+    stop_decoding_image();
+    m_timer->stop();
+    m_current_frame_index = 0;
+    m_loops_completed = 0;
+    m_is_waiting_for_first_frame = true;
+    m_is_waiting_for_next_frame = false;
+
     auto mime_type = Core::guess_mime_type_based_on_filename(path);
-    auto decoded_image_or_none = client->decode_image(TRY(file.read_until_eof()), mime_type);
-    if (!decoded_image_or_none.has_value()) {
+    m_streaming_image = m_image_decoder_client->start_decoding_image(mime_type);
+    if (!m_streaming_image)
         return Error::from_string_literal("Failed to decode image");
+
+    // Show as much of the image as there is until all of it has been decoded.
+    m_streaming_image->on_incomplete_frame_decoded = [this](auto bitmap) {
+        if (m_is_waiting_for_first_frame)
+            set_bitmap(bitmap.ptr());
+    };
+    m_streaming_image->on_frame_decoded = [this, path](u32 index, auto const& frame) {
+        if (m_is_waiting_for_first_frame && index == 0) {
+            m_is_waiting_for_first_frame = false;
+            did_decode_first_frame(path, frame);
+            return;
+        }
+        if (m_is_waiting_for_next_frame && index == next_frame_index()) {
+            m_is_waiting_for_next_frame = false;
+            show_frame(index, frame);
+        }
+    };
+    m_streaming_image->on_frame_failed = [this](u32 index) {
+        // The animation stops at the last frame that could be shown.
+        if (m_is_waiting_for_next_frame && index == next_frame_index()) {
+            m_is_waiting_for_next_frame = false;
+            m_timer->stop();
+        }
+    };
+    m_streaming_image->on_failure = [this] {
+        m_streaming_image = nullptr;
+        m_timer->stop();
+        GUI::MessageBox::show_error(nullptr, "Failed to open the image: Failed to decode image."sv);
+    };
+
+    // The file is sent over as it is read, so that the decoder doesn't have to wait for all of it to start.
+    auto buffer = TRY(ByteBuffer::create_uninitialized(64 * KiB));
+    while (!file.is_eof()) {
+        auto bytes = TRY(file.read_some(buffer));
+        if (bytes.is_empty())
+            break;
+        if (!m_streaming_image->append_encoded_data(bytes))
+            return Error::from_string_literal("Failed to decode image");
     }
+    if (!m_streaming_image->finish_encoded_data())
+        return Error::from_string_literal("Failed to decode image");
+
+    return {};
+}
 
-    m_decoded_image = decoded_image_or_none.release_value();
-    m_bitmap = m_decoded_image->frames[0].bitmap;
-    if (m_bitmap.is_null()) {
-        return Error::from_string_literal("Image didn't contain a bitmap");
+void ViewWidget::did_decode_first_frame(String const& path, ImageDecoderClient::Frame const& frame)
+{
+    if (frame.bitmap.is_null()) {
+        GUI::MessageBox::show_error(nullptr, "Failed to open the image: Image didn't contain a bitmap."sv);
+        return;
     }
+    m_bitmap = frame.bitmap;
 
     set_original_rect(m_bitmap->rect());
 
-    if (m_decoded_image->is_animated && m_decoded_image->frames.size() > 1) {
-        auto const& first_frame = m_decoded_image->frames[0];
-        m_timer->set_interval(first_frame.duration);
+    if (m_streaming_image->is_animated() && m_streaming_image->frame_count() > 1) {
+        m_timer->set_interval(frame.duration);
         m_timer->on_timeout = [this] { animate(); };
         m_timer->start();
-    } else {
-        m_timer->stop();
+        // Have the next frame ready by the time it's shown.
+        (void)m_streaming_image->frame(next_frame_index());
     }
 
     set_path(path);
@@ -209,8 +262,18 @@ ErrorOr<void> ViewWidget::try_open_file(String const& path, Core::File& file)
         scale_image_for_window();
     else
         reset_view();
+}
 
-    return {};
+void ViewWidget::stop_decoding_image()
+{
+    if (!m_streaming_image)
+        return;
+    m_streaming_image->on_incomplete_frame_decoded = nullptr;
+    m_streaming_image->on_frame_decoded = nullptr;
+    m_streaming_image->on_frame_failed = nullptr;
+    m_streaming_image->on_failure = nullptr;
+    m_streaming_image->stop();
+    m_streaming_image = nullptr;
 }
 
 void ViewWidget::drag_enter_event(GUI::DragEvent& event)
@@ -279,27 +342,41 @@ void ViewWidget::set_bitmap(Gfx::Bitmap const* bitmap)
     update();
 }
 
-// Same as ImageWidget::animate(), you probably want to keep any changes in sync
+u32 ViewWidget::next_frame_index() const
+{
+    return (m_current_frame_index + 1) % m_streaming_image->frame_count();
+}
+
 void ViewWidget::animate()
 {
-    if (!m_decoded_image.has_value())
+    if (!m_streaming_image)
         return;
 
-    m_current_frame_index = (m_current_frame_index + 1) % m_decoded_image->frames.size();
-
-    auto const& current_frame = m_decoded_image->frames[m_current_frame_index];
-    set_bitmap(current_frame.bitmap);
-
-    if ((int)current_frame.duration != m_timer->interval()) {
-        m_timer->restart(current_frame.duration);
+    auto frame = m_streaming_image->frame(next_frame_index());
+    if (!frame.has_value()) {
+        // The frame is still being decoded, and is shown as soon as it has been.
+        m_timer->stop();
+        m_is_waiting_for_next_frame = true;
+        return;
     }
+    show_frame(next_frame_index(), *frame);
+}
 
-    if (m_current_frame_index == m_decoded_image->frames.size() - 1) {
+void ViewWidget::show_frame(u32 index, ImageDecoderClient::Frame const& frame)
+{
+    m_current_frame_index = index;
+    set_bitmap(frame.bitmap);
+    m_timer->restart(frame.duration);
+
+    if (m_current_frame_index == m_streaming_image->frame_count() - 1) {
         ++m_loops_completed;
-        if (m_loops_completed > 0 && m_loops_completed == m_decoded_image->loop_count) {
+        if (m_loops_completed > 0 && m_loops_completed == m_streaming_image->loop_count()) {
             m_timer->stop();
+            return;
         }
     }
+
+    (void)m_streaming_image->frame(next_frame_index());
 }
 
 void ViewWidget::set_scaling_mode(Gfx::Painter::ScalingMode scaling_mode)
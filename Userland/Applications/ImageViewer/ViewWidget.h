@@ -15,6 +15,7 @@
 #include <LibGUI/AbstractZoomPanWidget.h>
 #include <LibGUI/Painter.h>
 #include <LibImageDecoderClient/Client.h>
+#include <LibImageDecoderClient/StreamingImage.h>
 
 namespace ImageViewer {
 
@@ -65,16 +66,23 @@ private:
     virtual void resize_event(GUI::ResizeEvent&) override;
 
     void set_bitmap(Gfx::Bitmap const* bitmap);
+    void did_decode_first_frame(String const& path, ImageDecoderClient::Frame const&);
+    void stop_decoding_image();
+    u32 next_frame_index() const;
     void animate();
+    void show_frame(u32 index, ImageDecoderClient::Frame const&);
     Vector<DeprecatedString> load_files_from_directory(DeprecatedString const& path) const;
     ErrorOr<void> try_open_file(String const&, Core::File&);
 
     String m_path;
     RefPtr<Gfx::Bitmap const> m_bitmap;
-    Optional<ImageDecoderClient::DecodedImage> m_decoded_image;
+    RefPtr<ImageDecoderClient::Client> m_image_decoder_client;
+    RefPtr<ImageDecoderClient::StreamingImage> m_streaming_image;
 
-    size_t m_current_frame_index { 0 };
+    u32 m_current_frame_index { 0 };
     size_t m_loops_completed { 0 };
+    bool m_is_waiting_for_first_frame { false };
+    bool m_is_waiting_for_next_frame { false };
     NonnullRefPtr<Core::Timer> m_timer;
 
     int m_toolbar_height { 28 };
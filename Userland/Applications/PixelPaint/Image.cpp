@@ -18,6 +18,7 @@
 #include <LibGfx/ImageFormats/QOIWriter.h>
 #include <LibImageDecoderClient/Client.h>
 #include <stdio.h>
+#include <unistd.h>
 
 namespace PixelPaint {
 
@@ -186,7 +187,9 @@ ErrorOr<void> Image::export_png_to_file(NonnullOwnPtr<Stream> stream, bool prese
     auto bitmap_format = preserve_alpha_channel ? Gfx::BitmapFormat::BGRA8888 : Gfx::BitmapFormat::BGRx8888;
     auto bitmap = TRY(compose_bitmap(bitmap_format));
 
-    auto encoded_data = TRY(Gfx::PNGWriter::encode(*bitmap));
+    Gfx::PNGWriter::Options options;
+    options.thread_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    auto encoded_data = TRY(Gfx::PNGWriter::encode(*bitmap, options));
     TRY(stream->write_until_depleted(encoded_data));
     return {};
 }
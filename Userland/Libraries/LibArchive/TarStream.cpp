@@ -7,7 +7,10 @@
  */
 
 #include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/LexicalPath.h>
 #include <AK/OwnPtr.h>
+#include <AK/StringBuilder.h>
 #include <LibArchive/TarStream.h>
 #include <string.h>
 
@@ -29,6 +32,7 @@ ErrorOr<Bytes> TarFileStream::read_some(Bytes bytes)
 
     auto slice = TRY(m_tar_stream.m_stream->read_some(bytes.trim(to_read)));
     m_tar_stream.m_file_offset += slice.size();
+    m_tar_stream.m_archive_offset += slice.size();
 
     return slice;
 }
@@ -81,6 +85,7 @@ ErrorOr<void> TarInputStream::advance()
     // Discard the pending bytes of the current entry.
     auto file_size = TRY(m_header.size());
     TRY(m_stream->discard(block_ceiling(file_size) - m_file_offset));
+    m_archive_offset = m_content_offset + block_ceiling(file_size);
     m_file_offset = 0;
 
     TRY(load_next_header());
@@ -96,6 +101,8 @@ ErrorOr<void> TarInputStream::load_next_header()
 
         // Discard the rest of the header block.
         TRY(m_stream->discard(block_size - sizeof(TarFileHeader)));
+        m_archive_offset += block_size;
+        m_content_offset = m_archive_offset;
 
         if (!header().is_zero_block())
             break;
@@ -135,6 +142,96 @@ TarFileStream TarInputStream::file_contents()
     return TarFileStream(*this);
 }
 
+ErrorOr<void> TarInputStream::for_each_member(Function<ErrorOr<void>(TarMember const&, TarFileStream&)> callback)
+{
+    HashMap<DeprecatedString, DeprecatedString> global_overrides;
+    HashMap<DeprecatedString, DeprecatedString> local_overrides;
+
+    auto get_override = [&](StringView key) -> Optional<DeprecatedString> {
+        Optional<DeprecatedString> maybe_local = local_overrides.get(key);
+
+        if (maybe_local.has_value())
+            return maybe_local;
+
+        Optional<DeprecatedString> maybe_global = global_overrides.get(key);
+
+        if (maybe_global.has_value())
+            return maybe_global;
+
+        return {};
+    };
+
+    while (!finished()) {
+        TarFileHeader const& header = this->header();
+
+        // Handle meta-entries earlier to avoid consuming the file content stream.
+        if (header.content_is_like_extended_header()) {
+            switch (header.type_flag()) {
+            case TarFileType::GlobalExtendedHeader: {
+                TRY(for_each_extended_header([&](StringView key, StringView value) {
+                    if (value.length() == 0)
+                        global_overrides.remove(key);
+                    else
+                        global_overrides.set(key, value);
+                }));
+                break;
+            }
+            case TarFileType::ExtendedHeader: {
+                TRY(for_each_extended_header([&](StringView key, StringView value) {
+                    local_overrides.set(key, value);
+                }));
+                break;
+            }
+            default:
+                return Error::from_string_literal("Unknown extended header type");
+            }
+
+            TRY(advance());
+            continue;
+        }
+
+        TarFileStream file_stream = file_contents();
+
+        if (header.type_flag() == TarFileType::LongName) {
+            StringBuilder long_name;
+
+            Array<u8, block_size> buffer;
+
+            while (!file_stream.is_eof()) {
+                auto slice = TRY(file_stream.read_some(buffer));
+                long_name.append(reinterpret_cast<char*>(slice.data()), slice.size());
+            }
+
+            local_overrides.set("path", long_name.to_deprecated_string());
+            TRY(advance());
+            continue;
+        }
+
+        LexicalPath path = LexicalPath(header.filename());
+        if (!header.prefix().is_empty())
+            path = path.prepend(header.prefix());
+
+        TarMember member { get_override("path"sv).value_or(path.string()), header, m_content_offset };
+        TRY(callback(member, file_stream));
+
+        // Non-global headers should be cleared after every file.
+        local_overrides.clear();
+
+        TRY(advance());
+    }
+
+    return {};
+}
+
+ErrorOr<Vector<TarMember>> TarInputStream::read_member_index()
+{
+    Vector<TarMember> members;
+    TRY(for_each_member([&](TarMember const& member, TarFileStream&) {
+        return members.try_append(member);
+    }));
+    return members;
+}
+
 TarOutputStream::TarOutputStream(MaybeOwned<Stream> stream)
     : m_stream(move(stream))
 {
@@ -7,15 +7,26 @@
 
 #pragma once
 
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
 #include <AK/MaybeOwned.h>
 #include <AK/Span.h>
 #include <AK/Stream.h>
+#include <AK/Vector.h>
 #include <LibArchive/Tar.h>
 
 namespace Archive {
 
 class TarInputStream;
 
+struct TarMember {
+    // The member's path, with GNU long names and pax extended headers applied.
+    DeprecatedString path;
+    TarFileHeader header;
+    // Where the member's contents start, counted from the start of the (uncompressed) archive.
+    u64 content_offset { 0 };
+};
+
 class TarFileStream : public Stream {
 public:
     virtual ErrorOr<Bytes> read_some(Bytes) override;
@@ -40,10 +51,18 @@ public:
     ErrorOr<bool> valid() const;
     TarFileHeader const& header() const { return m_header; }
     TarFileStream file_contents();
+    u64 content_offset() const { return m_content_offset; }
 
     template<VoidFunction<StringView, StringView> F>
     ErrorOr<void> for_each_extended_header(F func);
 
+    // Calls the callback for every member that is not just metadata for the member after it, and advances past it.
+    ErrorOr<void> for_each_member(Function<ErrorOr<void>(TarMember const&, TarFileStream&)>);
+
+    // Collects the members of the rest of the archive without reading their contents. On seekable streams, the contents
+    // are seeked over, so this only reads the member headers.
+    ErrorOr<Vector<TarMember>> read_member_index();
+
 private:
     TarInputStream(NonnullOwnPtr<Stream>);
     ErrorOr<void> load_next_header();
@@ -51,6 +70,8 @@ private:
     TarFileHeader m_header;
     NonnullOwnPtr<Stream> m_stream;
     unsigned long m_file_offset { 0 };
+    u64 m_archive_offset { 0 };
+    u64 m_content_offset { 0 };
     int m_generation { 0 };
     bool m_found_end_of_archive { false };
 
@@ -901,6 +901,14 @@ int ftruncate(int fd, off_t length)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// https://man7.org/linux/man-pages/man2/copy_file_range.2.html
+ssize_t copy_file_range(int fd_in, off_t* off_in, int fd_out, off_t* off_out, size_t len, unsigned flags)
+{
+    Syscall::SC_copy_file_range_params params { fd_in, off_in, fd_out, off_out, len, flags };
+    int rc = syscall(SC_copy_file_range, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/truncate.html
 int truncate(char const* path, off_t length)
 {
@@ -14,6 +14,9 @@
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -23,29 +26,14 @@ static constexpr u8 deflate_special_code_length_long_zeros = 18;
 
 CanonicalCode const& CanonicalCode::fixed_literal_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = MUST(CanonicalCode::from_bytes(fixed_literal_bit_lengths));
-    initialized = true;
-
+    // Function-local statics are initialized exactly once, even when several threads decompress at the same time.
+    static CanonicalCode const code = MUST(CanonicalCode::from_bytes(fixed_literal_bit_lengths));
     return code;
 }
 
 CanonicalCode const& CanonicalCode::fixed_distance_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = MUST(CanonicalCode::from_bytes(fixed_distance_bit_lengths));
-    initialized = true;
-
+    static CanonicalCode const code = MUST(CanonicalCode::from_bytes(fixed_distance_bit_lengths));
     return code;
 }
 
@@ -589,7 +577,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -699,6 +687,11 @@ void DeflateCompressor::lz77_compress_block()
         m_hash_head[hash] = window_pos;
     };
 
+    // the preset dictionary (if any) directly precedes our block, so make it available for back references
+    for (size_t position = block_size - m_dictionary_size; position < block_size; position++) {
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+    }
+
     auto emit_literal = [&](auto literal) {
         VERIFY(m_pending_symbol_size <= block_size + 1);
         auto index = m_pending_symbol_size++;
@@ -1036,6 +1029,7 @@ ErrorOr<void> DeflateCompressor::flush()
 
     // reset all block specific members
     m_pending_block_size = 0;
+    m_dictionary_size = 0;
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
@@ -1054,6 +1048,33 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
+ErrorOr<void> DeflateCompressor::final_flush_for_concatenation()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        TRY(flush());
+    m_finished = true;
+
+    // an empty stored block takes us to a byte boundary without ending the deflate stream
+    TRY(m_output_stream->write_bits(0b0u, 1));  // not the final block
+    TRY(m_output_stream->write_bits(0b00u, 2)); // no compression
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0));
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0xffff));
+    TRY(m_output_stream->flush_buffer_to_stream());
+    return {};
+}
+
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_pending_block_size == 0 && !m_finished);
+    // the rolling window only holds block_size bytes before the pending block, which is just short of the maximum back reference distance
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_dictionary_size = dictionary.size();
+}
+
 ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
@@ -1068,4 +1089,122 @@ ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, Compres
     return buffer;
 }
 
+namespace {
+
+struct CompressedChunk {
+    ByteBuffer data;
+    u32 checksum { 0 };
+};
+
+}
+
+static ErrorOr<CompressedChunk> compress_chunk(ReadonlyBytes dictionary, ReadonlyBytes chunk, bool is_last_chunk, DeflateCompressor::CompressionLevel compression_level, Function<u32(ReadonlyBytes)> const& checksum_chunk)
+{
+    AllocatingMemoryStream output_stream;
+    auto compressor = TRY(DeflateCompressor::construct(MaybeOwned<Stream>(output_stream), compression_level));
+    compressor->set_dictionary(dictionary);
+    TRY(compressor->write_until_depleted(chunk));
+    if (is_last_chunk)
+        TRY(compressor->final_flush());
+    else
+        TRY(compressor->final_flush_for_concatenation());
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+    TRY(output_stream.read_until_filled(buffer.bytes()));
+    return CompressedChunk { move(buffer), checksum_chunk(chunk) };
+}
+
+ErrorOr<u32> DeflateCompressor::compress_in_parallel(ReadonlyBytes bytes, Stream& output_stream, size_t thread_count, CompressionLevel compression_level,
+    Function<u32(ReadonlyBytes)> const& checksum_chunk, Function<u32(u32, u32, u64)> const& combine_checksums)
+{
+    VERIFY(thread_count > 0);
+    auto chunk_count = max<size_t>(ceil_div(bytes.size(), parallel_chunk_size), 1);
+    thread_count = min(thread_count, chunk_count);
+    // Keep the amount of compressed data waiting to be written bounded, no matter how large the input is.
+    auto max_chunks_in_flight = thread_count * 4;
+
+    Threading::Mutex mutex;
+    Threading::ConditionVariable condition { mutex };
+    size_t next_chunk_to_compress = 0;
+    size_t next_chunk_to_write = 0;
+    Vector<Optional<CompressedChunk>> compressed_chunks;
+    TRY(compressed_chunks.try_resize(chunk_count));
+    Optional<Error> error;
+
+    auto set_error = [&](Error const& new_error) {
+        Threading::MutexLocker locker(mutex);
+        if (!error.has_value())
+            error = Error::copy(new_error);
+        condition.broadcast();
+    };
+
+    auto compress_chunks = [&]() -> intptr_t {
+        while (true) {
+            size_t index;
+            {
+                Threading::MutexLocker locker(mutex);
+                while (!error.has_value() && next_chunk_to_compress < chunk_count && next_chunk_to_compress >= next_chunk_to_write + max_chunks_in_flight)
+                    condition.wait();
+                if (error.has_value() || next_chunk_to_compress >= chunk_count)
+                    return 0;
+                index = next_chunk_to_compress++;
+            }
+
+            auto offset = index * parallel_chunk_size;
+            auto chunk = bytes.slice(offset, min(parallel_chunk_size, bytes.size() - offset));
+            auto compressed_chunk = compress_chunk(bytes.slice(0, offset), chunk, index == chunk_count - 1, compression_level, checksum_chunk);
+            if (compressed_chunk.is_error()) {
+                set_error(compressed_chunk.error());
+                return 0;
+            }
+
+            Threading::MutexLocker locker(mutex);
+            compressed_chunks[index] = compressed_chunk.release_value();
+            condition.broadcast();
+        }
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    auto start_threads = [&]() -> ErrorOr<void> {
+        for (size_t i = 0; i < thread_count; ++i) {
+            auto thread = TRY(Threading::Thread::try_create([&] { return compress_chunks(); }, "Deflate compressor"sv));
+            TRY(threads.try_append(thread));
+            thread->start();
+        }
+        return {};
+    };
+
+    auto write_output = [&]() -> ErrorOr<u32> {
+        TRY(start_threads());
+
+        u32 checksum = 0;
+        for (size_t index = 0; index < chunk_count; ++index) {
+            CompressedChunk compressed_chunk;
+            {
+                Threading::MutexLocker locker(mutex);
+                while (!error.has_value() && !compressed_chunks[index].has_value())
+                    condition.wait();
+                if (error.has_value())
+                    return Error::copy(*error);
+                compressed_chunk = compressed_chunks[index].release_value();
+                next_chunk_to_write++;
+                condition.broadcast();
+            }
+            TRY(output_stream.write_until_depleted(compressed_chunk.data));
+
+            auto chunk_size = min(parallel_chunk_size, bytes.size() - index * parallel_chunk_size);
+            checksum = index == 0 ? compressed_chunk.checksum : combine_checksums(checksum, compressed_chunk.checksum, chunk_size);
+        }
+        return checksum;
+    };
+
+    auto result = write_output();
+    if (result.is_error())
+        set_error(result.error());
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return result;
+}
+
 }
@@ -11,6 +11,7 @@
 #include <AK/CircularBuffer.h>
 #include <AK/Endian.h>
 #include <AK/Forward.h>
+#include <AK/Function.h>
 #include <AK/MaybeOwned.h>
 #include <AK/Stream.h>
 #include <AK/Vector.h>
@@ -129,6 +130,7 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
@@ -165,8 +167,23 @@ public:
     virtual void close() override;
     ErrorOr<void> final_flush();
 
+    // Like final_flush(), but ends the output with an empty non-final stored block instead of a final block.
+    // The output is byte-aligned and can be followed by the deflate blocks of another compressor.
+    ErrorOr<void> final_flush_for_concatenation();
+
+    // Back references in the first block may point into the dictionary, which is expected to directly precede the data
+    // in the decompressed output. Only the last 32 KiB of the dictionary are used. Must be called before writing any data.
+    void set_dictionary(ReadonlyBytes);
+
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
+    // Compresses chunks of the input on multiple threads, each primed with the input before it as its dictionary, and
+    // writes them out in order as a single deflate stream. Container formats need a checksum of the whole input, so each
+    // chunk is also checksummed on its worker thread, and the combination of all of those checksums is returned.
+    static constexpr size_t parallel_chunk_size = 128 * KiB;
+    static ErrorOr<u32> compress_in_parallel(ReadonlyBytes bytes, Stream& output_stream, size_t thread_count, CompressionLevel,
+        Function<u32(ReadonlyBytes)> const& checksum_chunk, Function<u32(u32, u32, u64)> const& combine_checksums);
+
 private:
     DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel = CompressionLevel::GOOD);
 
@@ -204,6 +221,7 @@ private:
 
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_dictionary_size { 0 };
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -215,7 +215,7 @@ ErrorOr<Bytes> GzipCompressor::read_some(Bytes)
     return Error::from_errno(EBADF);
 }
 
-ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+ErrorOr<void> GzipCompressor::write_header(Stream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -225,7 +225,13 @@ ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    TRY(m_output_stream->write_until_depleted({ &header, sizeof(header) }));
+    TRY(stream.write_until_depleted({ &header, sizeof(header) }));
+    return {};
+}
+
+ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+{
+    TRY(write_header(*m_output_stream));
     auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
     TRY(compressed_stream->write_until_depleted(bytes));
     TRY(compressed_stream->final_flush());
@@ -262,7 +268,19 @@ ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
     return buffer;
 }
 
-ErrorOr<void> GzipCompressor::compress_file(StringView input_filename, NonnullOwnPtr<Stream> output_stream)
+ErrorOr<void> GzipCompressor::compress_in_parallel(ReadonlyBytes bytes, Stream& output_stream, size_t thread_count)
+{
+    TRY(write_header(output_stream));
+    auto crc32 = TRY(DeflateCompressor::compress_in_parallel(
+        bytes, output_stream, thread_count, DeflateCompressor::CompressionLevel::GOOD,
+        [](ReadonlyBytes chunk) { return Crypto::Checksum::CRC32(chunk).digest(); },
+        Crypto::Checksum::CRC32::combine));
+    TRY(output_stream.write_value<LittleEndian<u32>>(crc32));
+    TRY(output_stream.write_value<LittleEndian<u32>>(bytes.size()));
+    return {};
+}
+
+ErrorOr<void> GzipCompressor::compress_file(StringView input_filename, NonnullOwnPtr<Stream> output_stream, size_t thread_count)
 {
     // We map the whole file instead of streaming to reduce size overhead (gzip header) and increase the deflate block size (better compression)
     // TODO: automatically fallback to buffered streaming for very large files
@@ -274,6 +292,9 @@ ErrorOr<void> GzipCompressor::compress_file(StringView input_filename, NonnullOw
         input_bytes = file->bytes();
     }
 
+    if (thread_count > 1)
+        return compress_in_parallel(input_bytes, *output_stream, thread_count);
+
     auto output_bytes = TRY(Compress::GzipCompressor::compress_all(input_bytes));
     TRY(output_stream->write_until_depleted(output_bytes));
 
@@ -93,9 +93,16 @@ public:
     virtual void close() override;
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes);
-    static ErrorOr<void> compress_file(StringView input_file, NonnullOwnPtr<Stream> output_stream);
+    static ErrorOr<void> compress_file(StringView input_file, NonnullOwnPtr<Stream> output_stream, size_t thread_count = 1);
+
+    // Compresses chunks of the input on multiple threads, see DeflateCompressor::compress_in_parallel().
+    // The result is a single gzip member, which is slightly larger than what compress_all() would produce.
+    static constexpr size_t parallel_chunk_size = DeflateCompressor::parallel_chunk_size;
+    static ErrorOr<void> compress_in_parallel(ReadonlyBytes bytes, Stream& output_stream, size_t thread_count);
 
 private:
+    static ErrorOr<void> write_header(Stream&);
+
     MaybeOwned<Stream> m_output_stream;
 };
 
@@ -9,6 +9,9 @@
 #include <LibCompress/Lzma2.h>
 #include <LibCompress/Xz.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -252,14 +255,18 @@ ErrorOr<bool> XzDecompressor::load_next_stream()
     return true;
 }
 
-ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
-{
-    // We already read the encoded Block Header size (one byte) to determine that this is not an Index.
-    m_current_block_start_offset = m_stream->read_bytes() - 1;
+namespace {
 
-    // Ensure that the start of the block is aligned to a multiple of four (in theory, everything in XZ is).
-    VERIFY(m_current_block_start_offset % 4 == 0);
+struct XzBlockHeader {
+    MaybeOwned<Stream> block_stream;
+    Optional<u64> expected_uncompressed_size;
+};
+
+}
 
+// Reads the remainder of a Block Header from the stream, and sets up a stream that decompresses the Block's data from it.
+static ErrorOr<XzBlockHeader> read_block_header(Stream& stream, u8 encoded_block_header_size)
+{
     // 3.1.1. Block Header Size:
     // "This field contains the size of the Block Header field,
     //  including the Block Header Size field itself. Valid values are
@@ -273,7 +280,7 @@ ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
     // Read the whole header into a buffer to allow calculating the CRC32 later (3.1.7. CRC32).
     auto header = TRY(ByteBuffer::create_uninitialized(block_header_size));
     header[0] = encoded_block_header_size;
-    TRY(m_stream->read_until_filled(header.span().slice(1)));
+    TRY(stream.read_until_filled(header.span().slice(1)));
 
     FixedMemoryStream header_stream { header.span().slice(1) };
 
@@ -287,7 +294,8 @@ ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
     if (flags.reserved != 0)
         return Error::from_string_literal("XZ block header has reserved non-null block flag bits");
 
-    MaybeOwned<Stream> new_block_stream { *m_stream };
+    MaybeOwned<Stream> new_block_stream { stream };
+    Optional<u64> expected_uncompressed_size;
 
     // 3.1.3. Compressed Size:
     // "This field is present only if the appropriate bit is set in
@@ -311,9 +319,7 @@ ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
         // "Uncompressed Size is stored using the encoding described in Section 1.2."
         u64 const uncompressed_size = TRY(header_stream.read_value<XzMultibyteInteger>());
 
-        m_current_block_expected_uncompressed_size = uncompressed_size;
-    } else {
-        m_current_block_expected_uncompressed_size.clear();
+        expected_uncompressed_size = uncompressed_size;
     }
 
     // 3.1.5. List of Filter Flags:
@@ -370,7 +376,21 @@ ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
     if (calculated_header_crc32.digest() != stored_header_crc32)
         return Error::from_string_literal("Stored XZ block header CRC32 does not match the stored CRC32");
 
-    m_current_block_stream = move(new_block_stream);
+    return XzBlockHeader { move(new_block_stream), expected_uncompressed_size };
+}
+
+ErrorOr<void> XzDecompressor::load_next_block(u8 encoded_block_header_size)
+{
+    // We already read the encoded Block Header size (one byte) to determine that this is not an Index.
+    m_current_block_start_offset = m_stream->read_bytes() - 1;
+
+    // Ensure that the start of the block is aligned to a multiple of four (in theory, everything in XZ is).
+    VERIFY(m_current_block_start_offset % 4 == 0);
+
+    auto block_header = TRY(read_block_header(*m_stream, encoded_block_header_size));
+
+    m_current_block_stream = move(block_header.block_stream);
+    m_current_block_expected_uncompressed_size = block_header.expected_uncompressed_size;
     m_current_block_uncompressed_size = 0;
 
     return {};
@@ -552,6 +572,7 @@ ErrorOr<Bytes> XzDecompressor::read_some(Bytes bytes)
             // Another XZ Stream might follow, so we just unset the current information and continue on the next read.
             m_stream_flags.clear();
             m_processed_blocks.clear();
+            m_current_block_stream.clear();
             return bytes.trim(0);
         }
 
@@ -584,4 +605,294 @@ void XzDecompressor::close()
 {
 }
 
+namespace {
+
+struct XzBlockLocation {
+    u64 offset {};
+    u64 unpadded_size {};
+    u64 uncompressed_size {};
+    size_t check_size {};
+};
+
+}
+
+static ErrorOr<void> read_at(SeekableStream& stream, u64 offset, Bytes bytes)
+{
+    TRY(stream.seek(offset, SeekMode::SetPosition));
+    TRY(stream.read_until_filled(bytes));
+    return {};
+}
+
+// Reads the Index of the Stream that ends at `stream_end`, and returns the offset at which that Stream starts.
+static ErrorOr<u64> locate_blocks_of_stream(SeekableStream& stream, u64 stream_end, Vector<XzBlockLocation>& blocks)
+{
+    if (stream_end < sizeof(XzStreamHeader) + sizeof(XzStreamFooter))
+        return Error::from_string_literal("XZ stream is too small to contain a header and a footer");
+
+    XzStreamFooter stream_footer {};
+    TRY(read_at(stream, stream_end - sizeof(XzStreamFooter), { &stream_footer, sizeof(stream_footer) }));
+    TRY(stream_footer.validate());
+
+    // 2.1.2.2. Backward Size:
+    // "Backward Size is stored as a 32-bit little endian integer,
+    //  which indicates the size of the Index field [...]"
+    u64 const size_of_index = stream_footer.backward_size();
+    if (size_of_index > stream_end - sizeof(XzStreamHeader) - sizeof(XzStreamFooter))
+        return Error::from_string_literal("XZ stream footer points to an index outside of the input");
+
+    u64 const index_offset = stream_end - sizeof(XzStreamFooter) - size_of_index;
+    auto index = TRY(ByteBuffer::create_uninitialized(size_of_index));
+    TRY(read_at(stream, index_offset, index));
+
+    // 4.5. CRC32:
+    // "The CRC32 is calculated over everything in the Index field
+    //  except the CRC32 field itself. The CRC32 is stored as an
+    //  unsigned 32-bit little endian integer."
+    constexpr size_t size_of_crc32 = 4;
+    FixedMemoryStream index_stream { index.bytes() };
+    TRY(index_stream.seek(size_of_index - size_of_crc32, SeekMode::SetPosition));
+    u32 const index_crc32 = TRY(index_stream.read_value<LittleEndian<u32>>());
+    if (Crypto::Checksum::CRC32 { index.bytes().trim(size_of_index - size_of_crc32) }.digest() != index_crc32)
+        return Error::from_string_literal("XZ index has an invalid CRC32 checksum");
+
+    // 4.1. Index Indicator:
+    // "The first byte of the Index is always 0x00."
+    FixedMemoryStream records_stream { index.bytes().trim(size_of_index - size_of_crc32) };
+    if (TRY(records_stream.read_value<u8>()) != 0x00)
+        return Error::from_string_literal("XZ index does not start with an index indicator");
+
+    // 4.2. Number of Records
+    u64 const number_of_records = TRY(records_stream.read_value<XzMultibyteInteger>());
+
+    Vector<XzBlockLocation> stream_blocks;
+    u64 size_of_blocks = 0;
+    for (u64 i = 0; i < number_of_records; i++) {
+        // 4.3.1. Unpadded Size
+        u64 const unpadded_size = TRY(records_stream.read_value<XzMultibyteInteger>());
+        if (unpadded_size < 5)
+            return Error::from_string_literal("XZ index contains a record with an unpadded size of less than five");
+
+        // 4.3.2. Uncompressed Size
+        u64 const uncompressed_size = TRY(records_stream.read_value<XzMultibyteInteger>());
+
+        // The Blocks immediately follow each other, as each of them is padded to a multiple of four bytes (3.3. Block Padding).
+        TRY(stream_blocks.try_append({ .offset = size_of_blocks, .unpadded_size = unpadded_size, .uncompressed_size = uncompressed_size, .check_size = 0 }));
+        size_of_blocks += align_up_to(unpadded_size, 4);
+        if (size_of_blocks > index_offset)
+            return Error::from_string_literal("XZ index contains blocks that are larger than the input");
+    }
+
+    // 4.4. Index Padding:
+    // "This field MUST contain 0-3 null bytes to pad the Index to
+    //  a multiple of four bytes. If any of the bytes are not null
+    //  bytes, the decoder MUST indicate an error."
+    if (size_of_index - size_of_crc32 - MUST(records_stream.tell()) > 3)
+        return Error::from_string_literal("XZ index size does not match the stored size in the stream footer");
+    while (!records_stream.is_eof()) {
+        if (TRY(records_stream.read_value<u8>()) != 0)
+            return Error::from_string_literal("XZ index contains a non-null padding byte");
+    }
+
+    if (size_of_blocks + sizeof(XzStreamHeader) > index_offset)
+        return Error::from_string_literal("XZ index contains blocks that are larger than the input");
+
+    u64 const stream_start = index_offset - size_of_blocks - sizeof(XzStreamHeader);
+    XzStreamHeader stream_header {};
+    TRY(read_at(stream, stream_start, { &stream_header, sizeof(stream_header) }));
+    TRY(stream_header.validate());
+
+    // 2.1.2.3. Stream Flags:
+    // "The decoder MUST compare the Stream Flags fields in both Stream Header and Stream
+    //  Footer, and indicate an error if they are not identical."
+    if (ReadonlyBytes { &stream_header.flags, sizeof(XzStreamFlags) } != ReadonlyBytes { &stream_footer.flags, sizeof(XzStreamFlags) })
+        return Error::from_string_literal("XZ stream header flags don't match the stream footer");
+
+    auto const check_size = size_for_check_type(stream_header.flags.check_type);
+    if (!check_size.has_value())
+        return Error::from_string_literal("XZ stream has an unknown check type");
+
+    for (auto& block : stream_blocks) {
+        block.offset += stream_start + sizeof(XzStreamHeader);
+        block.check_size = *check_size;
+    }
+    TRY(blocks.try_prepend(move(stream_blocks)));
+
+    return stream_start;
+}
+
+static ErrorOr<Vector<XzBlockLocation>> locate_blocks(SeekableStream& stream)
+{
+    Vector<XzBlockLocation> blocks;
+
+    // Streams are located from back to front, since only the Stream Footer tells us where the Index of a Stream is.
+    u64 position = TRY(stream.size());
+    do {
+        // 2.2. Stream Padding:
+        // "To preserve the four-byte alignment of consecutive Streams, the size of Stream Padding MUST be a multiple of four bytes."
+        if (position % 4 != 0)
+            return Error::from_string_literal("XZ Stream Padding is not aligned to 4 bytes");
+
+        while (position >= 4) {
+            LittleEndian<u32> padding;
+            TRY(read_at(stream, position - 4, { &padding, sizeof(padding) }));
+            if (padding != 0)
+                break;
+            position -= 4;
+        }
+
+        position = TRY(locate_blocks_of_stream(stream, position, blocks));
+    } while (position > 0);
+
+    return blocks;
+}
+
+static ErrorOr<ByteBuffer> decompress_block(ReadonlyBytes block, XzBlockLocation const& location)
+{
+    FixedMemoryStream stream { block };
+
+    // The first byte between Block Header (3.1.1. Block Header Size) and Index (4.1. Index Indicator) overlap.
+    auto const encoded_block_header_size = TRY(stream.read_value<u8>());
+    if (encoded_block_header_size == 0x00)
+        return Error::from_string_literal("XZ index points to an index instead of a block");
+
+    auto block_header = TRY(read_block_header(stream, encoded_block_header_size));
+
+    if (block_header.expected_uncompressed_size.has_value() && *block_header.expected_uncompressed_size != location.uncompressed_size)
+        return Error::from_string_literal("Uncompressed size of XZ Block does not match the Index");
+
+    auto decompressed = TRY(ByteBuffer::create_uninitialized(location.uncompressed_size));
+    TRY(block_header.block_stream->read_until_filled(decompressed));
+
+    // The Block has to end exactly where the Index says it does.
+    u8 extra_byte;
+    if (!TRY(block_header.block_stream->read_some({ &extra_byte, 1 })).is_empty())
+        return Error::from_string_literal("Uncompressed size of XZ Block does not match the Index");
+
+    auto const end_of_compressed_data = MUST(stream.tell());
+    if (end_of_compressed_data + location.check_size != location.unpadded_size)
+        return Error::from_string_literal("Unpadded size of XZ Block does not match the Index");
+
+    // 3.3. Block Padding:
+    // "If any of the bytes in Block Padding are not null bytes, the decoder
+    //  MUST indicate an error."
+    for (auto padding_byte : block.slice(end_of_compressed_data, align_up_to(end_of_compressed_data, 4) - end_of_compressed_data)) {
+        if (padding_byte != 0)
+            return Error::from_string_literal("XZ block contains a non-null padding byte");
+    }
+
+    // TODO: Block content checks are currently unimplemented as a whole, independent of the check type.
+
+    return decompressed;
+}
+
+ErrorOr<void> XzDecompressor::decompress_in_parallel(SeekableStream& input, Stream& output, size_t thread_count, size_t max_buffered_size)
+{
+    VERIFY(thread_count > 0);
+
+    auto const blocks = TRY(locate_blocks(input));
+    thread_count = min(thread_count, max<size_t>(blocks.size(), 1));
+
+    Threading::Mutex mutex;
+    Threading::ConditionVariable condition { mutex };
+    size_t next_block_to_decompress = 0;
+    u64 buffered_size = 0;
+    Vector<Optional<ByteBuffer>> decompressed_blocks;
+    TRY(decompressed_blocks.try_resize(blocks.size()));
+    Optional<Error> error;
+
+    auto set_error = [&](Error const& new_error) {
+        Threading::MutexLocker locker(mutex);
+        if (!error.has_value())
+            error = Error::copy(new_error);
+        condition.broadcast();
+    };
+
+    auto can_start_next_block = [&] {
+        // A Block that doesn't fit within the limit is still decompressed once nothing else is buffered, so that we make progress.
+        auto const& block = blocks[next_block_to_decompress];
+        return buffered_size == 0 || buffered_size + block.uncompressed_size <= max_buffered_size;
+    };
+
+    auto decompress_blocks = [&]() -> intptr_t {
+        while (true) {
+            size_t index;
+            ByteBuffer compressed_block;
+            {
+                Threading::MutexLocker locker(mutex);
+                while (!error.has_value() && next_block_to_decompress < blocks.size() && !can_start_next_block())
+                    condition.wait();
+                if (error.has_value() || next_block_to_decompress >= blocks.size())
+                    return 0;
+                index = next_block_to_decompress++;
+                buffered_size += blocks[index].uncompressed_size;
+
+                // The input is shared between all threads, so it can only be read while holding the lock.
+                auto const& location = blocks[index];
+                auto read_result = [&]() -> ErrorOr<void> {
+                    compressed_block = TRY(ByteBuffer::create_uninitialized(align_up_to(location.unpadded_size, 4)));
+                    return read_at(input, location.offset, compressed_block);
+                }();
+                if (read_result.is_error()) {
+                    if (!error.has_value())
+                        error = read_result.release_error();
+                    condition.broadcast();
+                    return 0;
+                }
+            }
+
+            auto decompressed_block = decompress_block(compressed_block, blocks[index]);
+            if (decompressed_block.is_error()) {
+                set_error(decompressed_block.error());
+                return 0;
+            }
+
+            Threading::MutexLocker locker(mutex);
+            decompressed_blocks[index] = decompressed_block.release_value();
+            condition.broadcast();
+        }
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    auto start_threads = [&]() -> ErrorOr<void> {
+        for (size_t i = 0; i < thread_count; ++i) {
+            auto thread = TRY(Threading::Thread::try_create([&] { return decompress_blocks(); }, "XZ decompressor"sv));
+            TRY(threads.try_append(thread));
+            thread->start();
+        }
+        return {};
+    };
+
+    auto write_output = [&]() -> ErrorOr<void> {
+        TRY(start_threads());
+
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            ByteBuffer decompressed_block;
+            {
+                Threading::MutexLocker locker(mutex);
+                while (!error.has_value() && !decompressed_blocks[index].has_value())
+                    condition.wait();
+                if (error.has_value())
+                    return Error::copy(*error);
+                decompressed_block = decompressed_blocks[index].release_value();
+            }
+
+            TRY(output.write_until_depleted(decompressed_block));
+
+            Threading::MutexLocker locker(mutex);
+            buffered_size -= blocks[index].uncompressed_size;
+            condition.broadcast();
+        }
+
+        return {};
+    };
+
+    auto result = write_output();
+    if (result.is_error())
+        set_error(result.error());
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return result;
+}
+
 }
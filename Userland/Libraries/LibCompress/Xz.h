@@ -102,6 +102,11 @@ class XzDecompressor : public Stream {
 public:
     static ErrorOr<NonnullOwnPtr<XzDecompressor>> create(MaybeOwned<Stream>);
 
+    // Decompresses a seekable input using multiple threads. The Blocks of each Stream are located using the Stream's Index,
+    // which allows decompressing them independently of each other. Decompressed Blocks are written to the output in order,
+    // and at most `max_buffered_size` bytes of them are kept in memory at a time (unless a single Block is larger than that).
+    static ErrorOr<void> decompress_in_parallel(SeekableStream& input, Stream& output, size_t thread_count, size_t max_buffered_size = 256 * MiB);
+
     virtual ErrorOr<Bytes> read_some(Bytes) override;
     virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
     virtual bool is_eof() const override;
@@ -78,7 +78,7 @@ ErrorOr<NonnullOwnPtr<ZlibCompressor>> ZlibCompressor::construct(MaybeOwned<Stre
     auto compressor_stream = TRY(DeflateCompressor::construct(MaybeOwned(*stream), static_cast<DeflateCompressor::CompressionLevel>(compression_level)));
 
     auto zlib_compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ZlibCompressor(move(stream), move(compressor_stream))));
-    TRY(zlib_compressor->write_header(compression_method, compression_level));
+    TRY(write_header(*zlib_compressor->m_output_stream, compression_method, compression_level));
 
     return zlib_compressor;
 }
@@ -94,7 +94,7 @@ ZlibCompressor::~ZlibCompressor()
     VERIFY(m_finished);
 }
 
-ErrorOr<void> ZlibCompressor::write_header(ZlibCompressionMethod compression_method, ZlibCompressionLevel compression_level)
+ErrorOr<void> ZlibCompressor::write_header(Stream& stream, ZlibCompressionMethod compression_method, ZlibCompressionLevel compression_level)
 {
     u8 compression_info = 0;
     if (compression_method == ZlibCompressionMethod::Deflate) {
@@ -113,7 +113,7 @@ ErrorOr<void> ZlibCompressor::write_header(ZlibCompressionMethod compression_met
 
     // FIXME: Support pre-defined dictionaries.
 
-    TRY(m_output_stream->write_value(header.as_u16));
+    TRY(stream.write_value(header.as_u16));
 
     return {};
 }
@@ -176,4 +176,20 @@ ErrorOr<ByteBuffer> ZlibCompressor::compress_all(ReadonlyBytes bytes, ZlibCompre
     return buffer;
 }
 
+ErrorOr<ByteBuffer> ZlibCompressor::compress_all_in_parallel(ReadonlyBytes bytes, size_t thread_count, ZlibCompressionLevel compression_level)
+{
+    AllocatingMemoryStream output_stream;
+    TRY(write_header(output_stream, ZlibCompressionMethod::Deflate, compression_level));
+
+    auto adler32 = TRY(DeflateCompressor::compress_in_parallel(
+        bytes, output_stream, thread_count, static_cast<DeflateCompressor::CompressionLevel>(compression_level),
+        [](ReadonlyBytes chunk) { return Crypto::Checksum::Adler32(chunk).digest(); },
+        Crypto::Checksum::Adler32::combine));
+    TRY(output_stream.write_value<NetworkOrdered<u32>>(adler32));
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+    TRY(output_stream.read_until_filled(buffer.bytes()));
+    return buffer;
+}
+
 }
@@ -76,9 +76,12 @@ public:
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, ZlibCompressionLevel = ZlibCompressionLevel::Default);
 
+    // Like compress_all(), but compresses chunks of the input on multiple threads, see DeflateCompressor::compress_in_parallel().
+    static ErrorOr<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, size_t thread_count, ZlibCompressionLevel = ZlibCompressionLevel::Default);
+
 private:
     ZlibCompressor(MaybeOwned<Stream> stream, NonnullOwnPtr<Stream> compressor_stream);
-    ErrorOr<void> write_header(ZlibCompressionMethod, ZlibCompressionLevel);
+    static ErrorOr<void> write_header(Stream&, ZlibCompressionMethod, ZlibCompressionLevel);
 
     bool m_finished { false };
     MaybeOwned<Stream> m_output_stream;
@@ -6,6 +6,7 @@
 
 #include "DirectoryEntry.h"
 #include <dirent.h>
+#include <sys/stat.h>
 
 namespace Core {
 
@@ -36,6 +37,25 @@ static DirectoryEntry::Type directory_entry_type_from_posix(unsigned char dt_con
     VERIFY_NOT_REACHED();
 }
 
+DirectoryEntry::Type DirectoryEntry::type_from_stat_mode(mode_t mode)
+{
+    if (S_ISREG(mode))
+        return Type::File;
+    if (S_ISDIR(mode))
+        return Type::Directory;
+    if (S_ISCHR(mode))
+        return Type::CharacterDevice;
+    if (S_ISBLK(mode))
+        return Type::BlockDevice;
+    if (S_ISFIFO(mode))
+        return Type::NamedPipe;
+    if (S_ISLNK(mode))
+        return Type::SymbolicLink;
+    if (S_ISSOCK(mode))
+        return Type::Socket;
+    return Type::Unknown;
+}
+
 DirectoryEntry DirectoryEntry::from_dirent(dirent const& de)
 {
     return DirectoryEntry {
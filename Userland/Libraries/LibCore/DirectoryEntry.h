@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/DeprecatedString.h>
+#include <sys/types.h>
 
 struct dirent;
 
@@ -29,6 +30,7 @@ struct DirectoryEntry {
     DeprecatedString name;
 
     static DirectoryEntry from_dirent(dirent const&);
+    static Type type_from_stat_mode(mode_t);
 };
 
 }
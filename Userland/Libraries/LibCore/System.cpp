@@ -476,6 +476,21 @@ ErrorOr<void> ftruncate(int fd, off_t length)
     return {};
 }
 
+ErrorOr<size_t> copy_file_range(int fd_in, int fd_out, size_t size)
+{
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX) || defined(AK_OS_FREEBSD)
+    auto rc = ::copy_file_range(fd_in, nullptr, fd_out, nullptr, size, 0);
+    if (rc < 0)
+        return Error::from_syscall("copy_file_range"sv, -errno);
+    return static_cast<size_t>(rc);
+#else
+    (void)fd_in;
+    (void)fd_out;
+    (void)size;
+    return Error::from_errno(ENOTSUP);
+#endif
+}
+
 ErrorOr<struct stat> stat(StringView path)
 {
     if (!path.characters_without_null_termination())
@@ -9,6 +9,12 @@
 #include <AK/Types.h>
 #include <LibCrypto/Authentication/GHash.h>
 
+#if AK_IS_ARCH_X86_64() && !defined(KERNEL)
+#    include <AK/CPUFeatures.h>
+#    include <immintrin.h>
+#    define GHASH_HAS_PCLMUL_CODE_PATH
+#endif
+
 namespace {
 
 static u32 to_u32(u8 const* b)
@@ -85,21 +91,68 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
     return digest;
 }
 
+#ifdef GHASH_HAS_PCLMUL_CODE_PATH
+
+// Carry-less multiplication followed by a reduction modulo the bit-reflected GCM polynomial, see
+// Intel's "Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode" (algorithm 5).
+[[gnu::target("pclmul,sse4.1")]] static void galois_multiply_with_pclmul(u32 (&z)[4], const u32 (&x)[4], const u32 (&y)[4])
+{
+    auto a = _mm_set_epi32(x[0], x[1], x[2], x[3]);
+    auto b = _mm_set_epi32(y[0], y[1], y[2], y[3]);
+
+    auto low = _mm_clmulepi64_si128(a, b, 0x00);
+    auto middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    auto high = _mm_clmulepi64_si128(a, b, 0x11);
+    low = _mm_xor_si128(low, _mm_slli_si128(middle, 8));
+    high = _mm_xor_si128(high, _mm_srli_si128(middle, 8));
+
+    // The operands are bit-reflected, so the 256-bit product has to be shifted left by one.
+    auto low_carry = _mm_srli_epi32(low, 31);
+    auto high_carry = _mm_srli_epi32(high, 31);
+    low = _mm_or_si128(_mm_slli_epi32(low, 1), _mm_slli_si128(low_carry, 4));
+    high = _mm_or_si128(_mm_slli_epi32(high, 1), _mm_slli_si128(high_carry, 4));
+    high = _mm_or_si128(high, _mm_srli_si128(low_carry, 12));
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+    auto first = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    auto first_carry = _mm_srli_si128(first, 4);
+    low = _mm_xor_si128(low, _mm_slli_si128(first, 12));
+    auto second = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    second = _mm_xor_si128(second, first_carry);
+    auto result = _mm_xor_si128(high, _mm_xor_si128(low, second));
+
+    z[0] = _mm_extract_epi32(result, 3);
+    z[1] = _mm_extract_epi32(result, 2);
+    z[2] = _mm_extract_epi32(result, 1);
+    z[3] = _mm_extract_epi32(result, 0);
+}
+
+#endif
+
 /// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
 /// Note that x, y, and z are strictly BE.
 void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
 {
+#ifdef GHASH_HAS_PCLMUL_CODE_PATH
+    static bool const has_pclmul = cpu_features().pclmul && cpu_features().sse41;
+    if (has_pclmul) {
+        galois_multiply_with_pclmul(z, _x, _y);
+        return;
+    }
+#endif
+
     u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
     u32 y[4] { _y[0], _y[1], _y[2], _y[3] };
     __builtin_memset(z, 0, sizeof(z));
 
+    // NOTE: This avoids branching on the (secret) operands, so that the running time does not depend on them.
     for (ssize_t i = 127; i > -1; --i) {
-        if ((y[3 - (i / 32)] >> (i % 32)) & 1) {
-            z[0] ^= x[0];
-            z[1] ^= x[1];
-            z[2] ^= x[2];
-            z[3] ^= x[3];
-        }
+        u32 y_bit_mask = 0u - ((y[3 - (i / 32)] >> (i % 32)) & 1);
+        z[0] ^= x[0] & y_bit_mask;
+        z[1] ^= x[1] & y_bit_mask;
+        z[2] ^= x[2] & y_bit_mask;
+        z[3] ^= x[3] & y_bit_mask;
+
         auto a0 = x[0] & 1;
         x[0] >>= 1;
         auto a1 = x[1] & 1;
@@ -112,8 +165,7 @@ void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
         x[3] >>= 1;
         x[3] |= a2 << 31;
 
-        if (a3)
-            x[0] ^= 0xe1000000;
+        x[0] ^= 0xe1000000 & (0u - a3);
     }
 }
 
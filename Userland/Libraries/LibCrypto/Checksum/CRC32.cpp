@@ -5,11 +5,16 @@
  */
 
 #include <AK/Array.h>
+#include <AK/CPUFeatures.h>
 #include <AK/NumericLimits.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
 
+#if AK_IS_ARCH_X86_64()
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Checksum {
 
 #if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
@@ -101,7 +106,7 @@ static constexpr u32 single_byte_crc(u32 crc, u8 byte)
     return (crc >> 8) ^ table[0][(crc & 0xff) ^ byte];
 }
 
-void CRC32::update(ReadonlyBytes data)
+static u32 update_with_tables(u32 state, ReadonlyBytes data)
 {
     // The provided data may not be aligned to a 4-byte boundary, required to reinterpret its address
     // into a u32 in the loop below. So we split the bytes into two segments: the misaligned bytes
@@ -109,16 +114,16 @@ void CRC32::update(ReadonlyBytes data)
     auto [misaligned_data, aligned_data] = split_bytes_for_alignment(data, alignof(u32));
 
     for (auto byte : misaligned_data)
-        m_state = single_byte_crc(m_state, byte);
+        state = single_byte_crc(state, byte);
 
     while (aligned_data.size() >= 8) {
         auto const* segment = reinterpret_cast<u32 const*>(aligned_data.data());
-        auto low = *segment ^ m_state;
+        auto low = *segment ^ state;
         auto high = *(++segment);
 
         // clang-format will put this all on one line, which is really hard to read.
         // clang-format off
-        m_state = table[0][(high >> 24) & 0xff]
+        state = table[0][(high >> 24) & 0xff]
                 ^ table[1][(high >> 16) & 0xff]
                 ^ table[2][(high >> 8) & 0xff]
                 ^ table[3][high & 0xff]
@@ -132,8 +137,10 @@ void CRC32::update(ReadonlyBytes data)
     }
 
     for (auto byte : aligned_data)
-        m_state = single_byte_crc(m_state, byte);
-};
+        state = single_byte_crc(state, byte);
+
+    return state;
+}
 
 #    else
 
@@ -159,16 +166,152 @@ static constexpr auto generate_table()
 
 static constexpr auto table = generate_table();
 
-void CRC32::update(ReadonlyBytes data)
+static u32 update_with_tables(u32 state, ReadonlyBytes data)
 {
     for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+        state = table[(state ^ data.at(i)) & 0xFF] ^ (state >> 8);
     }
-};
+    return state;
+}
 
 #    endif
+
+#    if AK_IS_ARCH_X86_64()
+
+// This folds the data 64 bytes at a time with carry-less multiplications, and reduces the result with a Barrett reduction,
+// as described in Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" white paper.
+// The constants are the bit-reflected ones for the CRC-32 polynomial given at the end of the paper.
+[[gnu::target("pclmul")]] static inline __m128i fold_16_bytes(__m128i accumulator, __m128i next, __m128i constants)
+{
+    auto low = _mm_clmulepi64_si128(accumulator, constants, 0x00);
+    auto high = _mm_clmulepi64_si128(accumulator, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, next), low);
+}
+
+// Requires at least 64 bytes of data, and a multiple of 16 bytes.
+[[gnu::target("pclmul,sse4.1")]] static u32 update_with_pclmul(u32 state, ReadonlyBytes data)
+{
+    VERIFY(data.size() >= 64 && data.size() % 16 == 0);
+
+    alignas(16) static constexpr u64 k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static constexpr u64 k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static constexpr u64 k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static constexpr u64 poly[] = { 0x01db710641, 0x01f7011641 };
+
+    auto const* bytes = reinterpret_cast<__m128i const*>(data.data());
+    auto size = data.size();
+
+    auto x1 = _mm_loadu_si128(bytes + 0);
+    auto x2 = _mm_loadu_si128(bytes + 1);
+    auto x3 = _mm_loadu_si128(bytes + 2);
+    auto x4 = _mm_loadu_si128(bytes + 3);
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(state)));
+    bytes += 4;
+    size -= 64;
+
+    // Fold 64 bytes at a time into the four accumulators.
+    auto x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(k1k2));
+    while (size >= 64) {
+        x1 = fold_16_bytes(x1, _mm_loadu_si128(bytes + 0), x0);
+        x2 = fold_16_bytes(x2, _mm_loadu_si128(bytes + 1), x0);
+        x3 = fold_16_bytes(x3, _mm_loadu_si128(bytes + 2), x0);
+        x4 = fold_16_bytes(x4, _mm_loadu_si128(bytes + 3), x0);
+        bytes += 4;
+        size -= 64;
+    }
+
+    // Fold the accumulators into a single one, then fold any remaining 16 byte blocks into it.
+    x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(k3k4));
+    x1 = fold_16_bytes(x1, x2, x0);
+    x1 = fold_16_bytes(x1, x3, x0);
+    x1 = fold_16_bytes(x1, x4, x0);
+    while (size >= 16) {
+        x1 = fold_16_bytes(x1, _mm_loadu_si128(bytes), x0);
+        bytes += 1;
+        size -= 16;
+    }
+
+    // Fold 128 bits down to 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction down to 32 bits.
+    x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<u32>(_mm_extract_epi32(x1, 1));
+}
+
+#    endif
+
+void CRC32::update(ReadonlyBytes data)
+{
+#    if AK_IS_ARCH_X86_64()
+    static bool const has_pclmul = cpu_features().pclmul && cpu_features().sse41;
+    if (has_pclmul && data.size() >= 64) {
+        auto folded_size = data.size() & ~static_cast<size_t>(15);
+        m_state = update_with_pclmul(m_state, data.trim(folded_size));
+        data = data.slice(folded_size);
+    }
+#    endif
+    m_state = update_with_tables(m_state, data);
+}
+
 #endif
 
+// The combination works by multiplying the first checksum with x^(8 * length2) modulo the CRC polynomial,
+// which is how zlib's crc32_combine() does it since version 1.2.12.
+static constexpr u32 reflected_polynomial = 0xEDB88320;
+
+static constexpr u32 multiply_modulo_polynomial(u32 a, u32 b)
+{
+    u32 mask = 1u << 31;
+    u32 product = 0;
+    while (true) {
+        if (a & mask) {
+            product ^= b;
+            if ((a & (mask - 1)) == 0)
+                break;
+        }
+        mask >>= 1;
+        b = b & 1 ? (b >> 1) ^ reflected_polynomial : b >> 1;
+    }
+    return product;
+}
+
+// x^(2^n) modulo the CRC polynomial, for n = 0..31.
+static constexpr auto powers_of_x_table = [] {
+    Array<u32, 32> table {};
+    u32 power = 1u << 30; // x^1
+    table[0] = power;
+    for (size_t n = 1; n < table.size(); ++n)
+        table[n] = power = multiply_modulo_polynomial(power, power);
+    return table;
+}();
+
+u32 CRC32::combine(u32 first_digest, u32 second_digest, u64 second_length)
+{
+    // Calculate x^(8 * second_length) modulo the CRC polynomial.
+    u32 shift = 1u << 31; // x^0
+    for (size_t k = 3; second_length != 0; second_length >>= 1, ++k) {
+        if (second_length & 1)
+            shift = multiply_modulo_polynomial(powers_of_x_table[k % 32], shift);
+    }
+    return multiply_modulo_polynomial(shift, first_digest) ^ second_digest;
+}
+
 u32 CRC32::digest()
 {
     return ~m_state;
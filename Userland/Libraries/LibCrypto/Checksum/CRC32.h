@@ -29,6 +29,9 @@ public:
     virtual void update(ReadonlyBytes data) override;
     virtual u32 digest() override;
 
+    // Returns the digest of the concatenation of two pieces of data, given their individual digests.
+    static u32 combine(u32 first_digest, u32 second_digest, u64 second_length);
+
 private:
     u32 m_state { ~0u };
 };
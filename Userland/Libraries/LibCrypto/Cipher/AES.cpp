@@ -8,6 +8,12 @@
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if AK_IS_ARCH_X86_64() && !defined(KERNEL)
+#    include <AK/CPUFeatures.h>
+#    include <immintrin.h>
+#    define AES_HAS_AES_NI_CODE_PATH
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -197,8 +203,53 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+#ifdef AES_HAS_AES_NI_CODE_PATH
+
+// The round keys are stored as big-endian words, while the AES instructions expect them in memory order.
+[[gnu::target("ssse3")]] static inline __m128i load_round_key(u32 const* round_key)
+{
+    auto const byte_swap_words = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(round_key)), byte_swap_words);
+}
+
+[[gnu::target("aes,ssse3")]] static void encrypt_block_with_aes_ni(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), load_round_key(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesenc_si128(state, load_round_key(round_keys + 4 * i));
+    state = _mm_aesenclast_si128(state, load_round_key(round_keys + 4 * rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// NOTE: The decryption key schedule already has the inverse mix-column transformation applied to its
+//       middle round keys, which is exactly the form AESDEC expects.
+[[gnu::target("aes,ssse3")]] static void decrypt_block_with_aes_ni(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), load_round_key(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesdec_si128(state, load_round_key(round_keys + 4 * i));
+    state = _mm_aesdeclast_si128(state, load_round_key(round_keys + 4 * rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+static bool has_aes_ni()
+{
+    static bool const has_aes_ni = cpu_features().aes && cpu_features().ssse3;
+    return has_aes_ni;
+}
+
+#endif
+
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#ifdef AES_HAS_AES_NI_CODE_PATH
+    if (has_aes_ni()) {
+        auto const& cipher_key = key();
+        encrypt_block_with_aes_ni(cipher_key.round_keys(), cipher_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +339,14 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#ifdef AES_HAS_AES_NI_CODE_PATH
+    if (has_aes_ni()) {
+        auto const& cipher_key = key();
+        decrypt_block_with_aes_ni(cipher_key.round_keys(), cipher_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
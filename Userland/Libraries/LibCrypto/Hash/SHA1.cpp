@@ -10,6 +10,11 @@
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if AK_IS_ARCH_X86_64()
+#    include <AK/CPUFeatures.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 
 static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
@@ -17,8 +22,76 @@ static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
     return (value << bits) | (value >> (32 - bits));
 }
 
+#if AK_IS_ARCH_X86_64()
+
+// Processes one block using the SHA extensions, following the structure of Intel's reference code.
+[[gnu::target("sha,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[5], u8 const* data)
+{
+    auto const byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(state)), 0x1b);
+    auto e0 = _mm_set_epi32(state[4], 0, 0, 0);
+    auto e1 = _mm_setzero_si128();
+    auto const saved_abcd = abcd;
+    auto const saved_e0 = e0;
+
+    __m128i messages[4];
+    for (size_t i = 0; i < 4; ++i)
+        messages[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i * 16)), byte_swap);
+
+    // Each iteration performs four rounds, while the message schedule is computed a few rounds ahead.
+    for (size_t i = 0; i < 20; ++i) {
+        auto& e = i % 2 == 0 ? e0 : e1;
+        auto& next_e = i % 2 == 0 ? e1 : e0;
+        if (i == 0)
+            e = _mm_add_epi32(e, messages[0]);
+        else
+            e = _mm_sha1nexte_epu32(e, messages[i % 4]);
+        next_e = abcd;
+
+        if (i >= 3 && i <= 18)
+            messages[(i + 1) % 4] = _mm_sha1msg2_epu32(messages[(i + 1) % 4], messages[i % 4]);
+
+        switch (i / 5) {
+        case 0:
+            abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+            break;
+        case 1:
+            abcd = _mm_sha1rnds4_epu32(abcd, e, 1);
+            break;
+        case 2:
+            abcd = _mm_sha1rnds4_epu32(abcd, e, 2);
+            break;
+        default:
+            abcd = _mm_sha1rnds4_epu32(abcd, e, 3);
+            break;
+        }
+
+        if (i >= 1 && i <= 16)
+            messages[(i + 3) % 4] = _mm_sha1msg1_epu32(messages[(i + 3) % 4], messages[i % 4]);
+        if (i >= 2 && i <= 17)
+            messages[(i + 2) % 4] = _mm_xor_si128(messages[(i + 2) % 4], messages[i % 4]);
+    }
+
+    e0 = _mm_sha1nexte_epu32(e0, saved_e0);
+    abcd = _mm_add_epi32(abcd, saved_abcd);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = _mm_extract_epi32(e0, 3);
+}
+
+#endif
+
 inline void SHA1::transform(u8 const* data)
 {
+#if AK_IS_ARCH_X86_64()
+    static bool const has_sha_ni = cpu_features().sha && cpu_features().sse41;
+    if (has_sha_ni) {
+        transform_with_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 blocks[80];
     for (size_t i = 0; i < 16; ++i)
         blocks[i] = AK::convert_between_host_and_network_endian(((u32 const*)data)[i]);
@@ -8,6 +8,12 @@
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#if AK_IS_ARCH_X86_64() && !defined(KERNEL)
+#    include <AK/CPUFeatures.h>
+#    include <immintrin.h>
+#    define SHA256_HAS_SHA_NI_CODE_PATH
+#endif
+
 namespace Crypto::Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
 constexpr static auto CH(u32 x, u32 y, u32 z) { return (x & y) ^ (z & ~x); }
@@ -25,8 +31,63 @@ constexpr static auto EP1(u64 x) { return ROTRIGHT(x, 14) ^ ROTRIGHT(x, 18) ^ RO
 constexpr static auto SIGN0(u64 x) { return ROTRIGHT(x, 1) ^ ROTRIGHT(x, 8) ^ (x >> 7); }
 constexpr static auto SIGN1(u64 x) { return ROTRIGHT(x, 19) ^ ROTRIGHT(x, 61) ^ (x >> 6); }
 
+#ifdef SHA256_HAS_SHA_NI_CODE_PATH
+
+// Processes one block using the SHA extensions, following the structure of Intel's reference code.
+[[gnu::target("sha,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[8], u8 const* data)
+{
+    auto const byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions operate on the state in the order ABEF and CDGH.
+    auto cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0])), 0xb1);
+    auto efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4])), 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+    auto const saved_abef = abef;
+    auto const saved_cdgh = cdgh;
+
+    __m128i messages[4];
+    for (size_t i = 0; i < 4; ++i)
+        messages[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i * 16)), byte_swap);
+
+    // Each iteration performs four rounds, while the message schedule is computed a few rounds ahead.
+    for (size_t i = 0; i < 16; ++i) {
+        auto message = _mm_add_epi32(messages[i % 4], _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[i * 4])));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+
+        if (i >= 3 && i <= 14) {
+            auto& next = messages[(i + 1) % 4];
+            next = _mm_add_epi32(next, _mm_alignr_epi8(messages[i % 4], messages[(i + 3) % 4], 4));
+            next = _mm_sha256msg2_epu32(next, messages[i % 4]);
+        }
+
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0e));
+
+        if (i >= 1 && i <= 12)
+            messages[(i + 3) % 4] = _mm_sha256msg1_epu32(messages[(i + 3) % 4], messages[i % 4]);
+    }
+
+    abef = _mm_add_epi32(abef, saved_abef);
+    cdgh = _mm_add_epi32(cdgh, saved_cdgh);
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif
+
 inline void SHA256::transform(u8 const* data)
 {
+#ifdef SHA256_HAS_SHA_NI_CODE_PATH
+    static bool const has_sha_ni = cpu_features().sha && cpu_features().sse41;
+    if (has_sha_ni) {
+        transform_with_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 m[64];
 
     size_t i = 0;
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2018-2021, Andreas Kling <kling@serenityos.org>
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "NameserverQuery.h"
+#include "Packet.h"
+#include <AK/Debug.h>
+#include <AK/IPv4Address.h>
+#include <AK/IPv6Address.h>
+#include <AK/Random.h>
+#include <AK/ScopeGuard.h>
+#include <LibCore/System.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+
+namespace DNS {
+
+static constexpr u16 s_default_nameserver_port = 53;
+static constexpr Time s_resend_interval = Time::from_seconds(1);
+
+namespace {
+
+struct NameserverAddress {
+    sockaddr_storage address {};
+    socklen_t address_length { 0 };
+};
+
+struct UpstreamQuery {
+    DeprecatedString nameserver;
+    int fd { -1 };
+    Packet request;
+    ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+    bool is_done { false };
+};
+
+}
+
+static Optional<NameserverAddress> parse_nameserver(StringView nameserver)
+{
+    auto host = nameserver;
+    u16 port = s_default_nameserver_port;
+
+    auto parse_port = [&](StringView port_string) {
+        auto maybe_port = port_string.to_uint<u16>();
+        if (!maybe_port.has_value() || maybe_port.value() == 0)
+            return false;
+        port = maybe_port.value();
+        return true;
+    };
+
+    if (host.starts_with('[')) {
+        // "[address]" or "[address]:port", for IPv6 addresses with a port.
+        auto closing_bracket = host.find(']');
+        if (!closing_bracket.has_value())
+            return {};
+        auto rest = host.substring_view(closing_bracket.value() + 1);
+        host = host.substring_view(1, closing_bracket.value() - 1);
+        if (!rest.is_empty() && (!rest.starts_with(':') || !parse_port(rest.substring_view(1))))
+            return {};
+    } else if (auto colon = host.find(':'); colon.has_value() && host.find_last(':') == colon) {
+        // A single colon can only separate an IPv4 address from its port.
+        if (!parse_port(host.substring_view(colon.value() + 1)))
+            return {};
+        host = host.substring_view(0, colon.value());
+    }
+
+    NameserverAddress result;
+    if (auto address = IPv4Address::from_string(host); address.has_value()) {
+        auto& address_in = *reinterpret_cast<sockaddr_in*>(&result.address);
+        address_in.sin_family = AF_INET;
+        address_in.sin_port = htons(port);
+        address_in.sin_addr.s_addr = address->to_in_addr_t();
+        result.address_length = sizeof(sockaddr_in);
+        return result;
+    }
+    if (auto address = IPv6Address::from_string(host); address.has_value()) {
+        auto& address_in6 = *reinterpret_cast<sockaddr_in6*>(&result.address);
+        address_in6.sin6_family = AF_INET6;
+        address_in6.sin6_port = htons(port);
+        memcpy(&address_in6.sin6_addr, address->to_in6_addr_t(), sizeof(address_in6.sin6_addr));
+        result.address_length = sizeof(sockaddr_in6);
+        return result;
+    }
+    return {};
+}
+
+static ErrorOr<void> send_query(UpstreamQuery& query, Name const& name, RecordType record_type)
+{
+    query.request = {};
+    query.request.set_is_query();
+    query.request.set_id(get_random_uniform(UINT16_MAX));
+    Name name_in_question = name;
+    if (query.should_randomize_case == ShouldRandomizeCase::Yes)
+        name_in_question.randomize_case();
+    query.request.add_question({ name_in_question, record_type, RecordClass::IN, false });
+
+    auto buffer = TRY(query.request.to_byte_buffer());
+    TRY(Core::System::send(query.fd, buffer.data(), buffer.size(), 0));
+    return {};
+}
+
+static ErrorOr<void> resend_query(UpstreamQuery& query)
+{
+    auto buffer = TRY(query.request.to_byte_buffer());
+    TRY(Core::System::send(query.fd, buffer.data(), buffer.size(), 0));
+    return {};
+}
+
+static bool response_matches_request(Packet const& request, Packet const& response)
+{
+    if (response.question_count() != request.question_count()) {
+        dbgln("DNS: Question count ({} vs {}) :(", response.question_count(), request.question_count());
+        return false;
+    }
+
+    // Verify the questions in our request and in their response match, ignoring case.
+    for (size_t i = 0; i < request.question_count(); ++i) {
+        auto& request_question = request.questions()[i];
+        auto& response_question = response.questions()[i];
+        bool match = request_question.class_code() == response_question.class_code()
+            && request_question.record_type() == response_question.record_type()
+            && request_question.name().as_string().equals_ignoring_ascii_case(response_question.name().as_string());
+        if (!match) {
+            dbgln("Request and response questions do not match");
+            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            return false;
+        }
+    }
+    return true;
+}
+
+ErrorOr<NameserverQueryResult> query_nameservers(Name const& name, RecordType record_type, ReadonlySpan<DeprecatedString> nameservers, Time timeout)
+{
+    Vector<UpstreamQuery> queries;
+    ScopeGuard close_sockets = [&] {
+        for (auto& query : queries)
+            (void)Core::System::close(query.fd);
+    };
+
+    for (auto& nameserver : nameservers) {
+        auto address = parse_nameserver(nameserver);
+        if (!address.has_value()) {
+            dbgln("DNS: Invalid nameserver address '{}'", nameserver);
+            continue;
+        }
+
+        // NOTE: A nameserver we can't even open a socket for (e.g. an IPv6 one on a host without IPv6) is skipped, the others may still answer.
+        auto fd_or_error = Core::System::socket(address->address.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_or_error.is_error()) {
+            dbgln("DNS: Failed to create a socket for nameserver '{}': {}", nameserver, fd_or_error.error());
+            continue;
+        }
+        queries.append({ nameserver, fd_or_error.value(), {}, ShouldRandomizeCase::Yes, false });
+        auto& query = queries.last();
+
+        auto result = Core::System::connect(query.fd, reinterpret_cast<sockaddr const*>(&address->address), address->address_length);
+        if (!result.is_error())
+            result = send_query(query, name, record_type);
+        if (result.is_error()) {
+            dbgln("DNS: Failed to query nameserver '{}': {}", nameserver, result.error());
+            query.is_done = true;
+        }
+    }
+
+    NameserverQueryResult result;
+    bool got_any_response = false;
+
+    // NOTE: Only the clock decides when we give up, so a stream of unrelated or malformed packets can't keep us waiting.
+    auto const deadline = Time::now_monotonic() + timeout;
+    auto next_resend = Time::now_monotonic() + s_resend_interval;
+    Vector<pollfd> poll_fds;
+    Vector<UpstreamQuery*> polled_queries;
+    for (;;) {
+        poll_fds.clear_with_capacity();
+        polled_queries.clear_with_capacity();
+        for (auto& query : queries) {
+            if (query.is_done)
+                continue;
+            poll_fds.append({ query.fd, POLLIN, 0 });
+            polled_queries.append(&query);
+        }
+        if (poll_fds.is_empty())
+            break;
+
+        auto now = Time::now_monotonic();
+        if (now >= deadline)
+            break;
+        if (now >= next_resend) {
+            // Ask the nameservers that haven't responded yet again.
+            for (auto* query : polled_queries) {
+                if (resend_query(*query).is_error())
+                    query->is_done = true;
+            }
+            next_resend = now + s_resend_interval;
+            continue;
+        }
+
+        auto wait_time = min(deadline, next_resend) - now;
+        // Round up, so we don't spin on a sub-millisecond remainder.
+        auto rc = TRY(Core::System::poll(poll_fds, static_cast<int>(wait_time.to_milliseconds()) + 1));
+        if (rc == 0)
+            continue;
+
+        for (size_t i = 0; i < poll_fds.size(); ++i) {
+            if (poll_fds[i].revents == 0)
+                continue;
+            auto& query = *polled_queries[i];
+
+            u8 response_buffer[4096];
+            auto nrecv_or_error = Core::System::recv(query.fd, response_buffer, sizeof(response_buffer), 0);
+            if (nrecv_or_error.is_error()) {
+                dbgln("Never got a response from '{}': {}", query.nameserver, nrecv_or_error.error());
+                query.is_done = true;
+                continue;
+            }
+
+            auto o_response = Packet::from_raw_packet(response_buffer, nrecv_or_error.value());
+            if (!o_response.has_value())
+                continue;
+            auto& response = o_response.value();
+
+            if (response.id() != query.request.id()) {
+                dbgln("DNS: ID mismatch ({} vs {}) :(", response.id(), query.request.id());
+                continue;
+            }
+
+            got_any_response = true;
+
+            if (response.code() == Packet::Code::REFUSED) {
+                if (query.should_randomize_case == ShouldRandomizeCase::Yes) {
+                    // Retry with 0x20 case randomization turned off.
+                    query.should_randomize_case = ShouldRandomizeCase::No;
+                    if (!send_query(query, name, record_type).is_error())
+                        continue;
+                }
+                query.is_done = true;
+                continue;
+            }
+
+            query.is_done = true;
+            if (!response_matches_request(query.request, response))
+                continue;
+
+            if (response.code() == Packet::Code::NXDOMAIN) {
+                dbgln_if(LOOKUPSERVER_DEBUG, "'{}' says that '{}' does not exist", query.nameserver, name.as_string());
+                result.outcome = NameserverQueryResult::Outcome::NameDoesNotExist;
+                result.answers.clear();
+                result.negative_ttl = response.negative_caching_ttl();
+                return result;
+            }
+
+            if (response.code() != Packet::Code::NOERROR)
+                continue;
+
+            for (auto& answer : response.answers()) {
+                TRY(result.records.try_append(answer));
+                if (answer.type() == record_type)
+                    TRY(result.answers.try_append(answer));
+            }
+            if (!result.answers.is_empty()) {
+                result.outcome = NameserverQueryResult::Outcome::Answered;
+                result.negative_ttl = {};
+                return result;
+            }
+
+            dbgln("Received response from '{}' but no result(s), trying next nameserver", query.nameserver);
+            result.outcome = NameserverQueryResult::Outcome::NoAnswers;
+            if (auto ttl = response.negative_caching_ttl(); ttl.has_value())
+                result.negative_ttl = result.negative_ttl.has_value() ? min(result.negative_ttl.value(), ttl.value()) : ttl.value();
+        }
+    }
+
+    if (!got_any_response)
+        dbgln("Tried all nameservers but never got a response :(");
+    return result;
+}
+
+}
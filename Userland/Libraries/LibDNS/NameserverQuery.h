@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "Answer.h"
+#include "Name.h"
+#include <AK/DeprecatedString.h>
+#include <AK/Error.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+
+namespace DNS {
+
+struct NameserverQueryResult {
+    enum class Outcome {
+        Answered,
+        NameDoesNotExist,
+        NoAnswers,
+        NoResponse,
+    };
+
+    Outcome outcome { Outcome::NoResponse };
+    // The records of the requested type.
+    Vector<Answer> answers;
+    // Every record the nameservers sent back, including the ones of other types (e.g. CNAMEs), for the caller to cache.
+    Vector<Answer> records;
+    // How long the absence of the name (or of records of the requested type) may be cached, if the nameservers said.
+    Optional<u32> negative_ttl;
+};
+
+// Asks all nameservers at once and goes with the first useful response, resending to the silent ones every second.
+// Nameservers are IPv4 or IPv6 addresses, optionally with a port ("1.1.1.1", "127.0.0.1:5353", "::1", "[::1]:5353").
+// This blocks for at most `timeout`, no matter how many unrelated or malformed packets arrive in the meantime.
+ErrorOr<NameserverQueryResult> query_nameservers(Name const&, RecordType, ReadonlySpan<DeprecatedString> nameservers, Time timeout = Time::from_seconds(3));
+
+}
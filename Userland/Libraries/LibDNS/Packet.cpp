@@ -29,6 +29,46 @@ void Packet::add_answer(Answer const& answer)
     VERIFY(m_answers.size() <= UINT16_MAX);
 }
 
+void Packet::add_authority(Answer const& authority)
+{
+    m_authorities.empend(authority);
+
+    VERIFY(m_authorities.size() <= UINT16_MAX);
+}
+
+Optional<u32> Packet::negative_caching_ttl() const
+{
+    for (auto& authority : m_authorities) {
+        if (authority.type() != RecordType::SOA)
+            continue;
+        // The SOA MINIMUM field is the last 32-bit field of the record data.
+        auto& data = authority.record_data();
+        if (data.length() < 20)
+            continue;
+        auto const* minimum_bytes = reinterpret_cast<u8 const*>(data.characters()) + data.length() - 4;
+        u32 minimum = (minimum_bytes[0] << 24) | (minimum_bytes[1] << 16) | (minimum_bytes[2] << 8) | minimum_bytes[3];
+        return min(authority.ttl(), minimum);
+    }
+    return {};
+}
+
+static ErrorOr<void> write_record(Stream& stream, Answer const& answer)
+{
+    TRY(stream.write_value(answer.name()));
+    TRY(stream.write_value(htons((u16)answer.type())));
+    TRY(stream.write_value(htons(answer.raw_class_code())));
+    TRY(stream.write_value(htonl(answer.ttl())));
+    if (answer.type() == RecordType::PTR) {
+        Name name { answer.record_data() };
+        TRY(stream.write_value(htons(name.serialized_size())));
+        TRY(stream.write_value(name));
+    } else {
+        TRY(stream.write_value(htons(answer.record_data().length())));
+        TRY(stream.write_until_depleted(answer.record_data().bytes()));
+    }
+    return {};
+}
+
 ErrorOr<ByteBuffer> Packet::to_byte_buffer() const
 {
     PacketHeader header;
@@ -47,6 +87,7 @@ ErrorOr<ByteBuffer> Packet::to_byte_buffer() const
     header.set_recursion_available(m_recursion_available);
     header.set_question_count(m_questions.size());
     header.set_answer_count(m_answers.size());
+    header.set_authority_count(m_authorities.size());
 
     AllocatingMemoryStream stream;
 
@@ -56,20 +97,10 @@ ErrorOr<ByteBuffer> Packet::to_byte_buffer() const
         TRY(stream.write_value(htons((u16)question.record_type())));
         TRY(stream.write_value(htons(question.raw_class_code())));
     }
-    for (auto& answer : m_answers) {
-        TRY(stream.write_value(answer.name()));
-        TRY(stream.write_value(htons((u16)answer.type())));
-        TRY(stream.write_value(htons(answer.raw_class_code())));
-        TRY(stream.write_value(htonl(answer.ttl())));
-        if (answer.type() == RecordType::PTR) {
-            Name name { answer.record_data() };
-            TRY(stream.write_value(htons(name.serialized_size())));
-            TRY(stream.write_value(name));
-        } else {
-            TRY(stream.write_value(htons(answer.record_data().length())));
-            TRY(stream.write_until_depleted(answer.record_data().bytes()));
-        }
-    }
+    for (auto& answer : m_answers)
+        TRY(write_record(stream, answer));
+    for (auto& authority : m_authorities)
+        TRY(write_record(stream, authority));
 
     auto buffer = TRY(ByteBuffer::create_uninitialized(stream.used_buffer_size()));
     TRY(stream.read_until_filled(buffer));
@@ -97,6 +128,75 @@ private:
 
 static_assert(sizeof(DNSRecordWithoutName) == 10);
 
+static DeprecatedString parse_soa_record_data(u8 const* raw_data, size_t offset, size_t raw_size)
+{
+    // Store the record data uncompressed, so that it stays meaningful outside of this packet.
+    auto mname = Name::parse(raw_data, offset, raw_size);
+    auto rname = Name::parse(raw_data, offset, raw_size);
+    // SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM.
+    constexpr size_t fixed_fields_size = 5 * sizeof(u32);
+    if (offset + fixed_fields_size > raw_size)
+        return {};
+
+    AllocatingMemoryStream stream;
+    if (stream.write_value(mname).is_error()
+        || stream.write_value(rname).is_error()
+        || stream.write_until_depleted({ raw_data + offset, fixed_fields_size }).is_error())
+        return {};
+
+    auto buffer_or_error = ByteBuffer::create_uninitialized(stream.used_buffer_size());
+    if (buffer_or_error.is_error() || stream.read_until_filled(buffer_or_error.value()).is_error())
+        return {};
+    return DeprecatedString { buffer_or_error.value().bytes() };
+}
+
+static ErrorOr<Answer> parse_record(u8 const* raw_data, size_t& offset, size_t raw_size)
+{
+    auto name = Name::parse(raw_data, offset, raw_size);
+
+    if (offset + sizeof(DNSRecordWithoutName) > raw_size)
+        return Error::from_string_literal("DNS record header runs past the end of the packet");
+    auto& record = *(DNSRecordWithoutName const*)(&raw_data[offset]);
+    offset += sizeof(DNSRecordWithoutName);
+
+    if (offset + record.data_length() > raw_size)
+        return Error::from_string_literal("DNS record data runs past the end of the packet");
+    // Names in the record data may point anywhere in the packet, but must not be read past the end of the record.
+    size_t const record_end = offset + record.data_length();
+
+    DeprecatedString data;
+
+    switch ((RecordType)record.type()) {
+    case RecordType::PTR: {
+        size_t dummy_offset = offset;
+        data = Name::parse(raw_data, dummy_offset, record_end).as_string();
+        break;
+    }
+    case RecordType::SOA:
+        data = parse_soa_record_data(raw_data, offset, record_end);
+        break;
+    case RecordType::CNAME:
+        // Fall through
+    case RecordType::A:
+        // Fall through
+    case RecordType::TXT:
+        // Fall through
+    case RecordType::AAAA:
+        // Fall through
+    case RecordType::SRV:
+        data = { record.data(), record.data_length() };
+        break;
+    default:
+        // FIXME: Parse some other record types perhaps?
+        dbgln("data=(unimplemented record type {})", (u16)record.type());
+    }
+
+    u16 class_code = record.record_class() & ~MDNS_CACHE_FLUSH;
+    bool mdns_cache_flush = record.record_class() & MDNS_CACHE_FLUSH;
+    offset = record_end;
+    return Answer { name, (RecordType)record.type(), (RecordClass)class_code, record.ttl(), data, mdns_cache_flush };
+}
+
 Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
 {
     if (raw_size < sizeof(PacketHeader)) {
@@ -116,8 +216,9 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
 
-    // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    // NOTE: NXDOMAIN responses carry the SOA record needed for negative caching in their authority section.
+    // FIXME: Should we parse further in the other cases?
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(PacketHeader);
@@ -128,6 +229,10 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
             NetworkOrdered<u16> record_type;
             NetworkOrdered<u16> class_code;
         };
+        if (offset + sizeof(RawDNSAnswerQuestion) > raw_size) {
+            dbgln("DNS packet ends in the middle of question #{}", i);
+            return {};
+        }
         auto& record_and_class = *(RawDNSAnswerQuestion const*)&raw_data[offset];
         u16 class_code = record_and_class.class_code & ~MDNS_WANTS_UNICAST_RESPONSE;
         bool mdns_wants_unicast_response = record_and_class.class_code & MDNS_WANTS_UNICAST_RESPONSE;
@@ -138,41 +243,25 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
     }
 
     for (u16 i = 0; i < header.answer_count(); ++i) {
-        auto name = Name::parse(raw_data, offset, raw_size);
-
-        auto& record = *(DNSRecordWithoutName const*)(&raw_data[offset]);
-
-        DeprecatedString data;
-
-        offset += sizeof(DNSRecordWithoutName);
-
-        switch ((RecordType)record.type()) {
-        case RecordType::PTR: {
-            size_t dummy_offset = offset;
-            data = Name::parse(raw_data, dummy_offset, raw_size).as_string();
-            break;
-        }
-        case RecordType::CNAME:
-            // Fall through
-        case RecordType::A:
-            // Fall through
-        case RecordType::TXT:
-            // Fall through
-        case RecordType::AAAA:
-            // Fall through
-        case RecordType::SRV:
-            data = { record.data(), record.data_length() };
-            break;
-        default:
-            // FIXME: Parse some other record types perhaps?
-            dbgln("data=(unimplemented record type {})", (u16)record.type());
+        auto answer_or_error = parse_record(raw_data, offset, raw_size);
+        if (answer_or_error.is_error()) {
+            dbgln("Can't parse answer #{}: {}", i, answer_or_error.error());
+            return {};
         }
+        auto answer = answer_or_error.release_value();
+        dbgln_if(LOOKUPSERVER_DEBUG, "Answer   #{}: name=_{}_, type={}, ttl={}, data=_{}_", i, answer.name(), answer.type(), answer.ttl(), answer.record_data());
+        packet.m_answers.append(move(answer));
+    }
 
-        dbgln_if(LOOKUPSERVER_DEBUG, "Answer   #{}: name=_{}_, type={}, ttl={}, length={}, data=_{}_", i, name, record.type(), record.ttl(), record.data_length(), data);
-        u16 class_code = record.record_class() & ~MDNS_CACHE_FLUSH;
-        bool mdns_cache_flush = record.record_class() & MDNS_CACHE_FLUSH;
-        packet.m_answers.empend(name, (RecordType)record.type(), (RecordClass)class_code, record.ttl(), data, mdns_cache_flush);
-        offset += record.data_length();
+    for (u16 i = 0; i < header.authority_count(); ++i) {
+        auto authority_or_error = parse_record(raw_data, offset, raw_size);
+        if (authority_or_error.is_error()) {
+            dbgln("Can't parse authority #{}: {}", i, authority_or_error.error());
+            return {};
+        }
+        auto authority = authority_or_error.release_value();
+        dbgln_if(LOOKUPSERVER_DEBUG, "Authority #{}: name=_{}_, type={}, ttl={}", i, authority.name(), authority.type(), authority.ttl());
+        packet.m_authorities.append(move(authority));
     }
 
     return packet;
@@ -43,6 +43,7 @@ public:
 
     Vector<Question> const& questions() const { return m_questions; }
     Vector<Answer> const& answers() const { return m_answers; }
+    Vector<Answer> const& authorities() const { return m_authorities; }
 
     u16 question_count() const
     {
@@ -56,8 +57,19 @@ public:
         return m_answers.size();
     }
 
+    u16 authority_count() const
+    {
+        VERIFY(m_authorities.size() <= UINT16_MAX);
+        return m_authorities.size();
+    }
+
     void add_question(Question const&);
     void add_answer(Answer const&);
+    void add_authority(Answer const&);
+
+    // The TTL for caching a negative (NXDOMAIN or NODATA) response, as per RFC 2308 section 5.
+    // Negative responses without an SOA record in the authority section must not be cached.
+    Optional<u32> negative_caching_ttl() const;
 
     enum class Code : u8 {
         NOERROR = 0,
@@ -84,6 +96,7 @@ private:
     bool m_recursion_available { true };
     Vector<Question> m_questions;
     Vector<Answer> m_answers;
+    Vector<Answer> m_authorities;
 };
 
 }
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Queue.h>
+#include <AK/StringBuilder.h>
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/DirectoryWalker.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+#include <errno.h>
+
+namespace FileSystem {
+
+// Directories that have been read but not delivered yet hold on to all of their entries, so the worker threads stop
+// reading ahead once there are this many of them.
+static constexpr size_t max_directories_read_ahead = 1024;
+
+static DeprecatedString join_path(DeprecatedString const& directory_path, DeprecatedString const& name)
+{
+    StringBuilder builder;
+    builder.append(directory_path);
+    if (!directory_path.ends_with('/'))
+        builder.append('/');
+    builder.append(name);
+    return builder.to_deprecated_string();
+}
+
+class DirectoryWalker::Walk {
+public:
+    explicit Walk(DirectoryWalker const& walker)
+        : m_walker(walker)
+    {
+    }
+
+    ErrorOr<void> run(DeprecatedString const& root_path)
+    {
+        auto root = make_entry(root_path, Core::DirectoryEntry::Type::Unknown, 0);
+        if (root.is_error())
+            return deliver_error(root_path, root.release_error());
+        TRY(m_walker.on_entry(root.value()));
+        if (root.value().type != Core::DirectoryEntry::Type::Directory)
+            return {};
+
+        // Without workers, a depth-first walk simply reads each directory when it gets to it.
+        m_uses_queue = m_walker.m_thread_count > 1 || m_walker.m_order == Order::Unordered;
+
+        auto root_directory = make_ref_counted<Directory>(root_path, 1, nullptr, root.value().stat);
+        m_directories_pending = 1;
+        if (m_uses_queue)
+            m_queue.append(root_directory);
+
+        Vector<NonnullRefPtr<Threading::Thread>> threads;
+        if (m_walker.m_thread_count > 1) {
+            for (size_t i = 0; i < m_walker.m_thread_count; ++i)
+                TRY(threads.try_append(TRY(Threading::Thread::try_create([this] { return read_queued_directories(); }, "FileSystem walk"sv))));
+            for (auto& thread : threads)
+                thread->start();
+        }
+
+        auto result = m_walker.m_order == Order::DepthFirst
+            ? deliver_depth_first(*root_directory)
+            : deliver_unordered();
+
+        {
+            Threading::MutexLocker locker(m_mutex);
+            m_stopping = true;
+            m_condition.broadcast();
+        }
+        for (auto& thread : threads)
+            (void)thread->join();
+
+        return result;
+    }
+
+private:
+    struct Failure {
+        DeprecatedString path;
+        Error error;
+    };
+
+    struct Directory : public AtomicRefCounted<Directory> {
+        enum class State {
+            Queued,
+            Reading,
+            Read,
+        };
+
+        Directory(DeprecatedString path, size_t depth, RefPtr<Directory const> parent, Optional<struct stat> const& stat)
+            : path(move(path))
+            , depth(depth)
+            , parent(move(parent))
+        {
+            if (stat.has_value())
+                identity = Identity { stat->st_dev, stat->st_ino };
+        }
+
+        struct Identity {
+            dev_t device;
+            ino_t inode;
+        };
+
+        // Whether this directory or one of the directories above it is the directory with the given stat.
+        bool is_or_is_inside(struct stat const& stat) const
+        {
+            for (auto const* directory = this; directory; directory = directory->parent.ptr()) {
+                if (directory->identity.has_value() && directory->identity->device == stat.st_dev && directory->identity->inode == stat.st_ino)
+                    return true;
+            }
+            return false;
+        }
+
+        struct Item {
+            Variant<Entry, Failure> value;
+            RefPtr<Directory> subdirectory;
+        };
+
+        DeprecatedString path;
+        // The depth of the directory's entries.
+        size_t depth { 0 };
+        RefPtr<Directory const> parent;
+        // Only known when following symlinks, which is the only way to walk into a directory again.
+        Optional<Identity> identity;
+        State state { State::Queued };
+        Vector<Item> items;
+    };
+
+    ErrorOr<Entry> make_entry(DeprecatedString path, Core::DirectoryEntry::Type type, size_t depth) const
+    {
+        Entry entry { move(path), type, depth, {} };
+
+        bool follow_symlinks = m_walker.m_follow_symlinks == FollowSymlinks::Yes;
+        // When following symlinks, directories are stat'ed as well, to recognize them when a symlink leads back to them.
+        bool needs_stat = m_walker.m_stat_entries == StatEntries::Always
+            || type == Core::DirectoryEntry::Type::Unknown
+            || (type == Core::DirectoryEntry::Type::SymbolicLink && follow_symlinks)
+            || (type == Core::DirectoryEntry::Type::Directory && follow_symlinks);
+        if (!needs_stat)
+            return entry;
+
+        auto stat = follow_symlinks ? Core::System::stat(entry.path) : Core::System::lstat(entry.path);
+        // A dangling symlink cannot be followed, so report the link itself.
+        if (stat.is_error() && follow_symlinks)
+            stat = Core::System::lstat(entry.path);
+        entry.stat = TRY(stat);
+        entry.type = Core::DirectoryEntry::type_from_stat_mode(entry.stat->st_mode);
+        return entry;
+    }
+
+    // This only touches the directory itself, so it doesn't need the lock.
+    void read_directory(Directory& directory) const
+    {
+        Core::DirIterator iterator(directory.path, m_walker.m_iterator_flags);
+        if (iterator.has_error()) {
+            // The directory was replaced by something else since its parent was read.
+            if (iterator.error().code() != ENOTDIR)
+                directory.items.append({ Failure { directory.path, iterator.error() }, {} });
+            return;
+        }
+
+        while (true) {
+            auto directory_entry = iterator.next();
+            if (!directory_entry.has_value())
+                break;
+
+            auto path = join_path(directory.path, directory_entry->name);
+            auto entry = make_entry(path, directory_entry->type, directory.depth);
+            if (entry.is_error()) {
+                directory.items.append({ Failure { move(path), entry.release_error() }, {} });
+                continue;
+            }
+
+            RefPtr<Directory> subdirectory;
+            if (entry.value().type == Core::DirectoryEntry::Type::Directory) {
+                // A symlink to the directory itself or one above it would have us walk in circles forever.
+                if (entry.value().stat.has_value() && directory.is_or_is_inside(*entry.value().stat)) {
+                    directory.items.append({ Failure { move(path), Error::from_errno(ELOOP) }, {} });
+                    continue;
+                }
+                subdirectory = make_ref_counted<Directory>(move(path), directory.depth + 1, directory, entry.value().stat);
+            }
+            directory.items.append({ entry.release_value(), move(subdirectory) });
+        }
+
+        // DirIterator also records running out of entries as an error, with an errno of 0.
+        if (iterator.has_error() && iterator.error().code() != 0)
+            directory.items.append({ Failure { directory.path, iterator.error() }, {} });
+    }
+
+    // Must be called with the lock held.
+    void finish_reading(Directory& directory)
+    {
+        directory.state = Directory::State::Read;
+        ++m_directories_read_ahead;
+
+        for (auto const& item : directory.items) {
+            if (item.subdirectory)
+                ++m_directories_pending;
+        }
+
+        if (m_uses_queue) {
+            // The queue is used as a stack, so push the subdirectories in reverse to have them read in order.
+            for (size_t i = directory.items.size(); i > 0; --i) {
+                if (auto& subdirectory = directory.items[i - 1].subdirectory)
+                    m_queue.append(*subdirectory);
+            }
+        }
+
+        if (m_walker.m_order == Order::Unordered)
+            m_read_directories.enqueue(directory);
+
+        m_condition.broadcast();
+    }
+
+    // Must be called with the lock held.
+    void finish_delivering(Directory& directory)
+    {
+        --m_directories_read_ahead;
+        --m_directories_pending;
+        directory.items.clear();
+        m_condition.broadcast();
+    }
+
+    // Must be called with the lock held, which is released while reading.
+    void read_claimed_directory(Threading::MutexLocker& locker, Directory& directory)
+    {
+        directory.state = Directory::State::Reading;
+        locker.unlock();
+        read_directory(directory);
+        locker.lock();
+        finish_reading(directory);
+    }
+
+    intptr_t read_queued_directories()
+    {
+        Threading::MutexLocker locker(m_mutex);
+        while (true) {
+            while (!m_stopping && (m_queue.is_empty() || m_directories_read_ahead >= max_directories_read_ahead))
+                m_condition.wait();
+            if (m_stopping)
+                return 0;
+
+            // The delivering thread may have read this directory itself already.
+            auto directory = m_queue.take_last();
+            if (directory->state == Directory::State::Queued)
+                read_claimed_directory(locker, directory);
+        }
+    }
+
+    ErrorOr<void> deliver_error(DeprecatedString const& path, Error error) const
+    {
+        if (!m_walker.on_error)
+            return {};
+        return m_walker.on_error(path, move(error));
+    }
+
+    ErrorOr<void> deliver_items(Directory& directory, bool recurse)
+    {
+        for (auto& item : directory.items) {
+            if (item.value.has<Failure>()) {
+                auto& failure = item.value.get<Failure>();
+                TRY(deliver_error(failure.path, move(failure.error)));
+                continue;
+            }
+
+            TRY(m_walker.on_entry(item.value.get<Entry>()));
+            if (recurse && item.subdirectory)
+                TRY(deliver_depth_first(*item.subdirectory));
+        }
+        return {};
+    }
+
+    ErrorOr<void> deliver_depth_first(Directory& directory)
+    {
+        {
+            Threading::MutexLocker locker(m_mutex);
+            // Rather than waiting for a worker to get to the directory, read it right away.
+            if (directory.state == Directory::State::Queued)
+                read_claimed_directory(locker, directory);
+            while (directory.state != Directory::State::Read)
+                m_condition.wait();
+        }
+
+        TRY(deliver_items(directory, true));
+
+        Threading::MutexLocker locker(m_mutex);
+        finish_delivering(directory);
+        return {};
+    }
+
+    ErrorOr<void> deliver_unordered()
+    {
+        while (true) {
+            RefPtr<Directory> directory;
+            {
+                Threading::MutexLocker locker(m_mutex);
+                while (m_read_directories.is_empty()) {
+                    if (m_directories_pending == 0)
+                        return {};
+                    if (m_queue.is_empty()) {
+                        m_condition.wait();
+                        continue;
+                    }
+                    // Nothing is ready yet, so help out by reading the next directory.
+                    auto next_directory = m_queue.take_last();
+                    if (next_directory->state == Directory::State::Queued)
+                        read_claimed_directory(locker, next_directory);
+                }
+                directory = m_read_directories.dequeue();
+            }
+
+            TRY(deliver_items(*directory, false));
+
+            Threading::MutexLocker locker(m_mutex);
+            finish_delivering(*directory);
+        }
+    }
+
+    DirectoryWalker const& m_walker;
+    bool m_uses_queue { false };
+
+    Threading::Mutex m_mutex;
+    Threading::ConditionVariable m_condition { m_mutex };
+    // Directories waiting to be read. The last one is read next, which keeps the walk roughly depth-first.
+    Vector<NonnullRefPtr<Directory>> m_queue;
+    // In unordered walks, the directories that have been read, in the order they were read in.
+    Queue<NonnullRefPtr<Directory>> m_read_directories;
+    size_t m_directories_read_ahead { 0 };
+    size_t m_directories_pending { 0 };
+    bool m_stopping { false };
+};
+
+ErrorOr<void> DirectoryWalker::walk(DeprecatedString const& root_path)
+{
+    VERIFY(on_entry);
+    Walk walk(*this);
+    return walk.run(root_path);
+}
+
+}
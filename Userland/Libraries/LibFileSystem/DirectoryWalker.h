@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/DirectoryEntry.h>
+#include <sys/stat.h>
+
+namespace FileSystem {
+
+// Walks a directory tree, reading several directories at once on worker threads (this needs the "thread" pledge
+// promise). The callbacks are always invoked on the thread that called walk().
+class DirectoryWalker {
+public:
+    enum class Order {
+        // Entries are delivered in the order a sequential depth-first walk would find them in.
+        DepthFirst,
+        // Entries are delivered as soon as their directory has been read. A directory still comes before its contents.
+        Unordered,
+    };
+
+    enum class FollowSymlinks {
+        No,
+        // A symlink that leads back to a directory above it is reported to on_error as ELOOP, and not walked into.
+        Yes,
+    };
+
+    enum class StatEntries {
+        // Entries are only stat'ed when the type reported by readdir() is not enough to know whether to descend.
+        IfNeeded,
+        Always,
+    };
+
+    struct Entry {
+        // The root path, or the path of the parent directory and the entry's name joined with a '/'.
+        DeprecatedString path;
+        Core::DirectoryEntry::Type type;
+        // The root is at depth 0.
+        size_t depth { 0 };
+        // Present whenever the entry had to be stat'ed.
+        Optional<struct stat> stat;
+    };
+
+    void set_thread_count(size_t thread_count) { m_thread_count = max<size_t>(thread_count, 1); }
+    void set_order(Order order) { m_order = order; }
+    void set_follow_symlinks(FollowSymlinks follow_symlinks) { m_follow_symlinks = follow_symlinks; }
+    void set_stat_entries(StatEntries stat_entries) { m_stat_entries = stat_entries; }
+    void set_iterator_flags(Core::DirIterator::Flags flags) { m_iterator_flags = flags; }
+
+    // Returning an error from either callback stops the walk, and walk() returns that error.
+    Function<ErrorOr<void>(Entry const&)> on_entry;
+    // Called for directories that cannot be read and entries that cannot be stat'ed. The walk continues if this is not set.
+    Function<ErrorOr<void>(DeprecatedString const& path, Error)> on_error;
+
+    ErrorOr<void> walk(DeprecatedString const& root_path);
+
+private:
+    class Walk;
+    friend class Walk;
+
+    size_t m_thread_count { 1 };
+    Order m_order { Order::DepthFirst };
+    FollowSymlinks m_follow_symlinks { FollowSymlinks::No };
+    StatEntries m_stat_entries { StatEntries::IfNeeded };
+    Core::DirIterator::Flags m_iterator_flags { Core::DirIterator::SkipParentAndBaseDir };
+};
+
+}
@@ -5,10 +5,14 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/LexicalPath.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/System.h>
 #include <LibFileSystem/FileSystem.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <limits.h>
 
 #ifdef AK_OS_SERENITY
@@ -173,14 +177,192 @@ static ErrorOr<String> get_duplicate_file_name(StringView path)
     return current_name;
 }
 
-ErrorOr<void> copy_file(StringView destination_path, StringView source_path, struct stat const& source_stat, Core::File& source, PreserveMode preserve_mode)
+// File data is copied through buffers of this size.
+static constexpr size_t copy_buffer_size = 256 * KiB;
+// Reading on a helper thread while writing only pays off for files at least this big.
+static constexpr size_t helper_thread_copy_threshold = 16 * MiB;
+// The number of files of a directory tree that are copied at once.
+static constexpr size_t max_copy_threads = 4;
+// Holes in sparse files are looked for at this granularity.
+static constexpr size_t sparse_block_size = 4 * KiB;
+
+// The buffer is kept around, so that copying a lot of small files doesn't allocate one for each of them.
+static ErrorOr<Bytes> copy_buffer()
 {
+    thread_local ByteBuffer buffer;
+    if (buffer.is_empty())
+        buffer = TRY(ByteBuffer::create_uninitialized(copy_buffer_size));
+    return buffer.bytes();
+}
+
+static bool is_sparse(struct stat const& stat)
+{
+    return static_cast<u64>(stat.st_blocks) * 512 < static_cast<u64>(stat.st_size);
+}
+
+// Returns false if the kernel can't copy between these files, in which case nothing has been copied yet.
+static ErrorOr<bool> try_copy_in_kernel(Core::File& source, Core::File& destination)
+{
+    bool copied_anything = false;
+    while (true) {
+        auto result = Core::System::copy_file_range(source.fd(), destination.fd(), 1 * GiB);
+        if (result.is_error()) {
+            auto code = result.error().code();
+            if (!copied_anything && (code == EXDEV || code == EINVAL || code == ENOSYS || code == ENOTSUP || code == EOPNOTSUPP))
+                return false;
+            return result.release_error();
+        }
+        if (result.value() == 0)
+            return true;
+        copied_anything = true;
+    }
+}
+
+// Blocks of zeroes are skipped instead of written if the source is sparse, so that its holes stay holes in the copy.
+// The destination has already been truncated to the full size, so the skipped parts read back as zeroes.
+static ErrorOr<void> write_data(Core::File& destination, ReadonlyBytes data, bool skip_zero_blocks)
+{
+    if (!skip_zero_blocks)
+        return destination.write_until_depleted(data);
+
+    while (!data.is_empty()) {
+        auto block = data.trim(sparse_block_size);
+        if (all_of(block, [](u8 byte) { return byte == 0; }))
+            TRY(destination.seek(block.size(), SeekMode::FromCurrentPosition));
+        else
+            TRY(destination.write_until_depleted(block));
+        data = data.slice(block.size());
+    }
+    return {};
+}
+
+static ErrorOr<void> copy_through_buffer(Core::File& source, Core::File& destination, bool skip_zero_blocks)
+{
+    auto buffer = TRY(copy_buffer());
+    while (true) {
+        auto bytes_read = TRY(source.read_some(buffer));
+        if (bytes_read.is_empty())
+            return {};
+        TRY(write_data(destination, bytes_read, skip_zero_blocks));
+    }
+}
+
+// Reads the next part of the file on a helper thread while the previous part is being written.
+static ErrorOr<void> copy_with_helper_thread(Core::File& source, Core::File& destination, bool skip_zero_blocks)
+{
+    struct Part {
+        ByteBuffer buffer;
+        Bytes data;
+        Optional<Error> error;
+        bool is_ready { false };
+    };
+    Array<Part, 2> parts;
+    for (auto& part : parts)
+        part.buffer = TRY(ByteBuffer::create_uninitialized(copy_buffer_size));
+
+    Threading::Mutex mutex;
+    Threading::ConditionVariable condition { mutex };
+    bool should_stop = false;
+
+    auto reader = TRY(Threading::Thread::try_create([&]() -> intptr_t {
+        for (size_t index = 0;; ++index) {
+            auto& part = parts[index % parts.size()];
+            {
+                Threading::MutexLocker locker(mutex);
+                while (part.is_ready && !should_stop)
+                    condition.wait();
+                if (should_stop)
+                    return 0;
+            }
+
+            auto result = source.read_some(part.buffer);
+
+            Threading::MutexLocker locker(mutex);
+            if (result.is_error())
+                part.error = result.release_error();
+            else
+                part.data = result.release_value();
+            part.is_ready = true;
+            condition.broadcast();
+            if (part.error.has_value() || part.data.is_empty())
+                return 0;
+        }
+    },
+        "FileSystem copy"sv));
+    reader->start();
+
+    auto result = [&]() -> ErrorOr<void> {
+        for (size_t index = 0;; ++index) {
+            auto& part = parts[index % parts.size()];
+            {
+                Threading::MutexLocker locker(mutex);
+                while (!part.is_ready)
+                    condition.wait();
+            }
+
+            if (part.error.has_value())
+                return part.error.release_value();
+            if (part.data.is_empty())
+                return {};
+            TRY(write_data(destination, part.data, skip_zero_blocks));
+
+            Threading::MutexLocker locker(mutex);
+            part.is_ready = false;
+            condition.broadcast();
+        }
+    }();
+
+    {
+        Threading::MutexLocker locker(mutex);
+        should_stop = true;
+        condition.broadcast();
+    }
+    (void)reader->join();
+    return result;
+}
+
+static ErrorOr<void> copy_file_data(Core::File& source, Core::File& destination, struct stat const& source_stat, UseHelperThreads use_helper_threads)
+{
+    auto skip_zero_blocks = is_sparse(source_stat);
+    // The kernel copy would fill in the holes of sparse files.
+    if (!skip_zero_blocks && TRY(try_copy_in_kernel(source, destination)))
+        return {};
+
+    if (use_helper_threads == UseHelperThreads::Yes && static_cast<u64>(source_stat.st_size) >= helper_thread_copy_threshold)
+        return copy_with_helper_thread(source, destination, skip_zero_blocks);
+    return copy_through_buffer(source, destination, skip_zero_blocks);
+}
+
+// NOTE: The umask can only be read by changing it, so this must not run while other threads create files.
+static mode_t current_umask()
+{
+    auto my_umask = umask(0);
+    umask(my_umask);
+    return my_umask;
+}
+
+// Opening the destination truncates it, which would destroy the source if both are the same file.
+static ErrorOr<void> verify_not_same_file(StringView destination_path, struct stat const& source_stat)
+{
+    auto destination_stat_or_error = Core::System::stat(destination_path);
+    if (destination_stat_or_error.is_error())
+        return {};
+    auto const& destination_stat = destination_stat_or_error.value();
+    if (destination_stat.st_dev == source_stat.st_dev && destination_stat.st_ino == source_stat.st_ino)
+        return Error::from_errno(EINVAL);
+    return {};
+}
+
+static ErrorOr<void> copy_file_with_umask(StringView destination_path, StringView source_path, struct stat const& source_stat, Core::File& source, PreserveMode preserve_mode, UseHelperThreads use_helper_threads, mode_t my_umask)
+{
+    TRY(verify_not_same_file(destination_path, source_stat));
     auto destination_or_error = Core::File::open(destination_path, Core::File::OpenMode::Write, 0666);
     if (destination_or_error.is_error()) {
         if (destination_or_error.error().code() != EISDIR)
             return destination_or_error.release_error();
 
         auto destination_dir_path = TRY(String::formatted("{}/{}", destination_path, LexicalPath::basename(source_path)));
+        TRY(verify_not_same_file(destination_dir_path, source_stat));
         destination_or_error = TRY(Core::File::open(destination_dir_path, Core::File::OpenMode::Write, 0666));
     }
     auto destination = destination_or_error.release_value();
@@ -188,17 +370,8 @@ ErrorOr<void> copy_file(StringView destination_path, StringView source_path, str
     if (source_stat.st_size > 0)
         TRY(destination->truncate(source_stat.st_size));
 
-    while (true) {
-        auto bytes_read = TRY(source.read_until_eof());
-
-        if (bytes_read.is_empty())
-            break;
+    TRY(copy_file_data(source, *destination, source_stat, use_helper_threads));
 
-        TRY(destination->write_until_depleted(bytes_read));
-    }
-
-    auto my_umask = umask(0);
-    umask(my_umask);
     // NOTE: We don't copy the set-uid and set-gid bits unless requested.
     if (!has_flag(preserve_mode, PreserveMode::Permissions))
         my_umask |= 06000;
@@ -223,7 +396,119 @@ ErrorOr<void> copy_file(StringView destination_path, StringView source_path, str
     return {};
 }
 
-ErrorOr<void> copy_directory(StringView destination_path, StringView source_path, struct stat const& source_stat, LinkMode link, PreserveMode preserve_mode)
+ErrorOr<void> copy_file(StringView destination_path, StringView source_path, struct stat const& source_stat, Core::File& source, PreserveMode preserve_mode, UseHelperThreads use_helper_threads)
+{
+    return copy_file_with_umask(destination_path, source_path, source_stat, source, preserve_mode, use_helper_threads, current_umask());
+}
+
+static ErrorOr<void> apply_directory_metadata(StringView destination_path, struct stat const& source_stat, PreserveMode preserve_mode, mode_t my_umask)
+{
+    TRY(Core::System::chmod(destination_path, source_stat.st_mode & ~my_umask));
+
+    if (has_flag(preserve_mode, PreserveMode::Ownership))
+        TRY(Core::System::chown(destination_path, source_stat.st_uid, source_stat.st_gid));
+
+    if (has_flag(preserve_mode, PreserveMode::Timestamps)) {
+        struct timespec times[2] = {
+#ifdef AK_OS_MACOS
+            source_stat.st_atimespec,
+            source_stat.st_mtimespec,
+#else
+            source_stat.st_atim,
+            source_stat.st_mtim,
+#endif
+        };
+        TRY(Core::System::utimensat(AT_FDCWD, destination_path, times, 0));
+    }
+
+    return {};
+}
+
+// Collects the files of a directory tree while its directories are being created, and then copies them several at a time.
+// Directories get their permissions and timestamps last, so that copying the files inside them doesn't change them.
+class ParallelTreeCopy {
+public:
+    ErrorOr<void> add_file(String destination_path, String source_path, PreserveMode preserve_mode)
+    {
+        return m_files.try_append({ move(destination_path), move(source_path), preserve_mode });
+    }
+
+    ErrorOr<void> add_directory(String destination_path, struct stat const& source_stat, PreserveMode preserve_mode)
+    {
+        return m_directories.try_append({ move(destination_path), source_stat, preserve_mode });
+    }
+
+    ErrorOr<void> finish()
+    {
+        // The copying threads all share the umask read here, before any of them is started.
+        auto my_umask = current_umask();
+
+        Threading::Mutex mutex;
+        size_t next_file = 0;
+        Optional<Error> first_error;
+
+        auto copy_files = [&]() -> intptr_t {
+            while (true) {
+                size_t index;
+                {
+                    Threading::MutexLocker locker(mutex);
+                    if (first_error.has_value() || next_file >= m_files.size())
+                        return 0;
+                    index = next_file++;
+                }
+
+                auto result = copy_one_file(m_files[index], my_umask);
+                if (result.is_error()) {
+                    Threading::MutexLocker locker(mutex);
+                    if (!first_error.has_value())
+                        first_error = result.release_error();
+                }
+            }
+        };
+
+        Vector<NonnullRefPtr<Threading::Thread>> threads;
+        auto thread_count = min(max_copy_threads, m_files.size());
+        for (size_t i = 0; i < thread_count; ++i)
+            TRY(threads.try_append(TRY(Threading::Thread::try_create([&] { return copy_files(); }, "FileSystem copy"sv))));
+        for (auto& thread : threads)
+            thread->start();
+        for (auto& thread : threads)
+            (void)thread->join();
+
+        if (first_error.has_value())
+            return first_error.release_value();
+
+        // Directories were added after everything inside them.
+        for (auto& directory : m_directories)
+            TRY(apply_directory_metadata(directory.destination_path, directory.source_stat, directory.preserve_mode, my_umask));
+        return {};
+    }
+
+private:
+    struct File {
+        String destination_path;
+        String source_path;
+        PreserveMode preserve_mode;
+    };
+
+    struct Directory {
+        String destination_path;
+        struct stat source_stat;
+        PreserveMode preserve_mode;
+    };
+
+    static ErrorOr<void> copy_one_file(File const& file, mode_t my_umask)
+    {
+        auto source = TRY(Core::File::open(file.source_path, Core::File::OpenMode::Read));
+        auto source_stat = TRY(Core::System::fstat(source->fd()));
+        return copy_file_with_umask(file.destination_path, file.source_path, source_stat, *source, file.preserve_mode, UseHelperThreads::No, my_umask);
+    }
+
+    Vector<File> m_files;
+    Vector<Directory> m_directories;
+};
+
+static ErrorOr<void> copy_directory_tree(StringView destination_path, StringView source_path, struct stat const& source_stat, LinkMode link, PreserveMode preserve_mode, ParallelTreeCopy* parallel_copy)
 {
     TRY(Core::System::mkdir(destination_path, 0755));
 
@@ -242,37 +527,40 @@ ErrorOr<void> copy_directory(StringView destination_path, StringView source_path
 
     while (di.has_next()) {
         auto filename = TRY(String::from_deprecated_string(di.next_path()));
-        TRY(copy_file_or_directory(
-            TRY(String::formatted("{}/{}", destination_path, filename)),
-            TRY(String::formatted("{}/{}", source_path, filename)),
-            RecursionMode::Allowed, link, AddDuplicateFileMarker::Yes, preserve_mode));
-    }
+        auto entry_destination_path = TRY(String::formatted("{}/{}", destination_path, filename));
+        auto entry_source_path = TRY(String::formatted("{}/{}", source_path, filename));
 
-    auto my_umask = umask(0);
-    umask(my_umask);
+        if (!parallel_copy) {
+            TRY(copy_file_or_directory(entry_destination_path, entry_source_path, RecursionMode::Allowed, link, AddDuplicateFileMarker::Yes, preserve_mode));
+            continue;
+        }
 
-    TRY(Core::System::chmod(destination_path, source_stat.st_mode & ~my_umask));
+        auto final_destination_path = TRY(get_duplicate_file_name(entry_destination_path));
+        auto entry_stat = TRY(Core::System::stat(entry_source_path));
+        if (S_ISDIR(entry_stat.st_mode))
+            TRY(copy_directory_tree(final_destination_path, entry_source_path, entry_stat, LinkMode::Disallowed, PreserveMode::Nothing, parallel_copy));
+        else if (link == LinkMode::Allowed)
+            TRY(Core::System::link(entry_source_path, final_destination_path));
+        else
+            TRY(parallel_copy->add_file(move(final_destination_path), move(entry_source_path), preserve_mode));
+    }
 
-    if (has_flag(preserve_mode, PreserveMode::Ownership))
-        TRY(Core::System::chown(destination_path, source_stat.st_uid, source_stat.st_gid));
+    if (parallel_copy)
+        return parallel_copy->add_directory(TRY(String::from_utf8(destination_path)), source_stat, preserve_mode);
+    return apply_directory_metadata(destination_path, source_stat, preserve_mode, current_umask());
+}
 
-    if (has_flag(preserve_mode, PreserveMode::Timestamps)) {
-        struct timespec times[2] = {
-#ifdef AK_OS_MACOS
-            source_stat.st_atimespec,
-            source_stat.st_mtimespec,
-#else
-            source_stat.st_atim,
-            source_stat.st_mtim,
-#endif
-        };
-        TRY(Core::System::utimensat(AT_FDCWD, destination_path, times, 0));
-    }
+ErrorOr<void> copy_directory(StringView destination_path, StringView source_path, struct stat const& source_stat, LinkMode link, PreserveMode preserve_mode, UseHelperThreads use_helper_threads)
+{
+    if (use_helper_threads == UseHelperThreads::No)
+        return copy_directory_tree(destination_path, source_path, source_stat, link, preserve_mode, nullptr);
 
-    return {};
+    ParallelTreeCopy parallel_copy;
+    TRY(copy_directory_tree(destination_path, source_path, source_stat, link, preserve_mode, &parallel_copy));
+    return parallel_copy.finish();
 }
 
-ErrorOr<void> copy_file_or_directory(StringView destination_path, StringView source_path, RecursionMode recursion_mode, LinkMode link_mode, AddDuplicateFileMarker add_duplicate_file_marker, PreserveMode preserve_mode)
+ErrorOr<void> copy_file_or_directory(StringView destination_path, StringView source_path, RecursionMode recursion_mode, LinkMode link_mode, AddDuplicateFileMarker add_duplicate_file_marker, PreserveMode preserve_mode, UseHelperThreads use_helper_threads)
 {
     String final_destination_path;
     if (add_duplicate_file_marker == AddDuplicateFileMarker::Yes)
@@ -289,13 +577,13 @@ ErrorOr<void> copy_file_or_directory(StringView destination_path, StringView sou
             return Error::from_errno(EISDIR);
         }
 
-        return copy_directory(final_destination_path, source_path, source_stat);
+        return copy_directory(final_destination_path, source_path, source_stat, LinkMode::Disallowed, PreserveMode::Nothing, use_helper_threads);
     }
 
     if (link_mode == LinkMode::Allowed)
         return TRY(Core::System::link(source_path, final_destination_path));
 
-    return copy_file(final_destination_path, source_path, source_stat, *source, preserve_mode);
+    return copy_file(final_destination_path, source_path, source_stat, *source, preserve_mode, use_helper_threads);
 }
 
 ErrorOr<void> remove(StringView path, RecursionMode mode)
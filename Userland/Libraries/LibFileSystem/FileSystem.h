@@ -63,9 +63,16 @@ enum class PreserveMode {
 };
 AK_ENUM_BITWISE_OPERATORS(PreserveMode);
 
-ErrorOr<void> copy_file(StringView destination_path, StringView source_path, struct stat const& source_stat, Core::File& source, PreserveMode = PreserveMode::Nothing);
-ErrorOr<void> copy_directory(StringView destination_path, StringView source_path, struct stat const& source_stat, LinkMode = LinkMode::Disallowed, PreserveMode = PreserveMode::Nothing);
-ErrorOr<void> copy_file_or_directory(StringView destination_path, StringView source_path, RecursionMode = RecursionMode::Allowed, LinkMode = LinkMode::Disallowed, AddDuplicateFileMarker = AddDuplicateFileMarker::Yes, PreserveMode = PreserveMode::Nothing);
+// Large files are read on a helper thread while they are being written, and the files of a directory tree are copied
+// several at a time. This needs the "thread" pledge promise.
+enum class UseHelperThreads {
+    No,
+    Yes,
+};
+
+ErrorOr<void> copy_file(StringView destination_path, StringView source_path, struct stat const& source_stat, Core::File& source, PreserveMode = PreserveMode::Nothing, UseHelperThreads = UseHelperThreads::No);
+ErrorOr<void> copy_directory(StringView destination_path, StringView source_path, struct stat const& source_stat, LinkMode = LinkMode::Disallowed, PreserveMode = PreserveMode::Nothing, UseHelperThreads = UseHelperThreads::No);
+ErrorOr<void> copy_file_or_directory(StringView destination_path, StringView source_path, RecursionMode = RecursionMode::Allowed, LinkMode = LinkMode::Disallowed, AddDuplicateFileMarker = AddDuplicateFileMarker::Yes, PreserveMode = PreserveMode::Nothing, UseHelperThreads = UseHelperThreads::No);
 ErrorOr<void> remove(StringView path, RecursionMode);
 ErrorOr<size_t> size(StringView path);
 bool can_delete_or_move(StringView path);
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CPUFeatures.h>
+#include <AK/SIMD.h>
+#include <LibGfx/Blending.h>
+#include <string.h>
+
+namespace Gfx {
+
+using AK::SIMD::u16x16;
+using AK::SIMD::u16x8;
+using AK::SIMD::u32x4;
+using AK::SIMD::u32x8;
+
+ALWAYS_INLINE static ARGB32 blend_pixel(ARGB32 destination, ARGB32 source, bool opaque_destination)
+{
+    auto destination_color = opaque_destination ? Color::from_rgb(destination) : Color::from_argb(destination);
+    return destination_color.blend(Color::from_argb(source)).value();
+}
+
+// Over an opaque destination, Color::blend() simplifies to (destination * (255 - alpha) + source * alpha) / 255 for
+// each channel, and the result is opaque again. All of the intermediate values fit into 16 bits, so each pixel is
+// treated as two 16-bit lanes: one holding blue and red, and one holding green and alpha.
+template<typename U32xN, typename U16x2N>
+ALWAYS_INLINE static void blend_over_opaque(U32xN& destination, U32xN const& source)
+{
+    auto alpha_u32 = source >> 24;
+    auto alpha = (U16x2N)(alpha_u32 | (alpha_u32 << 16));
+    auto inverse_alpha = 255 - alpha;
+
+    auto blend_channels = [&](U16x2N& result, U16x2N const& destination_channels, U16x2N const& source_channels) {
+        U16x2N value = destination_channels * inverse_alpha + source_channels * alpha;
+        // This is value / 255, rounded down, for all values up to 255 * 255.
+        result = (value + 1 + (value >> 8)) >> 8;
+    };
+
+    U16x2N blue_and_red;
+    blend_channels(blue_and_red, (U16x2N)destination & 0xff, (U16x2N)source & 0xff);
+    U16x2N green_and_alpha;
+    blend_channels(green_and_alpha, (U16x2N)destination >> 8, (U16x2N)source >> 8);
+
+    destination = (U32xN)(blue_and_red | (green_and_alpha << 8)) | 0xff000000;
+}
+
+// Source pixels that can be loaded straight from memory, rather than computed one at a time.
+struct StoredSourcePixels {
+    ALWAYS_INLINE ARGB32 operator()(size_t i) const { return pixels[i]; }
+
+    ARGB32 const* pixels;
+};
+
+// Blends source_at(i) over destination[i] for each pixel, handling as many pixels at once as U32xN has lanes.
+template<typename U32xN, typename U16x2N, typename SourceAt>
+ALWAYS_INLINE static void blend_pixels_in_vectors(Span<ARGB32> destination, bool opaque_destination, SourceAt source_at)
+{
+    constexpr size_t lanes = sizeof(U32xN) / sizeof(u32);
+
+    auto* destination_pixels = destination.data();
+    size_t i = 0;
+    for (; i + lanes <= destination.size(); i += lanes) {
+        U32xN source_vector;
+        if constexpr (IsSame<SourceAt, StoredSourcePixels>) {
+            memcpy(&source_vector, &source_at.pixels[i], sizeof(source_vector));
+        } else {
+            ARGB32 source_pixels[lanes];
+            for (size_t lane = 0; lane < lanes; ++lane)
+                source_pixels[lane] = source_at(i + lane);
+            memcpy(&source_vector, source_pixels, sizeof(source_vector));
+        }
+
+        if (!opaque_destination) {
+            u32 all_destination_pixels = 0xffffffff;
+            for (size_t lane = 0; lane < lanes; ++lane)
+                all_destination_pixels &= destination_pixels[i + lane];
+            // Translucent destination pixels need a division by their combined alpha, which is left to Color::blend().
+            if ((all_destination_pixels >> 24) != 0xff) {
+                for (size_t lane = 0; lane < lanes; ++lane)
+                    destination_pixels[i + lane] = blend_pixel(destination_pixels[i + lane], source_vector[lane], false);
+                continue;
+            }
+        }
+
+        U32xN destination_vector;
+        memcpy(&destination_vector, &destination_pixels[i], sizeof(destination_vector));
+        blend_over_opaque<U32xN, U16x2N>(destination_vector, source_vector);
+        memcpy(&destination_pixels[i], &destination_vector, sizeof(destination_vector));
+    }
+
+    for (; i < destination.size(); ++i)
+        destination_pixels[i] = blend_pixel(destination_pixels[i], source_at(i), opaque_destination);
+}
+
+#if AK_IS_ARCH_X86_64()
+template<typename SourceAt>
+[[gnu::target("avx2")]] static void blend_pixels_with_avx2(Span<ARGB32> destination, bool opaque_destination, SourceAt source_at)
+{
+    blend_pixels_in_vectors<u32x8, u16x16>(destination, opaque_destination, source_at);
+}
+#endif
+
+template<typename SourceAt>
+static void blend_pixels_with(Span<ARGB32> destination, bool opaque_destination, SourceAt source_at)
+{
+#if AK_IS_ARCH_X86_64()
+    if (cpu_features().avx2)
+        return blend_pixels_with_avx2(destination, opaque_destination, source_at);
+#endif
+    blend_pixels_in_vectors<u32x4, u16x8>(destination, opaque_destination, source_at);
+}
+
+void blend_pixels(Span<ARGB32> destination, ReadonlySpan<ARGB32> source)
+{
+    VERIFY(destination.size() == source.size());
+    blend_pixels_with(destination, false, StoredSourcePixels { source.data() });
+}
+
+void blend_pixels(Span<ARGB32> destination, Color source)
+{
+    blend_pixels_with(destination, false, [value = source.value()](size_t) { return value; });
+}
+
+void blend_pixels(Span<ARGB32> destination, ReadonlySpan<ARGB32> source, BlendWithOpacityOptions const& options)
+{
+    VERIFY(destination.size() == source.size());
+    blend_pixels_with(destination, options.opaque_destination, [&, source = source.data()](size_t i) {
+        auto pixel = source[i];
+        if (options.swap_red_and_blue)
+            pixel = (pixel & 0xff00ff00) | ((pixel & 0x000000ff) << 16) | ((pixel & 0x00ff0000) >> 16);
+        return (pixel & 0x00ffffff) | (static_cast<u32>(options.alpha_map[pixel >> 24]) << 24);
+    });
+}
+
+void blend_coverage(Span<ARGB32> destination, ReadonlySpan<u8> coverage, Color color)
+{
+    VERIFY(destination.size() == coverage.size());
+    blend_pixels_with(destination, false, [rgb = color.value() & 0x00ffffff, alpha = static_cast<u32>(color.alpha()), coverage = coverage.data()](size_t i) {
+        return rgb | ((coverage[i] * alpha / 255) << 24);
+    });
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Span.h>
+#include <LibGfx/Color.h>
+
+namespace Gfx {
+
+// Source-over blending of whole runs of pixels, several pixels at a time where the CPU allows.
+// Every destination pixel ends up exactly as Color::blend() would have left it.
+
+// Blends each source pixel over the destination pixel at the same index.
+void blend_pixels(Span<ARGB32> destination, ReadonlySpan<ARGB32> source);
+
+// Blends the same color over every destination pixel.
+void blend_pixels(Span<ARGB32> destination, Color source);
+
+struct BlendWithOpacityOptions {
+    // The alpha a source pixel is blended with, indexed by the pixel's own alpha.
+    Array<u8, 256> alpha_map;
+    // Set for RGBA8888 sources.
+    bool swap_red_and_blue { false };
+    // Set to ignore the destination's alpha channel and treat it as 255, as for BGRx8888 bitmaps.
+    bool opaque_destination { false };
+};
+
+// Blends each source pixel over the destination pixel at the same index, after replacing its alpha through the map.
+void blend_pixels(Span<ARGB32> destination, ReadonlySpan<ARGB32> source, BlendWithOpacityOptions const&);
+
+// Blends the color over each destination pixel, with its alpha scaled by the coverage at the same index, as for glyphs.
+// Every destination pixel ends up as if a white pixel with the coverage as its alpha had been multiplied with the color.
+void blend_coverage(Span<ARGB32> destination, ReadonlySpan<u8> coverage, Color);
+
+}
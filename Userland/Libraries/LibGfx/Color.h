@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Assertions.h>
+#include <AK/BitCast.h>
 #include <AK/Format.h>
 #include <AK/Forward.h>
 #include <AK/Math.h>
@@ -257,12 +258,23 @@ public:
 
     ALWAYS_INLINE Color interpolate(Color other, float weight) const noexcept
     {
+#ifdef __SSE2__
+        using AK::SIMD::f32x4;
+        using AK::SIMD::u8x4;
+
+        // This mixes all four channels at once, and rounds them to nearest like round_to() does.
+        auto const color = __builtin_convertvector(bit_cast<u8x4>(m_value), f32x4);
+        auto const other_color = __builtin_convertvector(bit_cast<u8x4>(other.m_value), f32x4);
+        auto const mixed = __builtin_ia32_cvtps2dq(color + (other_color - color) * weight);
+        return Color::from_argb(bit_cast<ARGB32>(__builtin_convertvector(mixed, u8x4)));
+#else
         return Gfx::Color {
             round_to<u8>(mix<float>(red(), other.red(), weight)),
             round_to<u8>(mix<float>(green(), other.green(), weight)),
             round_to<u8>(mix<float>(blue(), other.blue(), weight)),
             round_to<u8>(mix<float>(alpha(), other.alpha(), weight)),
         };
+#endif
     }
 
     constexpr Color multiply(Color other) const
@@ -14,6 +14,7 @@
 #include <AK/Variant.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/Emoji.h>
+#include <LibThreading/Mutex.h>
 #include <LibUnicode/CharacterTypes.h>
 #include <LibUnicode/Emoji.h>
 
@@ -23,6 +24,7 @@ namespace Gfx {
 // https://unicode.org/emoji/charts/emoji-list.html
 // https://unicode.org/emoji/charts/emoji-zwj-sequences.html
 
+static Threading::Mutex s_emojis_mutex;
 static HashMap<StringView, RefPtr<Gfx::Bitmap>> s_emojis;
 static Variant<String, StringView> s_emoji_lookup_path = "/res/emoji"sv;
 
@@ -48,6 +50,7 @@ Bitmap const* Emoji::emoji_for_code_points(ReadonlySpan<u32> const& code_points)
         return nullptr;
 
     auto emoji_file = emoji->image_path.value();
+    Threading::MutexLocker locker(s_emojis_mutex);
     if (auto it = s_emojis.find(emoji_file); it != s_emojis.end())
         return it->value.ptr();
 
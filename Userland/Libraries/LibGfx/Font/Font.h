@@ -7,10 +7,10 @@
 
 #pragma once
 
+#include <AK/AtomicRefCounted.h>
 #include <AK/Bitmap.h>
 #include <AK/ByteReader.h>
 #include <AK/DeprecatedString.h>
-#include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
 #include <AK/Types.h>
 #include <LibCore/MappedFile.h>
@@ -145,7 +145,7 @@ enum FontWidth {
     UltraExpanded = 9
 };
 
-class Font : public RefCounted<Font> {
+class Font : public AtomicRefCounted<Font> {
 public:
     enum class AllowInexactSizeMatch {
         No,
@@ -218,6 +218,8 @@ public:
 
     virtual bool has_color_bitmaps() const = 0;
 
+    virtual bool is_scaled_font() const { return false; }
+
 private:
     mutable RefPtr<Gfx::Font const> m_bold_variant;
 };
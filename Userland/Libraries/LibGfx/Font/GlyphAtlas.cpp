@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font/GlyphAtlas.h>
+
+namespace Gfx {
+
+GlyphAtlas& GlyphAtlas::the()
+{
+    static GlyphAtlas s_the;
+    return s_the;
+}
+
+u64 GlyphAtlas::allocate_font_id()
+{
+    static Atomic<u64> s_next_font_id { 1 };
+    return s_next_font_id.fetch_add(1);
+}
+
+ErrorOr<NonnullRefPtr<GlyphAtlas::Page>> GlyphAtlas::Page::try_create()
+{
+    auto coverage = TRY(FixedArray<u8>::create(page_size * page_size));
+    return adopt_nonnull_ref_or_enomem(new (nothrow) Page(move(coverage)));
+}
+
+Optional<IntRect> GlyphAtlas::Page::allocate(IntSize size)
+{
+    auto shelf_height = static_cast<int>(align_up_to(size.height(), 8));
+    for (auto& shelf : m_shelves) {
+        if (shelf.height != shelf_height || shelf.used_width + size.width() > page_size)
+            continue;
+        IntRect rect { shelf.used_width, shelf.y, size.width(), size.height() };
+        shelf.used_width += size.width();
+        return rect;
+    }
+
+    if (m_used_height + shelf_height > page_size)
+        return {};
+    m_shelves.append({ m_used_height, shelf_height, size.width() });
+    IntRect rect { 0, m_used_height, size.width(), size.height() };
+    m_used_height += shelf_height;
+    return rect;
+}
+
+Optional<GlyphAtlas::Entry> GlyphAtlas::find(GlyphAtlasKey const& key)
+{
+    Threading::MutexLocker locker(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return {};
+    if (it->value.page)
+        it->value.page->m_last_use = ++m_use_counter;
+    return it->value;
+}
+
+ErrorOr<NonnullRefPtr<GlyphAtlas::Page>> GlyphAtlas::page_with_room_for(IntSize size, IntRect& rect)
+{
+    for (auto& page : m_pages) {
+        if (auto allocated_rect = page->allocate(size); allocated_rect.has_value()) {
+            rect = *allocated_rect;
+            return page;
+        }
+    }
+
+    if (m_pages.size() >= max_page_count) {
+        size_t least_recently_used = 0;
+        for (size_t i = 1; i < m_pages.size(); ++i) {
+            if (m_pages[i]->m_last_use < m_pages[least_recently_used]->m_last_use)
+                least_recently_used = i;
+        }
+        auto evicted_page = m_pages.take(least_recently_used);
+        m_entries.remove_all_matching([&](auto&, auto& entry) { return entry.page.ptr() == evicted_page.ptr(); });
+    }
+
+    auto page = TRY(Page::try_create());
+    TRY(m_pages.try_append(page));
+    rect = page->allocate(size).release_value();
+    return page;
+}
+
+Optional<GlyphAtlas::Entry> GlyphAtlas::add(GlyphAtlasKey const& key, Bitmap const* glyph_bitmap)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    // Another thread may have added the same glyph in the meantime.
+    if (auto it = m_entries.find(key); it != m_entries.end())
+        return it->value;
+
+    Entry entry;
+    if (glyph_bitmap && !glyph_bitmap->rect().is_empty()) {
+        if (glyph_bitmap->width() > max_glyph_size || glyph_bitmap->height() > max_glyph_size)
+            return {};
+
+        IntRect rect;
+        auto page_or_error = page_with_room_for(glyph_bitmap->size(), rect);
+        if (page_or_error.is_error())
+            return {};
+        auto page = page_or_error.release_value();
+
+        for (int y = 0; y < rect.height(); ++y) {
+            auto const* source = glyph_bitmap->scanline(y);
+            auto* destination = page->writable_scanline(rect.y() + y) + rect.x();
+            for (int x = 0; x < rect.width(); ++x)
+                destination[x] = source[x] >> 24;
+        }
+
+        page->m_last_use = ++m_use_counter;
+        entry = { move(page), rect };
+    }
+
+    if (m_entries.try_set(key, entry).is_error())
+        return {};
+    return entry;
+}
+
+void GlyphAtlas::remove_glyphs_of_font(u64 font_id)
+{
+    Threading::MutexLocker locker(m_mutex);
+    m_entries.remove_all_matching([&](auto& key, auto&) { return key.font_id == font_id; });
+}
+
+}
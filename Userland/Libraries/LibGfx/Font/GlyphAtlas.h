@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/FixedArray.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGfx/Font/Font.h>
+#include <LibGfx/Rect.h>
+#include <LibThreading/Mutex.h>
+
+namespace Gfx {
+
+struct GlyphAtlasKey {
+    // Identifies a font at one size, as handed out by GlyphAtlas::allocate_font_id().
+    u64 font_id;
+    u32 glyph_id;
+    GlyphSubpixelOffset subpixel_offset;
+
+    bool operator==(GlyphAtlasKey const&) const = default;
+};
+
+// The coverage of rasterized glyphs of all fonts, packed into a few large pages of 8-bit alpha values.
+// When all pages are full, the least recently used page is dropped along with all of its glyphs.
+// The atlas may be used from any thread. Pages are never written to where glyphs were already put, and a dropped page
+// stays alive for as long as someone still holds an entry on it, so entries can be read from without holding any lock.
+class GlyphAtlas {
+    AK_MAKE_NONCOPYABLE(GlyphAtlas);
+    AK_MAKE_NONMOVABLE(GlyphAtlas);
+
+public:
+    static constexpr int page_size = 1024;
+    static constexpr size_t max_page_count = 4;
+    // Larger glyphs would use up too much of a page, so they are not put into the atlas.
+    static constexpr int max_glyph_size = page_size / 4;
+
+    class Page : public AtomicRefCounted<Page> {
+    public:
+        static ErrorOr<NonnullRefPtr<Page>> try_create();
+
+        u8 const* scanline(int y) const { return m_coverage.data() + y * page_size; }
+
+    private:
+        friend class GlyphAtlas;
+
+        explicit Page(FixedArray<u8> coverage)
+            : m_coverage(move(coverage))
+        {
+        }
+
+        Optional<IntRect> allocate(IntSize);
+        u8* writable_scanline(int y) { return m_coverage.data() + y * page_size; }
+
+        // Glyphs are packed into rows ("shelves") of the same height, rounded up so that similar glyphs share a shelf.
+        struct Shelf {
+            int y { 0 };
+            int height { 0 };
+            int used_width { 0 };
+        };
+
+        FixedArray<u8> m_coverage;
+        Vector<Shelf> m_shelves;
+        int m_used_height { 0 };
+        u64 m_last_use { 0 };
+    };
+
+    // Where the coverage of a glyph is found. Glyphs that don't cover anything, like spaces, have no page and an empty rect.
+    struct Entry {
+        RefPtr<Page> page;
+        IntRect rect;
+    };
+
+    static GlyphAtlas& the();
+    static u64 allocate_font_id();
+
+    GlyphAtlas() = default;
+
+    Optional<Entry> find(GlyphAtlasKey const&);
+
+    // Copies the alpha channel of a glyph into the atlas. Returns nothing if the glyph is larger than max_glyph_size,
+    // or if memory for a page can't be allocated.
+    Optional<Entry> add(GlyphAtlasKey const&, Bitmap const* glyph_bitmap);
+
+    void remove_glyphs_of_font(u64 font_id);
+
+    size_t page_count() const { return m_pages.size(); }
+
+private:
+    ErrorOr<NonnullRefPtr<Page>> page_with_room_for(IntSize, IntRect& rect);
+
+    Threading::Mutex m_mutex;
+    HashMap<GlyphAtlasKey, Entry> m_entries;
+    Vector<NonnullRefPtr<Page>> m_pages;
+    u64 m_use_counter { 0 };
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Gfx::GlyphAtlasKey> : public GenericTraits<Gfx::GlyphAtlasKey> {
+    static unsigned hash(Gfx::GlyphAtlasKey const& key)
+    {
+        return pair_int_hash(u64_hash(key.font_id), pair_int_hash(key.glyph_id, (key.subpixel_offset.x << 8) | key.subpixel_offset.y));
+    }
+};
+
+}
@@ -681,6 +681,7 @@ float Font::glyphs_horizontal_kerning(u32 left_glyph_id, u32 right_glyph_id, flo
 
     // NOTE: OpenType glyph IDs are 16-bit, so this is safe.
     auto cache_key = (left_glyph_id << 16) | right_glyph_id;
+    Threading::MutexLocker locker(m_cache_mutex);
     if (auto it = m_kerning_cache.find(cache_key); it != m_kerning_cache.end()) {
         return it->value * x_scale;
     }
@@ -888,6 +889,8 @@ u32 Font::glyph_id_for_code_point(u32 code_point) const
 
 Font::GlyphPage const& Font::glyph_page(size_t page_index) const
 {
+    // Pages are never removed once created, so the reference stays valid after unlocking.
+    Threading::MutexLocker locker(m_cache_mutex);
     if (page_index == 0) {
         if (!m_glyph_page_zero) {
             m_glyph_page_zero = make<GlyphPage>();
@@ -17,6 +17,7 @@
 #include <LibGfx/Font/OpenType/Glyf.h>
 #include <LibGfx/Font/OpenType/Tables.h>
 #include <LibGfx/Font/VectorFont.h>
+#include <LibThreading/Mutex.h>
 
 namespace OpenType {
 
@@ -128,6 +129,9 @@ private:
     Optional<CBDT> m_cbdt;
     Optional<GPOS> m_gpos;
 
+    // The caches below are filled in lazily, possibly by several threads at once.
+    mutable Threading::Mutex m_cache_mutex;
+
     // This cache stores information per code point.
     // It's segmented into pages with data about 256 code points each.
     struct GlyphPage {
@@ -13,7 +13,7 @@
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/Font.h>
 #include <LibGfx/Font/OpenType/Tables.h>
-#include <LibGfx/Font/PathRasterizer.h>
+#include <LibGfx/PathRasterizer.h>
 #include <math.h>
 
 namespace OpenType {
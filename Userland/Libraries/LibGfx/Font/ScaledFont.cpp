@@ -36,6 +36,11 @@ ScaledFont::ScaledFont(NonnullRefPtr<VectorFont> font, float point_width, float
     };
 }
 
+ScaledFont::~ScaledFont()
+{
+    GlyphAtlas::the().remove_glyphs_of_font(m_glyph_atlas_font_id);
+}
+
 int ScaledFont::width_rounded_up(StringView view) const
 {
     return static_cast<int>(ceilf(width(view)));
@@ -74,6 +79,7 @@ ALWAYS_INLINE float ScaledFont::unicode_view_width(T const& view) const
 RefPtr<Gfx::Bitmap> ScaledFont::rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset subpixel_offset) const
 {
     GlyphIndexWithSubpixelOffset index { glyph_id, subpixel_offset };
+    Threading::MutexLocker locker(m_cached_glyph_bitmaps_mutex);
     auto glyph_iterator = m_cached_glyph_bitmaps.find(index);
     if (glyph_iterator != m_cached_glyph_bitmaps.end())
         return glyph_iterator->value;
@@ -83,6 +89,19 @@ RefPtr<Gfx::Bitmap> ScaledFont::rasterize_glyph(u32 glyph_id, GlyphSubpixelOffse
     return glyph_bitmap;
 }
 
+Optional<GlyphAtlas::Entry> ScaledFont::glyph_atlas_entry(u32 glyph_id, GlyphSubpixelOffset subpixel_offset) const
+{
+    GlyphAtlasKey key { m_glyph_atlas_font_id, glyph_id, subpixel_offset };
+    auto& atlas = GlyphAtlas::the();
+    if (auto entry = atlas.find(key); entry.has_value())
+        return entry;
+
+    // The atlas isn't locked while rasterizing, so that other threads can keep drawing glyphs meanwhile.
+    // The bitmap is only needed until its coverage has been copied, so it doesn't go into m_cached_glyph_bitmaps.
+    auto glyph_bitmap = m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale, subpixel_offset);
+    return atlas.add(key, glyph_bitmap.ptr());
+}
+
 Gfx::Glyph ScaledFont::glyph(u32 code_point) const
 {
     return glyph(code_point, GlyphSubpixelOffset { 0, 0 });
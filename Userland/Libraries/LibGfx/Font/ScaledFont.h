@@ -10,7 +10,9 @@
 #include <AK/HashMap.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/Font.h>
+#include <LibGfx/Font/GlyphAtlas.h>
 #include <LibGfx/Font/VectorFont.h>
+#include <LibThreading/Mutex.h>
 
 #define POINTS_PER_INCH 72.0f
 #define DEFAULT_DPI 96
@@ -27,11 +29,16 @@ struct GlyphIndexWithSubpixelOffset {
 class ScaledFont final : public Gfx::Font {
 public:
     ScaledFont(NonnullRefPtr<VectorFont>, float point_width, float point_height, unsigned dpi_x = DEFAULT_DPI, unsigned dpi_y = DEFAULT_DPI);
+    virtual ~ScaledFont() override;
     u32 glyph_id_for_code_point(u32 code_point) const { return m_font->glyph_id_for_code_point(code_point); }
     ScaledFontMetrics metrics() const { return m_font->metrics(m_x_scale, m_y_scale); }
     ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const { return m_font->glyph_metrics(glyph_id, m_x_scale, m_y_scale, m_point_width, m_point_height); }
     RefPtr<Gfx::Bitmap> rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset) const;
 
+    // Looks the glyph up in the shared glyph atlas, rasterizing it into the atlas first if it isn't there yet.
+    // Returns nothing for glyphs that can't be put into the atlas, which have to be drawn from rasterize_glyph() instead.
+    Optional<GlyphAtlas::Entry> glyph_atlas_entry(u32 glyph_id, GlyphSubpixelOffset) const;
+
     // ^Gfx::Font
     virtual NonnullRefPtr<Font> clone() const override { return MUST(try_clone()); } // FIXME: clone() should not need to be implemented
     virtual ErrorOr<NonnullRefPtr<Font>> try_clone() const override { return const_cast<ScaledFont&>(*this); }
@@ -74,6 +81,7 @@ public:
     virtual RefPtr<Font> with_size(float point_size) const override;
 
     virtual bool has_color_bitmaps() const override { return m_font->has_color_bitmaps(); }
+    virtual bool is_scaled_font() const override { return true; }
 
 private:
     NonnullRefPtr<VectorFont> m_font;
@@ -81,7 +89,10 @@ private:
     float m_y_scale { 0.0f };
     float m_point_width { 0.0f };
     float m_point_height { 0.0f };
+    // Glyphs may be rasterized on several threads at once.
+    mutable Threading::Mutex m_cached_glyph_bitmaps_mutex;
     mutable HashMap<GlyphIndexWithSubpixelOffset, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
+    u64 m_glyph_atlas_font_id { GlyphAtlas::allocate_font_id() };
     Gfx::FontPixelMetrics m_pixel_metrics;
 
     float m_pixel_size { 0.0f };
@@ -6,8 +6,8 @@
 
 #pragma once
 
+#include <AK/AtomicRefCounted.h>
 #include <AK/Noncopyable.h>
-#include <AK/RefCounted.h>
 #include <LibGfx/Font/Font.h>
 #include <LibGfx/Forward.h>
 
@@ -31,7 +31,7 @@ struct ScaledGlyphMetrics {
     float left_side_bearing;
 };
 
-class VectorFont : public RefCounted<VectorFont> {
+class VectorFont : public AtomicRefCounted<VectorFont> {
 public:
     virtual ~VectorFont() { }
     virtual ScaledFontMetrics metrics(float x_scale, float y_scale) const = 0;
@@ -29,6 +29,7 @@ class Painter;
 class Palette;
 class PaletteImpl;
 class Path;
+class ScaledFont;
 class ShareableBitmap;
 class StylePainter;
 struct SystemTheme;
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Math.h>
+#include <LibGfx/Blending.h>
 #include <LibGfx/Gradients.h>
 #include <LibGfx/PaintStyle.h>
 #include <LibGfx/Painter.h>
@@ -121,11 +122,21 @@ public:
     {
         auto clipped_rect = rect.intersected(painter.clip_rect() * painter.scale());
         auto start_offset = clipped_rect.location() - rect.location();
+        Vector<ARGB32> row;
+        row.resize(clipped_rect.width());
         for (int y = 0; y < clipped_rect.height(); y++) {
+            auto* scanline = painter.target()->scanline(clipped_rect.y() + y) + clipped_rect.x();
             for (int x = 0; x < clipped_rect.width(); x++) {
                 auto pixel = sample_color(location_transform(x + start_offset.x(), y + start_offset.y()));
-                painter.set_physical_pixel(clipped_rect.location().translated(x, y), pixel, m_requires_blending);
+                // Fully transparent pixels must leave the destination untouched, which blending only does if it isn't fully transparent itself.
+                if (m_requires_blending && pixel.alpha() == 0 && Color::from_argb(scanline[x]).alpha() == 0)
+                    pixel = Color::from_argb(scanline[x]);
+                row[x] = pixel.value();
             }
+            if (m_requires_blending)
+                blend_pixels({ scanline, row.size() }, row);
+            else
+                memcpy(scanline, row.data(), row.size() * sizeof(ARGB32));
         }
     }
 
@@ -36,7 +36,7 @@ public:
     virtual size_t loop_count() override;
     virtual size_t frame_count() override;
     virtual size_t first_animated_frame_index() override;
-    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
 
 private:
@@ -690,7 +690,7 @@ size_t DDSImageDecoderPlugin::first_animated_frame_index()
     return 0;
 }
 
-ErrorOr<ImageFrameDescriptor> DDSImageDecoderPlugin::frame(size_t index)
+ErrorOr<ImageFrameDescriptor> DDSImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
 {
     if (index > 0)
         return Error::from_string_literal("DDSImageDecoderPlugin: Invalid frame index");
@@ -91,6 +91,37 @@ RefPtr<ImageDecoder> ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes bytes,
     return {};
 }
 
+RefPtr<ImageDecoder> ImageDecoder::try_create_for_incomplete_bytes(ReadonlyBytes bytes)
+{
+    struct ImagePluginInitializer {
+        bool (*sniff)(ReadonlyBytes) = nullptr;
+        ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> (*create)(ReadonlyBytes) = nullptr;
+    };
+
+    // The other decoders go through all of the data to find the size, or more (GIF reads every frame descriptor,
+    // and the PBM family decodes the whole image).
+    static constexpr ImagePluginInitializer s_initializers[] = {
+        { PNGImageDecoderPlugin::sniff, PNGImageDecoderPlugin::create },
+        { BMPImageDecoderPlugin::sniff, BMPImageDecoderPlugin::create },
+        { JPEGImageDecoderPlugin::sniff, JPEGImageDecoderPlugin::create },
+        { QOIImageDecoderPlugin::sniff, QOIImageDecoderPlugin::create },
+        { WebPImageDecoderPlugin::sniff, WebPImageDecoderPlugin::create },
+    };
+
+    for (auto& plugin : s_initializers) {
+        if (!plugin.sniff(bytes))
+            continue;
+        auto plugin_decoder_or_error = plugin.create(bytes);
+        if (plugin_decoder_or_error.is_error())
+            return {};
+        auto plugin_decoder = plugin_decoder_or_error.release_value();
+        if (!plugin_decoder->initialize())
+            return {};
+        return adopt_ref_if_nonnull(new (nothrow) ImageDecoder(move(plugin_decoder)));
+    }
+    return {};
+}
+
 ImageDecoder::ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin> plugin)
     : m_plugin(move(plugin))
 {
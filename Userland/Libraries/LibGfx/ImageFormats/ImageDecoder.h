@@ -40,9 +40,17 @@ public:
     virtual size_t loop_count() = 0;
     virtual size_t frame_count() = 0;
     virtual size_t first_animated_frame_index() = 0;
-    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) = 0;
+
+    // If the caller is going to scale the frame down to ideal_size anyway, decoders that can produce a smaller
+    // image cheaply may do so. The returned image is never smaller than ideal_size (nor larger than size()), so
+    // callers have to look at its size rather than assume it matches size().
+    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) = 0;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() = 0;
 
+    // Decodes the first frame from data that stops before the end of the image, for showing it while the rest is
+    // still arriving. Whatever the data doesn't reach is left black.
+    virtual ErrorOr<ImageFrameDescriptor> incomplete_first_frame() { return Error::from_string_literal("Decoding incomplete images is not supported"); }
+
 protected:
     ImageDecoderPlugin() = default;
 };
@@ -50,6 +58,10 @@ protected:
 class ImageDecoder : public RefCounted<ImageDecoder> {
 public:
     static RefPtr<ImageDecoder> try_create_for_raw_bytes(ReadonlyBytes, Optional<DeprecatedString> mime_type = {});
+
+    // For data that may stop anywhere because it is still arriving. Only the formats whose size can be read from the
+    // header alone are recognized, so that size() never has to go through the rest of the data.
+    static RefPtr<ImageDecoder> try_create_for_incomplete_bytes(ReadonlyBytes);
     ~ImageDecoder() = default;
 
     IntSize size() const { return m_plugin->size(); }
@@ -61,8 +73,9 @@ public:
     size_t loop_count() const { return m_plugin->loop_count(); }
     size_t frame_count() const { return m_plugin->frame_count(); }
     size_t first_animated_frame_index() const { return m_plugin->first_animated_frame_index(); }
-    ErrorOr<ImageFrameDescriptor> frame(size_t index) const { return m_plugin->frame(index); }
+    ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) const { return m_plugin->frame(index, ideal_size); }
     ErrorOr<Optional<ReadonlyBytes>> icc_data() const { return m_plugin->icc_data(); }
+    ErrorOr<ImageFrameDescriptor> incomplete_first_frame() const { return m_plugin->incomplete_first_frame(); }
 
 private:
     explicit ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin>);
@@ -5,19 +5,29 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
 #include <AK/Error.h>
 #include <AK/FixedArray.h>
+#include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMDExtras.h>
 #include <AK/String.h>
 #include <AK/Try.h>
 #include <AK/Vector.h>
 #include <LibGfx/ImageFormats/JPEGLoader.h>
 
+// Functions returning vectors or accepting vector arguments have different calling conventions
+// depending on whether the target architecture supports SSE or not. GCC generates warning "psabi"
+// when compiling for non-SSE architectures. We disable this warning because these functions
+// are static and should never be visible from outside the translation unit that includes this header.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
 #define JPEG_INVALID 0X0000
 
 // These names are defined in B.1.1.3 - Marker assignments
@@ -260,41 +270,16 @@ private:
 
 class HuffmanStream {
 public:
-    static ErrorOr<HuffmanStream> create(SeekableStream& stream)
+    // If the data is allowed to be incomplete and ends before the next marker, the stream ends there too.
+    static ErrorOr<HuffmanStream> create(SeekableStream& stream, bool allow_incomplete_data)
     {
         HuffmanStream huffman {};
-
-        u8 last_byte {};
-        u8 current_byte = TRY(stream.read_value<u8>());
-
-        for (;;) {
-            last_byte = current_byte;
-            current_byte = TRY(stream.read_value<u8>());
-
-            if (last_byte == 0xFF) {
-                if (current_byte == 0xFF)
-                    continue;
-                if (current_byte == 0x00) {
-                    current_byte = TRY(stream.read_value<u8>());
-                    huffman.m_stream.append(last_byte);
-                    continue;
-                }
-                Marker marker = 0xFF00 | current_byte;
-                if (marker >= JPEG_RST0 && marker <= JPEG_RST7) {
-                    huffman.m_stream.append(marker);
-                    current_byte = TRY(stream.read_value<u8>());
-                    continue;
-                }
-
-                // Rollback the marker we just read
-                TRY(stream.seek(-2, AK::SeekMode::FromCurrentPosition));
-                return huffman;
-            }
-
-            huffman.m_stream.append(last_byte);
+        if (auto result = huffman.read_until_marker(stream); result.is_error()) {
+            if (!allow_incomplete_data || !stream.is_eof())
+                return result.release_error();
+            huffman.m_is_incomplete = true;
         }
-
-        VERIFY_NOT_REACHED();
+        return huffman;
     }
 
     ErrorOr<u8> next_symbol(HuffmanTable const& table)
@@ -365,10 +350,52 @@ public:
         return m_byte_offset;
     }
 
+    // Whether the data ended before the scan did, and everything that arrived has been read.
+    bool is_incomplete_and_exhausted() const
+    {
+        return m_is_incomplete && m_byte_offset >= m_stream.size();
+    }
+
 private:
+    ErrorOr<void> read_until_marker(SeekableStream& stream)
+    {
+        u8 last_byte {};
+        u8 current_byte = TRY(stream.read_value<u8>());
+
+        for (;;) {
+            last_byte = current_byte;
+            current_byte = TRY(stream.read_value<u8>());
+
+            if (last_byte == 0xFF) {
+                if (current_byte == 0xFF)
+                    continue;
+                if (current_byte == 0x00) {
+                    current_byte = TRY(stream.read_value<u8>());
+                    m_stream.append(last_byte);
+                    continue;
+                }
+                Marker marker = 0xFF00 | current_byte;
+                if (marker >= JPEG_RST0 && marker <= JPEG_RST7) {
+                    m_stream.append(marker);
+                    current_byte = TRY(stream.read_value<u8>());
+                    continue;
+                }
+
+                // Rollback the marker we just read
+                TRY(stream.seek(-2, AK::SeekMode::FromCurrentPosition));
+                return {};
+            }
+
+            m_stream.append(last_byte);
+        }
+
+        VERIFY_NOT_REACHED();
+    }
+
     Vector<u8> m_stream;
     u8 m_bit_offset { 0 };
     u64 m_byte_offset { 0 };
+    bool m_is_incomplete { false };
 };
 
 struct ICCMultiChunkState {
@@ -434,8 +461,14 @@ struct JPEGLoadingContext {
 
     Optional<ColorTransform> color_transform {};
 
+    // The bitmap is 1/scale_denominator the size of the image, see scale_denominator_for_ideal_size().
+    u16 scale_denominator { 1 };
+
     Optional<ICCMultiChunkState> icc_multi_chunk_state;
     Optional<ByteBuffer> icc_data;
+
+    // Set when decoding data that is still arriving. Scans then end where the data does.
+    bool allow_incomplete_data { false };
 };
 
 static inline auto* get_component(Macroblock& block, unsigned component)
@@ -726,14 +759,24 @@ static void reset_decoder(JPEGLoadingContext& context)
     VERIFY_NOT_REACHED();
 }
 
-static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
+// Decodes the MCUs of the current scan into macroblocks. If on_mcu_row_decoded is given, macroblocks only has room for a
+// single row of MCUs, which is handed to the callback as soon as it is complete and then reused for the next row.
+static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks, Function<ErrorOr<void>(u32 vcursor)> const& on_mcu_row_decoded = {})
 {
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+        u32 const vcursor_in_macroblocks = on_mcu_row_decoded ? 0 : vcursor;
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
 
             auto& huffman_stream = context.current_scan.huffman_stream;
 
+            // The blocks the data doesn't reach keep the coefficients they have, or stay zero.
+            if (huffman_stream.is_incomplete_and_exhausted()) {
+                if (on_mcu_row_decoded)
+                    TRY(on_mcu_row_decoded(vcursor));
+                return {};
+            }
+
             if (context.dc_restart_interval > 0) {
                 if (i != 0 && i % (context.dc_restart_interval * context.vsample_factor * context.hsample_factor) == 0) {
                     reset_decoder(context);
@@ -747,7 +790,7 @@ static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<M
                 }
             }
 
-            if (auto result = build_macroblocks(context, macroblocks, hcursor, vcursor); result.is_error()) {
+            if (auto result = build_macroblocks(context, macroblocks, hcursor, vcursor_in_macroblocks); result.is_error()) {
                 if constexpr (JPEG_DEBUG) {
                     dbgln("Failed to build Macroblock {}: {}", i, result.error());
                     dbgln("Huffman stream byte offset {}", huffman_stream.byte_offset());
@@ -755,6 +798,9 @@ static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<M
                 return result.release_error();
             }
         }
+
+        if (on_mcu_row_decoded)
+            TRY(on_mcu_row_decoded(vcursor));
     }
     return {};
 }
@@ -895,7 +941,7 @@ static ErrorOr<void> read_start_of_scan(Stream& stream, JPEGLoadingContext& cont
         return Error::from_string_literal("Spectral selection is not [0,63] or successive approximation is not null");
     }
 
-    current_scan.huffman_stream = TRY(HuffmanStream::create(*context.stream));
+    current_scan.huffman_stream = TRY(HuffmanStream::create(*context.stream, context.allow_incomplete_data));
     context.current_scan = move(current_scan);
 
     return {};
@@ -1273,9 +1319,9 @@ static ErrorOr<void> skip_segment(Stream& stream)
     return {};
 }
 
-static ErrorOr<void> dequantize(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static ErrorOr<void> dequantize(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u32 i = 0; i < context.components.size(); i++) {
                 auto const& component = context.components[i];
@@ -1303,7 +1349,7 @@ static ErrorOr<void> dequantize(JPEGLoadingContext& context, Vector<Macroblock>&
     return {};
 }
 
-static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
     static float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
     static float const m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
@@ -1320,7 +1366,98 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
     static float const s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f;
     static float const s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f;
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    // One pass of the AAN inverse DCT, applied to four rows or columns at once.
+    auto inverse_dct_8 = [&](AK::SIMD::f32x4 (&values)[8]) {
+        auto const g0 = values[0] * s0;
+        auto const g1 = values[4] * s4;
+        auto const g2 = values[2] * s2;
+        auto const g3 = values[6] * s6;
+        auto const g4 = values[5] * s5;
+        auto const g5 = values[1] * s1;
+        auto const g6 = values[7] * s7;
+        auto const g7 = values[3] * s3;
+
+        auto const f0 = g0;
+        auto const f1 = g1;
+        auto const f2 = g2;
+        auto const f3 = g3;
+        auto const f4 = g4 - g7;
+        auto const f5 = g5 + g6;
+        auto const f6 = g5 - g6;
+        auto const f7 = g4 + g7;
+
+        auto const e0 = f0;
+        auto const e1 = f1;
+        auto const e2 = f2 - f3;
+        auto const e3 = f2 + f3;
+        auto const e4 = f4;
+        auto const e5 = f5 - f7;
+        auto const e6 = f6;
+        auto const e7 = f5 + f7;
+        auto const e8 = f4 + f6;
+
+        auto const d0 = e0;
+        auto const d1 = e1;
+        auto const d2 = e2 * m1;
+        auto const d3 = e3;
+        auto const d4 = e4 * m2;
+        auto const d5 = e5 * m3;
+        auto const d6 = e6 * m4;
+        auto const d7 = e7;
+        auto const d8 = e8 * m5;
+
+        auto const c0 = d0 + d1;
+        auto const c1 = d0 - d1;
+        auto const c2 = d2 - d3;
+        auto const c3 = d3;
+        auto const c4 = d4 + d8;
+        auto const c5 = d5 + d7;
+        auto const c6 = d6 - d8;
+        auto const c7 = d7;
+        auto const c8 = c5 - c6;
+
+        auto const b0 = c0 + c3;
+        auto const b1 = c1 + c2;
+        auto const b2 = c1 - c2;
+        auto const b3 = c0 - c3;
+        auto const b4 = c4 - c8;
+        auto const b5 = c8;
+        auto const b6 = c6 - c7;
+        auto const b7 = c7;
+
+        values[0] = b0 + b7;
+        values[1] = b1 + b6;
+        values[2] = b2 + b5;
+        values[3] = b3 + b4;
+        values[4] = b3 - b4;
+        values[5] = b2 - b5;
+        values[6] = b1 - b6;
+        values[7] = b0 - b7;
+    };
+
+    // Transforms all columns (or rows) of a block. The i-th value of a column is element_stride apart from the previous
+    // one, and neighboring columns are lane_stride apart. Values are truncated to integers after each pass, when they are
+    // stored back into the block.
+    auto inverse_dct_pass = [&](i16* block_component, u32 element_stride, u32 lane_stride) {
+        for (u32 first_lane = 0; first_lane < 8; first_lane += 4) {
+            AK::SIMD::f32x4 values[8];
+            for (u32 i = 0; i < 8; ++i) {
+                auto const* samples = block_component + i * element_stride + first_lane * lane_stride;
+                values[i] = AK::SIMD::to_f32x4(AK::SIMD::i32x4 { samples[0], samples[lane_stride], samples[2 * lane_stride], samples[3 * lane_stride] });
+            }
+
+            inverse_dct_8(values);
+
+            for (u32 i = 0; i < 8; ++i) {
+                auto* samples = block_component + i * element_stride + first_lane * lane_stride;
+                auto const truncated = AK::SIMD::to_i32x4(values[i]);
+                for (u32 lane = 0; lane < 4; ++lane)
+                    samples[lane * lane_stride] = truncated[lane];
+            }
+        }
+    };
+
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
                 auto& component = context.components[component_i];
@@ -1329,140 +1466,16 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
                         u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[macroblock_index];
                         auto* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            float const g0 = block_component[0 * 8 + k] * s0;
-                            float const g1 = block_component[4 * 8 + k] * s4;
-                            float const g2 = block_component[2 * 8 + k] * s2;
-                            float const g3 = block_component[6 * 8 + k] * s6;
-                            float const g4 = block_component[5 * 8 + k] * s5;
-                            float const g5 = block_component[1 * 8 + k] * s1;
-                            float const g6 = block_component[7 * 8 + k] * s7;
-                            float const g7 = block_component[3 * 8 + k] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            float const g0 = block_component[l * 8 + 0] * s0;
-                            float const g1 = block_component[l * 8 + 4] * s4;
-                            float const g2 = block_component[l * 8 + 2] * s2;
-                            float const g3 = block_component[l * 8 + 6] * s6;
-                            float const g4 = block_component[l * 8 + 5] * s5;
-                            float const g5 = block_component[l * 8 + 1] * s1;
-                            float const g6 = block_component[l * 8 + 7] * s7;
-                            float const g7 = block_component[l * 8 + 3] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
+                        if (context.scale_denominator == 8) {
+                            // Only the average of the block ends up in the bitmap, and that is what the DC
+                            // coefficient holds.
+                            auto const average = static_cast<i16>(block_component[0] / 8.0f);
+                            for (u32 k = 0; k < 64; ++k)
+                                block_component[k] = average;
+                            continue;
                         }
+                        inverse_dct_pass(block_component, 8, 1);
+                        inverse_dct_pass(block_component, 1, 8);
                     }
                 }
             }
@@ -1472,7 +1485,7 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
     // F.2.1.5 - Inverse DCT (IDCT)
     auto const level_shift = 1 << (context.frame.precision - 1);
     auto const max_value = (1 << context.frame.precision) - 1;
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
                 for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
@@ -1500,12 +1513,12 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
     }
 }
 
-static void ycbcr_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void ycbcr_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
     // Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
     // See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
     // 7 - Conversion to and from RGB
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
             Macroblock const& chroma = macroblocks[chroma_block_index];
@@ -1536,7 +1549,7 @@ static void ycbcr_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>&
     }
 }
 
-static void invert_colors_for_adobe_images(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void invert_colors_for_adobe_images(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
     if (!context.color_transform.has_value())
         return;
@@ -1547,7 +1560,7 @@ static void invert_colors_for_adobe_images(JPEGLoadingContext const& context, Ve
     // files: 0 represents 100% ink coverage, rather than 0% ink as you'd expect.
     // This is arguably a bug in Photoshop, but if you need to work with Photoshop
     // CMYK files, you will have to deal with it in your application.
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
                 for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
@@ -1566,11 +1579,11 @@ static void invert_colors_for_adobe_images(JPEGLoadingContext const& context, Ve
     }
 }
 
-static void cmyk_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void cmyk_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
-    invert_colors_for_adobe_images(context, macroblocks);
+    invert_colors_for_adobe_images(context, macroblocks, row_count);
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
                 for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
@@ -1601,16 +1614,16 @@ static void cmyk_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& m
     }
 }
 
-static void ycck_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void ycck_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
 {
     // 7 - Conversions between colour encodings
     // YCCK is obtained from CMYK by converting the CMY channels to YCC channel.
 
     // To convert back into RGB, we only need the 3 first components, which are baseline YCbCr
-    ycbcr_to_rgb(context, macroblocks);
+    ycbcr_to_rgb(context, macroblocks, row_count);
 
     // RGB to CMYK, as mentioned in https://www.smcm.iqfr.csic.es/docs/intel/ipp/ipp_manual/IPPI/ippi_ch15/functn_YCCKToCMYK_JPEG.htm#functn_YCCKToCMYK_JPEG
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+    for (u32 vcursor = 0; vcursor < row_count; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
                 for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
@@ -1627,11 +1640,30 @@ static void ycck_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& m
         }
     }
 
-    cmyk_to_rgb(context, macroblocks);
+    cmyk_to_rgb(context, macroblocks, row_count);
 }
 
-static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+// Whether the image is encoded as YCbCr, which is converted to RGB while composing the bitmap.
+static bool is_ycbcr(JPEGLoadingContext const& context)
 {
+    if (context.color_transform.has_value())
+        return *context.color_transform == ColorTransform::YCbCr;
+
+    // No App14 segment is present, assuming :
+    //      - 1 components means grayscale
+    //      - 3 components means YCbCr
+    //      - 4 components means CMYK
+    // With Cb and Cr being equal to zero, the conversion from YCbCr assigns the Y
+    // value (luminosity) to R, G and B. Providing a proper conversion
+    // from grayscale to RGB.
+    return context.components.size() == 3 || context.components.size() == 1;
+}
+
+static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 row_count)
+{
+    if (is_ycbcr(context))
+        return {};
+
     if (context.color_transform.has_value()) {
         // https://www.itu.int/rec/dologin_pub.asp?lang=e&id=T-REC-T.872-201206-I!!PDF-E&type=items
         // 6.5.3 - APP14 marker segment for colour encoding
@@ -1639,7 +1671,7 @@ static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, V
         switch (*context.color_transform) {
         case ColorTransform::CmykOrRgb:
             if (context.components.size() == 4) {
-                cmyk_to_rgb(context, macroblocks);
+                cmyk_to_rgb(context, macroblocks, row_count);
             } else if (context.components.size() == 3) {
                 // Note: components.size() == 3 means that we have an RGB image, so no color transformation is needed.
             } else {
@@ -1647,52 +1679,152 @@ static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, V
             }
             break;
         case ColorTransform::YCbCr:
-            ycbcr_to_rgb(context, macroblocks);
-            break;
+            VERIFY_NOT_REACHED();
         case ColorTransform::YCCK:
-            ycck_to_rgb(context, macroblocks);
+            ycck_to_rgb(context, macroblocks, row_count);
             break;
         }
 
         return {};
     }
 
-    // No App14 segment is present, assuming :
-    //      - 1 components means grayscale
-    //      - 3 components means YCbCr
-    //      - 4 components means CMYK
     if (context.components.size() == 4)
-        cmyk_to_rgb(context, macroblocks);
-    if (context.components.size() == 3)
-        ycbcr_to_rgb(context, macroblocks);
-
-    if (context.components.size() == 1) {
-        // With Cb and Cr being equal to zero, this function assign the Y
-        // value (luminosity) to R, G and B. Providing a proper conversion
-        // from grayscale to RGB.
-        ycbcr_to_rgb(context, macroblocks);
-    }
+        cmyk_to_rgb(context, macroblocks, row_count);
 
     return {};
 }
 
-static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock> const& macroblocks)
+// Converts one row of eight pixels of a luma block, four at a time. The chroma of the MCU is upsampled on the way, cb and
+// cr point to the chroma samples that cover the first pixel.
+static void ycbcr_to_rgb_row(i16 const* y, i16 const* cb, i16 const* cr, u8 hsample_factor, ARGB32* pixels)
 {
-    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
+    using AK::SIMD::f32x4;
+    using AK::SIMD::i32x4;
+    using AK::SIMD::u32x4;
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
+    // Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
+    // See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
+    // 7 - Conversion to and from RGB
+    for (u32 j = 0; j < 8; j += 4) {
+        auto chroma = [&](i16 const* samples) {
+            return AK::SIMD::to_f32x4(i32x4 {
+                samples[(j + 0) / hsample_factor] - 128,
+                samples[(j + 1) / hsample_factor] - 128,
+                samples[(j + 2) / hsample_factor] - 128,
+                samples[(j + 3) / hsample_factor] - 128,
+            });
+        };
+        auto const luma = AK::SIMD::to_f32x4(i32x4 { y[j], y[j + 1], y[j + 2], y[j + 3] });
+        auto const blue_difference = chroma(cb);
+        auto const red_difference = chroma(cr);
+
+        auto to_channel = [](f32x4 value) {
+            auto channel = AK::SIMD::to_i32x4(value);
+            channel = channel < 0 ? 0 : channel;
+            channel = channel > 255 ? 255 : channel;
+            return AK::SIMD::to_u32x4(channel);
+        };
+        auto const r = to_channel(luma + 1.402f * red_difference);
+        auto const g = to_channel(luma - 0.3441f * blue_difference - 0.7141f * red_difference);
+        auto const b = to_channel(luma + 1.772f * blue_difference);
+
+        u32x4 const argb = 0xff000000 | (r << 16) | (g << 8) | b;
+        __builtin_memcpy(pixels + j, &argb, sizeof(argb));
+    }
+}
+
+// Writes the pixels of one line of the image into scanline, with y counted from the top of the macroblocks.
+static void compose_scanline(JPEGLoadingContext const& context, Vector<Macroblock> const& macroblocks, u32 y, ARGB32* scanline)
+{
+    const u32 block_row = y / 8;
+    const u32 pixel_row = y % 8;
+
+    if (!is_ycbcr(context)) {
         for (u32 x = 0; x < context.frame.width; x++) {
             const u32 block_column = x / 8;
             auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
             const u32 pixel_column = x % 8;
             const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+            scanline[x] = Color((u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index]).value();
         }
+        return;
+    }
+
+    // The chroma of an MCU is stored in its first macroblock.
+    const u32 vfactor_i = block_row % context.vsample_factor;
+    const u32 chroma_pxrow = (pixel_row / context.vsample_factor) + 4 * vfactor_i;
+    for (u32 block_column = 0; block_column * 8 < context.frame.width; block_column++) {
+        const u32 hfactor_i = block_column % context.hsample_factor;
+        auto const& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
+        auto const& chroma = macroblocks[(block_row - vfactor_i) * context.mblock_meta.hpadded_count + (block_column - hfactor_i)];
+        const u32 chroma_pixel = chroma_pxrow * 8 + 4 * hfactor_i;
+
+        Array<ARGB32, 8> pixels;
+        ycbcr_to_rgb_row(block.y + pixel_row * 8, chroma.cb + chroma_pixel, chroma.cr + chroma_pixel, context.hsample_factor, pixels.data());
+        auto const pixel_count = min(8u, context.frame.width - block_column * 8);
+        __builtin_memcpy(scanline + block_column * 8, pixels.data(), pixel_count * sizeof(ARGB32));
     }
+}
+
+// Writes the pixels of row_count rows of macroblocks into the bitmap, starting at the macroblock row first_row.
+static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock> const& macroblocks, u32 first_row, u32 row_count)
+{
+    u32 const first_y = first_row * 8;
+    u32 const end_y = min(first_y + row_count * 8, static_cast<u32>(context.frame.height));
+    u32 const scale = context.scale_denominator;
+
+    if (scale == 1) {
+        for (u32 y = first_y; y < end_y; y++)
+            compose_scanline(context, macroblocks, y - first_y, context.bitmap->scanline(y));
+        return {};
+    }
+
+    Vector<ARGB32> line;
+    TRY(line.try_resize(context.frame.width));
 
+    if (scale == 8) {
+        // Every macroblock was reduced to a single color by the inverse DCT, so one pixel of each is enough.
+        for (u32 y = first_y; y < end_y; y += scale) {
+            compose_scanline(context, macroblocks, y - first_y, line.data());
+            auto* scanline = context.bitmap->scanline(y / scale);
+            for (int x = 0; x < context.bitmap->width(); x++)
+                scanline[x] = line[x * scale];
+        }
+        return {};
+    }
+
+    // Otherwise, every pixel of the bitmap is the average of a square of scale by scale pixels. Since the scale divides
+    // the height of a macroblock, these squares never span macroblock rows that are composed separately.
+    // Red and blue are summed up in one word, 16 bits apart, so that at most 16 pixels never carry into each other.
+    struct Sum {
+        u32 red_and_blue { 0 };
+        u32 green { 0 };
+    };
+    Vector<Sum> sums;
+    TRY(sums.try_resize(context.bitmap->width()));
+    auto const scale_shift = count_trailing_zeroes(scale);
+
+    for (u32 y = first_y; y < end_y; y += scale) {
+        for (auto& sum : sums)
+            sum = {};
+        auto const line_count = min(scale, end_y - y);
+        for (u32 i = 0; i < line_count; i++) {
+            compose_scanline(context, macroblocks, y + i - first_y, line.data());
+            for (u32 x = 0; x < context.frame.width; x++) {
+                auto& sum = sums[x >> scale_shift];
+                sum.red_and_blue += line[x] & 0xff00ff;
+                sum.green += (line[x] >> 8) & 0xff;
+            }
+        }
+
+        auto* scanline = context.bitmap->scanline(y / scale);
+        for (int x = 0; x < context.bitmap->width(); x++) {
+            auto const pixel_count = min(scale, context.frame.width - x * scale) * line_count;
+            auto const average = [&](u32 sum) { return static_cast<u8>((sum + pixel_count / 2) / pixel_count); };
+            auto const& sum = sums[x];
+            scanline[x] = Color(average(sum.red_and_blue >> 16), average(sum.green), average(sum.red_and_blue & 0xffff)).value();
+        }
+    }
     return {};
 }
 
@@ -1817,14 +1949,53 @@ static ErrorOr<void> decode_header(JPEGLoadingContext& context)
     return {};
 }
 
-static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& context)
+static ErrorOr<void> convert_macroblocks_to_pixels(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 first_row, u32 row_count)
+{
+    TRY(dequantize(context, macroblocks, row_count));
+    inverse_dct(context, macroblocks, row_count);
+    TRY(handle_color_transform(context, macroblocks, row_count));
+    TRY(compose_bitmap(context, macroblocks, first_row, row_count));
+    return {};
+}
+
+static bool can_decode_scan_row_by_row(JPEGLoadingContext const& context)
+{
+    // Progressive frames and frames with a scan per component only have all coefficients of a block after the last scan.
+    if (is_progressive(context.frame.type) || context.current_scan.components.size() != context.components.size())
+        return false;
+
+    // The MCUs of a non-interleaved scan are only laid out in rows of macroblocks if the luma isn't subsampled.
+    return context.current_scan.are_components_interleaved() || (context.hsample_factor == 1 && context.vsample_factor == 1);
+}
+
+static ErrorOr<void> decode_scan_row_by_row(JPEGLoadingContext& context)
+{
+    // Only a single row of MCUs is kept, and turned into pixels as soon as it has been decoded.
+    Vector<Macroblock> macroblocks;
+    TRY(macroblocks.try_resize(context.mblock_meta.hpadded_count * context.vsample_factor));
+
+    return decode_huffman_stream(context, macroblocks, [&](u32 vcursor) -> ErrorOr<void> {
+        auto const row_count = min<u32>(context.vsample_factor, context.mblock_meta.vcount - vcursor);
+        TRY(convert_macroblocks_to_pixels(context, macroblocks, vcursor, row_count));
+        for (auto& macroblock : macroblocks)
+            macroblock = {};
+        return {};
+    });
+}
+
+static ErrorOr<void> decode_scans(JPEGLoadingContext& context)
 {
     // B.6 - Summary
     // See: Figure B.16 – Flow of compressed data syntax
     // This function handles the "Multi-scan" loop.
 
+    // Only allocated if the coefficients of the whole image have to be kept across scans.
     Vector<Macroblock> macroblocks;
-    TRY(macroblocks.try_resize(context.mblock_meta.padded_total));
+
+    // Incomplete data ends after the scan that it stops in, or before the marker that it stops at.
+    auto is_end_of_incomplete_data = [&] {
+        return context.allow_incomplete_data && (context.current_scan.huffman_stream.is_incomplete_and_exhausted() || context.stream->is_eof());
+    };
 
     Marker marker = TRY(read_marker_at_cursor(*context.stream));
     while (true) {
@@ -1832,14 +2003,24 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
             TRY(handle_miscellaneous_or_table(*context.stream, context, marker));
         } else if (marker == JPEG_SOS) {
             TRY(read_start_of_scan(*context.stream, context));
-            TRY(decode_huffman_stream(context, macroblocks));
-        } else if (marker == JPEG_EOI) {
-            return macroblocks;
-        } else {
+            if (macroblocks.is_empty() && can_decode_scan_row_by_row(context)) {
+                TRY(decode_scan_row_by_row(context));
+            } else {
+                if (macroblocks.is_empty())
+                    TRY(macroblocks.try_resize(context.mblock_meta.padded_total));
+                TRY(decode_huffman_stream(context, macroblocks));
+            }
+        } else if (marker != JPEG_EOI) {
             dbgln_if(JPEG_DEBUG, "Unexpected marker {:x}!", marker);
             return Error::from_string_literal("Unexpected marker");
         }
 
+        if (marker == JPEG_EOI || is_end_of_incomplete_data()) {
+            if (!macroblocks.is_empty())
+                TRY(convert_macroblocks_to_pixels(context, macroblocks, 0, context.mblock_meta.vcount));
+            return {};
+        }
+
         marker = TRY(read_marker_at_cursor(*context.stream));
     }
 }
@@ -1847,15 +2028,23 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
 static ErrorOr<void> decode_jpeg(JPEGLoadingContext& context)
 {
     TRY(decode_header(context));
-    auto macroblocks = TRY(construct_macroblocks(context));
-    TRY(dequantize(context, macroblocks));
-    inverse_dct(context, macroblocks);
-    TRY(handle_color_transform(context, macroblocks));
-    TRY(compose_bitmap(context, macroblocks));
-    context.stream.clear();
+    IntSize const bitmap_size { ceil_div(context.frame.width, context.scale_denominator), ceil_div(context.frame.height, context.scale_denominator) };
+    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, bitmap_size));
+    TRY(decode_scans(context));
     return {};
 }
 
+// Images can be decoded at 1/2, 1/4 or 1/8 of their size with a fraction of the memory. At 1/8, every macroblock is a
+// single pixel whose value is its DC coefficient, so there isn't even an inverse DCT to compute.
+static u16 scale_denominator_for_ideal_size(JPEGLoadingContext const& context, IntSize ideal_size)
+{
+    for (u16 denominator : { 8, 4, 2 }) {
+        if (ceil_div(context.frame.width, denominator) >= ideal_size.width() && ceil_div(context.frame.height, denominator) >= ideal_size.height())
+            return denominator;
+    }
+    return 1;
+}
+
 JPEGImageDecoderPlugin::JPEGImageDecoderPlugin(NonnullOwnPtr<FixedMemoryStream> stream)
 {
     m_context = make<JPEGLoadingContext>();
@@ -1868,10 +2057,10 @@ IntSize JPEGImageDecoderPlugin::size()
 {
     if (m_context->state == JPEGLoadingContext::State::Error)
         return {};
-    if (m_context->state >= JPEGLoadingContext::State::FrameDecoded)
-        return { m_context->frame.width, m_context->frame.height };
+    if (m_context->state < JPEGLoadingContext::State::FrameDecoded && decode_header(*m_context).is_error())
+        return {};
 
-    return {};
+    return { m_context->frame.width, m_context->frame.height };
 }
 
 void JPEGImageDecoderPlugin::set_volatile()
@@ -1926,7 +2115,7 @@ size_t JPEGImageDecoderPlugin::first_animated_frame_index()
     return 0;
 }
 
-ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index)
+ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (index > 0)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Invalid frame index");
@@ -1934,6 +2123,19 @@ ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index)
     if (m_context->state == JPEGLoadingContext::State::Error)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
 
+    TRY(decode_header(*m_context));
+    auto const scale_denominator = ideal_size.has_value() ? scale_denominator_for_ideal_size(*m_context, *ideal_size) : 1;
+    if (m_context->state == JPEGLoadingContext::State::BitmapDecoded && m_context->scale_denominator > scale_denominator) {
+        // The image was decoded at a smaller size before, so it has to be decoded again from the start.
+        auto stream = m_context->stream.release_nonnull();
+        TRY(stream->seek(0, SeekMode::SetPosition));
+        m_context = make<JPEGLoadingContext>();
+        m_context->stream = move(stream);
+        TRY(decode_header(*m_context));
+    }
+    if (m_context->state < JPEGLoadingContext::State::BitmapDecoded)
+        m_context->scale_denominator = scale_denominator;
+
     if (m_context->state < JPEGLoadingContext::State::BitmapDecoded) {
         if (auto result = decode_jpeg(*m_context); result.is_error()) {
             m_context->state = JPEGLoadingContext::State::Error;
@@ -1945,13 +2147,33 @@ ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index)
     return ImageFrameDescriptor { m_context->bitmap, 0 };
 }
 
+ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::incomplete_first_frame()
+{
+    if (m_context->state == JPEGLoadingContext::State::Error)
+        return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
+    if (m_context->state == JPEGLoadingContext::State::BitmapDecoded)
+        return ImageFrameDescriptor { m_context->bitmap, 0 };
+
+    m_context->allow_incomplete_data = true;
+    if (auto result = decode_jpeg(*m_context); result.is_error()) {
+        m_context->state = JPEGLoadingContext::State::Error;
+        return result.release_error();
+    }
+    m_context->state = JPEGLoadingContext::State::BitmapDecoded;
+    return ImageFrameDescriptor { m_context->bitmap, 0 };
+}
+
 ErrorOr<Optional<ReadonlyBytes>> JPEGImageDecoderPlugin::icc_data()
 {
     TRY(decode_header(*m_context));
 
-    if (m_context->icc_data.has_value())
-        return *m_context->icc_data;
+    if (!m_icc_data.has_value() && m_context->icc_data.has_value())
+        m_icc_data = m_context->icc_data.release_value();
+    if (m_icc_data.has_value())
+        return *m_icc_data;
     return OptionalNone {};
 }
 
 }
+
+#pragma GCC diagnostic pop
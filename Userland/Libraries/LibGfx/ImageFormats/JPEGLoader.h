@@ -30,13 +30,18 @@ public:
     virtual size_t loop_count() override;
     virtual size_t frame_count() override;
     virtual size_t first_animated_frame_index() override;
-    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
+    virtual ErrorOr<ImageFrameDescriptor> incomplete_first_frame() override;
 
 private:
     JPEGImageDecoderPlugin(NonnullOwnPtr<FixedMemoryStream>);
 
     OwnPtr<JPEGLoadingContext> m_context;
+
+    // Owned by the plugin rather than the context, so that the bytes returned by icc_data() stay valid when the
+    // context is replaced to decode the image again at a larger size.
+    Optional<ByteBuffer> m_icc_data;
 };
 
 }
@@ -292,10 +292,71 @@ union [[gnu::packed]] Pixel {
 };
 static_assert(AssertSize<Pixel, 4>());
 
+template<size_t bytes_per_complete_pixel>
+ALWAYS_INLINE static AK::SIMD::u8x4 load_pixel(u8 const* data)
+{
+    AK::SIMD::u8x4 pixel {};
+    __builtin_memcpy(&pixel, data, bytes_per_complete_pixel);
+    return pixel;
+}
+
+template<size_t bytes_per_complete_pixel>
+ALWAYS_INLINE static void store_pixel(u8* data, AK::SIMD::u8x4 pixel)
+{
+    __builtin_memcpy(data, &pixel, bytes_per_complete_pixel);
+}
+
+// Unfilters 8-bit RGB and RGBA scanlines a whole pixel at a time. Each pixel depends on the one to its left, so
+// this is as wide as the Sub, Average and Paeth filters can be undone.
+template<size_t bytes_per_complete_pixel>
+static void unfilter_scanline_by_pixel(PNG::FilterType filter, Bytes scanline_data, ReadonlyBytes previous_scanlines_data)
+{
+    static_assert(bytes_per_complete_pixel <= sizeof(AK::SIMD::u8x4));
+    VERIFY(scanline_data.size() % bytes_per_complete_pixel == 0);
+
+    AK::SIMD::u8x4 left {};
+    switch (filter) {
+    case PNG::FilterType::Sub:
+        for (size_t i = 0; i < scanline_data.size(); i += bytes_per_complete_pixel) {
+            left += load_pixel<bytes_per_complete_pixel>(&scanline_data[i]);
+            store_pixel<bytes_per_complete_pixel>(&scanline_data[i], left);
+        }
+        break;
+    case PNG::FilterType::Average:
+        for (size_t i = 0; i < scanline_data.size(); i += bytes_per_complete_pixel) {
+            auto above = load_pixel<bytes_per_complete_pixel>(&previous_scanlines_data[i]);
+            // Rounds down like (left + above) / 2, without needing nine bits.
+            auto average = (left & above) + ((left ^ above) >> 1);
+            left = load_pixel<bytes_per_complete_pixel>(&scanline_data[i]) + average;
+            store_pixel<bytes_per_complete_pixel>(&scanline_data[i], left);
+        }
+        break;
+    case PNG::FilterType::Paeth: {
+        AK::SIMD::u8x4 upper_left {};
+        for (size_t i = 0; i < scanline_data.size(); i += bytes_per_complete_pixel) {
+            auto above = load_pixel<bytes_per_complete_pixel>(&previous_scanlines_data[i]);
+            left = load_pixel<bytes_per_complete_pixel>(&scanline_data[i]) + PNG::paeth_predictor(left, above, upper_left);
+            store_pixel<bytes_per_complete_pixel>(&scanline_data[i], left);
+            upper_left = above;
+        }
+        break;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
 static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, ReadonlyBytes previous_scanlines_data, u8 bytes_per_complete_pixel)
 {
     VERIFY(filter != PNG::FilterType::None);
 
+    if (filter != PNG::FilterType::Up) {
+        if (bytes_per_complete_pixel == 4)
+            return unfilter_scanline_by_pixel<4>(filter, scanline_data, previous_scanlines_data);
+        if (bytes_per_complete_pixel == 3)
+            return unfilter_scanline_by_pixel<3>(filter, scanline_data, previous_scanlines_data);
+    }
+
     switch (filter) {
     case PNG::FilterType::Sub:
         // This loop starts at bytes_per_complete_pixel because all bytes before that are
@@ -410,8 +471,45 @@ ALWAYS_INLINE static void unpack_triplets_with_transparency_value(PNGLoadingCont
     }
 }
 
+static void swap_red_and_blue(ARGB32* pixels, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        auto pixel = pixels[i];
+        pixels[i] = (pixel & 0xff00ff00) | ((pixel & 0xff) << 16) | ((pixel >> 16) & 0xff);
+    }
+}
+
+// 8-bit RGBA scanlines already have the layout of the bitmap's rows, apart from the order of the channels. So they are
+// unfiltered right in the bitmap, without a copy of the whole image in between. The row above has to stay in PNG's
+// channel order while a row is being unfiltered, which is why red and blue are swapped one row behind.
+static ErrorOr<void> unfilter_into_bitmap(PNGLoadingContext& context)
+{
+    auto& bitmap = *context.bitmap;
+    auto bytes_per_scanline = context.scanlines[0].data.size();
+    VERIFY(bytes_per_scanline == bitmap.width() * sizeof(ARGB32));
+
+    auto dummy_scanline = TRY(ByteBuffer::create_zeroed(bytes_per_scanline));
+    ReadonlyBytes previous_scanline_data = dummy_scanline;
+
+    for (int y = 0; y < context.height; ++y) {
+        Bytes scanline_data { bitmap.scanline_u8(y), bytes_per_scanline };
+        context.scanlines[y].data.copy_to(scanline_data);
+        if (context.scanlines[y].filter != PNG::FilterType::None)
+            unfilter_scanline(context.scanlines[y].filter, scanline_data, previous_scanline_data, sizeof(ARGB32));
+
+        if (y > 0)
+            swap_red_and_blue(bitmap.scanline(y - 1), bitmap.width());
+        previous_scanline_data = scanline_data;
+    }
+    swap_red_and_blue(bitmap.scanline(context.height - 1), bitmap.width());
+    return {};
+}
+
 NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
 {
+    if (context.color_type == PNG::ColorType::TruecolorWithAlpha && context.bit_depth == 8)
+        return unfilter_into_bitmap(context);
+
     // First unfilter the scanlines:
 
     // FIXME: Instead of creating a separate buffer for the scanlines that need to be
@@ -510,11 +608,7 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         }
         break;
     case PNG::ColorType::TruecolorWithAlpha:
-        if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
-        } else if (context.bit_depth == 16) {
+        if (context.bit_depth == 16) {
             for (int y = 0; y < context.height; ++y) {
                 auto* quartets = reinterpret_cast<Quartet<u16> const*>(context.scanlines[y].data.data());
                 for (int i = 0; i < context.width; ++i) {
@@ -578,13 +672,8 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
     }
 
     // Swap r and b values:
-    for (int y = 0; y < context.height; ++y) {
-        auto* pixels = (Pixel*)context.bitmap->scanline(y);
-        for (int i = 0; i < context.bitmap->width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
+    for (int y = 0; y < context.height; ++y)
+        swap_red_and_blue(context.bitmap->scanline(y), context.bitmap->width());
 
     return {};
 }
@@ -1407,7 +1496,7 @@ static ErrorOr<RefPtr<Bitmap>> render_animation_frame(AnimationFrame const& prev
     return rendered_bitmap;
 }
 
-ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index)
+ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
 {
     if (m_context->state == PNGLoadingContext::State::Error)
         return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
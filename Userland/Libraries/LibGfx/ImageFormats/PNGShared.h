@@ -48,12 +48,23 @@ ALWAYS_INLINE u8 paeth_predictor(u8 a, u8 b, u8 c)
 
 ALWAYS_INLINE AK::SIMD::u8x4 paeth_predictor(AK::SIMD::u8x4 a, AK::SIMD::u8x4 b, AK::SIMD::u8x4 c)
 {
-    return AK::SIMD::u8x4 {
-        paeth_predictor(a[0], b[0], c[0]),
-        paeth_predictor(a[1], b[1], c[1]),
-        paeth_predictor(a[2], b[2], c[2]),
-        paeth_predictor(a[3], b[3], c[3]),
+    // Same as the scalar version for each lane, but without branches. With p = a + b - c, the distances
+    // |p - a|, |p - b| and |p - c| are |b - c|, |a - c| and |a + b - 2c|.
+    auto a16 = __builtin_convertvector(a, AK::SIMD::i16x4);
+    auto b16 = __builtin_convertvector(b, AK::SIMD::i16x4);
+    auto c16 = __builtin_convertvector(c, AK::SIMD::i16x4);
+    auto abs = [](AK::SIMD::i16x4 v) {
+        auto sign = v >> 15;
+        return (v ^ sign) - sign;
     };
+    auto pa = abs(b16 - c16);
+    auto pb = abs(a16 - c16);
+    auto pc = abs(a16 + b16 - c16 - c16);
+
+    auto use_a = (pa <= pb) & (pa <= pc);
+    auto use_b = ~use_a & (pb <= pc);
+    auto use_c = ~use_a & ~use_b;
+    return __builtin_convertvector((a16 & use_a) | (b16 & use_b) | (c16 & use_c), AK::SIMD::u8x4);
 }
 
 };
@@ -14,6 +14,8 @@
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageFormats/PNGWriter.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 
 #pragma GCC diagnostic ignored "-Wpsabi"
 
@@ -167,82 +169,68 @@ union [[gnu::packed]] Pixel {
 };
 static_assert(AssertSize<Pixel, 4>());
 
-ErrorOr<void> PNGWriter::add_IDAT_chunk(Gfx::Bitmap const& bitmap)
+// Filters the rows in [first_y, end_y) of the bitmap, and puts them (prefixed with their filter type) at their place in the image data.
+static ErrorOr<void> filter_rows(Gfx::Bitmap const& bitmap, int first_y, int end_y, Bytes image_data)
 {
-    PNGChunk png_chunk { "IDAT"_short_string };
-    TRY(png_chunk.reserve(bitmap.size_in_bytes()));
-
-    ByteBuffer uncompressed_block_data;
-    TRY(uncompressed_block_data.try_ensure_capacity(bitmap.size_in_bytes() + bitmap.height()));
-
-    auto dummy_scanline = TRY(FixedArray<Pixel>::create(bitmap.width()));
-    auto const* scanline_minus_1 = dummy_scanline.data();
-
-    for (int y = 0; y < bitmap.height(); ++y) {
+    auto const width = static_cast<size_t>(bitmap.width());
+    auto const row_size = 1 + width * sizeof(Pixel);
+
+    auto dummy_scanline = TRY(FixedArray<Pixel>::create(width));
+    // One filtered row for each filter type, in the order of PNG::FilterType.
+    auto filtered_rows = TRY(FixedArray<AK::SIMD::u8x4>::create(5 * width));
+    auto* none_row = filtered_rows.data();
+    auto* sub_row = none_row + width;
+    auto* up_row = sub_row + width;
+    auto* average_row = up_row + width;
+    auto* paeth_row = average_row + width;
+
+    for (int y = first_y; y < end_y; ++y) {
         auto* scanline = reinterpret_cast<Pixel const*>(bitmap.scanline(y));
+        auto* scanline_minus_1 = y == 0 ? dummy_scanline.data() : reinterpret_cast<Pixel const*>(bitmap.scanline(y - 1));
 
-        struct Filter {
-            PNG::FilterType type;
-            ByteBuffer buffer {};
-            int sum = 0;
-
-            ErrorOr<void> append(u8 byte)
-            {
-                TRY(buffer.try_append(byte));
-                sum += static_cast<i8>(byte);
-                return {};
-            }
-
-            ErrorOr<void> append(AK::SIMD::u8x4 simd)
-            {
-                TRY(append(simd[0]));
-                TRY(append(simd[1]));
-                TRY(append(simd[2]));
-                TRY(append(simd[3]));
-                return {};
-            }
+        // The sums of the filtered bytes, each taken as a signed difference, for each channel.
+        AK::SIMD::i32x4 none_sum {}, sub_sum {}, up_sum {}, average_sum {}, paeth_sum {};
+        auto add_to_sum = [](AK::SIMD::i32x4& sum, AK::SIMD::u8x4 filtered) {
+            sum += AK::SIMD::to_i32x4(bit_cast<AK::SIMD::i8x4>(filtered));
         };
 
-        Filter none_filter { .type = PNG::FilterType::None };
-        TRY(none_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.height()));
-
-        Filter sub_filter { .type = PNG::FilterType::Sub };
-        TRY(sub_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.height()));
-
-        Filter up_filter { .type = PNG::FilterType::Up };
-        TRY(up_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.height()));
-
-        Filter average_filter { .type = PNG::FilterType::Average };
-        TRY(average_filter.buffer.try_ensure_capacity(sizeof(ARGB32) * bitmap.height()));
-
-        Filter paeth_filter { .type = PNG::FilterType::Paeth };
-        TRY(paeth_filter.buffer.try_ensure_capacity(sizeof(ARGB32) * bitmap.height()));
-
         auto pixel_x_minus_1 = Pixel::gfx_to_png(dummy_scanline[0]);
         auto pixel_xy_minus_1 = Pixel::gfx_to_png(dummy_scanline[0]);
 
-        for (int x = 0; x < bitmap.width(); ++x) {
+        for (size_t x = 0; x < width; ++x) {
             auto pixel = Pixel::gfx_to_png(scanline[x]);
             auto pixel_y_minus_1 = Pixel::gfx_to_png(scanline_minus_1[x]);
 
-            TRY(none_filter.append(pixel));
+            none_row[x] = pixel;
+            add_to_sum(none_sum, none_row[x]);
 
-            TRY(sub_filter.append(pixel - pixel_x_minus_1));
+            sub_row[x] = pixel - pixel_x_minus_1;
+            add_to_sum(sub_sum, sub_row[x]);
 
-            TRY(up_filter.append(pixel - pixel_y_minus_1));
+            up_row[x] = pixel - pixel_y_minus_1;
+            add_to_sum(up_sum, up_row[x]);
 
             // The sum Orig(a) + Orig(b) shall be performed without overflow (using at least nine-bit arithmetic).
             auto sum = AK::SIMD::to_u16x4(pixel_x_minus_1) + AK::SIMD::to_u16x4(pixel_y_minus_1);
             auto average = AK::SIMD::to_u8x4(sum / 2);
-            TRY(average_filter.append(pixel - average));
+            average_row[x] = pixel - average;
+            add_to_sum(average_sum, average_row[x]);
 
-            TRY(paeth_filter.append(pixel - PNG::paeth_predictor(pixel_x_minus_1, pixel_y_minus_1, pixel_xy_minus_1)));
+            paeth_row[x] = pixel - PNG::paeth_predictor(pixel_x_minus_1, pixel_y_minus_1, pixel_xy_minus_1);
+            add_to_sum(paeth_sum, paeth_row[x]);
 
             pixel_x_minus_1 = pixel;
             pixel_xy_minus_1 = pixel_y_minus_1;
         }
 
-        scanline_minus_1 = scanline;
+        auto horizontal_sum = [](AK::SIMD::i32x4 sum) { return sum[0] + sum[1] + sum[2] + sum[3]; };
+        Array<int, 5> sums {
+            horizontal_sum(none_sum),
+            horizontal_sum(sub_sum),
+            horizontal_sum(up_sum),
+            horizontal_sum(average_sum),
+            horizontal_sum(paeth_sum),
+        };
 
         // 12.8 Filter selection: https://www.w3.org/TR/PNG/#12Filter-selection
         // For best compression of truecolour and greyscale images, the recommended approach
@@ -250,21 +238,75 @@ ErrorOr<void> PNGWriter::add_IDAT_chunk(Gfx::Bitmap const& bitmap)
         // The following simple heuristic has performed well in early tests:
         // compute the output scanline using all five filters, and select the filter that gives the smallest sum of absolute values of outputs.
         // (Consider the output bytes as signed differences for this test.)
-        Filter& best_filter = none_filter;
-        if (abs(best_filter.sum) > abs(sub_filter.sum))
-            best_filter = sub_filter;
-        if (abs(best_filter.sum) > abs(up_filter.sum))
-            best_filter = up_filter;
-        if (abs(best_filter.sum) > abs(average_filter.sum))
-            best_filter = average_filter;
-        if (abs(best_filter.sum) > abs(paeth_filter.sum))
-            best_filter = paeth_filter;
-
-        TRY(uncompressed_block_data.try_append(to_underlying(best_filter.type)));
-        TRY(uncompressed_block_data.try_append(best_filter.buffer));
+        size_t best_filter = 0;
+        for (size_t filter = 1; filter < sums.size(); ++filter) {
+            if (abs(sums[best_filter]) > abs(sums[filter]))
+                best_filter = filter;
+        }
+
+        auto output_row = image_data.slice(y * row_size, row_size);
+        output_row[0] = static_cast<u8>(best_filter);
+        ReadonlyBytes { filtered_rows.data() + best_filter * width, width * sizeof(Pixel) }.copy_to(output_row.slice(1));
+    }
+    return {};
+}
+
+// Filters bands of rows on separate threads. The filter of each row only depends on the bitmap, so the bands are independent.
+static ErrorOr<void> filter_rows_in_parallel(Gfx::Bitmap const& bitmap, Bytes image_data, size_t thread_count)
+{
+    auto band_height = ceil_div(bitmap.height(), static_cast<int>(thread_count));
+
+    Threading::Mutex mutex;
+    Optional<Error> error;
+    auto filter_band = [&](int first_y) -> intptr_t {
+        auto result = filter_rows(bitmap, first_y, min(first_y + band_height, bitmap.height()), image_data);
+        if (result.is_error()) {
+            Threading::MutexLocker locker(mutex);
+            if (!error.has_value())
+                error = result.release_error();
+        }
+        return 0;
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    auto start_threads = [&]() -> ErrorOr<void> {
+        for (int first_y = band_height; first_y < bitmap.height(); first_y += band_height) {
+            auto thread = TRY(Threading::Thread::try_create([&filter_band, first_y] { return filter_band(first_y); }, "PNG filter"sv));
+            TRY(threads.try_append(thread));
+            thread->start();
+        }
+        return {};
+    };
+
+    // The first band is filtered on this thread.
+    auto result = start_threads();
+    if (!result.is_error())
+        filter_band(0);
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    TRY(result);
+    if (error.has_value())
+        return error.release_value();
+    return {};
+}
+
+ErrorOr<void> PNGWriter::add_IDAT_chunk(Gfx::Bitmap const& bitmap, size_t thread_count)
+{
+    PNGChunk png_chunk { "IDAT"_short_string };
+    TRY(png_chunk.reserve(bitmap.size_in_bytes()));
+
+    auto uncompressed_block_data = TRY(ByteBuffer::create_uninitialized((1 + bitmap.width() * sizeof(Pixel)) * bitmap.height()));
+
+    thread_count = clamp<size_t>(thread_count, 1, bitmap.height());
+    if (thread_count == 1) {
+        TRY(filter_rows(bitmap, 0, bitmap.height(), uncompressed_block_data));
+        TRY(png_chunk.compress_and_add(uncompressed_block_data));
+    } else {
+        TRY(filter_rows_in_parallel(bitmap, uncompressed_block_data, thread_count));
+        TRY(png_chunk.add(TRY(Compress::ZlibCompressor::compress_all_in_parallel(uncompressed_block_data, thread_count, Compress::ZlibCompressionLevel::Best))));
     }
 
-    TRY(png_chunk.compress_and_add(uncompressed_block_data));
     TRY(add_chunk(png_chunk));
     return {};
 }
@@ -276,7 +318,7 @@ ErrorOr<ByteBuffer> PNGWriter::encode(Gfx::Bitmap const& bitmap, Options options
     TRY(writer.add_IHDR_chunk(bitmap.width(), bitmap.height(), 8, PNG::ColorType::TruecolorWithAlpha, 0, 0, 0));
     if (options.icc_data.has_value())
         TRY(writer.add_iCCP_chunk(options.icc_data.value()));
-    TRY(writer.add_IDAT_chunk(bitmap));
+    TRY(writer.add_IDAT_chunk(bitmap, options.thread_count));
     TRY(writer.add_IEND_chunk());
     return ByteBuffer::copy(writer.m_data);
 }
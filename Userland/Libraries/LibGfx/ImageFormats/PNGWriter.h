@@ -21,6 +21,10 @@ struct PNGWriterOptions {
     // Data for the iCCP chunk.
     // FIXME: Allow writing cICP, sRGB, or gAMA instead too.
     Optional<ReadonlyBytes> icc_data;
+
+    // The image is filtered and compressed on this many threads. With more than one thread, the compressed data is
+    // split into chunks that each end their last deflate block early, which makes the output slightly larger.
+    size_t thread_count { 1 };
 };
 
 class PNGWriter {
@@ -37,7 +41,7 @@ private:
     ErrorOr<void> add_png_header();
     ErrorOr<void> add_IHDR_chunk(u32 width, u32 height, u8 bit_depth, PNG::ColorType color_type, u8 compression_method, u8 filter_method, u8 interlace_method);
     ErrorOr<void> add_iCCP_chunk(ReadonlyBytes icc_data);
-    ErrorOr<void> add_IDAT_chunk(Gfx::Bitmap const&);
+    ErrorOr<void> add_IDAT_chunk(Gfx::Bitmap const&, size_t thread_count);
     ErrorOr<void> add_IEND_chunk();
 };
 
@@ -51,7 +51,7 @@ public:
     virtual size_t loop_count() override { return 0; }
     virtual size_t frame_count() override { return 1; }
     virtual size_t first_animated_frame_index() override { return 0; }
-    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
 
 private:
@@ -12,8 +12,10 @@
 
 #include "Painter.h"
 #include "Bitmap.h"
+#include "Blending.h"
 #include "Font/Emoji.h"
 #include "Font/Font.h"
+#include "Font/ScaledFont.h"
 #include "Gamma.h"
 #include <AK/Assertions.h>
 #include <AK/Debug.h>
@@ -122,8 +124,7 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_argb(dst[j]).blend(color).value();
+        blend_pixels({ dst, static_cast<size_t>(physical_rect.width()) }, color);
         dst += dst_skip;
     }
 }
@@ -816,62 +817,6 @@ void Painter::draw_triangle(IntPoint a, IntPoint b, IntPoint c, Color color)
     }
 }
 
-struct BlitState {
-    enum AlphaState {
-        NoAlpha = 0,
-        SrcAlpha = 1,
-        DstAlpha = 2,
-        BothAlpha = SrcAlpha | DstAlpha
-    };
-
-    ARGB32 const* src;
-    ARGB32* dst;
-    size_t src_pitch;
-    size_t dst_pitch;
-    int row_count;
-    int column_count;
-    float opacity;
-    BitmapFormat src_format;
-};
-
-// FIXME: This is a hack to support blit_with_opacity() with RGBA8888 source.
-//        Ideally we'd have a more generic solution that allows any source format.
-static void swap_red_and_blue_channels(Color& color)
-{
-    u32 rgba = color.value();
-    u32 bgra = (rgba & 0xff00ff00)
-        | ((rgba & 0x000000ff) << 16)
-        | ((rgba & 0x00ff0000) >> 16);
-    color = Color::from_argb(bgra);
-}
-
-// FIXME: This function is very unoptimized.
-template<BlitState::AlphaState has_alpha>
-static void do_blit_with_opacity(BlitState& state)
-{
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_argb(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_argb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
-        }
-        state.dst += state.dst_pitch;
-        state.src += state.src_pitch;
-    }
-}
-
 void Painter::blit_with_opacity(IntPoint position, Gfx::Bitmap const& source, IntRect const& a_src_rect, float opacity, bool apply_alpha)
 {
     VERIFY(scale() >= source.scale() && "painter doesn't support downsampling scale factors");
@@ -898,27 +843,32 @@ void Painter::blit_with_opacity(IntPoint position, Gfx::Bitmap const& source, In
     int const first_column = clipped_rect.left() - dst_rect.left();
     int const last_column = clipped_rect.right() - dst_rect.left();
 
-    BlitState blit_state {
-        .src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column,
-        .dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x(),
-        .src_pitch = source.pitch() / sizeof(ARGB32),
-        .dst_pitch = m_target->pitch() / sizeof(ARGB32),
-        .row_count = last_row - first_row + 1,
-        .column_count = last_column - first_column + 1,
-        .opacity = opacity,
-        .src_format = source.format(),
+    // The alpha a source pixel is blended with only depends on its own alpha, so work it out once for each value.
+    BlendWithOpacityOptions options {
+        .alpha_map = {},
+        .swap_red_and_blue = source.format() == BitmapFormat::RGBA8888,
+        .opaque_destination = !m_target->has_alpha_channel(),
     };
+    bool const use_source_alpha = source.has_alpha_channel() && apply_alpha;
+    for (size_t alpha = 0; alpha < options.alpha_map.size(); ++alpha) {
+        if (use_source_alpha) {
+            float pixel_opacity = alpha / 255.0;
+            options.alpha_map[alpha] = 255 * (opacity * pixel_opacity);
+        } else {
+            options.alpha_map[alpha] = opacity * 255;
+        }
+    }
 
-    if (source.has_alpha_channel() && apply_alpha) {
-        if (m_target->has_alpha_channel())
-            do_blit_with_opacity<BlitState::BothAlpha>(blit_state);
-        else
-            do_blit_with_opacity<BlitState::SrcAlpha>(blit_state);
-    } else {
-        if (m_target->has_alpha_channel())
-            do_blit_with_opacity<BlitState::DstAlpha>(blit_state);
-        else
-            do_blit_with_opacity<BlitState::NoAlpha>(blit_state);
+    ARGB32 const* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
+    ARGB32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
+    size_t const src_skip = source.pitch() / sizeof(ARGB32);
+    size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
+    size_t const column_count = last_column - first_column + 1;
+
+    for (int row = first_row; row <= last_row; ++row) {
+        blend_pixels({ dst, column_count }, { src, column_count }, options);
+        dst += dst_skip;
+        src += src_skip;
     }
 }
 
@@ -1201,12 +1151,21 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
     i64 clipped_src_bottom_shifted = (clipped_src_rect.y() + clipped_src_rect.height()) * shift;
     i64 clipped_src_right_shifted = (clipped_src_rect.x() + clipped_src_rect.width()) * shift;
 
+    // With an alpha channel, each row is sampled first and then blended all at once. The sampled pixels are contiguous,
+    // as the ones that fall outside of the source can only be at either end of the row.
+    Vector<ARGB32> sampled_row;
+    if constexpr (has_alpha_channel)
+        sampled_row.ensure_capacity(clipped_rect.width());
+
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
         auto* scanline = (Color*)target.scanline(y);
         auto desired_y = ((y - dst_rect.y()) * vscale + src_top);
         if (desired_y < clipped_src_rect.top() || desired_y > clipped_src_bottom_shifted)
             continue;
 
+        int first_sampled_x = 0;
+        sampled_row.clear_with_capacity();
+
         for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
             auto desired_x = ((x - dst_rect.x()) * hscale + src_left);
             if (desired_x < clipped_src_rect.left() || desired_x > clipped_src_right_shifted)
@@ -1264,11 +1223,16 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
             if (has_opacity)
                 src_pixel.set_alpha(src_pixel.alpha() * opacity);
             if constexpr (has_alpha_channel) {
-                scanline[x] = scanline[x].blend(src_pixel);
+                if (sampled_row.is_empty())
+                    first_sampled_x = x;
+                sampled_row.unchecked_append(src_pixel.value());
             } else {
                 scanline[x] = src_pixel;
             }
         }
+
+        if constexpr (has_alpha_channel)
+            blend_pixels({ target.scanline(y) + first_sampled_x, sampled_row.size() }, sampled_row);
     }
 }
 
@@ -1401,23 +1365,28 @@ void Painter::draw_glyph_or_emoji(FloatPoint point, u32 code_point, Font const&
     return draw_glyph_or_emoji(point, it, font, color);
 }
 
+// Discards the code point after the one at the iterator if it's a variation selector.
+static void skip_variation_selector(Utf8CodePointIterator& it)
+{
+    static auto const variation_selector = Unicode::property_from_string("Variation_Selector"sv);
+    if (!variation_selector.has_value())
+        return;
+
+    auto next_code_point = it.peek(1);
+    if (next_code_point.has_value() && Unicode::code_point_has_property(*next_code_point, *variation_selector))
+        ++it;
+}
+
 void Painter::draw_glyph_or_emoji(FloatPoint point, Utf8CodePointIterator& it, Font const& font, Color color)
 {
     u32 code_point = *it;
-    auto next_code_point = it.peek(1);
 
     ScopeGuard consume_variation_selector = [&, initial_it = it] {
-        static auto const variation_selector = Unicode::property_from_string("Variation_Selector"sv);
-        if (!variation_selector.has_value())
-            return;
-
         // If we advanced the iterator to consume an emoji sequence, don't look for another variation selector.
         if (initial_it != it)
             return;
 
-        // Otherwise, discard one code point if it's a variation selector.
-        if (next_code_point.has_value() && Unicode::code_point_has_property(*next_code_point, *variation_selector))
-            ++it;
+        skip_variation_selector(it);
     };
 
     // NOTE: We don't check for emoji
@@ -2488,6 +2457,17 @@ void Painter::draw_text_run(FloatPoint baseline_start, Utf8View const& string, F
     auto point = baseline_start;
     point.translate_by(0, -font.pixel_metrics().ascent);
 
+    // Plain text glyphs of vector fonts are collected into runs, which are drawn straight from the glyph atlas.
+    // Anything that may turn out to be an emoji is left to draw_glyph_or_emoji().
+    auto const* scaled_font = font.is_scaled_font() && !font.has_color_bitmaps() ? static_cast<ScaledFont const*>(&font) : nullptr;
+    Vector<PositionedGlyph, 64> glyph_run;
+    auto flush_glyph_run = [&] {
+        if (glyph_run.is_empty())
+            return;
+        draw_glyph_run(glyph_run, *scaled_font, color);
+        glyph_run.clear_with_capacity();
+    };
+
     for (auto code_point_iterator = string.begin(); code_point_iterator != string.end(); ++code_point_iterator) {
         auto code_point = *code_point_iterator;
         if (should_paint_as_space(code_point)) {
@@ -2503,11 +2483,55 @@ void Painter::draw_text_run(FloatPoint baseline_start, Utf8View const& string, F
         auto it = code_point_iterator; // The callback function will advance the iterator, so create a copy for this lookup.
         auto glyph_width = font.glyph_or_emoji_width(it) + font.glyph_spacing();
 
-        draw_glyph_or_emoji(point, code_point_iterator, font, color);
+        if (scaled_font && font.contains_glyph(code_point) && !Unicode::could_be_start_of_emoji_sequence(code_point_iterator, Unicode::SequenceType::EmojiPresentation)) {
+            glyph_run.append({ scaled_font->glyph_id_for_code_point(code_point), point });
+            skip_variation_selector(code_point_iterator);
+        } else {
+            flush_glyph_run();
+            draw_glyph_or_emoji(point, code_point_iterator, font, color);
+        }
 
         point.translate_by(glyph_width, 0);
         last_code_point = code_point;
     }
+
+    flush_glyph_run();
+}
+
+void Painter::draw_glyph_run(ReadonlySpan<PositionedGlyph> glyphs, ScaledFont const& font, Color color)
+{
+    VERIFY(!font.has_color_bitmaps());
+
+    for (auto const& glyph : glyphs) {
+        auto top_left = glyph.position + FloatPoint(font.glyph_metrics(glyph.glyph_id).left_side_bearing, 0);
+        auto glyph_position = GlyphRasterPosition::get_nearest_fit_for(top_left);
+
+        // The atlas holds glyphs at the font's own size, so scaled painters draw them the way draw_glyph() does.
+        auto entry = scale() == 1 ? font.glyph_atlas_entry(glyph.glyph_id, glyph_position.subpixel_offset) : Optional<GlyphAtlas::Entry> {};
+        if (!entry.has_value()) {
+            if (auto bitmap = font.rasterize_glyph(glyph.glyph_id, glyph_position.subpixel_offset)) {
+                blit_filtered(glyph_position.blit_position, *bitmap, bitmap->rect(), [color](Color pixel) -> Color {
+                    return pixel.multiply(color);
+                });
+            }
+            continue;
+        }
+        if (!entry->page)
+            continue;
+
+        auto dst_rect = IntRect(glyph_position.blit_position, entry->rect.size()).translated(translation());
+        auto clipped_rect = dst_rect.intersected(clip_rect());
+        if (clipped_rect.is_empty())
+            continue;
+
+        auto source_location = entry->rect.location() + (clipped_rect.location() - dst_rect.location());
+        auto width = static_cast<size_t>(clipped_rect.width());
+        for (int row = 0; row < clipped_rect.height(); ++row) {
+            auto* dst = m_target->scanline(clipped_rect.y() + row) + clipped_rect.x();
+            auto const* coverage = entry->page->scanline(source_location.y() + row) + source_location.x();
+            blend_coverage({ dst, width }, { coverage, width }, color);
+        }
+    }
 }
 
 void Painter::draw_scaled_bitmap_with_transform(IntRect const& dst_rect, Bitmap const& bitmap, FloatRect const& src_rect, AffineTransform const& transform, float opacity, Painter::ScalingMode scaling_mode)
@@ -27,6 +27,12 @@
 
 namespace Gfx {
 
+// A glyph of a run that was already shaped, at the position that draw_glyph() would be given for its code point.
+struct PositionedGlyph {
+    u32 glyph_id;
+    FloatPoint position;
+};
+
 class Painter {
 public:
     static constexpr int LINE_SPACING = 4;
@@ -119,6 +125,8 @@ public:
     // Streamlined text drawing routine that does no wrapping/elision/alignment.
     void draw_text_run(IntPoint baseline_start, Utf8View const&, Font const&, Color);
     void draw_text_run(FloatPoint baseline_start, Utf8View const&, Font const&, Color);
+    // Draws a run of glyphs of one font, blending their coverage straight from the shared glyph atlas.
+    void draw_glyph_run(ReadonlySpan<PositionedGlyph>, ScaledFont const&, Color);
 
     enum class CornerOrientation {
         TopLeft,
@@ -226,10 +234,8 @@ private:
         PlaceOnIntGrid,
         AllowFloatingPoints,
     };
-    template<typename T, typename TColorOrFunction>
-    void draw_scanline_for_fill_path(int y, T x_start, T x_end, TColorOrFunction color);
     template<FillPathMode fill_path_mode, typename ColorOrFunction>
-    void fill_path_impl(Path const& path, ColorOrFunction color, Gfx::Painter::WindingRule winding_rule, Optional<FloatPoint> offset = {});
+    void fill_path_impl(Path const& path, ColorOrFunction color, Gfx::Painter::WindingRule winding_rule, FloatPoint offset = {});
 };
 
 class PainterStateSaver {
@@ -7,7 +7,6 @@
 #include <AK/Function.h>
 #include <AK/HashTable.h>
 #include <AK/Math.h>
-#include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Path.h>
@@ -272,11 +271,20 @@ void Path::segmentize_path()
     };
 
     FloatPoint cursor { 0, 0 };
+    FloatPoint subpath_start { 0, 0 };
     bool first = true;
 
+    // Filling a path always fills the area enclosed by each subpath, so subpaths that were left open are closed here.
+    auto close_subpath = [&] {
+        if (cursor != subpath_start)
+            add_line(cursor, subpath_start);
+    };
+
     for (auto& segment : m_segments) {
         switch (segment->type()) {
         case Segment::Type::MoveTo:
+            close_subpath();
+            subpath_start = segment->point();
             if (first) {
                 min_x = segment->point().x();
                 min_y = segment->point().y();
@@ -324,11 +332,7 @@ void Path::segmentize_path()
 
         first = false;
     }
-
-    // sort segments by ymax
-    quick_sort(segments, [](auto const& line0, auto const& line1) {
-        return line1.maximum_y < line0.maximum_y;
-    });
+    close_subpath();
 
     m_split_lines = move(segments);
     m_bounding_box = Gfx::FloatRect { min_x, min_y, max_x - min_x, max_y - min_y };
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2020, Srimanta Barua <srimanta.barua1@gmail.com>
+ * Copyright (c) 2023, Jelle Raaijmakers <jelle@gmta.nl>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Memory.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
+#include <LibGfx/PathRasterizer.h>
+
+// Functions returning vectors or accepting vector arguments have different calling conventions
+// depending on whether the target architecture supports SSE or not. GCC generates warning "psabi"
+// when compiling for non-SSE architectures. We disable this warning because these functions
+// are static and should never be visible from outside the translation unit that includes this header.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace Gfx {
+
+PathRasterizer::PathRasterizer(Gfx::IntSize size)
+    : m_size(size)
+    , m_stride(size.width() + 2)
+{
+    m_data.resize(m_stride * m_size.height());
+    for (auto& cell : m_data)
+        cell = 0.f;
+    m_row_extents.resize(m_size.height());
+    m_coverage.resize(m_size.width());
+}
+
+void PathRasterizer::draw_path(Gfx::Path const& path)
+{
+    for (auto& line : path.split_lines())
+        draw_line(line.from, line.to);
+}
+
+RefPtr<Gfx::Bitmap> PathRasterizer::accumulate()
+{
+    auto bitmap_or_error = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, m_size);
+    if (bitmap_or_error.is_error())
+        return {};
+    auto bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
+    Color base_color = Color::from_rgb(0xffffff);
+    bitmap->fill(base_color.with_alpha(0));
+    accumulate_rows(Painter::WindingRule::Nonzero, [&](int y, int x, ReadonlySpan<u8> coverage, u8 coverage_of_rest_of_row) {
+        auto* scanline = bitmap->scanline(y) + x;
+        for (size_t i = 0; i < coverage.size(); ++i)
+            scanline[i] = base_color.with_alpha(coverage[i]).value();
+        if (coverage_of_rest_of_row != 0)
+            fast_u32_fill(scanline + coverage.size(), base_color.with_alpha(coverage_of_rest_of_row).value(), m_size.width() - x - coverage.size());
+    });
+    return bitmap;
+}
+
+void PathRasterizer::draw_line(Gfx::FloatPoint p0, Gfx::FloatPoint p1)
+{
+    // If we're on the same Y, there's no need to draw
+    if (p0.y() == p1.y())
+        return;
+
+    // Lines above or below the rasterizer don't cover anything in it.
+    float const height = m_size.height();
+    if ((p0.y() <= 0.f && p1.y() <= 0.f) || (p0.y() >= height && p1.y() >= height))
+        return;
+
+    auto const dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
+    auto point_at_y = [&](float y) {
+        return Gfx::FloatPoint { p0.x() + (y - p0.y()) * dxdy, y };
+    };
+    auto clip_to_rows = [&](Gfx::FloatPoint point) {
+        if (point.y() < 0.f)
+            return point_at_y(0.f);
+        if (point.y() > height)
+            return point_at_y(height);
+        return point;
+    };
+    auto from = clip_to_rows(p0);
+    auto to = clip_to_rows(p1);
+
+    // Parts of the line left of the rasterizer still cover everything right of them, which is the same as they
+    // would if they ran along the left edge. Parts right of the rasterizer don't cover anything, just as if they
+    // ran along the right edge. So the line is split where it crosses those edges, and the parts outside are
+    // moved onto the edges.
+    float const width = m_size.width();
+    auto const dx = to.x() - from.x();
+    Array<float, 4> splits;
+    size_t split_count = 0;
+    splits[split_count++] = 0.f;
+    for (float edge : { 0.f, width }) {
+        if ((from.x() < edge && to.x() > edge) || (from.x() > edge && to.x() < edge))
+            splits[split_count++] = (edge - from.x()) / dx;
+    }
+    splits[split_count++] = 1.f;
+    if (split_count == 4 && splits[1] > splits[2])
+        swap(splits[1], splits[2]);
+
+    auto point_at = [&](float t) {
+        return Gfx::FloatPoint { clamp(from.x() + t * dx, 0.f, width), from.y() + t * (to.y() - from.y()) };
+    };
+    for (size_t i = 0; i + 1 < split_count; ++i)
+        draw_line_inside_rows(point_at(splits[i]), point_at(splits[i + 1]));
+}
+
+void PathRasterizer::draw_line_inside_rows(Gfx::FloatPoint p0, Gfx::FloatPoint p1)
+{
+    if (p0.y() == p1.y())
+        return;
+
+    float direction = -1.f;
+    if (p1.y() < p0.y()) {
+        direction = 1.f;
+        AK::swap(p0, p1);
+    }
+
+    float const width = m_size.width();
+    float const dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
+    int const first_row = max(0, static_cast<int>(floorf(p0.y())));
+    int const end_row = min(m_size.height(), static_cast<int>(ceilf(p1.y())));
+    float x_cur = p0.x();
+
+    for (int y = first_row; y < end_row; y++) {
+        float* row = &m_data[y * m_stride];
+
+        float dy = AK::min(y + 1.f, p1.y()) - AK::max(static_cast<float>(y), p0.y());
+        float directed_dy = dy * direction;
+        float x_next = clamp(x_cur + dy * dxdy, 0.f, width);
+        float x0 = AK::min(x_cur, x_next);
+        float x1 = AK::max(x_cur, x_next);
+        float x0_floor = floorf(x0);
+        float x1_ceil = ceilf(x1);
+        int x0_floor_i = x0_floor;
+        int x1_ceil_i = x1_ceil;
+
+        if (x1_ceil_i <= x0_floor_i + 1) {
+            // If x0 and x1 are within the same pixel, then area to the right is (1 - (mid(x0, x1) - x0_floor)) * dy
+            float area = .5f * (x0 + x1) - x0_floor;
+            row[x0_floor_i] += directed_dy * (1.f - area);
+            row[x0_floor_i + 1] += directed_dy * area;
+            x1_ceil_i = x0_floor_i + 1;
+        } else {
+            // The line crosses several pixels. The area it covers grows quadratically in the first and the last
+            // pixel, and linearly in the ones in between.
+            float const dydx = 1.f / (x1 - x0);
+            float const x0_fraction = x0 - x0_floor;
+            float const area_of_first = .5f * dydx * (1.f - x0_fraction) * (1.f - x0_fraction);
+            float const x1_fraction = x1 - x1_ceil + 1.f;
+            float const area_of_last = .5f * dydx * x1_fraction * x1_fraction;
+            row[x0_floor_i] += directed_dy * area_of_first;
+            if (x1_ceil_i == x0_floor_i + 2) {
+                row[x0_floor_i + 1] += directed_dy * (1.f - area_of_first - area_of_last);
+            } else {
+                float const area_up_to_second = dydx * (1.5f - x0_fraction);
+                row[x0_floor_i + 1] += directed_dy * (area_up_to_second - area_of_first);
+                for (int x = x0_floor_i + 2; x < x1_ceil_i - 1; x++)
+                    row[x] += directed_dy * dydx;
+                float const area_up_to_last = area_up_to_second + (x1_ceil_i - x0_floor_i - 3) * dydx;
+                row[x1_ceil_i - 1] += directed_dy * (1.f - area_up_to_last - area_of_last);
+            }
+            row[x1_ceil_i] += directed_dy * area_of_last;
+        }
+
+        auto& extent = m_row_extents[y];
+        extent.min_x = AK::min(extent.min_x, x0_floor_i);
+        extent.max_x = AK::max(extent.max_x, x1_ceil_i);
+
+        x_cur = x_next;
+    }
+}
+
+template<Painter::WindingRule winding_rule>
+ALWAYS_INLINE static float coverage_from_area(float area)
+{
+    auto coverage = fabsf(area);
+    if constexpr (winding_rule == Painter::WindingRule::Nonzero)
+        return AK::min(coverage, 1.f);
+    // Every other time the winding number goes up by one, the pixel is outside again.
+    coverage -= 2.f * truncf(coverage * .5f);
+    return coverage > 1.f ? 2.f - coverage : coverage;
+}
+
+template<Painter::WindingRule winding_rule>
+ALWAYS_INLINE static AK::SIMD::f32x4 coverage_from_area(AK::SIMD::f32x4 area)
+{
+    auto coverage = area < 0.f ? -area : area;
+    if constexpr (winding_rule == Painter::WindingRule::Nonzero)
+        return coverage > 1.f ? 1.f : coverage;
+    coverage -= 2.f * AK::SIMD::truncate_int_range(coverage * .5f);
+    return coverage > 1.f ? 2.f - coverage : coverage;
+}
+
+// Sums up the cells of a row into the coverage of each pixel, four at a time, and returns the sum of all of them.
+template<Painter::WindingRule winding_rule>
+static float accumulate_row(float const* cells, u8* coverage, size_t count)
+{
+    using AK::SIMD::f32x4;
+
+    float area = 0.f;
+    size_t x = 0;
+    for (; x + 4 <= count; x += 4) {
+        f32x4 sums;
+        __builtin_memcpy(&sums, cells + x, sizeof(sums));
+        // A prefix sum of four values takes two shifted additions.
+        sums += f32x4 { 0.f, sums[0], sums[1], sums[2] };
+        sums += f32x4 { 0.f, 0.f, sums[0], sums[1] };
+        sums += area;
+        area = sums[3];
+        auto bytes = AK::SIMD::to_u8x4(AK::SIMD::to_i32x4(coverage_from_area<winding_rule>(sums) * 255.f));
+        __builtin_memcpy(coverage + x, &bytes, sizeof(bytes));
+    }
+    for (; x < count; ++x) {
+        area += cells[x];
+        coverage[x] = coverage_from_area<winding_rule>(area) * 255.f;
+    }
+    return area;
+}
+
+template<Painter::WindingRule winding_rule>
+static void accumulate_rows_with_rule(Span<float> data, int stride, Span<u8> coverage, auto& row_extents, PathRasterizer::RowCallback const& callback)
+{
+    auto width = static_cast<int>(coverage.size());
+    for (size_t y = 0; y < row_extents.size(); ++y) {
+        auto& extent = row_extents[y];
+        if (extent.max_x < 0)
+            continue;
+
+        auto* cells = data.offset_pointer(y * stride);
+        int end = AK::min(extent.max_x + 1, width);
+        if (extent.min_x < end) {
+            auto count = static_cast<size_t>(end - extent.min_x);
+            auto area = accumulate_row<winding_rule>(cells + extent.min_x, coverage.data(), count);
+            u8 coverage_of_rest_of_row = coverage_from_area<winding_rule>(area) * 255.f;
+            callback(static_cast<int>(y), extent.min_x, coverage.trim(count), coverage_of_rest_of_row);
+        }
+
+        __builtin_memset(cells + extent.min_x, 0, (extent.max_x - extent.min_x + 1) * sizeof(float));
+        extent = {};
+    }
+}
+
+void PathRasterizer::accumulate_rows(Painter::WindingRule winding_rule, RowCallback const& callback)
+{
+    switch (winding_rule) {
+    case Painter::WindingRule::Nonzero:
+        accumulate_rows_with_rule<Painter::WindingRule::Nonzero>(m_data.span(), m_stride, m_coverage.span(), m_row_extents, callback);
+        return;
+    case Painter::WindingRule::EvenOdd:
+        accumulate_rows_with_rule<Painter::WindingRule::EvenOdd>(m_data.span(), m_stride, m_coverage.span(), m_row_extents, callback);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+}
+
+#pragma GCC diagnostic pop
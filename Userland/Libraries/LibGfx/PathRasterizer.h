@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, Srimanta Barua <srimanta.barua1@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+
+namespace Gfx {
+
+// Rasterizes paths with exact anti-aliasing, for both glyphs and filled paths.
+// Every edge adds the signed area it covers to the cells of the rows it crosses. Summing those cells up along a row
+// then gives the winding number of each pixel, weighted by how much of the pixel is covered. Only the cells between
+// the leftmost and the rightmost one touched in a row have to be summed up; past that, the coverage stays the same.
+class PathRasterizer {
+public:
+    PathRasterizer(Gfx::IntSize);
+
+    void draw_path(Gfx::Path const&);
+
+    // Parts of the line that are outside of the rasterizer are clipped, but still count towards the coverage of the
+    // pixels to their right.
+    void draw_line(Gfx::FloatPoint, Gfx::FloatPoint);
+
+    // Returns a white bitmap with the (nonzero) coverage in its alpha channel, as used for glyphs.
+    RefPtr<Gfx::Bitmap> accumulate();
+
+    // Calls the callback for every row that any line passed through, with the coverage of the pixels from the first
+    // column a line touched up to the last one, and the coverage of all pixels right of that.
+    // Afterwards, the rasterizer is empty again and can be reused.
+    using RowCallback = Function<void(int y, int x, ReadonlySpan<u8> coverage, u8 coverage_of_rest_of_row)>;
+    void accumulate_rows(Painter::WindingRule, RowCallback const&);
+
+    Gfx::IntSize size() const { return m_size; }
+
+private:
+    void draw_line_inside_rows(Gfx::FloatPoint, Gfx::FloatPoint);
+
+    struct RowExtent {
+        int min_x { NumericLimits<int>::max() };
+        int max_x { -1 };
+    };
+
+    Gfx::IntSize m_size;
+    // Lines may touch the cell right of the last column, so every row has room for that.
+    int m_stride { 0 };
+    Vector<float> m_data;
+    Vector<RowExtent> m_row_extents;
+    Vector<u8> m_coverage;
+};
+
+}
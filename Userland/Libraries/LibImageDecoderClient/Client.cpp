@@ -6,6 +6,7 @@
 
 #include <LibCore/AnonymousBuffer.h>
 #include <LibImageDecoderClient/Client.h>
+#include <LibImageDecoderClient/StreamingImage.h>
 
 namespace ImageDecoderClient {
 
@@ -16,6 +17,12 @@ Client::Client(NonnullOwnPtr<Core::LocalSocket> socket)
 
 void Client::die()
 {
+    auto streaming_images = move(m_streaming_images);
+    for (auto& it : streaming_images) {
+        if (auto image = it.value.strong_ref())
+            image->did_fail({});
+    }
+
     if (on_death)
         on_death();
 }
@@ -58,4 +65,106 @@ Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data, Optional
     return image;
 }
 
+RefPtr<StreamingImage> Client::start_decoding_image(Optional<DeprecatedString> mime_type)
+{
+    auto response = send_sync_but_allow_failure<Messages::ImageDecoderServer::StartDecodingImage>(move(mime_type));
+    if (!response) {
+        dbgln("ImageDecoder died heroically");
+        return nullptr;
+    }
+
+    auto image_id = response->image_id();
+    auto image = StreamingImage::create_from_id({}, *this, image_id);
+    m_streaming_images.set(image_id, image->make_weak_ptr());
+    return image;
+}
+
+bool Client::append_encoded_data(Badge<StreamingImage>, StreamingImage& image, ReadonlyBytes encoded_data)
+{
+    if (!m_streaming_images.contains(image.id()))
+        return false;
+    if (encoded_data.is_empty())
+        return true;
+
+    auto encoded_buffer_or_error = Core::AnonymousBuffer::create_with_size(encoded_data.size());
+    if (encoded_buffer_or_error.is_error()) {
+        dbgln("Could not allocate encoded buffer");
+        return false;
+    }
+    auto encoded_buffer = encoded_buffer_or_error.release_value();
+    memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
+    async_append_encoded_data(image.id(), move(encoded_buffer));
+    return true;
+}
+
+bool Client::finish_encoded_data(Badge<StreamingImage>, StreamingImage& image)
+{
+    if (!m_streaming_images.contains(image.id()))
+        return false;
+    async_finish_encoded_data(image.id());
+    return true;
+}
+
+bool Client::decode_frame(Badge<StreamingImage>, StreamingImage& image, u32 index)
+{
+    if (!m_streaming_images.contains(image.id()))
+        return false;
+    async_decode_frame(image.id(), index);
+    return true;
+}
+
+bool Client::stop_decoding_image(Badge<StreamingImage>, StreamingImage& image)
+{
+    if (!m_streaming_images.remove(image.id()))
+        return false;
+    async_stop_decoding_image(image.id());
+    return true;
+}
+
+RefPtr<StreamingImage> Client::streaming_image_with_id(i32 image_id) const
+{
+    auto image = m_streaming_images.get(image_id);
+    if (!image.has_value())
+        return nullptr;
+    return image->strong_ref();
+}
+
+void Client::did_decode_image_size(i32 image_id, Gfx::IntSize size)
+{
+    if (auto image = streaming_image_with_id(image_id))
+        image->did_decode_size({}, size);
+}
+
+void Client::did_decode_incomplete_frame(i32 image_id, Gfx::ShareableBitmap const& bitmap)
+{
+    if (auto image = streaming_image_with_id(image_id))
+        image->did_decode_incomplete_frame({}, const_cast<Gfx::ShareableBitmap&>(bitmap).bitmap());
+}
+
+void Client::did_decode_image_details(i32 image_id, bool is_animated, u32 loop_count, u32 frame_count)
+{
+    if (auto image = streaming_image_with_id(image_id))
+        image->did_decode_details({}, is_animated, loop_count, frame_count);
+}
+
+void Client::did_decode_frame(i32 image_id, u32 frame_index, Gfx::ShareableBitmap const& bitmap, u32 duration)
+{
+    if (auto image = streaming_image_with_id(image_id))
+        image->did_decode_frame({}, frame_index, Frame { const_cast<Gfx::ShareableBitmap&>(bitmap).bitmap(), duration });
+}
+
+void Client::did_fail_to_decode_frame(i32 image_id, u32 frame_index)
+{
+    if (auto image = streaming_image_with_id(image_id))
+        image->did_fail_to_decode_frame({}, frame_index);
+}
+
+void Client::did_fail_to_decode_image(i32 image_id)
+{
+    auto image = streaming_image_with_id(image_id);
+    m_streaming_images.remove(image_id);
+    if (image)
+        image->did_fail({});
+}
+
 }
@@ -7,12 +7,17 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/WeakPtr.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
 #include <LibIPC/ConnectionToServer.h>
 
+class ImageDecoderTestConnection;
+
 namespace ImageDecoderClient {
 
+class StreamingImage;
+
 struct Frame {
     RefPtr<Gfx::Bitmap> bitmap;
     u32 duration { 0 };
@@ -29,15 +34,37 @@ class Client final
     , public ImageDecoderClientEndpoint {
     IPC_CLIENT_CONNECTION(Client, "/tmp/session/%sid/portal/image"sv);
 
+    // The tests connect to the service over a socket pair instead of through the portal.
+    friend class ::ImageDecoderTestConnection;
+
 public:
     Optional<DecodedImage> decode_image(ReadonlyBytes, Optional<DeprecatedString> mime_type = {});
 
+    RefPtr<StreamingImage> start_decoding_image(Optional<DeprecatedString> mime_type = {});
+
+    bool append_encoded_data(Badge<StreamingImage>, StreamingImage&, ReadonlyBytes);
+    bool finish_encoded_data(Badge<StreamingImage>, StreamingImage&);
+    bool decode_frame(Badge<StreamingImage>, StreamingImage&, u32 index);
+    bool stop_decoding_image(Badge<StreamingImage>, StreamingImage&);
+
     Function<void()> on_death;
 
 private:
     Client(NonnullOwnPtr<Core::LocalSocket>);
 
     virtual void die() override;
+
+    virtual void did_decode_image_size(i32 image_id, Gfx::IntSize) override;
+    virtual void did_decode_incomplete_frame(i32 image_id, Gfx::ShareableBitmap const&) override;
+    virtual void did_decode_image_details(i32 image_id, bool is_animated, u32 loop_count, u32 frame_count) override;
+    virtual void did_decode_frame(i32 image_id, u32 frame_index, Gfx::ShareableBitmap const&, u32 duration) override;
+    virtual void did_fail_to_decode_frame(i32 image_id, u32 frame_index) override;
+    virtual void did_fail_to_decode_image(i32 image_id) override;
+
+    RefPtr<StreamingImage> streaming_image_with_id(i32 image_id) const;
+
+    // The images stop decoding when they're destroyed, so they're only referenced weakly here.
+    HashMap<i32, WeakPtr<StreamingImage>> m_streaming_images;
 };
 
 }
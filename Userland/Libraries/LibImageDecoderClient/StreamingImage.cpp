@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibImageDecoderClient/StreamingImage.h>
+
+namespace ImageDecoderClient {
+
+StreamingImage::StreamingImage(Client& client, i32 image_id)
+    : m_client(client)
+    , m_image_id(image_id)
+{
+}
+
+StreamingImage::~StreamingImage()
+{
+    // Let the server forget about the image, it would otherwise keep the encoded data until the connection closes.
+    if (m_client)
+        m_client->stop_decoding_image({}, *this);
+}
+
+bool StreamingImage::append_encoded_data(ReadonlyBytes data)
+{
+    if (!m_client)
+        return false;
+    return m_client->append_encoded_data({}, *this, data);
+}
+
+bool StreamingImage::finish_encoded_data()
+{
+    if (!m_client)
+        return false;
+    // The server decodes the first frame as soon as it has all of the data.
+    m_frames_being_decoded.set(0);
+    return m_client->finish_encoded_data({}, *this);
+}
+
+bool StreamingImage::stop()
+{
+    if (!m_client)
+        return false;
+    return m_client->stop_decoding_image({}, *this);
+}
+
+Optional<Frame> StreamingImage::frame(u32 index)
+{
+    for (size_t i = 0; i < m_cached_frames.size(); ++i) {
+        if (m_cached_frames[i].index != index)
+            continue;
+        auto cached_frame = m_cached_frames.take(i);
+        auto frame = cached_frame.frame;
+        m_cached_frames.append(move(cached_frame));
+        return frame;
+    }
+
+    if (index < m_frame_count && !m_frames_being_decoded.contains(index) && !m_frames_that_failed.contains(index) && m_client) {
+        m_frames_being_decoded.set(index);
+        m_client->decode_frame({}, *this, index);
+    }
+    return {};
+}
+
+void StreamingImage::add_frame_to_cache(u32 index, Frame const& frame)
+{
+    auto size_in_bytes = frame.bitmap ? frame.bitmap->size_in_bytes() : 0;
+    while (!m_cached_frames.is_empty() && m_cached_frames_size_in_bytes + size_in_bytes > frame_cache_size_in_bytes) {
+        auto evicted_frame = m_cached_frames.take_first();
+        m_cached_frames_size_in_bytes -= evicted_frame.frame.bitmap ? evicted_frame.frame.bitmap->size_in_bytes() : 0;
+    }
+    m_cached_frames.append({ index, frame });
+    m_cached_frames_size_in_bytes += size_in_bytes;
+}
+
+void StreamingImage::did_decode_size(Badge<Client>, Gfx::IntSize size)
+{
+    if (on_size)
+        on_size(size);
+}
+
+void StreamingImage::did_decode_incomplete_frame(Badge<Client>, RefPtr<Gfx::Bitmap> bitmap)
+{
+    if (bitmap && on_incomplete_frame_decoded)
+        on_incomplete_frame_decoded(bitmap.release_nonnull());
+}
+
+void StreamingImage::did_decode_details(Badge<Client>, bool is_animated, u32 loop_count, u32 frame_count)
+{
+    m_is_animated = is_animated;
+    m_loop_count = loop_count;
+    m_frame_count = frame_count;
+    if (on_details)
+        on_details();
+}
+
+void StreamingImage::did_decode_frame(Badge<Client>, u32 index, Frame frame)
+{
+    m_frames_being_decoded.remove(index);
+    add_frame_to_cache(index, frame);
+    if (on_frame_decoded)
+        on_frame_decoded(index, frame);
+}
+
+void StreamingImage::did_fail_to_decode_frame(Badge<Client>, u32 index)
+{
+    m_frames_being_decoded.remove(index);
+    m_frames_that_failed.set(index);
+    if (on_frame_failed)
+        on_frame_failed(index);
+}
+
+void StreamingImage::did_fail(Badge<Client>)
+{
+    m_frames_being_decoded.clear();
+    if (on_failure)
+        on_failure();
+}
+
+}
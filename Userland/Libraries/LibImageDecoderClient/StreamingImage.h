@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/Function.h>
+#include <AK/HashTable.h>
+#include <AK/RefCounted.h>
+#include <AK/WeakPtr.h>
+#include <AK/Weakable.h>
+#include <LibImageDecoderClient/Client.h>
+
+namespace ImageDecoderClient {
+
+// An image that the server decodes while its data is still being sent over. Only the first frame is decoded right
+// away; the other frames of an animation are decoded when they're asked for, and only some of them are kept around.
+class StreamingImage
+    : public RefCounted<StreamingImage>
+    , public Weakable<StreamingImage> {
+public:
+    static NonnullRefPtr<StreamingImage> create_from_id(Badge<Client>, Client& client, i32 image_id)
+    {
+        return adopt_ref(*new StreamingImage(client, image_id));
+    }
+
+    ~StreamingImage();
+
+    i32 id() const { return m_image_id; }
+
+    bool append_encoded_data(ReadonlyBytes);
+    bool finish_encoded_data();
+    bool stop();
+
+    // These are known once on_details has been called.
+    bool is_animated() const { return m_is_animated; }
+    u32 loop_count() const { return m_loop_count; }
+    u32 frame_count() const { return m_frame_count; }
+
+    // Returns the frame if it is in the cache. Otherwise, the frame is decoded and on_frame_decoded is called once
+    // it is ready, or on_frame_failed if it couldn't be decoded. Frames that failed once aren't tried again.
+    Optional<Frame> frame(u32 index);
+
+    Function<void(Gfx::IntSize)> on_size;
+    // Called with as much of the first frame as could be decoded while the data was still arriving. These aren't
+    // cached, and on_frame_decoded is called with the whole frame once it has all arrived.
+    Function<void(NonnullRefPtr<Gfx::Bitmap>)> on_incomplete_frame_decoded;
+    Function<void()> on_details;
+    Function<void(u32 index, Frame const&)> on_frame_decoded;
+    // A frame of an animation couldn't be decoded. The frames that were decoded before stay in the cache.
+    Function<void(u32 index)> on_frame_failed;
+    // Nothing could be decoded, and the image is no longer usable.
+    Function<void()> on_failure;
+
+    void did_decode_size(Badge<Client>, Gfx::IntSize);
+    void did_decode_incomplete_frame(Badge<Client>, RefPtr<Gfx::Bitmap>);
+    void did_decode_details(Badge<Client>, bool is_animated, u32 loop_count, u32 frame_count);
+    void did_decode_frame(Badge<Client>, u32 index, Frame);
+    void did_fail_to_decode_frame(Badge<Client>, u32 index);
+    void did_fail(Badge<Client>);
+
+private:
+    StreamingImage(Client&, i32 image_id);
+
+    void add_frame_to_cache(u32 index, Frame const&);
+
+    // Frames are dropped from the cache once they take up more memory than this, the least recently used first.
+    static constexpr size_t frame_cache_size_in_bytes = 32 * MiB;
+
+    struct CachedFrame {
+        u32 index { 0 };
+        Frame frame;
+    };
+
+    WeakPtr<Client> m_client;
+    i32 m_image_id { -1 };
+
+    bool m_is_animated { false };
+    u32 m_loop_count { 0 };
+    u32 m_frame_count { 0 };
+
+    // The most recently used frame is at the end.
+    Vector<CachedFrame> m_cached_frames;
+    size_t m_cached_frames_size_in_bytes { 0 };
+    HashTable<u32> m_frames_being_decoded;
+    HashTable<u32> m_frames_that_failed;
+};
+
+}
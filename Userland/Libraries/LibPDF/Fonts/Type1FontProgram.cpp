@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibGfx/Font/PathRasterizer.h>
+#include <LibGfx/PathRasterizer.h>
 #include <LibPDF/Fonts/Type1FontProgram.h>
 
 namespace PDF {
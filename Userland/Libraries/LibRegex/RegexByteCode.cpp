@@ -158,18 +158,14 @@ static bool restore_string_position(MatchInput const& input, MatchState& state)
     return true;
 }
 
-OwnPtr<OpCode> ByteCode::s_opcodes[(size_t)OpCodeId::Last + 1];
-bool ByteCode::s_opcodes_initialized { false };
-
-void ByteCode::ensure_opcodes_initialized()
+static Array<OwnPtr<OpCode>, (size_t)OpCodeId::Last + 1> create_opcodes()
 {
-    if (s_opcodes_initialized)
-        return;
+    Array<OwnPtr<OpCode>, (size_t)OpCodeId::Last + 1> opcodes;
     for (u32 i = (u32)OpCodeId::First; i <= (u32)OpCodeId::Last; ++i) {
         switch ((OpCodeId)i) {
-#define __ENUMERATE_OPCODE(OpCode)              \
-    case OpCodeId::OpCode:                      \
-        s_opcodes[i] = make<OpCode_##OpCode>(); \
+#define __ENUMERATE_OPCODE(OpCode)            \
+    case OpCodeId::OpCode:                    \
+        opcodes[i] = make<OpCode_##OpCode>(); \
         break;
 
             ENUMERATE_OPCODES
@@ -177,16 +173,19 @@ void ByteCode::ensure_opcodes_initialized()
 #undef __ENUMERATE_OPCODE
         }
     }
-    s_opcodes_initialized = true;
+    return opcodes;
 }
 
-ALWAYS_INLINE OpCode& ByteCode::get_opcode_by_id(OpCodeId id) const
+OpCode* const* opcodes_for_current_thread()
 {
-    VERIFY(id >= OpCodeId::First && id <= OpCodeId::Last);
-
-    auto& opcode = s_opcodes[(u32)id];
-    opcode->set_bytecode(*const_cast<ByteCode*>(this));
-    return *opcode;
+    static thread_local auto s_opcodes = create_opcodes();
+    static thread_local auto s_opcode_pointers = [] {
+        Array<OpCode*, (size_t)OpCodeId::Last + 1> pointers;
+        for (size_t i = 0; i < pointers.size(); ++i)
+            pointers[i] = s_opcodes[i].ptr();
+        return pointers;
+    }();
+    return s_opcode_pointers.data();
 }
 
 OpCode& ByteCode::get_opcode(MatchState& state) const
@@ -197,7 +196,9 @@ OpCode& ByteCode::get_opcode(MatchState& state) const
     else
         opcode_id = OpCodeId::Exit;
 
-    auto& opcode = get_opcode_by_id(opcode_id);
+    VERIFY(opcode_id >= OpCodeId::First && opcode_id <= OpCodeId::Last);
+    auto& opcode = *state.opcodes[(u32)opcode_id];
+    opcode.set_bytecode(*const_cast<ByteCode*>(this));
     opcode.set_state(state);
     return opcode;
 }
@@ -437,6 +438,37 @@ ALWAYS_INLINE ExecutionResult OpCode_SaveRightNamedCaptureGroup::execute(MatchIn
 
 ALWAYS_INLINE ExecutionResult OpCode_Compare::execute(MatchInput const& input, MatchState& state) const
 {
+    // Most compares test a single character against a character, a range or a class, which needs none of the
+    // inversion and disjunction bookkeeping below.
+    if (arguments_count() == 1) {
+        auto offset = state.instruction_position + 3;
+        auto compare_type = (CharacterCompareType)m_bytecode->at(offset);
+        if (compare_type == CharacterCompareType::Char || compare_type == CharacterCompareType::CharRange || compare_type == CharacterCompareType::CharClass) {
+            state.string_position_before_match = state.string_position;
+
+            auto string_position = state.string_position;
+            bool inverse_matched { false };
+            if (compare_type == CharacterCompareType::Char) {
+                if (input.view.length() <= state.string_position)
+                    return ExecutionResult::Failed_ExecuteLowPrioForks;
+                compare_char(input, state, m_bytecode->at(offset + 1), false, inverse_matched);
+            } else if (compare_type == CharacterCompareType::CharRange) {
+                if (input.view.length() <= state.string_position)
+                    return ExecutionResult::Failed_ExecuteLowPrioForks;
+                auto range = (CharRange)m_bytecode->at(offset + 1);
+                compare_character_range(input, state, range.from, range.to, input.view[state.string_position_in_code_units], false, inverse_matched);
+            } else {
+                if (input.view.length() <= state.string_position_in_code_units)
+                    return ExecutionResult::Failed_ExecuteLowPrioForks;
+                compare_character_class(input, state, (CharClass)m_bytecode->at(offset + 1), input.view[state.string_position_in_code_units], false, inverse_matched);
+            }
+
+            if (string_position == state.string_position || state.string_position > input.view.length())
+                return ExecutionResult::Failed_ExecuteLowPrioForks;
+            return ExecutionResult::Continue;
+        }
+    }
+
     bool inverse { false };
     bool temporary_inverse { false };
     bool reset_temp_inverse { false };
@@ -148,11 +148,7 @@ class ByteCode : public DisjointChunks<ByteCodeValueType> {
     using Base = DisjointChunks<ByteCodeValueType>;
 
 public:
-    ByteCode()
-    {
-        ensure_opcodes_initialized();
-    }
-
+    ByteCode() = default;
     ByteCode(ByteCode const&) = default;
     virtual ~ByteCode() = default;
 
@@ -514,11 +510,6 @@ private:
         for (size_t i = 0; i < view.length(); ++i)
             empend((ByteCodeValueType)view[i]);
     }
-
-    void ensure_opcodes_initialized();
-    ALWAYS_INLINE OpCode& get_opcode_by_id(OpCodeId id) const;
-    static OwnPtr<OpCode> s_opcodes[(size_t)OpCodeId::Last + 1];
-    static bool s_opcodes_initialized;
 };
 
 #define ENUMERATE_EXECUTION_RESULTS                          \
@@ -210,6 +210,10 @@ public:
         return m_view.get<Utf8View>();
     }
 
+    bool is_string_view() const { return m_view.has<StringView>(); }
+    bool is_u8_view() const { return m_view.has<Utf8View>(); }
+    bool is_u16_view() const { return m_view.has<Utf16View>(); }
+
     bool unicode() const { return m_unicode; }
     void set_unicode(bool unicode) { m_unicode = unicode; }
 
@@ -651,7 +655,13 @@ struct MatchInput {
     mutable Optional<size_t> fork_to_replace;
 };
 
+// This thread's instance of every opcode, indexed by OpCodeId. They are created on first use.
+OpCode* const* opcodes_for_current_thread();
+
 struct MatchState {
+    // Opcodes keep track of the bytecode and state they're executed with, so every thread executes its own instances.
+    // They are looked up once here, so that the opcode dispatch doesn't have to.
+    OpCode* const* opcodes { opcodes_for_current_thread() };
     size_t string_position_before_match { 0 };
     size_t string_position { 0 };
     size_t string_position_in_code_units { 0 };
@@ -10,6 +10,7 @@
 #include <AK/StringBuilder.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
+#include <LibThreading/Mutex.h>
 
 #if REGEX_DEBUG
 #    include <LibRegex/RegexDebug.h>
@@ -30,16 +31,79 @@ regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename
     return parser.parse();
 }
 
+// Parsing and optimizing a pattern costs far more than copying the resulting bytecode, and programs tend to compile the
+// same few patterns over and over (think of a RegExp literal inside a loop). So the most recently compiled patterns are
+// remembered for the whole process.
+// Patterns with named capture groups aren't cached, as their bytecode points into the pattern string of the regex that
+// compiled it, which can be destroyed while a copy of the bytecode is still in use.
+static constexpr size_t max_cached_compiled_patterns = 64;
+
+template<class Parser>
+class CompiledPatternCache {
+public:
+    using FlagsType = typename ParserTraits<Parser>::OptionsType::FlagsType;
+
+    static CompiledPatternCache& the()
+    {
+        static CompiledPatternCache s_the;
+        return s_the;
+    }
+
+    Optional<regex::Parser::Result> get(StringView pattern, FlagsType flags)
+    {
+        Threading::MutexLocker locker(m_mutex);
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            if (m_entries[i].flags != flags || m_entries[i].pattern != pattern)
+                continue;
+            // Entries are kept in order of use, the most recently used one first.
+            if (i != 0)
+                m_entries.prepend(m_entries.take(i));
+            return m_entries.first().result;
+        }
+        return {};
+    }
+
+    void set(StringView pattern, FlagsType flags, regex::Parser::Result const& result)
+    {
+        // The pattern is copied rather than shared, since strings aren't reference counted atomically and the regex
+        // it came from may be destroyed on another thread.
+        DeprecatedString pattern_copy { pattern };
+        Threading::MutexLocker locker(m_mutex);
+        if (m_entries.size() == max_cached_compiled_patterns)
+            m_entries.take_last();
+        m_entries.prepend({ move(pattern_copy), flags, result });
+    }
+
+private:
+    struct Entry {
+        DeprecatedString pattern;
+        FlagsType flags;
+        regex::Parser::Result result;
+    };
+
+    Threading::Mutex m_mutex;
+    Vector<Entry> m_entries;
+};
+
 template<class Parser>
 Regex<Parser>::Regex(DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options)
     : pattern_value(move(pattern))
 {
-    regex::Lexer lexer(pattern_value);
+    auto& cache = CompiledPatternCache<Parser>::the();
+    if (auto cached_result = cache.get(pattern_value, regex_options.value()); cached_result.has_value()) {
+        parser_result = cached_result.release_value();
+    } else {
+        regex::Lexer lexer(pattern_value);
 
-    Parser parser(lexer, regex_options);
-    parser_result = parser.parse();
+        Parser parser(lexer, regex_options);
+        parser_result = parser.parse();
+
+        run_optimization_passes();
+        // Only successful results are cached, as the error token points into the pattern.
+        if (parser_result.error == regex::Error::NoError && parser_result.named_capture_groups_count == 0)
+            cache.set(pattern_value, regex_options.value(), parser_result);
+    }
 
-    run_optimization_passes();
     if (parser_result.error == regex::Error::NoError)
         matcher = make<Matcher<Parser>>(this, static_cast<decltype(regex_options.value())>(parser_result.options.value()));
 }
@@ -193,6 +257,9 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         }
         input.view = view;
         dbgln_if(REGEX_DEBUG, "[match] Starting match with view ({}): _{}_", view.length(), view);
+        auto use_nfa = m_nfa && NFA::can_search(input);
+        auto use_prefilter = m_prefilter.has_value() && LiteralPrefilter::can_search(input);
+        Optional<size_t> literal_position;
 
         auto view_length = view.length();
         size_t view_index = m_pattern->start_offset;
@@ -232,6 +299,21 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         }
 
         for (; view_index <= view_length; ++view_index) {
+            if (use_prefilter) {
+                // Every match contains the literal, so there's nothing to find past its last occurrence.
+                if (!literal_position.has_value() || *literal_position < view_index) {
+                    literal_position = m_prefilter->find(view, view_index);
+                    if (!literal_position.has_value())
+                        break;
+                }
+                // And if every match starts with it, no other position has to be tried.
+                if (m_prefilter->is_prefix() && *literal_position != view_index) {
+                    if (!continue_search)
+                        break;
+                    view_index = *literal_position;
+                }
+            }
+
             if (view_index == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
                 break;
 
@@ -253,7 +335,24 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            bool success;
+            if (use_nfa) {
+                // The NFA tries all start positions at once, so there is no point in continuing if it didn't find a match.
+                auto last_start = view_index;
+                if (continue_search) {
+                    last_start = view_length - (input.regex_options.has_flag_set(AllFlags::Multiline) ? 1 : 0);
+                    if (match_length_minimum)
+                        last_start = min(last_start, view_length - match_length_minimum);
+                }
+                auto match_start = m_nfa->search(input, state, view_index, last_start, operations);
+                if (!match_start.has_value())
+                    break;
+                view_index = *match_start;
+                success = true;
+            } else {
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
 
@@ -8,8 +8,10 @@
 
 #include "RegexByteCode.h"
 #include "RegexMatch.h"
+#include "RegexNFA.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
+#include "RegexPrefilter.h"
 
 #include <AK/Forward.h>
 #include <AK/GenericLexer.h>
@@ -55,6 +57,8 @@ public:
     Matcher(Regex<Parser> const* pattern, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {})
         : m_pattern(pattern)
         , m_regex_options(regex_options.value_or({}))
+        , m_nfa(NFA::try_create(pattern->parser_result.bytecode))
+        , m_prefilter(LiteralPrefilter::try_create(pattern->parser_result.bytecode))
     {
     }
     ~Matcher() = default;
@@ -77,6 +81,9 @@ private:
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+    // Patterns without backreferences and lookarounds are matched in linear time by this instead of execute().
+    OwnPtr<NFA> m_nfa;
+    Optional<LiteralPrefilter> m_prefilter;
 };
 
 template<class Parser>
@@ -0,0 +1,795 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexNFA.h"
+#include <AK/CharacterTypes.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashTable.h>
+
+namespace regex {
+
+// The DFA cache is cleared once it holds this many states.
+static constexpr size_t s_max_dfa_states = 2048;
+// If the DFA cache fills up faster than this (in input characters per state), the DFA is given up on for that search.
+static constexpr size_t s_min_characters_per_dfa_state = 10;
+// After giving up this many times, the DFA isn't used for a pattern anymore.
+static constexpr size_t s_max_times_dfa_given_up = 8;
+
+static constexpr u8 s_context_at_beginning = 1 << 0;
+static constexpr u8 s_context_after_line_terminator = 1 << 1;
+static constexpr u8 s_context_after_word_character = 1 << 2;
+
+enum class CompareShape {
+    SingleCharacter,
+    String,
+    Unsupported,
+};
+
+// Figures out whether the Compare opcode at the given position always consumes exactly one character, or matches a string
+// of ASCII characters, which is then consumed one character at a time.
+static CompareShape compare_shape(ByteCode const& bytecode, size_t instruction_position, Vector<u32>& string)
+{
+    auto arguments_count = bytecode.at(instruction_position + 1);
+    auto offset = instruction_position + 3;
+
+    for (size_t i = 0; i < arguments_count; ++i) {
+        switch ((CharacterCompareType)bytecode.at(offset++)) {
+        case CharacterCompareType::Inverse:
+        case CharacterCompareType::TemporaryInverse:
+        case CharacterCompareType::AnyChar:
+        case CharacterCompareType::And:
+        case CharacterCompareType::Or:
+        case CharacterCompareType::EndAndOr:
+            break;
+        case CharacterCompareType::Char:
+        case CharacterCompareType::CharClass:
+        case CharacterCompareType::CharRange:
+        case CharacterCompareType::Property:
+        case CharacterCompareType::GeneralCategory:
+        case CharacterCompareType::Script:
+        case CharacterCompareType::ScriptExtension:
+            ++offset;
+            break;
+        case CharacterCompareType::LookupTable:
+            offset += 1 + bytecode.at(offset);
+            break;
+        case CharacterCompareType::String: {
+            auto length = bytecode.at(offset++);
+            if (length == 1) {
+                ++offset;
+                break;
+            }
+            if (length == 0 || arguments_count != 1)
+                return CompareShape::Unsupported;
+            for (size_t j = 0; j < length; ++j) {
+                auto character = bytecode.at(offset + j);
+                if (!is_ascii(character))
+                    return CompareShape::Unsupported;
+                string.append(character);
+            }
+            return CompareShape::String;
+        }
+        case CharacterCompareType::Reference:
+        case CharacterCompareType::Undefined:
+        case CharacterCompareType::RangeExpressionDummy:
+            return CompareShape::Unsupported;
+        }
+    }
+
+    return CompareShape::SingleCharacter;
+}
+
+unsigned NFA::U64VectorTraits::hash(Vector<u64> const& values)
+{
+    unsigned hash = 0;
+    for (auto value : values)
+        hash = pair_int_hash(hash, u64_hash(value));
+    return hash;
+}
+
+NFA::CounterSets::CounterSets(size_t counter_count)
+    : m_counter_count(counter_count)
+{
+    clear();
+}
+
+u32 NFA::CounterSets::intern(Vector<u64> counters)
+{
+    if (auto index = m_indices.get(counters); index.has_value())
+        return *index;
+
+    u32 index = m_sets.size();
+    m_sets.append(counters);
+    m_indices.set(move(counters), index);
+    return index;
+}
+
+void NFA::CounterSets::clear()
+{
+    m_sets.clear();
+    m_indices.clear();
+
+    // All counters start out at zero.
+    Vector<u64> initial_counters;
+    initial_counters.resize(m_counter_count);
+    intern(move(initial_counters));
+}
+
+// The threads that have been added at the current input position, and the state needed to follow the instructions
+// that don't consume anything.
+class NFA::Closure {
+public:
+    Closure(NFA const& nfa, MatchInput const& input, MatchState& scratch_state, CounterSets& counters, Vector<CaptureEvent>* capture_events)
+        : m_nfa(nfa)
+        , m_input(input)
+        , m_scratch_state(scratch_state)
+        , m_counters(counters)
+        , m_capture_events(capture_events)
+    {
+        if (nfa.m_counter_count == 0)
+            m_visited_program_counters.resize(nfa.m_program.size());
+    }
+
+    void reset(size_t position)
+    {
+        m_position = position;
+        m_visited_threads.clear_with_capacity();
+        if (++m_generation == 0) {
+            for (auto& generation : m_visited_program_counters)
+                generation = 0;
+            m_generation = 1;
+        }
+    }
+
+    // Returns false if a thread in the same state has already been added at this position. Which loops have matched
+    // the empty string so far is part of that state, as the backtracking VM leaves those instead of going around again.
+    bool visit(Thread const& thread, u64 checkpoints)
+    {
+        if (m_nfa.m_counter_count == 0 && checkpoints == 0) {
+            if (m_visited_program_counters[thread.pc] == m_generation)
+                return false;
+            m_visited_program_counters[thread.pc] = m_generation;
+            return true;
+        }
+        return m_visited_threads.set({ (static_cast<u64>(thread.counters) << 32) | thread.pc, checkpoints }) == HashSetResult::InsertedNewEntry;
+    }
+
+    bool check_assertion(u32 operation)
+    {
+        m_scratch_state.instruction_position = operation;
+        m_scratch_state.string_position = m_position;
+        m_scratch_state.string_position_in_code_units = m_position;
+        return m_nfa.m_operations.get_opcode(m_scratch_state).execute(m_input, m_scratch_state) == ExecutionResult::Continue;
+    }
+
+    size_t position() const { return m_position; }
+    CounterSets& counters() { return m_counters; }
+    Vector<CaptureEvent>* capture_events() { return m_capture_events; }
+
+    struct StackEntry {
+        Thread thread;
+        // The checkpoints that have been passed at this position, i.e. without consuming anything since.
+        u64 checkpoints { 0 };
+    };
+    Vector<StackEntry> stack;
+
+private:
+    NFA const& m_nfa;
+    MatchInput const& m_input;
+    MatchState& m_scratch_state;
+    CounterSets& m_counters;
+    Vector<CaptureEvent>* m_capture_events { nullptr };
+
+    size_t m_position { 0 };
+    u32 m_generation { 0 };
+    Vector<u32> m_visited_program_counters;
+
+    struct VisitedThread {
+        u64 state { 0 };
+        u64 checkpoints { 0 };
+        bool operator==(VisitedThread const&) const = default;
+    };
+    struct VisitedThreadTraits : public GenericTraits<VisitedThread> {
+        static unsigned hash(VisitedThread const& thread) { return pair_int_hash(u64_hash(thread.state), u64_hash(thread.checkpoints)); }
+    };
+    HashTable<VisitedThread, VisitedThreadTraits> m_visited_threads;
+};
+
+OwnPtr<NFA> NFA::try_create(ByteCode const& bytecode)
+{
+    auto nfa = adopt_own(*new NFA);
+    auto bytecode_size = bytecode.size();
+
+    // Compare opcodes that match a string become one instruction per character, so the program counters of all
+    // opcodes have to be known before any jumps can be resolved.
+    HashMap<size_t, u32> program_counters;
+    HashMap<size_t, u32> checkpoint_indices;
+    HashMap<size_t, u32> counter_indices;
+    u32 program_counter = 0;
+
+    MatchState state;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        program_counters.set(state.instruction_position, program_counter++);
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            Vector<u32> string;
+            auto shape = compare_shape(bytecode, state.instruction_position, string);
+            if (shape == CompareShape::Unsupported)
+                return nullptr;
+            if (shape == CompareShape::String)
+                program_counter += string.size() - 1;
+            break;
+        }
+        case OpCodeId::Checkpoint:
+            checkpoint_indices.set(state.instruction_position, checkpoint_indices.size());
+            break;
+        case OpCodeId::Repeat:
+            counter_indices.ensure(static_cast<OpCode_Repeat const&>(opcode).id(), [&] { return counter_indices.size(); });
+            break;
+        case OpCodeId::ResetRepeat:
+            counter_indices.ensure(static_cast<OpCode_ResetRepeat const&>(opcode).id(), [&] { return counter_indices.size(); });
+            break;
+        case OpCodeId::Jump:
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkReplaceStay:
+        case OpCodeId::JumpNonEmpty:
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            break;
+        default:
+            // Lookarounds and explicit exits can't be expressed in terms of an NFA.
+            return nullptr;
+        }
+
+        state.instruction_position += opcode.size();
+    }
+
+    // Each checkpoint that has been passed at the current position is tracked by a bit.
+    if (checkpoint_indices.size() > 64)
+        return nullptr;
+
+    auto match_program_counter = program_counter;
+    auto resolve = [&](size_t instruction_position) -> Optional<u32> {
+        // Like in the backtracking VM, running past the end of the bytecode is a successful match.
+        if (instruction_position >= bytecode_size)
+            return match_program_counter;
+        return program_counters.get(instruction_position);
+    };
+
+    auto copy_operation = [&](size_t instruction_position, size_t size) -> u32 {
+        u32 operation = nfa->m_operations.size();
+        for (size_t i = 0; i < size; ++i)
+            nfa->m_operations.empend(bytecode.at(instruction_position + i));
+        return operation;
+    };
+
+    bool is_valid = true;
+    auto resolve_or_fail = [&](size_t instruction_position) -> u32 {
+        auto program_counter = resolve(instruction_position);
+        if (!program_counter.has_value()) {
+            is_valid = false;
+            return 0;
+        }
+        return *program_counter;
+    };
+
+    state.instruction_position = 0;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto instruction_position = state.instruction_position;
+        auto next = resolve_or_fail(instruction_position + opcode.size());
+
+        Instruction instruction;
+        instruction.next = next;
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto const& compare = static_cast<OpCode_Compare const&>(opcode);
+            Vector<u32> string;
+            if (compare_shape(bytecode, instruction_position, string) == CompareShape::String) {
+                for (size_t i = 0; i < string.size(); ++i) {
+                    Instruction character_instruction;
+                    character_instruction.type = Instruction::Type::Consume;
+                    character_instruction.next = i + 1 < string.size() ? nfa->m_program.size() + 1 : next;
+                    character_instruction.operand = nfa->m_operations.size();
+                    character_instruction.literal = string[i];
+                    nfa->m_operations.empend(static_cast<ByteCodeValueType>(OpCodeId::Compare));
+                    nfa->m_operations.empend(1u); // Arguments count
+                    nfa->m_operations.empend(2u); // Arguments size
+                    nfa->m_operations.empend(static_cast<ByteCodeValueType>(CharacterCompareType::Char));
+                    nfa->m_operations.empend(string[i]);
+                    nfa->m_program.append(character_instruction);
+                }
+                state.instruction_position += opcode.size();
+                continue;
+            }
+
+            instruction.type = Instruction::Type::Consume;
+            instruction.operand = copy_operation(instruction_position, opcode.size());
+            // Single characters that aren't (part of) surrogate pairs are compared directly.
+            if (compare.arguments_count() == 1 && static_cast<CharacterCompareType>(bytecode.at(instruction_position + 3)) == CharacterCompareType::Char) {
+                auto character = bytecode.at(instruction_position + 4);
+                if (character < 0xd800)
+                    instruction.literal = character;
+            }
+            break;
+        }
+        case OpCodeId::Jump:
+            instruction.type = Instruction::Type::Jump;
+            instruction.target = resolve_or_fail(instruction_position + opcode.size() + static_cast<OpCode_Jump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay: {
+            // The replacing forks are only introduced by the optimizer where dropping the other alternative doesn't
+            // change the result, so they behave just like the regular ones here.
+            auto offset = static_cast<ssize_t>(opcode.argument(0));
+            instruction.type = Instruction::Type::Fork;
+            instruction.prefer_target = opcode.opcode_id() == OpCodeId::ForkJump || opcode.opcode_id() == OpCodeId::ForkReplaceJump;
+            instruction.target = resolve_or_fail(instruction_position + opcode.size() + offset);
+            break;
+        }
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            instruction.type = Instruction::Type::Assert;
+            instruction.operand = copy_operation(instruction_position, opcode.size());
+            nfa->m_has_assertions = true;
+            break;
+        case OpCodeId::Checkpoint:
+            instruction.type = Instruction::Type::Checkpoint;
+            instruction.operand = *checkpoint_indices.get(instruction_position);
+            break;
+        case OpCodeId::JumpNonEmpty: {
+            auto const& jump = static_cast<OpCode_JumpNonEmpty const&>(opcode);
+            auto checkpoint_index = checkpoint_indices.get(instruction_position + jump.size() + jump.checkpoint());
+            if (!checkpoint_index.has_value())
+                return nullptr;
+
+            instruction.type = Instruction::Type::JumpNonEmpty;
+            instruction.operand = *checkpoint_index;
+            instruction.target = resolve_or_fail(instruction_position + jump.size() + jump.offset());
+            switch (jump.form()) {
+            case OpCodeId::Jump:
+                instruction.forks = false;
+                break;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkReplaceJump:
+                instruction.forks = true;
+                instruction.prefer_target = true;
+                break;
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay:
+                instruction.forks = true;
+                instruction.prefer_target = false;
+                break;
+            default:
+                return nullptr;
+            }
+            break;
+        }
+        case OpCodeId::Repeat: {
+            auto const& repeat = static_cast<OpCode_Repeat const&>(opcode);
+            instruction.type = Instruction::Type::Repeat;
+            instruction.operand = *counter_indices.get(repeat.id());
+            instruction.count = repeat.count();
+            instruction.target = resolve_or_fail(instruction_position - repeat.offset());
+            break;
+        }
+        case OpCodeId::ResetRepeat:
+            instruction.type = Instruction::Type::ResetRepeat;
+            instruction.operand = *counter_indices.get(static_cast<OpCode_ResetRepeat const&>(opcode).id());
+            break;
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            instruction.type = Instruction::Type::Capture;
+            instruction.operand = copy_operation(instruction_position, opcode.size());
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+
+        nfa->m_program.append(instruction);
+        state.instruction_position += opcode.size();
+    }
+
+    if (!is_valid)
+        return nullptr;
+
+    VERIFY(nfa->m_program.size() == match_program_counter);
+    Instruction match_instruction;
+    match_instruction.type = Instruction::Type::Match;
+    nfa->m_program.append(match_instruction);
+
+    nfa->m_entry = *resolve(0);
+    nfa->m_counter_count = counter_indices.size();
+    nfa->m_dfa.counters = make<CounterSets>(nfa->m_counter_count);
+    return nfa;
+}
+
+bool NFA::can_search(MatchInput const& input)
+{
+    // In unicode mode, positions are counted in code points but the input is indexed by code units, which the
+    // backtracking VM keeps track of per path. UTF-8 views are indexed by bytes but compared by code points.
+    return !input.view.unicode() && !input.view.is_u8_view();
+}
+
+u8 NFA::context_at(MatchInput const& input, size_t position)
+{
+    if (position == 0)
+        return s_context_at_beginning;
+    return context_after(input.view[position - 1]);
+}
+
+u8 NFA::context_after(u32 character)
+{
+    // These are the characters that CheckBegin and CheckBoundary look at.
+    u8 context = 0;
+    if (character == '\r' || character == '\n' || character == 0x2028 || character == 0x2029)
+        context |= s_context_after_line_terminator;
+    if (is_ascii_alphanumeric(character) || character == '_')
+        context |= s_context_after_word_character;
+    return context;
+}
+
+// Follows the instructions that don't consume anything from the given thread, and appends the threads that are waiting
+// for a character to `threads` in order of priority. If the end of the program is reached, the thread that got there is
+// returned, and the remaining (lower priority) alternatives are dropped.
+Optional<NFA::Thread> NFA::add_thread(Closure& closure, Thread thread, Vector<Thread>& threads) const
+{
+    auto& stack = closure.stack;
+    stack.clear_with_capacity();
+    stack.append({ thread, 0 });
+
+    while (!stack.is_empty()) {
+        auto entry = stack.take_last();
+        auto& current = entry.thread;
+        auto& checkpoints = entry.checkpoints;
+
+        auto const& instruction = m_program[current.pc];
+        if (!closure.visit(current, checkpoints))
+            continue;
+
+        auto follow = [&](u32 program_counter) {
+            auto next = current;
+            next.pc = program_counter;
+            stack.append({ next, checkpoints });
+        };
+        auto fork = [&] {
+            // The alternative that is pushed last is followed first.
+            if (instruction.prefer_target) {
+                follow(instruction.next);
+                follow(instruction.target);
+            } else {
+                follow(instruction.target);
+                follow(instruction.next);
+            }
+        };
+        auto update_counter = [&](auto callback) {
+            auto counters = closure.counters().get(current.counters);
+            callback(counters[instruction.operand]);
+            current.counters = closure.counters().intern(move(counters));
+        };
+
+        switch (instruction.type) {
+        case Instruction::Type::Consume:
+            threads.append(current);
+            break;
+        case Instruction::Type::Match:
+            return current;
+        case Instruction::Type::Jump:
+            follow(instruction.target);
+            break;
+        case Instruction::Type::Fork:
+            fork();
+            break;
+        case Instruction::Type::Assert:
+            if (closure.check_assertion(instruction.operand))
+                follow(instruction.next);
+            break;
+        case Instruction::Type::Checkpoint:
+            checkpoints |= 1ull << instruction.operand;
+            follow(instruction.next);
+            break;
+        case Instruction::Type::JumpNonEmpty:
+            if (checkpoints & (1ull << instruction.operand)) {
+                // The loop body matched the empty string, so don't go around again.
+                follow(instruction.next);
+            } else if (!instruction.forks) {
+                follow(instruction.target);
+            } else {
+                fork();
+            }
+            break;
+        case Instruction::Type::Repeat: {
+            bool repeat = false;
+            update_counter([&](u64& counter) {
+                repeat = counter != instruction.count - 1;
+                counter = repeat ? counter + 1 : 0;
+            });
+            follow(repeat ? instruction.target : instruction.next);
+            break;
+        }
+        case Instruction::Type::ResetRepeat:
+            update_counter([](u64& counter) { counter = 0; });
+            follow(instruction.next);
+            break;
+        case Instruction::Type::Capture:
+            if (auto* capture_events = closure.capture_events()) {
+                capture_events->append({ instruction.operand, current.captures, closure.position() });
+                current.captures = capture_events->size() - 1;
+            }
+            follow(instruction.next);
+            break;
+        }
+    }
+
+    return {};
+}
+
+bool NFA::consume(Instruction const& instruction, MatchInput const& input, MatchState& scratch_state, size_t position) const
+{
+    if (position >= input.view.length())
+        return false;
+
+    if (instruction.literal.has_value() && !input.regex_options.has_flag_set(AllFlags::Insensitive))
+        return input.view[position] == *instruction.literal;
+
+    scratch_state.instruction_position = instruction.operand;
+    scratch_state.string_position = position;
+    scratch_state.string_position_in_code_units = position;
+    return m_operations.get_opcode(scratch_state).execute(input, scratch_state) == ExecutionResult::Continue;
+}
+
+i32 NFA::find_or_create_dfa_state(Vector<u64> threads, u8 context, bool adds_start_thread) const
+{
+    // The context only makes a difference to assertions.
+    if (!m_has_assertions)
+        context = 0;
+
+    auto key = threads;
+    key.append(context | (adds_start_thread ? 0x100 : 0));
+    if (auto index = m_dfa.state_indices.get(key); index.has_value())
+        return *index;
+
+    if (m_dfa.states.size() >= s_max_dfa_states) {
+        m_dfa.states.clear();
+        m_dfa.state_indices.clear();
+        ++m_dfa.generation;
+
+        // Counter sets are only referenced by states, so they go too. The threads of the new state have to be re-interned.
+        Vector<Vector<u64>> thread_counters;
+        thread_counters.ensure_capacity(threads.size());
+        for (auto encoded_thread : threads)
+            thread_counters.unchecked_append(m_dfa.counters->get(static_cast<u32>(encoded_thread >> 32)));
+        m_dfa.counters->clear();
+        for (size_t i = 0; i < threads.size(); ++i) {
+            u64 counters = m_dfa.counters->intern(move(thread_counters[i]));
+            threads[i] = (counters << 32) | static_cast<u32>(threads[i]);
+        }
+        key = threads;
+        key.append(context | (adds_start_thread ? 0x100 : 0));
+    }
+
+    auto state = make<DFAState>();
+    state->threads = move(threads);
+    state->context = context;
+    state->adds_start_thread = adds_start_thread;
+    state->transitions.fill(unknown_state);
+
+    i32 index = m_dfa.states.size();
+    m_dfa.states.append(move(state));
+    m_dfa.state_indices.set(move(key), index);
+    return index;
+}
+
+i32 NFA::compute_dfa_transition(i32 state_index, MatchInput const& input, MatchState& scratch_state, size_t position) const
+{
+    auto const& state = *m_dfa.states[state_index];
+
+    Closure closure(*this, input, scratch_state, *m_dfa.counters, nullptr);
+    closure.reset(position);
+
+    Vector<Thread> waiting_threads;
+    for (auto encoded_thread : state.threads) {
+        Thread thread { .pc = static_cast<u32>(encoded_thread), .counters = static_cast<u32>(encoded_thread >> 32) };
+        if (add_thread(closure, thread, waiting_threads).has_value())
+            return match_state;
+    }
+    if (state.adds_start_thread && add_thread(closure, Thread { .pc = m_entry }, waiting_threads).has_value())
+        return match_state;
+
+    if (position == input.view.length())
+        return dead_state;
+
+    Vector<u64> next_threads;
+    for (auto const& thread : waiting_threads) {
+        auto const& instruction = m_program[thread.pc];
+        if (consume(instruction, input, scratch_state, position))
+            next_threads.append((static_cast<u64>(thread.counters) << 32) | instruction.next);
+    }
+    if (next_threads.is_empty() && !state.adds_start_thread)
+        return dead_state;
+
+    return find_or_create_dfa_state(move(next_threads), context_after(input.view[position]), state.adds_start_thread);
+}
+
+NFA::DFAResult NFA::run_dfa(MatchInput const& input, MatchState& scratch_state, size_t start, size_t last_start, size_t& operations) const
+{
+    if (m_dfa.options != input.regex_options.value()) {
+        // The options affect how characters are compared, so none of the cached transitions are valid anymore.
+        m_dfa.states.clear();
+        m_dfa.state_indices.clear();
+        m_dfa.counters->clear();
+        m_dfa.options = input.regex_options.value();
+    }
+
+    auto length = input.view.length();
+    auto generation = m_dfa.generation;
+    auto position_at_last_reset = start;
+
+    auto state_index = find_or_create_dfa_state({}, context_at(input, start), true);
+
+    for (auto position = start;; ++position) {
+        ++operations;
+
+        // Transitions are only stored if the cache (and the state they belong to) wasn't cleared while computing them.
+        // The state that was computed is always valid though.
+        if (m_dfa.generation != generation) {
+            if (position - position_at_last_reset < s_max_dfa_states * s_min_characters_per_dfa_state)
+                return DFAResult::GaveUp;
+            generation = m_dfa.generation;
+            position_at_last_reset = position;
+        }
+
+        auto* state = m_dfa.states[state_index].ptr();
+        if (state->adds_start_thread && position > last_start) {
+            auto next_index = state->without_start_thread;
+            if (next_index == unknown_state) {
+                next_index = find_or_create_dfa_state(state->threads, state->context, false);
+                if (m_dfa.generation == generation)
+                    state->without_start_thread = next_index;
+            }
+            state_index = next_index;
+            state = m_dfa.states[state_index].ptr();
+        }
+
+        i32 next_index;
+        if (position == length) {
+            if (state->transition_at_end == unknown_state)
+                state->transition_at_end = compute_dfa_transition(state_index, input, scratch_state, position);
+            next_index = state->transition_at_end;
+        } else if (auto character = input.view[position]; character < state->transitions.size()) {
+            next_index = state->transitions[character];
+            if (next_index == unknown_state) {
+                next_index = compute_dfa_transition(state_index, input, scratch_state, position);
+                if (m_dfa.generation == generation)
+                    state->transitions[character] = next_index;
+            }
+        } else {
+            next_index = state->wide_transitions.get(character).value_or(unknown_state);
+            if (next_index == unknown_state) {
+                next_index = compute_dfa_transition(state_index, input, scratch_state, position);
+                if (m_dfa.generation == generation)
+                    state->wide_transitions.set(character, next_index);
+            }
+        }
+
+        if (next_index == match_state)
+            return DFAResult::Match;
+        if (next_index == dead_state || position == length)
+            return DFAResult::NoMatch;
+        state_index = next_index;
+    }
+}
+
+Optional<size_t> NFA::run_pike_vm(MatchInput const& input, MatchState& state, MatchState& scratch_state, size_t start, size_t last_start, size_t& operations) const
+{
+    CounterSets counters(m_counter_count);
+    Vector<CaptureEvent> capture_events;
+    Closure closure(*this, input, scratch_state, counters, &capture_events);
+
+    Vector<Thread> pending_threads;
+    Vector<Thread> waiting_threads;
+    Optional<Thread> match;
+    size_t match_end = 0;
+
+    auto length = input.view.length();
+    for (auto position = start;; ++position) {
+        ++operations;
+        closure.reset(position);
+        waiting_threads.clear_with_capacity();
+
+        // Threads are added in order of priority. Once one of them matches, all threads after it are dropped, and
+        // only the ones before it can still find a better match.
+        bool found_match = false;
+        for (auto const& thread : pending_threads) {
+            if (auto matching_thread = add_thread(closure, thread, waiting_threads); matching_thread.has_value()) {
+                match = matching_thread;
+                match_end = position;
+                found_match = true;
+                break;
+            }
+        }
+        if (!found_match && !match.has_value() && position <= last_start) {
+            if (auto matching_thread = add_thread(closure, Thread { .pc = m_entry, .start = position }, waiting_threads); matching_thread.has_value()) {
+                match = matching_thread;
+                match_end = position;
+            }
+        }
+
+        if (position == length)
+            break;
+        if (waiting_threads.is_empty() && (match.has_value() || position >= last_start))
+            break;
+
+        pending_threads.clear_with_capacity();
+        for (auto thread : waiting_threads) {
+            auto const& instruction = m_program[thread.pc];
+            if (consume(instruction, input, scratch_state, position)) {
+                thread.pc = instruction.next;
+                pending_threads.append(thread);
+            }
+        }
+    }
+
+    if (!match.has_value())
+        return {};
+
+    // Replay the capture group operations on the path of the matching thread, exactly like the backtracking VM would have.
+    Vector<u32> capture_path;
+    for (auto index = match->captures; index != no_captures; index = capture_events[index].previous)
+        capture_path.append(index);
+
+    for (size_t i = capture_path.size(); i > 0; --i) {
+        auto const& event = capture_events[capture_path[i - 1]];
+        state.instruction_position = event.operation;
+        state.string_position = event.position;
+        state.string_position_in_code_units = event.position;
+        m_operations.get_opcode(state).execute(input, state);
+    }
+
+    state.string_position = match_end;
+    state.string_position_in_code_units = match_end;
+    return match->start;
+}
+
+Optional<size_t> NFA::search(MatchInput const& input, MatchState& state, size_t start, size_t last_start, size_t& operations) const
+{
+    MatchState scratch_state;
+
+    if (!m_dfa.disabled) {
+        switch (run_dfa(input, scratch_state, start, last_start, operations)) {
+        case DFAResult::NoMatch:
+            return {};
+        case DFAResult::Match:
+            break;
+        case DFAResult::GaveUp:
+            if (++m_dfa.times_given_up >= s_max_times_dfa_given_up) {
+                m_dfa.disabled = true;
+                m_dfa.states.clear();
+                m_dfa.state_indices.clear();
+            }
+            break;
+        }
+    }
+
+    return run_pike_vm(input, state, scratch_state, start, last_start, operations);
+}
+
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Matches patterns without backreferences and lookarounds in time linear in the length of the input.
+//
+// The bytecode of such patterns is translated into an NFA. Whether a match exists is then decided by a DFA that is
+// built lazily from the NFA while matching, and whose states are cached (up to a fixed number) across matches.
+// Only if there is a match, the NFA is simulated directly (a "Pike VM") to find its bounds and capture groups.
+// Both follow each instruction at most once per input position, and prefer alternatives in the same order as the
+// backtracking VM in Matcher::execute() does.
+class NFA {
+public:
+    // Returns null if the bytecode contains anything that can't be expressed as an NFA, like backreferences or lookarounds.
+    static OwnPtr<NFA> try_create(ByteCode const&);
+
+    static bool can_search(MatchInput const&);
+
+    // Finds the first match that starts anywhere in [start, last_start]. If there is one, its end and capture groups are
+    // stored in the state like Matcher::execute() would, and the position it starts at is returned.
+    Optional<size_t> search(MatchInput const&, MatchState&, size_t start, size_t last_start, size_t& operations) const;
+
+private:
+    NFA() = default;
+
+    struct Instruction {
+        enum class Type : u8 {
+            Consume,
+            Jump,
+            Fork,
+            Assert,
+            Checkpoint,
+            JumpNonEmpty,
+            Repeat,
+            ResetRepeat,
+            Capture,
+            Match,
+        };
+
+        Type type { Type::Match };
+        // Fork and JumpNonEmpty: Whether the jump target is tried before the next instruction.
+        bool prefer_target { false };
+        // JumpNonEmpty: Whether the next instruction is tried at all if the loop didn't match the empty string.
+        bool forks { false };
+        u32 next { 0 };
+        u32 target { 0 };
+        // Consume, Assert and Capture: The position of the opcode to execute in m_operations.
+        // Checkpoint and JumpNonEmpty: The index of the checkpoint.
+        // Repeat and ResetRepeat: The index of the repetition counter.
+        u32 operand { 0 };
+        u64 count { 0 };
+        // Consume: The character to compare against, if that is all this instruction does.
+        Optional<u32> literal;
+    };
+
+    static constexpr u32 no_captures = NumericLimits<u32>::max();
+
+    struct Thread {
+        u32 pc { 0 };
+        // An index into the interned repetition counter values, see CounterSets.
+        u32 counters { 0 };
+        // The last capture group operation on the path of this thread, only recorded by the Pike VM.
+        u32 captures { no_captures };
+        size_t start { 0 };
+    };
+
+    struct U64VectorTraits : public GenericTraits<Vector<u64>> {
+        static unsigned hash(Vector<u64> const&);
+    };
+
+    class CounterSets {
+    public:
+        explicit CounterSets(size_t counter_count);
+
+        Vector<u64> const& get(u32 index) const { return m_sets[index]; }
+        u32 intern(Vector<u64>);
+        void clear();
+
+    private:
+        size_t m_counter_count { 0 };
+        Vector<Vector<u64>> m_sets;
+        HashMap<Vector<u64>, u32, U64VectorTraits> m_indices;
+    };
+
+    struct CaptureEvent {
+        u32 operation { 0 };
+        u32 previous { no_captures };
+        size_t position { 0 };
+    };
+
+    class Closure;
+
+    static constexpr i32 unknown_state = -1;
+    static constexpr i32 dead_state = -2;
+    static constexpr i32 match_state = -3;
+
+    struct DFAState {
+        // The threads that are about to continue after the previous character, in order of priority.
+        Vector<u64> threads;
+        u8 context { 0 };
+        bool adds_start_thread { false };
+
+        Array<i32, 256> transitions;
+        HashMap<u32, i32> wide_transitions;
+        i32 transition_at_end { unknown_state };
+        i32 without_start_thread { unknown_state };
+    };
+
+    enum class DFAResult {
+        Match,
+        NoMatch,
+        GaveUp,
+    };
+
+    struct DFACache {
+        Optional<AllFlags> options;
+        Vector<NonnullOwnPtr<DFAState>> states;
+        HashMap<Vector<u64>, i32, U64VectorTraits> state_indices;
+        OwnPtr<CounterSets> counters;
+        // Incremented whenever the states are cleared because the cache is full.
+        size_t generation { 0 };
+        size_t times_given_up { 0 };
+        bool disabled { false };
+    };
+
+    static u8 context_at(MatchInput const&, size_t position);
+    static u8 context_after(u32 character);
+
+    Optional<Thread> add_thread(Closure&, Thread, Vector<Thread>&) const;
+    bool consume(Instruction const&, MatchInput const&, MatchState&, size_t position) const;
+
+    DFAResult run_dfa(MatchInput const&, MatchState&, size_t start, size_t last_start, size_t& operations) const;
+    i32 find_or_create_dfa_state(Vector<u64> threads, u8 context, bool adds_start_thread) const;
+    i32 compute_dfa_transition(i32 state_index, MatchInput const&, MatchState&, size_t position) const;
+
+    Optional<size_t> run_pike_vm(MatchInput const&, MatchState&, MatchState& scratch_state, size_t start, size_t last_start, size_t& operations) const;
+
+    Vector<Instruction> m_program;
+    // Copies of the opcodes that read the input or write capture groups, which are still executed by the backtracking VM's code.
+    ByteCode m_operations;
+    u32 m_entry { 0 };
+    size_t m_counter_count { 0 };
+    bool m_has_assertions { false };
+
+    mutable DFACache m_dfa;
+};
+
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexPrefilter.h"
+#include <AK/BuiltinWrappers.h>
+#include <AK/CPUFeatures.h>
+#include <AK/CharacterTypes.h>
+#include <AK/MemMem.h>
+#include <string.h>
+
+#if AK_IS_ARCH_X86_64()
+#    include <immintrin.h>
+#endif
+
+namespace regex {
+
+// If the Compare opcode at the given position matches a fixed string of ASCII characters and nothing else, appends them to the literal.
+static bool append_compared_literal(ByteCode const& bytecode, size_t instruction_position, Vector<u8>& literal)
+{
+    auto arguments_count = bytecode.at(instruction_position + 1);
+    if (arguments_count != 1)
+        return false;
+
+    auto offset = instruction_position + 3;
+    switch ((CharacterCompareType)bytecode.at(offset++)) {
+    case CharacterCompareType::Char: {
+        auto character = bytecode.at(offset);
+        if (!is_ascii(character))
+            return false;
+        literal.append(static_cast<u8>(character));
+        return true;
+    }
+    case CharacterCompareType::String: {
+        auto length = bytecode.at(offset++);
+        if (length == 0)
+            return false;
+        for (size_t i = 0; i < length; ++i) {
+            if (!is_ascii(bytecode.at(offset + i)))
+                return false;
+        }
+        for (size_t i = 0; i < length; ++i)
+            literal.append(static_cast<u8>(bytecode.at(offset + i)));
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+Optional<LiteralPrefilter> LiteralPrefilter::try_create(ByteCode const& bytecode)
+{
+    auto bytecode_size = bytecode.size();
+    MatchState state;
+    state.instruction_position = 0;
+
+    // Every path through the bytecode passes an instruction, unless an instruction before it can jump past it.
+    // Backwards jumps only ever repeat instructions that have already been passed.
+    size_t furthest_forward_jump_target = 0;
+    bool at_start_of_match = true;
+
+    Vector<u8> literal;
+    bool literal_is_prefix = false;
+    Vector<u8> best_literal;
+    bool best_literal_is_prefix = false;
+
+    auto end_literal = [&] {
+        if (literal.size() > best_literal.size()) {
+            best_literal = move(literal);
+            best_literal_is_prefix = literal_is_prefix;
+        }
+        literal.clear();
+    };
+
+    while (state.instruction_position < bytecode_size) {
+        auto const& opcode = bytecode.get_opcode(state);
+        auto instruction_position = state.instruction_position;
+        auto is_always_passed = furthest_forward_jump_target <= instruction_position;
+
+        auto jump_to = [&](size_t target) {
+            // Jumping to the next instruction doesn't change anything.
+            if (target == instruction_position + opcode.size())
+                return;
+            furthest_forward_jump_target = max(furthest_forward_jump_target, target);
+            at_start_of_match = false;
+            end_literal();
+        };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto literal_size = literal.size();
+            if (is_always_passed && append_compared_literal(bytecode, instruction_position, literal)) {
+                if (literal_size == 0)
+                    literal_is_prefix = at_start_of_match;
+            } else {
+                end_literal();
+            }
+            at_start_of_match = false;
+            break;
+        }
+        case OpCodeId::Jump:
+            jump_to(instruction_position + opcode.size() + static_cast<OpCode_Jump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            jump_to(instruction_position + opcode.size() + static_cast<OpCode_ForkJump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            jump_to(instruction_position + opcode.size() + static_cast<OpCode_ForkStay const&>(opcode).offset());
+            break;
+        case OpCodeId::JumpNonEmpty:
+            jump_to(instruction_position + opcode.size() + static_cast<OpCode_JumpNonEmpty const&>(opcode).offset());
+            break;
+        case OpCodeId::Repeat:
+            jump_to(instruction_position - static_cast<OpCode_Repeat const&>(opcode).offset());
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+            // Lookarounds look at input outside of the match, or require something *not* to be there.
+            return {};
+        case OpCodeId::Exit:
+            end_literal();
+            break;
+        default:
+            // Capture groups, assertions and other bookkeeping don't consume anything.
+            if (!is_always_passed)
+                end_literal();
+            break;
+        }
+
+        state.instruction_position += opcode.size();
+    }
+    end_literal();
+
+    if (best_literal.is_empty())
+        return {};
+    return LiteralPrefilter { move(best_literal), best_literal_is_prefix };
+}
+
+bool LiteralPrefilter::can_search(MatchInput const& input)
+{
+    // Case-insensitive literals would have to be searched for in all their spellings, and in unicode mode positions
+    // aren't indices into the view.
+    if (input.regex_options.has_flag_set(AllFlags::Insensitive))
+        return false;
+    return !input.view.unicode() && !input.view.is_u8_view();
+}
+
+template<typename CodeUnit>
+static Optional<size_t> find_wide_literal(ReadonlySpan<CodeUnit> haystack, ReadonlyBytes needle)
+{
+    if (haystack.size() < needle.size())
+        return {};
+
+    for (size_t position = 0; position <= haystack.size() - needle.size(); ++position) {
+        if (haystack[position] != needle[0])
+            continue;
+        size_t i = 1;
+        while (i < needle.size() && haystack[position + i] == needle[i])
+            ++i;
+        if (i == needle.size())
+            return position;
+    }
+    return {};
+}
+
+Optional<size_t> LiteralPrefilter::find(RegexStringView const& view, size_t start) const
+{
+    Optional<size_t> position;
+    if (view.is_string_view()) {
+        position = find_literal(view.string_view().bytes().slice(min(start, view.length())), m_literal);
+    } else if (view.is_u16_view()) {
+        auto const& u16_view = view.u16_view();
+        ReadonlySpan<u16> code_units { u16_view.data(), u16_view.length_in_code_units() };
+        position = find_wide_literal(code_units.slice(min(start, code_units.size())), m_literal);
+    } else {
+        auto const& u32_view = view.u32_view();
+        ReadonlySpan<u32> code_points { u32_view.code_points(), u32_view.length() };
+        position = find_wide_literal(code_points.slice(min(start, code_points.size())), m_literal);
+    }
+
+    if (!position.has_value())
+        return {};
+    return start + *position;
+}
+
+#if AK_IS_ARCH_X86_64()
+
+// These look for positions at which both the first and the last byte of the needle match, a whole vector of positions at a time,
+// and only compare the bytes in between at those. If the needle wasn't found, `position` is where the rest of the haystack starts.
+
+static Optional<size_t> find_literal_with_sse2(ReadonlyBytes haystack, ReadonlyBytes needle, size_t& position)
+{
+    auto first = _mm_set1_epi8(static_cast<char>(needle.first()));
+    auto last = _mm_set1_epi8(static_cast<char>(needle.last()));
+
+    for (; position + needle.size() + 15 <= haystack.size(); position += 16) {
+        auto block_first = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.offset_pointer(position)));
+        auto block_last = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack.offset_pointer(position + needle.size() - 1)));
+        u32 candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+        while (candidates != 0) {
+            auto candidate = position + count_trailing_zeroes(candidates);
+            if (memcmp(haystack.offset_pointer(candidate + 1), needle.offset_pointer(1), needle.size() - 2) == 0)
+                return candidate;
+            candidates &= candidates - 1;
+        }
+    }
+    return {};
+}
+
+[[gnu::target("avx2")]] static Optional<size_t> find_literal_with_avx2(ReadonlyBytes haystack, ReadonlyBytes needle, size_t& position)
+{
+    auto first = _mm256_set1_epi8(static_cast<char>(needle.first()));
+    auto last = _mm256_set1_epi8(static_cast<char>(needle.last()));
+
+    for (; position + needle.size() + 31 <= haystack.size(); position += 32) {
+        auto block_first = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.offset_pointer(position)));
+        auto block_last = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack.offset_pointer(position + needle.size() - 1)));
+        u32 candidates = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+        while (candidates != 0) {
+            auto candidate = position + count_trailing_zeroes(candidates);
+            if (memcmp(haystack.offset_pointer(candidate + 1), needle.offset_pointer(1), needle.size() - 2) == 0)
+                return candidate;
+            candidates &= candidates - 1;
+        }
+    }
+    return {};
+}
+
+#endif
+
+Optional<size_t> find_literal(ReadonlyBytes haystack, ReadonlyBytes needle)
+{
+    if (needle.is_empty())
+        return 0;
+    if (haystack.size() < needle.size())
+        return {};
+
+    if (needle.size() == 1) {
+        // The C library already has a vectorized implementation of this.
+        auto const* match = static_cast<u8 const*>(memchr(haystack.data(), needle[0], haystack.size()));
+        if (!match)
+            return {};
+        return match - haystack.data();
+    }
+
+    size_t position = 0;
+#if AK_IS_ARCH_X86_64()
+    auto match = cpu_features().avx2
+        ? find_literal_with_avx2(haystack, needle, position)
+        : find_literal_with_sse2(haystack, needle, position);
+    if (match.has_value())
+        return match;
+#endif
+
+    auto match_in_rest = AK::memmem_optional(haystack.offset_pointer(position), haystack.size() - position, needle.data(), needle.size());
+    if (!match_in_rest.has_value())
+        return {};
+    return position + *match_in_rest;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// A string of characters that every match of a pattern contains, which is looked for before running the matcher so that
+// input that can't possibly match is skipped quickly.
+class LiteralPrefilter {
+public:
+    // Returns an empty Optional if there is no such literal, or it can't be determined from the bytecode.
+    static Optional<LiteralPrefilter> try_create(ByteCode const&);
+
+    static bool can_search(MatchInput const&);
+
+    // Whether every match starts with the literal, rather than just containing it somewhere.
+    bool is_prefix() const { return m_is_prefix; }
+    ReadonlyBytes literal() const { return m_literal.span(); }
+
+    // Returns the position of the first occurrence of the literal at or after `start`.
+    Optional<size_t> find(RegexStringView const&, size_t start) const;
+
+private:
+    LiteralPrefilter(Vector<u8> literal, bool is_prefix)
+        : m_literal(move(literal))
+        , m_is_prefix(is_prefix)
+    {
+    }
+
+    Vector<u8> m_literal;
+    bool m_is_prefix { false };
+};
+
+// Finds the first occurrence of the needle in the haystack, using SIMD instructions where available.
+Optional<size_t> find_literal(ReadonlyBytes haystack, ReadonlyBytes needle);
+
+}
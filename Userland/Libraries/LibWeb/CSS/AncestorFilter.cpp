@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringHash.h>
+#include <LibWeb/CSS/AncestorFilter.h>
+#include <LibWeb/DOM/Element.h>
+#include <LibWeb/HTML/AttributeNames.h>
+
+namespace Web::CSS {
+
+u32 AncestorFilter::hash(HashKind kind, StringView name)
+{
+    return AK::case_insensitive_string_hash(name.characters_without_null_termination(), name.length(), to_underlying(kind));
+}
+
+void AncestorFilter::add(u32 hash)
+{
+    for (auto index : { hash & key_mask, (hash >> key_bits) & key_mask }) {
+        if (m_buckets[index] != NumericLimits<u8>::max())
+            ++m_buckets[index];
+    }
+}
+
+void AncestorFilter::remove(u32 hash)
+{
+    for (auto index : { hash & key_mask, (hash >> key_bits) & key_mask }) {
+        VERIFY(m_buckets[index] != 0);
+        if (m_buckets[index] != NumericLimits<u8>::max())
+            --m_buckets[index];
+    }
+}
+
+void AncestorFilter::push_ancestor(DOM::Element const& element)
+{
+    auto hash_count_before = m_hashes.size();
+    m_hashes.append(hash(HashKind::TagName, element.local_name().view()));
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_null())
+        m_hashes.append(hash(HashKind::Id, id.view()));
+    for (auto const& class_name : element.class_names())
+        m_hashes.append(hash(HashKind::Class, class_name.bytes_as_string_view()));
+
+    for (size_t i = hash_count_before; i < m_hashes.size(); ++i)
+        add(m_hashes[i]);
+    m_ancestors.append({ &element, m_hashes.size() - hash_count_before });
+}
+
+void AncestorFilter::pop_ancestor(DOM::Element const& element)
+{
+    auto ancestor = m_ancestors.take_last();
+    VERIFY(ancestor.element == &element);
+    for (size_t i = 0; i < ancestor.hash_count; ++i)
+        remove(m_hashes.take_last());
+}
+
+bool AncestorFilter::is_filtering_ancestors_of(DOM::Element const& element) const
+{
+    return !m_ancestors.is_empty() && m_ancestors.last().element == element.parent();
+}
+
+bool AncestorFilter::may_contain_all(ReadonlySpan<u32> hashes) const
+{
+    for (auto hash : hashes) {
+        if (m_buckets[hash & key_mask] == 0 || m_buckets[(hash >> key_bits) & key_mask] == 0)
+            return false;
+    }
+    return true;
+}
+
+}
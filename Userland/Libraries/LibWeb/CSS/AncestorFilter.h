@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Span.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibWeb/Forward.h>
+
+namespace Web::CSS {
+
+// A counting Bloom filter of the tag names, IDs and classes of the elements that enclose the element whose style is
+// being computed. The style tree walk pushes every element before visiting its descendants, and pops it afterwards.
+// Selectors whose descendant and child combinators ask for ancestors with something the filter has never seen can be
+// rejected without walking up the DOM. The filter may claim to contain hashes it doesn't, but never the other way around.
+class AncestorFilter {
+public:
+    enum class HashKind : u32 {
+        TagName = 0x7a9e1b01,
+        Id = 0x3c5d2f02,
+        Class = 0x51f0c603,
+    };
+
+    // Names are hashed case-insensitively, which covers both the case-sensitive and the case-insensitive ways to match them.
+    static u32 hash(HashKind, StringView name);
+
+    void push_ancestor(DOM::Element const&);
+    void pop_ancestor(DOM::Element const&);
+
+    // The filter only knows all ancestors of an element while the element's parent is the most recently pushed one.
+    bool is_filtering_ancestors_of(DOM::Element const&) const;
+
+    bool may_contain_all(ReadonlySpan<u32> hashes) const;
+
+private:
+    static constexpr size_t key_bits = 12;
+    static constexpr u32 key_mask = (1u << key_bits) - 1;
+
+    // Each hash counts towards two buckets. A bucket that overflows stays full for good, as it's no longer known how many
+    // of the hashes in it have been removed again.
+    void add(u32 hash);
+    void remove(u32 hash);
+
+    Array<u8, 1u << key_bits> m_buckets {};
+
+    struct Ancestor {
+        DOM::Element const* element { nullptr };
+        size_t hash_count { 0 };
+    };
+    Vector<Ancestor> m_ancestors;
+    Vector<u32> m_hashes;
+};
+
+}
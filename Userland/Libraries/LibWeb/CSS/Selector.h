@@ -150,7 +150,8 @@ public:
         struct Name {
             Name(FlyString n)
                 : name(move(n))
-                , lowercase_name(name.to_string().to_lowercase().release_value_but_fixme_should_propagate_errors())
+                // HTML element and attribute names are matched ASCII case-insensitively, which doesn't need the Unicode data.
+                , lowercase_name(FlyString::from_utf8(name.bytes_as_string_view().to_lowercase_string()).release_value_but_fixme_should_propagate_errors())
             {
             }
 
@@ -50,8 +50,10 @@
 #include <LibWeb/CSS/StyleValues/StyleValueList.h>
 #include <LibWeb/CSS/StyleValues/TextDecorationStyleValue.h>
 #include <LibWeb/CSS/StyleValues/UnresolvedStyleValue.h>
+#include <LibWeb/DOM/Attr.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
+#include <LibWeb/DOM/NamedNodeMap.h>
 #include <LibWeb/FontCache.h>
 #include <LibWeb/HTML/HTMLHtmlElement.h>
 #include <LibWeb/Layout/Node.h>
@@ -223,12 +225,22 @@ Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& e
         add_rules_to_run(it->value);
     add_rules_to_run(rule_cache.other_rules);
 
+    // Only the style tree walk keeps the ancestor filter up to date, styles computed any other way try every selector.
+    bool const can_use_ancestor_filter = m_ancestor_filter.is_filtering_ancestors_of(element);
+
     Vector<MatchingRule> matching_rules;
     matching_rules.ensure_capacity(rules_to_run.size());
     for (auto const& rule_to_run : rules_to_run) {
+        ++m_selector_matching_statistics.selectors_tried;
+        if (can_use_ancestor_filter && !m_ancestor_filter.may_contain_all(rule_to_run.ancestor_hashes.span().trim(rule_to_run.ancestor_hash_count))) {
+            ++m_selector_matching_statistics.rejected_by_ancestor_filter;
+            continue;
+        }
         auto const& selector = rule_to_run.rule->selectors()[rule_to_run.selector_index];
-        if (SelectorEngine::matches(selector, element, pseudo_element))
+        if (SelectorEngine::matches(selector, element, pseudo_element)) {
+            ++m_selector_matching_statistics.selectors_matched;
             matching_rules.append(rule_to_run);
+        }
     }
     return matching_rules;
 }
@@ -934,25 +946,9 @@ static ErrorOr<void> cascade_custom_properties(DOM::Element& element, Vector<Mat
 }
 
 // https://www.w3.org/TR/css-cascade/#cascading
-ErrorOr<void> StyleComputer::compute_cascaded_values(StyleProperties& style, DOM::Element& element, Optional<CSS::Selector::PseudoElement> pseudo_element, bool& did_match_any_pseudo_element_rules, ComputeStyleMode mode) const
+ErrorOr<void> StyleComputer::compute_cascaded_values(StyleProperties& style, DOM::Element& element, Optional<CSS::Selector::PseudoElement> pseudo_element, MatchingRuleSet const& matching_rule_set) const
 {
-    // First, we collect all the CSS rules whose selectors match `element`:
-    MatchingRuleSet matching_rule_set;
-    matching_rule_set.user_agent_rules = collect_matching_rules(element, CascadeOrigin::UserAgent, pseudo_element);
-    sort_matching_rules(matching_rule_set.user_agent_rules);
-    matching_rule_set.author_rules = collect_matching_rules(element, CascadeOrigin::Author, pseudo_element);
-    sort_matching_rules(matching_rule_set.author_rules);
-
-    if (mode == ComputeStyleMode::CreatePseudoElementStyleIfNeeded) {
-        VERIFY(pseudo_element.has_value());
-        if (matching_rule_set.author_rules.is_empty() && matching_rule_set.user_agent_rules.is_empty()) {
-            did_match_any_pseudo_element_rules = false;
-            return {};
-        }
-        did_match_any_pseudo_element_rules = true;
-    }
-
-    // Then we resolve all the CSS custom properties ("variables") for this element:
+    // First, we resolve all the CSS custom properties ("variables") for this element:
     // FIXME: Look into how custom properties should interact with pseudo elements and support that properly.
     if (!pseudo_element.has_value())
         TRY(cascade_custom_properties(element, matching_rule_set.author_rules));
@@ -1011,12 +1007,12 @@ void StyleComputer::compute_defaulted_property_value(StyleProperties& style, DOM
 {
     // FIXME: If we don't know the correct initial value for a property, we fall back to InitialStyleValue.
 
-    auto& value_slot = style.m_property_values[to_underlying(property_id)];
+    auto& value_slot = style.mutable_value_slot(property_id);
     if (!value_slot) {
         if (is_inherited_property(property_id))
-            style.m_property_values[to_underlying(property_id)] = get_inherit_value(document().realm(), property_id, element, pseudo_element);
+            value_slot = get_inherit_value(document().realm(), property_id, element, pseudo_element);
         else
-            style.m_property_values[to_underlying(property_id)] = property_initial_value(document().realm(), property_id).release_value_but_fixme_should_propagate_errors();
+            value_slot = property_initial_value(document().realm(), property_id).release_value_but_fixme_should_propagate_errors();
         return;
     }
 
@@ -1408,7 +1404,7 @@ ErrorOr<void> StyleComputer::absolutize_values(StyleProperties& style, DOM::Elem
     //       We have to resolve them right away, so that the *computed* line-height is ready for inheritance.
     //       We can't simply absolutize *all* percentage values against the font size,
     //       because most percentages are relative to containing block metrics.
-    auto& line_height_value_slot = style.m_property_values[to_underlying(CSS::PropertyID::LineHeight)];
+    auto& line_height_value_slot = style.mutable_value_slot(CSS::PropertyID::LineHeight);
     if (line_height_value_slot && line_height_value_slot->is_percentage()) {
         line_height_value_slot = TRY(LengthStyleValue::create(
             Length::make_px(font_size * line_height_value_slot->as_percentage().percentage().as_fraction())));
@@ -1421,8 +1417,8 @@ ErrorOr<void> StyleComputer::absolutize_values(StyleProperties& style, DOM::Elem
     if (line_height_value_slot && line_height_value_slot->is_length())
         line_height_value_slot = TRY(LengthStyleValue::create(Length::make_px(line_height)));
 
-    for (size_t i = 0; i < style.m_property_values.size(); ++i) {
-        auto& value_slot = style.m_property_values[i];
+    for (auto i = to_underlying(CSS::first_property_id); i <= to_underlying(CSS::last_property_id); ++i) {
+        auto& value_slot = style.mutable_value_slot(static_cast<CSS::PropertyID>(i));
         if (!value_slot)
             continue;
         value_slot = TRY(value_slot->absolutized(viewport_rect(), font_metrics, m_root_element_font_metrics));
@@ -1522,6 +1518,81 @@ void StyleComputer::transform_box_type_if_needed(StyleProperties& style, DOM::El
         style.set_property(CSS::PropertyID::Display, DisplayStyleValue::create(new_display).release_value_but_fixme_should_propagate_errors());
 }
 
+void StyleComputer::push_ancestor(DOM::Element const& element)
+{
+    m_ancestor_filter.push_ancestor(element);
+    m_style_sharing_candidates.append({});
+}
+
+void StyleComputer::pop_ancestor(DOM::Element const& element)
+{
+    m_ancestor_filter.pop_ancestor(element);
+    m_style_sharing_candidates.take_last();
+}
+
+static bool has_inline_style(DOM::Element const& element)
+{
+    auto const* inline_style = verify_cast<PropertyOwningCSSStyleDeclaration>(element.inline_style());
+    return inline_style && (!inline_style->properties().is_empty() || !inline_style->custom_properties().is_empty());
+}
+
+// Presentational hints are the only way attributes affect styles without going through selectors, but comparing all of
+// them is simpler than knowing which ones each element type cares about. Siblings usually have them in the same order.
+static bool have_same_attributes(DOM::Element const& a, DOM::Element const& b)
+{
+    if (a.attribute_list_size() != b.attribute_list_size())
+        return false;
+    for (size_t i = 0; i < a.attribute_list_size(); ++i) {
+        auto const& a_attribute = *a.attributes()->item(i);
+        auto const& b_attribute = *b.attributes()->item(i);
+        if (a_attribute.namespace_uri() != b_attribute.namespace_uri() || a_attribute.name() != b_attribute.name() || a_attribute.value() != b_attribute.value())
+            return false;
+    }
+    return true;
+}
+
+static bool have_same_rules(Vector<MatchingRule> const& a, Vector<MatchingRule> const& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].rule != b[i].rule || a[i].selector_index != b[i].selector_index)
+            return false;
+    }
+    return true;
+}
+
+RefPtr<StyleProperties> StyleComputer::find_shareable_style(DOM::Element const& element, MatchingRuleSet const& matching_rule_set) const
+{
+    // The candidates are all children of the same parent, so they inherit the same values and see the same ancestors when
+    // resolving custom properties. Structural pseudo-classes and the like show up in the rules that matched.
+    if (has_inline_style(element))
+        return nullptr;
+
+    for (auto const& candidate : m_style_sharing_candidates.last()) {
+        if (candidate.element->local_name() != element.local_name() || candidate.element->namespace_() != element.namespace_())
+            continue;
+        if (!have_same_attributes(*candidate.element, element))
+            continue;
+        if (!have_same_rules(candidate.matching_rule_set.user_agent_rules, matching_rule_set.user_agent_rules)
+            || !have_same_rules(candidate.matching_rule_set.author_rules, matching_rule_set.author_rules))
+            continue;
+        return candidate.style;
+    }
+    return nullptr;
+}
+
+void StyleComputer::add_style_sharing_candidate(DOM::Element const& element, NonnullRefPtr<StyleProperties> style, MatchingRuleSet matching_rule_set) const
+{
+    if (has_inline_style(element))
+        return;
+
+    auto& candidates = m_style_sharing_candidates.last();
+    if (candidates.size() == max_style_sharing_candidates)
+        candidates.take_first();
+    candidates.append({ element, move(style), move(matching_rule_set) });
+}
+
 NonnullRefPtr<StyleProperties> StyleComputer::create_document_style() const
 {
     auto style = StyleProperties::create();
@@ -1549,26 +1620,53 @@ ErrorOr<RefPtr<StyleProperties>> StyleComputer::compute_style_impl(DOM::Element&
 {
     build_rule_cache_if_needed();
 
-    auto style = StyleProperties::create();
-    // 1. Perform the cascade. This produces the "specified style"
-    bool did_match_any_pseudo_element_rules = false;
-    TRY(compute_cascaded_values(style, element, pseudo_element, did_match_any_pseudo_element_rules, mode));
+    // 1. Collect all the CSS rules whose selectors match `element`
+    MatchingRuleSet matching_rule_set;
+    matching_rule_set.user_agent_rules = collect_matching_rules(element, CascadeOrigin::UserAgent, pseudo_element);
+    sort_matching_rules(matching_rule_set.user_agent_rules);
+    matching_rule_set.author_rules = collect_matching_rules(element, CascadeOrigin::Author, pseudo_element);
+    sort_matching_rules(matching_rule_set.author_rules);
 
-    if (mode == ComputeStyleMode::CreatePseudoElementStyleIfNeeded && !did_match_any_pseudo_element_rules)
-        return nullptr;
+    if (mode == ComputeStyleMode::CreatePseudoElementStyleIfNeeded) {
+        VERIFY(pseudo_element.has_value());
+        if (matching_rule_set.author_rules.is_empty() && matching_rule_set.user_agent_rules.is_empty())
+            return nullptr;
+    }
+
+    // 2. Reuse the style of a sibling that matched the same rules, if there is one
+    // NOTE: Only the style tree walk keeps track of the siblings, just like with the ancestor filter.
+    bool const can_share_style = !pseudo_element.has_value() && m_ancestor_filter.is_filtering_ancestors_of(element);
+    if (can_share_style) {
+        if (auto shared_style = find_shareable_style(element, matching_rule_set)) {
+            // NOTE: Custom properties are stored on the element rather than in its style, so we still have to cascade them.
+            TRY(cascade_custom_properties(element, matching_rule_set.author_rules));
+            return shared_style;
+        }
+    }
 
-    // 2. Compute the font, since that may be needed for font-relative CSS units
+    // 3. Perform the cascade. This produces the "specified style"
+    auto style = StyleProperties::create();
+    TRY(compute_cascaded_values(style, element, pseudo_element, matching_rule_set));
+
+    // 4. Compute the font, since that may be needed for font-relative CSS units
     compute_font(style, &element, pseudo_element);
 
-    // 3. Absolutize values, turning font/viewport relative lengths into absolute lengths
+    // 5. Absolutize values, turning font/viewport relative lengths into absolute lengths
     TRY(absolutize_values(style, &element, pseudo_element));
 
-    // 4. Default the values, applying inheritance and 'initial' as needed
+    // 6. Default the values, applying inheritance and 'initial' as needed
     compute_defaulted_values(style, &element, pseudo_element);
 
-    // 5. Run automatic box type transformations
+    // 7. Run automatic box type transformations
     transform_box_type_if_needed(style, element, pseudo_element);
 
+    // 8. Most elements don't change any inherited property, so keep only one copy of those values around
+    if (auto const* parent_element = element_to_inherit_style_from(&element, pseudo_element); parent_element && parent_element->computed_css_values())
+        style->share_inherited_values_if_equal(*parent_element->computed_css_values());
+
+    if (can_share_style)
+        add_style_sharing_candidate(element, style, move(matching_rule_set));
+
     return style;
 }
 
@@ -1609,6 +1707,37 @@ void StyleComputer::build_rule_cache_if_needed() const
     const_cast<StyleComputer&>(*this).build_rule_cache();
 }
 
+// The compound selector left of a descendant or child combinator has to match an ancestor of the element. Remember what
+// its tag name, ID and classes hash to, so the ancestor filter can reject the selector without looking at the DOM.
+static void collect_ancestor_hashes(Selector const& selector, MatchingRule& matching_rule)
+{
+    auto collect_hashes = [&](bool ids_and_classes) {
+        auto const& compound_selectors = selector.compound_selectors();
+        for (size_t i = compound_selectors.size() - 1; i > 0; --i) {
+            auto combinator = compound_selectors[i].combinator;
+            if (combinator != Selector::Combinator::Descendant && combinator != Selector::Combinator::ImmediateChild)
+                continue;
+            for (auto const& simple_selector : compound_selectors[i - 1].simple_selectors) {
+                if (matching_rule.ancestor_hash_count == MatchingRule::max_ancestor_hashes)
+                    return;
+                Optional<AncestorFilter::HashKind> kind;
+                if (ids_and_classes && simple_selector.type == Selector::SimpleSelector::Type::Id)
+                    kind = AncestorFilter::HashKind::Id;
+                else if (ids_and_classes && simple_selector.type == Selector::SimpleSelector::Type::Class)
+                    kind = AncestorFilter::HashKind::Class;
+                else if (!ids_and_classes && simple_selector.type == Selector::SimpleSelector::Type::TagName)
+                    kind = AncestorFilter::HashKind::TagName;
+                if (kind.has_value())
+                    matching_rule.ancestor_hashes[matching_rule.ancestor_hash_count++] = AncestorFilter::hash(*kind, simple_selector.name().bytes_as_string_view());
+            }
+        }
+    };
+
+    // Nearly every element has a div or body ancestor, so IDs and classes are much better at rejecting selectors.
+    collect_hashes(true);
+    collect_hashes(false);
+}
+
 NonnullOwnPtr<StyleComputer::RuleCache> StyleComputer::make_rule_cache_for_cascade_origin(CascadeOrigin cascade_origin)
 {
     auto rule_cache = make<RuleCache>();
@@ -1632,6 +1761,7 @@ NonnullOwnPtr<StyleComputer::RuleCache> StyleComputer::make_rule_cache_for_casca
                     selector_index,
                     selector.specificity(),
                 };
+                collect_ancestor_hashes(selector, matching_rule);
 
                 for (auto const& simple_selector : selector.compound_selectors().last().simple_selectors) {
                     if (simple_selector.type == CSS::Selector::SimpleSelector::Type::PseudoElement) {
@@ -1694,6 +1824,10 @@ void StyleComputer::invalidate_rule_cache()
 {
     m_author_rule_cache = nullptr;
 
+    // The candidates' matched rules are meaningless without the rule cache they came from.
+    for (auto& candidates : m_style_sharing_candidates)
+        candidates.clear();
+
     // NOTE: It might not be necessary to throw away the UA rule cache.
     //       If we are sure that it's safe, we could keep it as an optimization.
     m_user_agent_rule_cache = nullptr;
@@ -10,6 +10,7 @@
 #include <AK/HashMap.h>
 #include <AK/Optional.h>
 #include <AK/OwnPtr.h>
+#include <LibWeb/CSS/AncestorFilter.h>
 #include <LibWeb/CSS/CSSFontFaceRule.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
 #include <LibWeb/CSS/Parser/ComponentValue.h>
@@ -27,6 +28,18 @@ struct MatchingRule {
     size_t selector_index { 0 };
     u32 specificity { 0 };
     bool contains_pseudo_element { false };
+
+    // Hashes of tag names, IDs and classes that the element's ancestors must have for the selector to match.
+    static constexpr size_t max_ancestor_hashes = 4;
+    Array<u32, max_ancestor_hashes> ancestor_hashes {};
+    u8 ancestor_hash_count { 0 };
+};
+
+// Counts how selectors fared against the elements they were tried on, to see how much matching the fast rejects save.
+struct SelectorMatchingStatistics {
+    u64 selectors_tried { 0 };
+    u64 rejected_by_ancestor_filter { 0 };
+    u64 selectors_matched { 0 };
 };
 
 class PropertyDependencyNode : public RefCounted<PropertyDependencyNode> {
@@ -71,6 +84,14 @@ public:
 
     Vector<MatchingRule> collect_matching_rules(DOM::Element const&, CascadeOrigin, Optional<CSS::Selector::PseudoElement>) const;
 
+    // The style tree walk tells the style computer about the elements it descends into, so selectors that need
+    // ancestors which the current element doesn't have can be rejected early, and siblings can share their styles.
+    void push_ancestor(DOM::Element const&);
+    void pop_ancestor(DOM::Element const&);
+
+    SelectorMatchingStatistics const& selector_matching_statistics() const { return m_selector_matching_statistics; }
+    void reset_selector_matching_statistics() { m_selector_matching_statistics = {}; }
+
     void invalidate_rule_cache();
 
     Gfx::Font const& initial_font() const;
@@ -85,8 +106,13 @@ private:
         CreatePseudoElementStyleIfNeeded,
     };
 
+    struct MatchingRuleSet {
+        Vector<MatchingRule> user_agent_rules;
+        Vector<MatchingRule> author_rules;
+    };
+
     ErrorOr<RefPtr<StyleProperties>> compute_style_impl(DOM::Element&, Optional<CSS::Selector::PseudoElement>, ComputeStyleMode) const;
-    ErrorOr<void> compute_cascaded_values(StyleProperties&, DOM::Element&, Optional<CSS::Selector::PseudoElement>, bool& did_match_any_pseudo_element_rules, ComputeStyleMode) const;
+    ErrorOr<void> compute_cascaded_values(StyleProperties&, DOM::Element&, Optional<CSS::Selector::PseudoElement>, MatchingRuleSet const&) const;
     void compute_font(StyleProperties&, DOM::Element const*, Optional<CSS::Selector::PseudoElement>) const;
     void compute_defaulted_values(StyleProperties&, DOM::Element const*, Optional<CSS::Selector::PseudoElement>) const;
     ErrorOr<void> absolutize_values(StyleProperties&, DOM::Element const*, Optional<CSS::Selector::PseudoElement>) const;
@@ -105,10 +131,8 @@ private:
     [[nodiscard]] Length::FontMetrics calculate_root_element_font_metrics(StyleProperties const&) const;
     CSSPixels parent_or_root_element_line_height(DOM::Element const*, Optional<CSS::Selector::PseudoElement>) const;
 
-    struct MatchingRuleSet {
-        Vector<MatchingRule> user_agent_rules;
-        Vector<MatchingRule> author_rules;
-    };
+    RefPtr<StyleProperties> find_shareable_style(DOM::Element const&, MatchingRuleSet const&) const;
+    void add_style_sharing_candidate(DOM::Element const&, NonnullRefPtr<StyleProperties>, MatchingRuleSet) const;
 
     void cascade_declarations(StyleProperties&, DOM::Element&, Optional<CSS::Selector::PseudoElement>, Vector<MatchingRule> const&, CascadeOrigin, Important) const;
 
@@ -134,6 +158,19 @@ private:
     class FontLoader;
     HashMap<String, NonnullOwnPtr<FontLoader>> m_loaded_fonts;
 
+    AncestorFilter m_ancestor_filter;
+    mutable SelectorMatchingStatistics m_selector_matching_statistics;
+
+    // Styles recently computed for children of each element the style tree walk is in. A sibling that matches the same
+    // rules and can't be told apart from one of them in any other way gets the very same style.
+    struct StyleSharingCandidate {
+        JS::NonnullGCPtr<DOM::Element const> element;
+        NonnullRefPtr<StyleProperties> style;
+        MatchingRuleSet matching_rule_set;
+    };
+    static constexpr size_t max_style_sharing_candidates = 4;
+    mutable Vector<Vector<StyleSharingCandidate, max_style_sharing_candidates>> m_style_sharing_candidates;
+
     Length::FontMetrics m_default_font_metrics;
     Length::FontMetrics m_root_element_font_metrics;
 };
@@ -28,8 +28,47 @@
 
 namespace Web::CSS {
 
+namespace {
+
+// Which group each property's value lives in, and where in that group.
+struct PropertyValueLayout {
+    Array<bool, to_underlying(CSS::last_property_id) + 1> is_inherited {};
+    Array<u16, to_underlying(CSS::last_property_id) + 1> index_in_group {};
+    size_t inherited_property_count { 0 };
+    size_t non_inherited_property_count { 0 };
+};
+
+}
+
+static PropertyValueLayout const& property_value_layout()
+{
+    static PropertyValueLayout const s_layout = [] {
+        PropertyValueLayout layout;
+        for (size_t i = 0; i < layout.index_in_group.size(); ++i) {
+            layout.is_inherited[i] = is_inherited_property(static_cast<CSS::PropertyID>(i));
+            layout.index_in_group[i] = layout.is_inherited[i] ? layout.inherited_property_count++ : layout.non_inherited_property_count++;
+        }
+        return layout;
+    }();
+    return s_layout;
+}
+
+static Vector<RefPtr<StyleValue const>> empty_property_values(size_t count)
+{
+    Vector<RefPtr<StyleValue const>> values;
+    values.resize(count);
+    return values;
+}
+
+StyleProperties::StyleProperties()
+    : m_inherited_values(adopt_ref(*new PropertyValues(empty_property_values(property_value_layout().inherited_property_count))))
+    , m_non_inherited_values(adopt_ref(*new PropertyValues(empty_property_values(property_value_layout().non_inherited_property_count))))
+{
+}
+
 StyleProperties::StyleProperties(StyleProperties const& other)
-    : m_property_values(other.m_property_values)
+    : m_inherited_values(other.m_inherited_values)
+    , m_non_inherited_values(other.m_non_inherited_values)
 {
     if (other.m_font) {
         m_font = other.m_font->clone();
@@ -43,14 +82,46 @@ NonnullRefPtr<StyleProperties> StyleProperties::clone() const
     return adopt_ref(*new StyleProperties(*this));
 }
 
+RefPtr<StyleValue const> const& StyleProperties::value_slot(CSS::PropertyID property_id) const
+{
+    auto const& layout = property_value_layout();
+    auto const& group = layout.is_inherited[to_underlying(property_id)] ? m_inherited_values : m_non_inherited_values;
+    return group->values[layout.index_in_group[to_underlying(property_id)]];
+}
+
+RefPtr<StyleValue const>& StyleProperties::mutable_value_slot(CSS::PropertyID property_id)
+{
+    auto const& layout = property_value_layout();
+    auto& group = layout.is_inherited[to_underlying(property_id)] ? m_inherited_values : m_non_inherited_values;
+    if (group->ref_count() > 1)
+        group = adopt_ref(*new PropertyValues(group->values));
+    return group->values[layout.index_in_group[to_underlying(property_id)]];
+}
+
+void StyleProperties::share_inherited_values_if_equal(StyleProperties const& other)
+{
+    if (shares_inherited_values_with(other))
+        return;
+
+    auto const& values = m_inherited_values->values;
+    auto const& other_values = other.m_inherited_values->values;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] == other_values[i])
+            continue;
+        if (!values[i] || !other_values[i] || *values[i] != *other_values[i])
+            return;
+    }
+    m_inherited_values = other.m_inherited_values;
+}
+
 void StyleProperties::set_property(CSS::PropertyID id, NonnullRefPtr<StyleValue const> value)
 {
-    m_property_values[to_underlying(id)] = move(value);
+    mutable_value_slot(id) = move(value);
 }
 
 NonnullRefPtr<StyleValue const> StyleProperties::property(CSS::PropertyID property_id) const
 {
-    auto value = m_property_values[to_underlying(property_id)];
+    auto value = value_slot(property_id);
     // By the time we call this method, all properties have values assigned.
     VERIFY(!value.is_null());
     return value.release_nonnull();
@@ -58,7 +129,7 @@ NonnullRefPtr<StyleValue const> StyleProperties::property(CSS::PropertyID proper
 
 RefPtr<StyleValue const> StyleProperties::maybe_null_property(CSS::PropertyID property_id) const
 {
-    return m_property_values[to_underlying(property_id)];
+    return value_slot(property_id);
 }
 
 CSS::Size StyleProperties::size_value(CSS::PropertyID id) const
@@ -476,12 +547,9 @@ Optional<CSS::Position> StyleProperties::position() const
 
 bool StyleProperties::operator==(StyleProperties const& other) const
 {
-    if (m_property_values.size() != other.m_property_values.size())
-        return false;
-
-    for (size_t i = 0; i < m_property_values.size(); ++i) {
-        auto const& my_ptr = m_property_values[i];
-        auto const& other_ptr = other.m_property_values[i];
+    for (auto i = to_underlying(CSS::first_property_id); i <= to_underlying(CSS::last_property_id); ++i) {
+        auto const& my_ptr = value_slot(static_cast<CSS::PropertyID>(i));
+        auto const& other_ptr = other.value_slot(static_cast<CSS::PropertyID>(i));
         if (!my_ptr) {
             if (other_ptr)
                 return false;
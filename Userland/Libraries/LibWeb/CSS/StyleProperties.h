@@ -18,7 +18,7 @@ namespace Web::CSS {
 
 class StyleProperties : public RefCounted<StyleProperties> {
 public:
-    StyleProperties() = default;
+    StyleProperties();
 
     explicit StyleProperties(StyleProperties const&);
 
@@ -29,15 +29,12 @@ public:
     template<typename Callback>
     inline void for_each_property(Callback callback) const
     {
-        for (size_t i = 0; i < m_property_values.size(); ++i) {
-            if (m_property_values[i])
-                callback((CSS::PropertyID)i, *m_property_values[i]);
+        for (auto i = to_underlying(CSS::first_property_id); i <= to_underlying(CSS::last_property_id); ++i) {
+            if (auto const& value = value_slot((CSS::PropertyID)i))
+                callback((CSS::PropertyID)i, *value);
         }
     }
 
-    auto& properties() { return m_property_values; }
-    auto const& properties() const { return m_property_values; }
-
     void set_property(CSS::PropertyID, NonnullRefPtr<StyleValue const> value);
     NonnullRefPtr<StyleValue const> property(CSS::PropertyID) const;
     RefPtr<StyleValue const> maybe_null_property(CSS::PropertyID) const;
@@ -116,6 +113,9 @@ public:
 
     bool operator==(StyleProperties const&) const;
 
+    // True if both styles use the very same values for all inherited properties, e.g. because one inherited them all from the other.
+    bool shares_inherited_values_with(StyleProperties const& other) const { return m_inherited_values.ptr() == other.m_inherited_values.ptr(); }
+
     Optional<CSS::Position> position() const;
     Optional<int> z_index() const;
 
@@ -124,7 +124,26 @@ public:
 private:
     friend class StyleComputer;
 
-    Array<RefPtr<StyleValue const>, to_underlying(CSS::last_property_id) + 1> m_property_values;
+    // Inherited and non-inherited properties are kept in separate groups, so that an element which doesn't change any
+    // inherited property can share that group with its parent. A group that is shared gets copied before it's written to.
+    struct PropertyValues : public RefCounted<PropertyValues> {
+        explicit PropertyValues(Vector<RefPtr<StyleValue const>> values)
+            : values(move(values))
+        {
+        }
+
+        Vector<RefPtr<StyleValue const>> values;
+    };
+
+    RefPtr<StyleValue const> const& value_slot(CSS::PropertyID) const;
+    RefPtr<StyleValue const>& mutable_value_slot(CSS::PropertyID);
+
+    // Switches over to the other style's inherited values if they're all equal to ours.
+    void share_inherited_values_if_equal(StyleProperties const& other);
+
+    NonnullRefPtr<PropertyValues> m_inherited_values;
+    NonnullRefPtr<PropertyValues> m_non_inherited_values;
+
     Optional<CSS::Overflow> overflow(CSS::PropertyID) const;
     Vector<CSS::ShadowData> shadow(CSS::PropertyID) const;
 
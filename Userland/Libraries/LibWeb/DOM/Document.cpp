@@ -916,6 +916,11 @@ void Document::update_layout()
     node.set_needs_style_update(false);
 
     if (needs_full_style_update || node.child_needs_style_update()) {
+        // Let the style computer know which ancestors the descendants of this element have.
+        auto& style_computer = node.document().style_computer();
+        if (node.is_element())
+            style_computer.push_ancestor(static_cast<DOM::Element&>(node));
+
         if (node.is_element()) {
             if (auto* shadow_root = static_cast<DOM::Element&>(node).shadow_root_internal()) {
                 if (needs_full_style_update || shadow_root->needs_style_update() || shadow_root->child_needs_style_update())
@@ -927,6 +932,9 @@ void Document::update_layout()
                 needs_relayout |= update_style_recursively(child);
             return IterationDecision::Continue;
         });
+
+        if (node.is_element())
+            style_computer.pop_ancestor(static_cast<DOM::Element&>(node));
     }
 
     node.set_child_needs_style_update(false);
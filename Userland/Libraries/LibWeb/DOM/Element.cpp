@@ -410,8 +410,8 @@ static RequiredInvalidation compute_required_invalidation(CSS::StyleProperties c
     bool requires_stacking_context_tree_rebuild = false;
     for (auto i = to_underlying(CSS::first_property_id); i <= to_underlying(CSS::last_property_id); ++i) {
         auto property_id = static_cast<CSS::PropertyID>(i);
-        auto const& old_value = old_style.properties()[i];
-        auto const& new_value = new_style.properties()[i];
+        auto old_value = old_style.maybe_null_property(property_id);
+        auto new_value = new_style.maybe_null_property(property_id);
         if (!old_value && !new_value)
             continue;
         if (!old_value || !new_value)
@@ -469,12 +469,14 @@ class PerformanceTiming;
 }
 
 namespace Web::Painting {
+class BorderRadiusCornerClipper;
 class ButtonPaintable;
 class CheckBoxPaintable;
 class LabelablePaintable;
 class Paintable;
 class PaintableBox;
 class PaintableWithLines;
+class RecordingPainter;
 class StackingContext;
 class TextPaintable;
 class VideoPaintable;
@@ -77,8 +77,11 @@ JS::GCPtr<Layout::Node> HTMLInputElement::create_layout_node(NonnullRefPtr<CSS::
 
     // AD-HOC: We rewrite `display: inline` to `display: inline-block`.
     //         This is required for the internal shadow tree to work correctly in layout.
-    if (style->display().is_inline_outside() && style->display().is_flow_inside())
+    //         The style may be shared with our siblings, so we change a copy of it.
+    if (style->display().is_inline_outside() && style->display().is_flow_inside()) {
+        style = style->clone();
         style->set_property(CSS::PropertyID::Display, CSS::DisplayStyleValue::create(CSS::Display::from_short(CSS::Display::Short::InlineBlock)).release_value_but_fixme_should_propagate_errors());
+    }
 
     return Element::create_layout_node_for_display_type(document(), style->display(), style, this);
 }
@@ -132,8 +132,7 @@ void paint_border(PaintContext& context, BorderEdge edge, DevicePixelRect const&
             break;
         }
         if (border_style == CSS::LineStyle::Dotted) {
-            Gfx::AntiAliasingPainter aa_painter { context.painter() };
-            aa_painter.draw_line(p1.to_type<int>(), p2.to_type<int>(), color, device_pixel_width.value(), gfx_line_style);
+            context.painter().draw_anti_aliased_line(p1.to_type<int>(), p2.to_type<int>(), color, device_pixel_width.value(), gfx_line_style);
             return;
         }
         context.painter().draw_line(p1.to_type<int>(), p2.to_type<int>(), color, device_pixel_width.value(), gfx_line_style);
@@ -312,20 +311,10 @@ void paint_all_borders(PaintContext& context, CSSPixelRect const& bordered_rect,
             top_right.vertical_radius + bottom_right.vertical_radius + expand_height.value())
     };
 
-    auto corner_bitmap = get_cached_corner_bitmap(corner_mask_rect.size());
-    if (!corner_bitmap)
-        return;
-    Gfx::Painter painter { *corner_bitmap };
-
-    Gfx::AntiAliasingPainter aa_painter { painter };
-
     // Paint a little tile sheet for the corners
     // TODO: Support various line styles on the corners (dotted, dashes, etc)
 
-    // Paint the outer (minimal) corner rounded rectangle:
-    aa_painter.fill_rect_with_rounded_corners(corner_mask_rect.to_type<int>(), border_color_no_alpha, top_left, top_right, bottom_right, bottom_left);
-
-    // Subtract the inner corner rectangle:
+    // The outer (minimal) corner rounded rectangle is painted first, then the inner corner rectangle is subtracted from it.
     auto inner_corner_mask_rect = corner_mask_rect.shrunken(
         context.enclosing_device_pixels(borders_data.top.width),
         context.enclosing_device_pixels(borders_data.right.width),
@@ -343,14 +332,19 @@ void paint_all_borders(PaintContext& context, CSSPixelRect const& bordered_rect,
     inner_bottom_right.vertical_radius = max(0, inner_bottom_right.vertical_radius - context.enclosing_device_pixels(borders_data.bottom.width).value());
     inner_bottom_left.horizontal_radius = max(0, inner_bottom_left.horizontal_radius - context.enclosing_device_pixels(borders_data.left.width).value());
     inner_bottom_left.vertical_radius = max(0, inner_bottom_left.vertical_radius - context.enclosing_device_pixels(borders_data.bottom.width).value());
-    aa_painter.fill_rect_with_rounded_corners(inner_corner_mask_rect.to_type<int>(), border_color_no_alpha, inner_top_left, inner_top_right, inner_bottom_right, inner_bottom_left, Gfx::AntiAliasingPainter::BlendMode::AlphaSubtract);
+    RecordingPainter::BorderCornersParams corners {
+        .mask_rect = corner_mask_rect.to_type<int>(),
+        .radii = { top_left, top_right, bottom_right, bottom_left },
+        .inner_mask_rect = inner_corner_mask_rect.to_type<int>(),
+        .inner_radii = { inner_top_left, inner_top_right, inner_bottom_right, inner_bottom_left },
+        .mask_color = border_color_no_alpha,
+        .corners = {},
+    };
 
     // TODO: Support dual color corners. Other browsers will render a rounded corner between two borders of
     // different colors using both colours, normally split at a 45 degree angle (though the exact angle is interpolated).
     auto blit_corner = [&](Gfx::IntPoint position, Gfx::IntRect const& src_rect, Color corner_color) {
-        context.painter().blit_filtered(position, *corner_bitmap, src_rect, [&](auto const& corner_pixel) {
-            return corner_color.with_alpha((corner_color.alpha() * corner_pixel.alpha()) / 255);
-        });
+        corners.corners.append({ position, src_rect, corner_color });
     };
 
     // FIXME: Corners should actually split between the two colors, if both are provided (and differ)
@@ -372,6 +366,8 @@ void paint_all_borders(PaintContext& context, CSSPixelRect const& bordered_rect,
 
     if (bottom_left)
         blit_corner(border_rect.bottom_left().to_type<int>().translated(0, -bottom_left.vertical_radius + 1), bottom_left.as_rect().translated(0, corner_mask_rect.height().value() - bottom_left.vertical_radius), pick_corner_color(borders_data.bottom, borders_data.left));
+
+    context.painter().paint_border_corners(move(corners));
 }
 
 }
@@ -10,7 +10,7 @@
 
 namespace Web::Painting {
 
-ErrorOr<BorderRadiusCornerClipper> BorderRadiusCornerClipper::create(PaintContext& context, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip, UseCachedBitmap use_cached_bitmap)
+ErrorOr<NonnullRefPtr<BorderRadiusCornerClipper>> BorderRadiusCornerClipper::create(PaintContext& context, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip, UseCachedBitmap use_cached_bitmap)
 {
     VERIFY(border_radii.has_any_radius());
 
@@ -28,15 +28,6 @@ ErrorOr<BorderRadiusCornerClipper> BorderRadiusCornerClipper::create(PaintContex
             top_right.vertical_radius + bottom_right.vertical_radius)
     };
 
-    RefPtr<Gfx::Bitmap> corner_bitmap;
-    if (use_cached_bitmap == UseCachedBitmap::Yes) {
-        corner_bitmap = get_cached_corner_bitmap(corners_bitmap_size);
-        if (!corner_bitmap)
-            return Error::from_errno(ENOMEM);
-    } else {
-        corner_bitmap = TRY(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, corners_bitmap_size.to_type<int>()));
-    }
-
     CornerData corner_data {
         .corner_radii = {
             .top_left = top_left,
@@ -48,13 +39,25 @@ ErrorOr<BorderRadiusCornerClipper> BorderRadiusCornerClipper::create(PaintContex
         .corner_bitmap_size = corners_bitmap_size
     };
 
-    return BorderRadiusCornerClipper { corner_data, corner_bitmap.release_nonnull(), corner_clip };
+    return adopt_nonnull_ref_or_enomem(new (nothrow) BorderRadiusCornerClipper(corner_data, corner_clip, use_cached_bitmap));
 }
 
-void BorderRadiusCornerClipper::sample_under_corners(Gfx::Painter& page_painter)
+RefPtr<Gfx::Bitmap> BorderRadiusCornerClipper::sample_under_corners(Gfx::Painter& page_painter) const
 {
+    RefPtr<Gfx::Bitmap> corner_bitmap;
+    if (m_use_cached_bitmap == UseCachedBitmap::Yes) {
+        corner_bitmap = get_cached_corner_bitmap(m_data.corner_bitmap_size);
+    } else {
+        auto new_corner_bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, m_data.corner_bitmap_size.to_type<int>());
+        if (new_corner_bitmap.is_error())
+            return nullptr;
+        corner_bitmap = new_corner_bitmap.release_value();
+    }
+    if (!corner_bitmap)
+        return nullptr;
+
     // Generate a mask for the corners:
-    Gfx::Painter corner_painter { *m_corner_bitmap };
+    Gfx::Painter corner_painter { *corner_bitmap };
     Gfx::AntiAliasingPainter corner_aa_painter { corner_painter };
     Gfx::IntRect corner_rect { { 0, 0 }, m_data.corner_bitmap_size };
     corner_aa_painter.fill_rect_with_rounded_corners(corner_rect, Color::NamedColor::Black,
@@ -64,7 +67,7 @@ void BorderRadiusCornerClipper::sample_under_corners(Gfx::Painter& page_painter)
         for (int row = 0; row < mask_src.height(); ++row) {
             for (int col = 0; col < mask_src.width(); ++col) {
                 auto corner_location = mask_src.location().translated(col, row);
-                auto mask_pixel = m_corner_bitmap->get_pixel(corner_location);
+                auto mask_pixel = corner_bitmap->get_pixel(corner_location);
                 u8 mask_alpha = mask_pixel.alpha();
                 if (m_corner_clip == CornerClip::Outside)
                     mask_alpha = ~mask_pixel.alpha();
@@ -74,7 +77,7 @@ void BorderRadiusCornerClipper::sample_under_corners(Gfx::Painter& page_painter)
                     if (page_pixel.has_value())
                         final_pixel = page_pixel.value().with_alpha(mask_alpha);
                 }
-                m_corner_bitmap->set_pixel(corner_location, final_pixel);
+                corner_bitmap->set_pixel(corner_location, final_pixel);
             }
         }
     };
@@ -89,22 +92,20 @@ void BorderRadiusCornerClipper::sample_under_corners(Gfx::Painter& page_painter)
     if (m_data.corner_radii.bottom_left)
         copy_page_masked(m_data.corner_radii.bottom_left.as_rect().translated(m_data.bitmap_locations.bottom_left.to_type<int>()), m_data.page_locations.bottom_left.to_type<int>());
 
-    m_has_sampled = true;
+    return corner_bitmap;
 }
 
-void BorderRadiusCornerClipper::blit_corner_clipping(Gfx::Painter& painter)
+void BorderRadiusCornerClipper::blit_corner_clipping(Gfx::Painter& painter, Gfx::Bitmap const& corner_bitmap) const
 {
-    VERIFY(m_has_sampled);
-
     // Restore the corners:
     if (m_data.corner_radii.top_left)
-        painter.blit(m_data.page_locations.top_left.to_type<int>(), *m_corner_bitmap, m_data.corner_radii.top_left.as_rect().translated(m_data.bitmap_locations.top_left.to_type<int>()));
+        painter.blit(m_data.page_locations.top_left.to_type<int>(), corner_bitmap, m_data.corner_radii.top_left.as_rect().translated(m_data.bitmap_locations.top_left.to_type<int>()));
     if (m_data.corner_radii.top_right)
-        painter.blit(m_data.page_locations.top_right.to_type<int>(), *m_corner_bitmap, m_data.corner_radii.top_right.as_rect().translated(m_data.bitmap_locations.top_right.to_type<int>()));
+        painter.blit(m_data.page_locations.top_right.to_type<int>(), corner_bitmap, m_data.corner_radii.top_right.as_rect().translated(m_data.bitmap_locations.top_right.to_type<int>()));
     if (m_data.corner_radii.bottom_right)
-        painter.blit(m_data.page_locations.bottom_right.to_type<int>(), *m_corner_bitmap, m_data.corner_radii.bottom_right.as_rect().translated(m_data.bitmap_locations.bottom_right.to_type<int>()));
+        painter.blit(m_data.page_locations.bottom_right.to_type<int>(), corner_bitmap, m_data.corner_radii.bottom_right.as_rect().translated(m_data.bitmap_locations.bottom_right.to_type<int>()));
     if (m_data.corner_radii.bottom_left)
-        painter.blit(m_data.page_locations.bottom_left.to_type<int>(), *m_corner_bitmap, m_data.corner_radii.bottom_left.as_rect().translated(m_data.bitmap_locations.bottom_left.to_type<int>()));
+        painter.blit(m_data.page_locations.bottom_left.to_type<int>(), corner_bitmap, m_data.corner_radii.bottom_left.as_rect().translated(m_data.bitmap_locations.bottom_left.to_type<int>()));
 }
 
 }
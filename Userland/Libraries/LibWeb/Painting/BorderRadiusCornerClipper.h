@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/RefCounted.h>
 #include <LibGfx/AntiAliasingPainter.h>
 #include <LibWeb/Painting/BorderPainting.h>
+#include <LibWeb/Painting/RecordingPainter.h>
 
 namespace Web::Painting {
 
@@ -16,17 +18,20 @@ enum class CornerClip {
     Inside
 };
 
-class BorderRadiusCornerClipper {
+// The clipper is recorded into the display list, and the corners are only sampled and restored when it is rasterized.
+// As a display list may be rasterized on several threads at once, the clipper itself doesn't change when that happens:
+// the sampled corners are handed back to whoever rasterizes it, to be passed to blit_corner_clipping() later.
+class BorderRadiusCornerClipper : public RefCounted<BorderRadiusCornerClipper> {
 public:
     enum class UseCachedBitmap {
         Yes,
         No
     };
 
-    static ErrorOr<BorderRadiusCornerClipper> create(PaintContext&, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip = CornerClip::Outside, UseCachedBitmap use_cached_bitmap = UseCachedBitmap::Yes);
+    static ErrorOr<NonnullRefPtr<BorderRadiusCornerClipper>> create(PaintContext&, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip = CornerClip::Outside, UseCachedBitmap use_cached_bitmap = UseCachedBitmap::Yes);
 
-    void sample_under_corners(Gfx::Painter& page_painter);
-    void blit_corner_clipping(Gfx::Painter& page_painter);
+    RefPtr<Gfx::Bitmap> sample_under_corners(Gfx::Painter& page_painter) const;
+    void blit_corner_clipping(Gfx::Painter& page_painter, Gfx::Bitmap const& corner_bitmap) const;
 
 private:
     using CornerRadius = Gfx::AntiAliasingPainter::CornerRadius;
@@ -48,35 +53,34 @@ private:
         DevicePixelSize corner_bitmap_size;
     } m_data;
 
-    NonnullRefPtr<Gfx::Bitmap> m_corner_bitmap;
-    bool m_has_sampled { false };
     CornerClip m_corner_clip { false };
+    UseCachedBitmap m_use_cached_bitmap { UseCachedBitmap::Yes };
 
-    BorderRadiusCornerClipper(CornerData corner_data, NonnullRefPtr<Gfx::Bitmap> corner_bitmap, CornerClip corner_clip)
+    BorderRadiusCornerClipper(CornerData corner_data, CornerClip corner_clip, UseCachedBitmap use_cached_bitmap)
         : m_data(move(corner_data))
-        , m_corner_bitmap(corner_bitmap)
         , m_corner_clip(corner_clip)
+        , m_use_cached_bitmap(use_cached_bitmap)
     {
     }
 };
 
 struct ScopedCornerRadiusClip {
-    ScopedCornerRadiusClip(PaintContext& context, Gfx::Painter& painter, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip = CornerClip::Outside, BorderRadiusCornerClipper::UseCachedBitmap use_cached_bitmap = BorderRadiusCornerClipper::UseCachedBitmap::Yes)
+    ScopedCornerRadiusClip(PaintContext& context, RecordingPainter& painter, DevicePixelRect const& border_rect, BorderRadiiData const& border_radii, CornerClip corner_clip = CornerClip::Outside, BorderRadiusCornerClipper::UseCachedBitmap use_cached_bitmap = BorderRadiusCornerClipper::UseCachedBitmap::Yes)
         : m_painter(painter)
     {
         if (border_radii.has_any_radius()) {
             auto clipper = BorderRadiusCornerClipper::create(context, border_rect, border_radii, corner_clip, use_cached_bitmap);
             if (!clipper.is_error()) {
                 m_corner_clipper = clipper.release_value();
-                m_corner_clipper->sample_under_corners(m_painter);
+                m_painter.sample_under_corners(*m_corner_clipper);
             }
         }
     }
 
     ~ScopedCornerRadiusClip()
     {
-        if (m_corner_clipper.has_value()) {
-            m_corner_clipper->blit_corner_clipping(m_painter);
+        if (m_corner_clipper) {
+            m_painter.blit_corner_clipping(*m_corner_clipper);
         }
     }
 
@@ -84,8 +88,8 @@ struct ScopedCornerRadiusClip {
     AK_MAKE_NONCOPYABLE(ScopedCornerRadiusClip);
 
 private:
-    Gfx::Painter& m_painter;
-    Optional<BorderRadiusCornerClipper> m_corner_clipper;
+    RecordingPainter& m_painter;
+    RefPtr<BorderRadiusCornerClipper> m_corner_clipper;
 };
 
 }
@@ -19,7 +19,34 @@
 
 namespace Web::Painting {
 
-void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, ReadonlySpan<CSS::FilterFunction> filter_list)
+Vector<CSS::FilterFunction> resolve_filter_list(Layout::Node const& node, ReadonlySpan<CSS::FilterFunction> filter_list)
+{
+    Vector<CSS::FilterFunction> resolved_filter_list;
+    resolved_filter_list.ensure_capacity(filter_list.size());
+    for (auto& filter_function : filter_list) {
+        resolved_filter_list.unchecked_append(filter_function.visit(
+            [&](CSS::Filter::Blur const& blur) -> CSS::FilterFunction {
+                if (!blur.radius.has_value())
+                    return blur;
+                return CSS::Filter::Blur { CSS::Length::make_px(blur.radius->to_px(node)) };
+            },
+            [&](CSS::Filter::DropShadow const& drop_shadow) -> CSS::FilterFunction {
+                auto resolved = drop_shadow.resolved(node);
+                return CSS::Filter::DropShadow {
+                    CSS::Length::make_px(CSSPixels(resolved.offset_x)),
+                    CSS::Length::make_px(CSSPixels(resolved.offset_y)),
+                    CSS::Length::make_px(CSSPixels(resolved.radius)),
+                    resolved.color,
+                };
+            },
+            [&](auto const& other) -> CSS::FilterFunction {
+                return other;
+            }));
+    }
+    return resolved_filter_list;
+}
+
+void apply_filter_list(Gfx::Bitmap& target_bitmap, ReadonlySpan<CSS::FilterFunction> filter_list)
 {
     auto apply_color_filter = [&](Gfx::ColorFilter const& filter) {
         const_cast<Gfx::ColorFilter&>(filter).apply(target_bitmap, target_bitmap.rect(), target_bitmap, target_bitmap.rect());
@@ -30,8 +57,11 @@ void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Rea
             [&](CSS::Filter::Blur const& blur) {
                 // Applies a Gaussian blur to the input image.
                 // The passed parameter defines the value of the standard deviation to the Gaussian function.
+                // Default value when omitted is 0px.
+                int sigma = blur.radius.has_value() ? blur.radius->absolute_length_to_px().value() : 0;
+                // Note: The radius/sigma of the blur needs to be doubled for LibGfx's blur functions.
                 Gfx::StackBlurFilter filter { target_bitmap };
-                filter.process_rgba(blur.resolved_radius(node), Color::Transparent);
+                filter.process_rgba(sigma * 2, Color::Transparent);
             },
             [&](CSS::Filter::Color const& color) {
                 auto amount = color.resolved_amount();
@@ -104,24 +134,12 @@ void apply_backdrop_filter(PaintContext& context, Layout::Node const& node, CSSP
 
     auto backdrop_region = context.rounded_device_rect(backdrop_rect);
 
-    // Note: The region bitmap can be smaller than the backdrop_region if it's at the edge of canvas.
-    // Note: This is in DevicePixels, but we use an IntRect because `get_region_bitmap()` below writes to it.
-    Gfx::IntRect actual_region {};
-
     // FIXME: Go through the steps to find the "Backdrop Root Image"
     // https://drafts.fxtf.org/filter-effects-2/#BackdropRoot
 
     // 1. Copy the Backdrop Root Image into a temporary buffer, such as a raster image. Call this buffer T’.
-    auto maybe_backdrop_bitmap = context.painter().get_region_bitmap(backdrop_region.to_type<int>(), Gfx::BitmapFormat::BGRA8888, actual_region);
-    if (actual_region.is_empty())
-        return;
-    if (maybe_backdrop_bitmap.is_error()) {
-        dbgln("Failed get region bitmap for backdrop-filter");
-        return;
-    }
-    auto backdrop_bitmap = maybe_backdrop_bitmap.release_value();
     // 2. Apply the backdrop-filter’s filter operations to the entire contents of T'.
-    apply_filter_list(*backdrop_bitmap, node, backdrop_filter.filters());
+    // Note: Both of these happen when the recorded painting is rasterized, as only then is the backdrop known.
 
     // FIXME: 3. If element B has any transforms (between B and the Backdrop Root), apply the inverse of those transforms to the contents of T’.
 
@@ -133,7 +151,7 @@ void apply_backdrop_filter(PaintContext& context, Layout::Node const& node, CSSP
     // FXIME: 6. If element B has any transforms, effects, or clips, apply those to T’.
 
     // 7. Composite the contents of T’ into element B’s parent, using source-over compositing.
-    context.painter().blit(actual_region.location(), *backdrop_bitmap, backdrop_bitmap->rect());
+    context.painter().apply_backdrop_filter(backdrop_region.to_type<int>(), resolve_filter_list(node, backdrop_filter.filters()));
 }
 
 }
@@ -12,7 +12,11 @@
 
 namespace Web::Painting {
 
-void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, ReadonlySpan<CSS::FilterFunction> filter_list);
+// Resolves every relative length in the filter list against the node, so the list can be applied without it.
+Vector<CSS::FilterFunction> resolve_filter_list(Layout::Node const&, ReadonlySpan<CSS::FilterFunction> filter_list);
+
+// Expects a filter list returned by resolve_filter_list().
+void apply_filter_list(Gfx::Bitmap& target_bitmap, ReadonlySpan<CSS::FilterFunction> filter_list);
 
 void apply_backdrop_filter(PaintContext&, Layout::Node const&, CSSPixelRect const&, BorderRadiiData const&, CSS::BackdropFilter const&);
 
@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibWeb/Layout/ListItemMarkerBox.h>
 #include <LibWeb/Painting/MarkerPaintable.h>
@@ -57,17 +56,17 @@ void MarkerPaintable::paint(PaintContext& context, PaintPhase phase) const
 
     auto color = computed_values().color();
 
-    Gfx::AntiAliasingPainter aa_painter { context.painter() };
+    auto& painter = context.painter();
 
     switch (layout_box().list_style_type()) {
     case CSS::ListStyleType::Square:
         context.painter().fill_rect(device_marker_rect.to_type<int>(), color);
         break;
     case CSS::ListStyleType::Circle:
-        aa_painter.draw_ellipse(device_marker_rect.to_type<int>(), color, 1);
+        painter.draw_ellipse(device_marker_rect.to_type<int>(), color, 1);
         break;
     case CSS::ListStyleType::Disc:
-        aa_painter.fill_ellipse(device_marker_rect.to_type<int>(), color);
+        painter.fill_ellipse(device_marker_rect.to_type<int>(), color);
         break;
     case CSS::ListStyleType::Decimal:
     case CSS::ListStyleType::DecimalLeadingZero:
@@ -372,7 +372,7 @@ void PaintableBox::apply_clip_overflow_rect(PaintContext& context, PaintPhase ph
             }
             clip_overflow();
             m_overflow_corner_radius_clipper = corner_clipper.release_value();
-            m_overflow_corner_radius_clipper->sample_under_corners(context.painter());
+            context.painter().sample_under_corners(*m_overflow_corner_radius_clipper);
         }
     }
 }
@@ -387,9 +387,9 @@ void PaintableBox::clear_clip_overflow_rect(PaintContext& context, PaintPhase ph
         context.painter().restore();
         m_clipping_overflow = false;
     }
-    if (m_overflow_corner_radius_clipper.has_value()) {
-        m_overflow_corner_radius_clipper->blit_corner_clipping(context.painter());
-        m_overflow_corner_radius_clipper = {};
+    if (m_overflow_corner_radius_clipper) {
+        context.painter().blit_corner_clipping(*m_overflow_corner_radius_clipper);
+        m_overflow_corner_radius_clipper = nullptr;
     }
 }
 
@@ -427,7 +427,7 @@ static void paint_cursor_if_needed(PaintContext& context, Layout::TextNode const
     context.painter().draw_rect(cursor_device_rect, text_node.computed_values().color());
 }
 
-static void paint_text_decoration(PaintContext& context, Gfx::Painter& painter, Layout::Node const& text_node, Layout::LineBoxFragment const& fragment)
+static void paint_text_decoration(PaintContext& context, RecordingPainter& painter, Layout::Node const& text_node, Layout::LineBoxFragment const& fragment)
 {
     auto& font = fragment.layout_node().font();
     auto fragment_box = fragment.absolute_rect();
@@ -531,7 +531,7 @@ static void paint_text_fragment(PaintContext& context, Layout::TextNode const& t
         auto selection_rect = context.enclosing_device_rect(fragment.selection_rect(text_node.font())).to_type<int>();
         if (!selection_rect.is_empty()) {
             painter.fill_rect(selection_rect, context.palette().selection());
-            Gfx::PainterStateSaver saver(painter);
+            RecordingPainterStateSaver saver(painter);
             painter.add_clip_rect(selection_rect);
             painter.draw_text_run(baseline_start.to_type<int>(), view, scaled_font, context.palette().selection_text());
         }
@@ -552,7 +552,7 @@ void PaintableWithLines::paint(PaintContext& context, PaintPhase phase) const
         return;
 
     bool should_clip_overflow = computed_values().overflow_x() != CSS::Overflow::Visible && computed_values().overflow_y() != CSS::Overflow::Visible;
-    Optional<BorderRadiusCornerClipper> corner_clipper;
+    RefPtr<BorderRadiusCornerClipper> corner_clipper;
 
     if (should_clip_overflow) {
         context.painter().save();
@@ -567,7 +567,7 @@ void PaintableWithLines::paint(PaintContext& context, PaintPhase phase) const
             auto clipper = BorderRadiusCornerClipper::create(context, clip_box, border_radii);
             if (!clipper.is_error()) {
                 corner_clipper = clipper.release_value();
-                corner_clipper->sample_under_corners(context.painter());
+                context.painter().sample_under_corners(*corner_clipper);
             }
         }
     }
@@ -617,8 +617,8 @@ void PaintableWithLines::paint(PaintContext& context, PaintPhase phase) const
 
     if (should_clip_overflow) {
         context.painter().restore();
-        if (corner_clipper.has_value())
-            corner_clipper->blit_corner_clipping(context.painter());
+        if (corner_clipper)
+            context.painter().blit_corner_clipping(*corner_clipper);
     }
 
     // FIXME: Merge this loop with the above somehow..
@@ -160,7 +160,7 @@ private:
     Optional<CSSPixelRect> mutable m_clip_rect;
 
     mutable bool m_clipping_overflow { false };
-    Optional<BorderRadiusCornerClipper> mutable m_overflow_corner_radius_clipper;
+    RefPtr<BorderRadiusCornerClipper> mutable m_overflow_corner_radius_clipper;
 };
 
 class PaintableWithLines final : public PaintableBox {
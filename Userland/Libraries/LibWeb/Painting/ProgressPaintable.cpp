@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibGfx/StylePainter.h>
 #include <LibWeb/Painting/ProgressPaintable.h>
 
 namespace Web::Painting {
@@ -34,9 +33,9 @@ void ProgressPaintable::paint(PaintContext& context, PaintPhase phase) const
         auto min_frame_thickness = context.rounded_device_pixels(3);
         auto frame_thickness = min(min(progress_rect.width(), progress_rect.height()) / 6, min_frame_thickness);
 
-        Gfx::StylePainter::paint_progressbar(context.painter(), progress_rect.shrunken(frame_thickness, frame_thickness).to_type<int>(), context.palette(), 0, round_to<int>(layout_box().dom_node().max()), round_to<int>(layout_box().dom_node().value()), ""sv);
+        context.painter().paint_progressbar(progress_rect.shrunken(frame_thickness, frame_thickness).to_type<int>(), context.palette(), 0, round_to<int>(layout_box().dom_node().max()), round_to<int>(layout_box().dom_node().value()));
 
-        Gfx::StylePainter::paint_frame(context.painter(), progress_rect.to_type<int>(), context.palette(), Gfx::FrameStyle::RaisedBox);
+        context.painter().paint_frame(progress_rect.to_type<int>(), context.palette(), Gfx::FrameStyle::RaisedBox);
     }
 }
 
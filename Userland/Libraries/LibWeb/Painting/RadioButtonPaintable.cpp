@@ -37,7 +37,7 @@ void RadioButtonPaintable::paint(PaintContext& context, PaintPhase phase) const
     if (phase != PaintPhase::Foreground)
         return;
 
-    Gfx::AntiAliasingPainter painter { context.painter() };
+    auto& painter = context.painter();
 
     auto draw_circle = [&](auto const& rect, Color color) {
         // Note: Doing this is a bit more forgiving than draw_circle() which will round to the nearset even radius.
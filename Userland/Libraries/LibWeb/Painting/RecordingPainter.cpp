@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <AK/Utf8View.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font/FontDatabase.h>
+#include <LibWeb/Painting/BorderRadiusCornerClipper.h>
+#include <LibWeb/Painting/FilterPainting.h>
+#include <LibWeb/Painting/RecordingPainter.h>
+
+namespace Web::Painting {
+
+// This rounds the same way as PaintContext::rounded_device_point().
+static Gfx::IntPoint to_device_translation(CSSPixelPoint translation, float device_pixels_per_css_pixel)
+{
+    return {
+        static_cast<int>(roundf(translation.x().value() * device_pixels_per_css_pixel)),
+        static_cast<int>(roundf(translation.y().value() * device_pixels_per_css_pixel))
+    };
+}
+
+RecordingPainter::RecordingPainter(Gfx::IntSize target_size)
+{
+    m_state_stack.append(State { {}, { {}, target_size }, {} });
+}
+
+RecordingPainter::~RecordingPainter() = default;
+
+void RecordingPainter::fill_rect(Gfx::IntRect const& rect, Color color)
+{
+    m_commands.append(FillRect { rect, color });
+}
+
+void RecordingPainter::clear_rect(Gfx::IntRect const& rect, Color color)
+{
+    m_commands.append(ClearRect { rect, color });
+}
+
+void RecordingPainter::draw_rect(Gfx::IntRect const& rect, Color color, bool rough)
+{
+    m_commands.append(DrawRect { rect, color, rough });
+}
+
+void RecordingPainter::draw_focus_rect(Gfx::IntRect const& rect, Color color)
+{
+    m_commands.append(DrawFocusRect { rect, color });
+}
+
+void RecordingPainter::draw_line(Gfx::IntPoint from, Gfx::IntPoint to, Color color, int thickness, Gfx::Painter::LineStyle style, Color alternate_color)
+{
+    m_commands.append(DrawLine { from, to, color, thickness, style, alternate_color });
+}
+
+void RecordingPainter::draw_triangle_wave(Gfx::IntPoint from, Gfx::IntPoint to, Color color, int amplitude, int thickness)
+{
+    m_commands.append(DrawTriangleWave { from, to, color, amplitude, thickness });
+}
+
+void RecordingPainter::draw_triangle(Gfx::IntPoint offset, ReadonlySpan<Gfx::IntPoint> points, Color color)
+{
+    Vector<Gfx::IntPoint, 3> copied_points;
+    copied_points.append(points.data(), points.size());
+    m_commands.append(DrawTriangle { offset, move(copied_points), color });
+}
+
+void RecordingPainter::draw_text(Gfx::IntRect const& rect, StringView text, Gfx::Font const& font, Gfx::TextAlignment alignment, Color color, Gfx::TextElision elision, Gfx::TextWrapping wrapping)
+{
+    m_commands.append(DrawText { rect, text, font, alignment, color, elision, wrapping });
+}
+
+void RecordingPainter::draw_text(Gfx::IntRect const& rect, StringView text, Gfx::TextAlignment alignment, Color color, Gfx::TextElision elision, Gfx::TextWrapping wrapping)
+{
+    draw_text(rect, text, font(), alignment, color, elision, wrapping);
+}
+
+void RecordingPainter::draw_text_run(Gfx::IntPoint baseline_start, Utf8View const& text, Gfx::Font const& font, Color color)
+{
+    m_commands.append(DrawTextRun { baseline_start, text.as_string(), font, color });
+}
+
+void RecordingPainter::blit(Gfx::IntPoint position, Gfx::Bitmap const& bitmap, Gfx::IntRect const& src_rect, float opacity)
+{
+    m_commands.append(Blit { position, bitmap, src_rect, opacity });
+}
+
+void RecordingPainter::draw_scaled_bitmap(Gfx::IntRect const& dst_rect, Gfx::Bitmap const& bitmap, Gfx::IntRect const& src_rect, float opacity, Gfx::Painter::ScalingMode scaling_mode)
+{
+    m_commands.append(DrawScaledBitmap { dst_rect, bitmap, src_rect, opacity, scaling_mode });
+}
+
+void RecordingPainter::draw_signed_distance_field(Gfx::IntRect const& dst_rect, Color color, Gfx::GrayscaleBitmap const& sdf, float smoothing)
+{
+    m_commands.append(DrawSignedDistanceField { dst_rect, color, sdf, smoothing });
+}
+
+void RecordingPainter::fill_rect_with_linear_gradient(Gfx::IntRect const& rect, ReadonlySpan<Gfx::ColorStop> color_stops, float angle, Optional<float> repeat_length)
+{
+    m_commands.append(FillRectWithLinearGradient { rect, Vector<Gfx::ColorStop> { color_stops }, angle, repeat_length });
+}
+
+void RecordingPainter::fill_rect_with_conic_gradient(Gfx::IntRect const& rect, ReadonlySpan<Gfx::ColorStop> color_stops, Gfx::IntPoint center, float start_angle, Optional<float> repeat_length)
+{
+    m_commands.append(FillRectWithConicGradient { rect, Vector<Gfx::ColorStop> { color_stops }, center, start_angle, repeat_length });
+}
+
+void RecordingPainter::fill_rect_with_radial_gradient(Gfx::IntRect const& rect, ReadonlySpan<Gfx::ColorStop> color_stops, Gfx::IntPoint center, Gfx::IntSize size, Optional<float> repeat_length)
+{
+    m_commands.append(FillRectWithRadialGradient { rect, Vector<Gfx::ColorStop> { color_stops }, center, size, repeat_length });
+}
+
+void RecordingPainter::fill_rect_with_rounded_corners(Gfx::IntRect const& rect, Color color, int radius)
+{
+    fill_rect_with_rounded_corners(rect, color, { radius, radius }, { radius, radius }, { radius, radius }, { radius, radius });
+}
+
+void RecordingPainter::fill_rect_with_rounded_corners(Gfx::IntRect const& rect, Color color, CornerRadius top_left, CornerRadius top_right, CornerRadius bottom_right, CornerRadius bottom_left, BlendMode blend_mode)
+{
+    m_commands.append(FillRectWithRoundedCorners { rect, color, top_left, top_right, bottom_right, bottom_left, blend_mode });
+}
+
+void RecordingPainter::fill_ellipse(Gfx::IntRect const& rect, Color color)
+{
+    m_commands.append(FillEllipse { rect, color });
+}
+
+void RecordingPainter::draw_ellipse(Gfx::IntRect const& rect, Color color, int thickness)
+{
+    m_commands.append(DrawEllipse { rect, color, thickness });
+}
+
+void RecordingPainter::fill_path(Gfx::Path const& path, Color color, Gfx::Painter::WindingRule winding_rule)
+{
+    m_commands.append(FillPathWithColor { path, color, winding_rule });
+}
+
+void RecordingPainter::fill_path(Gfx::Path const& path, NonnullRefPtr<Gfx::PaintStyle const> paint_style, Gfx::Painter::WindingRule winding_rule)
+{
+    m_commands.append(FillPathWithPaintStyle { path, move(paint_style), winding_rule });
+}
+
+void RecordingPainter::stroke_path(Gfx::Path const& path, Color color, float thickness)
+{
+    m_commands.append(StrokePath { path, color, thickness });
+}
+
+void RecordingPainter::draw_anti_aliased_line(Gfx::IntPoint from, Gfx::IntPoint to, Color color, float thickness, Gfx::Painter::LineStyle style)
+{
+    m_commands.append(DrawAntiAliasedLine { from, to, color, thickness, style });
+}
+
+void RecordingPainter::paint_frame(Gfx::IntRect const& rect, Palette const& palette, Gfx::FrameStyle style)
+{
+    m_commands.append(PaintFrame { rect, palette, style });
+}
+
+void RecordingPainter::paint_progressbar(Gfx::IntRect const& rect, Palette const& palette, int min, int max, int value)
+{
+    m_commands.append(PaintProgressbar { rect, palette, min, max, value });
+}
+
+void RecordingPainter::paint_border_corners(BorderCornersParams params)
+{
+    m_commands.append(PaintBorderCorners { move(params) });
+}
+
+void RecordingPainter::sample_under_corners(BorderRadiusCornerClipper& corner_clipper)
+{
+    m_commands.append(SampleUnderCorners { corner_clipper });
+}
+
+void RecordingPainter::blit_corner_clipping(BorderRadiusCornerClipper& corner_clipper)
+{
+    m_commands.append(BlitCornerClipping { corner_clipper });
+}
+
+void RecordingPainter::apply_backdrop_filter(Gfx::IntRect const& backdrop_region, Vector<CSS::FilterFunction> filters)
+{
+    m_commands.append(ApplyBackdropFilter { backdrop_region, move(filters) });
+}
+
+void RecordingPainter::push_stacking_context(StackingContextParams const& params)
+{
+    m_commands.append(PushStackingContext { params });
+
+    // The translation that rasterization adds for the part of the destination rect that is outside of the target is
+    // not known yet, so this is the largest area that can be visible in the stacking context's bitmap.
+    m_state_stack.append(State {
+        .translation = to_device_translation(-params.paint_rect_location, params.device_pixels_per_css_pixel),
+        .clip_rect = { {}, params.source_size.to_rounded<int>() },
+        .font = state().font,
+    });
+}
+
+void RecordingPainter::pop_stacking_context()
+{
+    VERIFY(m_state_stack.size() > 1);
+    m_state_stack.take_last();
+    m_commands.append(PopStackingContext {});
+}
+
+void RecordingPainter::translate(Gfx::IntPoint delta)
+{
+    state().translation.translate_by(delta);
+    m_commands.append(Translate { delta });
+}
+
+void RecordingPainter::add_clip_rect(Gfx::IntRect const& rect)
+{
+    state().clip_rect.intersect(rect.translated(state().translation));
+    m_commands.append(AddClipRect { rect });
+}
+
+Gfx::Font const& RecordingPainter::font() const
+{
+    if (!state().font)
+        return Gfx::FontDatabase::default_font();
+    return *state().font;
+}
+
+void RecordingPainter::set_font(Gfx::Font const& font)
+{
+    state().font = font;
+}
+
+void RecordingPainter::save()
+{
+    m_state_stack.append(m_state_stack.last());
+    m_commands.append(Save {});
+}
+
+void RecordingPainter::restore()
+{
+    VERIFY(m_state_stack.size() > 1);
+    m_state_stack.take_last();
+    m_commands.append(Restore {});
+}
+
+namespace {
+
+struct StackingContextLayer {
+    // Null if the layer's bitmap could not be created, in which case everything painted into the layer is skipped.
+    OwnPtr<Gfx::Painter> painter;
+    RefPtr<Gfx::Bitmap> bitmap;
+    Gfx::IntRect destination_rect;
+    float opacity { 1.0f };
+};
+
+}
+
+void RecordingPainter::execute(Gfx::Painter& target_painter) const
+{
+    Vector<StackingContextLayer> layers;
+    // The same display list may be executed on several threads at once, so the corners sampled by each clipper are
+    // kept here until they are blitted back, rather than in the clipper.
+    HashMap<BorderRadiusCornerClipper const*, NonnullRefPtr<Gfx::Bitmap>> sampled_corners;
+    auto current_painter = [&]() -> Gfx::Painter* {
+        if (layers.is_empty())
+            return &target_painter;
+        return layers.last().painter.ptr();
+    };
+
+    auto push_layer = [&](StackingContextParams const& params) {
+        auto* painter = current_painter();
+        if (!painter) {
+            layers.append({});
+            return;
+        }
+
+        auto destination_rect = params.destination_rect;
+        Gfx::IntRect actual_destination_rect;
+        auto bitmap_or_error = painter->get_region_bitmap(destination_rect, Gfx::BitmapFormat::BGRA8888, actual_destination_rect);
+        if (bitmap_or_error.is_error()) {
+            layers.append({});
+            return;
+        }
+        auto bitmap = bitmap_or_error.release_value();
+
+        // get_region_bitmap() may clip to a smaller region if the requested rect goes outside the painter, so we need to account for that.
+        CSSPixelPoint destination_clipped_fixup { destination_rect.location() - actual_destination_rect.location() };
+        destination_rect = actual_destination_rect;
+        if (params.source_size != params.transformed_destination_size) {
+            auto sx = static_cast<float>(params.source_size.width()) / params.transformed_destination_size.width();
+            auto sy = static_cast<float>(params.source_size.height()) / params.transformed_destination_size.height();
+            auto scaled_bitmap_or_error = bitmap->scaled(sx, sy);
+            if (scaled_bitmap_or_error.is_error()) {
+                layers.append({});
+                return;
+            }
+            bitmap = scaled_bitmap_or_error.release_value();
+            destination_clipped_fixup.scale_by(sx, sy);
+        }
+
+        auto layer_painter = make<Gfx::Painter>(bitmap);
+        layer_painter->translate(to_device_translation(-params.paint_rect_location + destination_clipped_fixup, params.device_pixels_per_css_pixel));
+        layers.append({ move(layer_painter), move(bitmap), destination_rect, params.opacity });
+    };
+
+    auto pop_layer = [&] {
+        auto layer = layers.take_last();
+        auto* painter = current_painter();
+        if (!layer.painter || !painter)
+            return;
+        if (layer.destination_rect.size() == layer.bitmap->size())
+            painter->blit(layer.destination_rect.location(), *layer.bitmap, layer.bitmap->rect(), layer.opacity);
+        else
+            painter->draw_scaled_bitmap(layer.destination_rect, *layer.bitmap, layer.bitmap->rect(), layer.opacity, Gfx::Painter::ScalingMode::BilinearBlend);
+    };
+
+    for (auto const& recorded_command : m_commands) {
+        if (recorded_command.has<PushStackingContext>()) {
+            push_layer(recorded_command.get<PushStackingContext>().params);
+            continue;
+        }
+        if (recorded_command.has<PopStackingContext>()) {
+            pop_layer();
+            continue;
+        }
+
+        auto* painter_pointer = current_painter();
+        if (!painter_pointer)
+            continue;
+        auto& painter = *painter_pointer;
+
+        recorded_command.visit(
+            [&](Save const&) { painter.save(); },
+            [&](Restore const&) { painter.restore(); },
+            [&](Translate const& command) { painter.translate(command.delta); },
+            [&](AddClipRect const& command) { painter.add_clip_rect(command.rect); },
+            [&](FillRect const& command) { painter.fill_rect(command.rect, command.color); },
+            [&](ClearRect const& command) { painter.clear_rect(command.rect, command.color); },
+            [&](DrawRect const& command) { painter.draw_rect(command.rect, command.color, command.rough); },
+            [&](DrawFocusRect const& command) { painter.draw_focus_rect(command.rect, command.color); },
+            [&](DrawLine const& command) {
+                painter.draw_line(command.from, command.to, command.color, command.thickness, command.style, command.alternate_color);
+            },
+            [&](DrawTriangleWave const& command) {
+                painter.draw_triangle_wave(command.from, command.to, command.color, command.amplitude, command.thickness);
+            },
+            [&](DrawTriangle const& command) { painter.draw_triangle(command.offset, command.points, command.color); },
+            [&](DrawText const& command) {
+                painter.draw_text(command.rect, command.text, *command.font, command.alignment, command.color, command.elision, command.wrapping);
+            },
+            [&](DrawTextRun const& command) {
+                painter.draw_text_run(command.baseline_start, Utf8View(command.text), *command.font, command.color);
+            },
+            [&](Blit const& command) { painter.blit(command.position, *command.bitmap, command.src_rect, command.opacity); },
+            [&](DrawScaledBitmap const& command) {
+                painter.draw_scaled_bitmap(command.dst_rect, *command.bitmap, command.src_rect, command.opacity, command.scaling_mode);
+            },
+            [&](DrawSignedDistanceField const& command) {
+                painter.draw_signed_distance_field(command.dst_rect, command.color, command.sdf, command.smoothing);
+            },
+            [&](FillRectWithLinearGradient const& command) {
+                painter.fill_rect_with_linear_gradient(command.rect, command.color_stops, command.angle, command.repeat_length);
+            },
+            [&](FillRectWithConicGradient const& command) {
+                painter.fill_rect_with_conic_gradient(command.rect, command.color_stops, command.center, command.start_angle, command.repeat_length);
+            },
+            [&](FillRectWithRadialGradient const& command) {
+                painter.fill_rect_with_radial_gradient(command.rect, command.color_stops, command.center, command.size, command.repeat_length);
+            },
+            [&](FillRectWithRoundedCorners const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.fill_rect_with_rounded_corners(command.rect, command.color, command.top_left, command.top_right, command.bottom_right, command.bottom_left, command.blend_mode);
+            },
+            [&](FillEllipse const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.fill_ellipse(command.rect, command.color);
+            },
+            [&](DrawEllipse const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.draw_ellipse(command.rect, command.color, command.thickness);
+            },
+            [&](FillPathWithColor const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.fill_path(command.path, command.color, command.winding_rule);
+            },
+            [&](FillPathWithPaintStyle const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.fill_path(command.path, *command.paint_style, command.winding_rule);
+            },
+            [&](StrokePath const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.stroke_path(command.path, command.color, command.thickness);
+            },
+            [&](DrawAntiAliasedLine const& command) {
+                Gfx::AntiAliasingPainter aa_painter { painter };
+                aa_painter.draw_line(command.from, command.to, command.color, command.thickness, command.style);
+            },
+            [&](PaintFrame const& command) { Gfx::StylePainter::paint_frame(painter, command.rect, command.palette, command.style); },
+            [&](PaintProgressbar const& command) {
+                Gfx::StylePainter::paint_progressbar(painter, command.rect, command.palette, command.min, command.max, command.value, ""sv);
+            },
+            [&](PaintBorderCorners const& command) {
+                auto const& params = command.params;
+                auto corner_bitmap = get_cached_corner_bitmap(params.mask_rect.size().to_type<DevicePixels>());
+                if (!corner_bitmap)
+                    return;
+                Gfx::Painter mask_painter { *corner_bitmap };
+                Gfx::AntiAliasingPainter aa_mask_painter { mask_painter };
+                aa_mask_painter.fill_rect_with_rounded_corners(params.mask_rect, params.mask_color, params.radii[0], params.radii[1], params.radii[2], params.radii[3]);
+                aa_mask_painter.fill_rect_with_rounded_corners(params.inner_mask_rect, params.mask_color, params.inner_radii[0], params.inner_radii[1], params.inner_radii[2], params.inner_radii[3], BlendMode::AlphaSubtract);
+                for (auto const& corner : params.corners) {
+                    painter.blit_filtered(corner.position, *corner_bitmap, corner.mask_rect, [&](auto const& mask_pixel) {
+                        return corner.color.with_alpha((corner.color.alpha() * mask_pixel.alpha()) / 255);
+                    });
+                }
+            },
+            [&](SampleUnderCorners const& command) {
+                if (auto corner_bitmap = command.corner_clipper->sample_under_corners(painter))
+                    sampled_corners.set(command.corner_clipper.ptr(), corner_bitmap.release_nonnull());
+            },
+            [&](BlitCornerClipping const& command) {
+                if (auto corner_bitmap = sampled_corners.take(command.corner_clipper.ptr()); corner_bitmap.has_value())
+                    command.corner_clipper->blit_corner_clipping(painter, *corner_bitmap);
+            },
+            [&](ApplyBackdropFilter const& command) {
+                Gfx::IntRect actual_region {};
+                auto backdrop_bitmap = painter.get_region_bitmap(command.backdrop_region, Gfx::BitmapFormat::BGRA8888, actual_region);
+                if (actual_region.is_empty())
+                    return;
+                if (backdrop_bitmap.is_error()) {
+                    dbgln("Failed get region bitmap for backdrop-filter");
+                    return;
+                }
+                apply_filter_list(*backdrop_bitmap.value(), command.filters);
+                painter.blit(actual_region.location(), *backdrop_bitmap.value(), backdrop_bitmap.value()->rect());
+            },
+            [&](PushStackingContext const&) { VERIFY_NOT_REACHED(); },
+            [&](PopStackingContext const&) { VERIFY_NOT_REACHED(); });
+    }
+
+    VERIFY(layers.is_empty());
+}
+
+}
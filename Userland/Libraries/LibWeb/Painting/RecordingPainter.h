@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/DeprecatedString.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibGfx/AntiAliasingPainter.h>
+#include <LibGfx/Color.h>
+#include <LibGfx/Forward.h>
+#include <LibGfx/Gradients.h>
+#include <LibGfx/GrayscaleBitmap.h>
+#include <LibGfx/PaintStyle.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Palette.h>
+#include <LibGfx/Path.h>
+#include <LibGfx/Point.h>
+#include <LibGfx/Rect.h>
+#include <LibGfx/StylePainter.h>
+#include <LibGfx/TextAlignment.h>
+#include <LibGfx/TextElision.h>
+#include <LibGfx/TextWrapping.h>
+#include <LibWeb/CSS/StyleValues/FilterValueListStyleValue.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/PixelUnits.h>
+
+namespace Web::Painting {
+
+// Records paint commands into a display list instead of drawing them, so they can be rasterized later with execute(),
+// possibly on another thread and possibly more than once.
+// It keeps track of the translation and clip rect the same way Gfx::Painter does, so the paintable tree can still
+// skip painting what is out of view while recording.
+//
+// Everything a command refers to is owned by the display list, so rasterizing it never touches the DOM, the layout
+// tree or the paintable tree. The display list itself is not thread-safe though: it must be destroyed on the thread
+// that recorded it, and not while it is being rasterized.
+class RecordingPainter {
+    AK_MAKE_NONCOPYABLE(RecordingPainter);
+    AK_MAKE_NONMOVABLE(RecordingPainter);
+
+public:
+    explicit RecordingPainter(Gfx::IntSize target_size);
+    ~RecordingPainter();
+
+    void fill_rect(Gfx::IntRect const&, Color);
+    void clear_rect(Gfx::IntRect const&, Color);
+    void draw_rect(Gfx::IntRect const&, Color, bool rough = false);
+    void draw_focus_rect(Gfx::IntRect const&, Color);
+    void draw_line(Gfx::IntPoint from, Gfx::IntPoint to, Color, int thickness = 1, Gfx::Painter::LineStyle = Gfx::Painter::LineStyle::Solid, Color alternate_color = Color::Transparent);
+    void draw_triangle_wave(Gfx::IntPoint from, Gfx::IntPoint to, Color, int amplitude, int thickness = 1);
+    void draw_triangle(Gfx::IntPoint offset, ReadonlySpan<Gfx::IntPoint>, Color);
+
+    void draw_text(Gfx::IntRect const&, StringView, Gfx::Font const&, Gfx::TextAlignment = Gfx::TextAlignment::TopLeft, Color = Color::Black, Gfx::TextElision = Gfx::TextElision::None, Gfx::TextWrapping = Gfx::TextWrapping::DontWrap);
+    void draw_text(Gfx::IntRect const&, StringView, Gfx::TextAlignment = Gfx::TextAlignment::TopLeft, Color = Color::Black, Gfx::TextElision = Gfx::TextElision::None, Gfx::TextWrapping = Gfx::TextWrapping::DontWrap);
+    void draw_text_run(Gfx::IntPoint baseline_start, Utf8View const&, Gfx::Font const&, Color);
+
+    void blit(Gfx::IntPoint, Gfx::Bitmap const&, Gfx::IntRect const& src_rect, float opacity = 1.0f);
+    void draw_scaled_bitmap(Gfx::IntRect const& dst_rect, Gfx::Bitmap const&, Gfx::IntRect const& src_rect, float opacity = 1.0f, Gfx::Painter::ScalingMode = Gfx::Painter::ScalingMode::NearestNeighbor);
+    void draw_signed_distance_field(Gfx::IntRect const& dst_rect, Color, Gfx::GrayscaleBitmap const&, float smoothing);
+
+    void fill_rect_with_linear_gradient(Gfx::IntRect const&, ReadonlySpan<Gfx::ColorStop>, float angle, Optional<float> repeat_length = {});
+    void fill_rect_with_conic_gradient(Gfx::IntRect const&, ReadonlySpan<Gfx::ColorStop>, Gfx::IntPoint center, float start_angle, Optional<float> repeat_length = {});
+    void fill_rect_with_radial_gradient(Gfx::IntRect const&, ReadonlySpan<Gfx::ColorStop>, Gfx::IntPoint center, Gfx::IntSize size, Optional<float> repeat_length = {});
+
+    // These are drawn with Gfx::AntiAliasingPainter.
+    using CornerRadius = Gfx::AntiAliasingPainter::CornerRadius;
+    using BlendMode = Gfx::AntiAliasingPainter::BlendMode;
+    void fill_rect_with_rounded_corners(Gfx::IntRect const&, Color, int radius);
+    void fill_rect_with_rounded_corners(Gfx::IntRect const&, Color, CornerRadius top_left, CornerRadius top_right, CornerRadius bottom_right, CornerRadius bottom_left, BlendMode = BlendMode::Normal);
+    void fill_ellipse(Gfx::IntRect const&, Color);
+    void draw_ellipse(Gfx::IntRect const&, Color, int thickness);
+    void fill_path(Gfx::Path const&, Color, Gfx::Painter::WindingRule = Gfx::Painter::WindingRule::Nonzero);
+    // The display list keeps a reference to the paint style until it is rasterized, which may happen on another thread.
+    // So the paint style must not be changed or shared with anything else afterwards.
+    void fill_path(Gfx::Path const&, NonnullRefPtr<Gfx::PaintStyle const>, Gfx::Painter::WindingRule = Gfx::Painter::WindingRule::Nonzero);
+    void stroke_path(Gfx::Path const&, Color, float thickness);
+    void draw_anti_aliased_line(Gfx::IntPoint from, Gfx::IntPoint to, Color, float thickness, Gfx::Painter::LineStyle = Gfx::Painter::LineStyle::Solid);
+
+    void paint_frame(Gfx::IntRect const&, Palette const&, Gfx::FrameStyle);
+    void paint_progressbar(Gfx::IntRect const&, Palette const&, int min, int max, int value);
+
+    // The rounded corners of a border are painted into a mask first, which is then drawn at each corner in its color.
+    // The radii are in the order top left, top right, bottom right, bottom left.
+    struct BorderCorner {
+        Gfx::IntPoint position;
+        Gfx::IntRect mask_rect;
+        Color color;
+    };
+    struct BorderCornersParams {
+        Gfx::IntRect mask_rect;
+        Array<CornerRadius, 4> radii;
+        Gfx::IntRect inner_mask_rect;
+        Array<CornerRadius, 4> inner_radii;
+        Color mask_color;
+        Vector<BorderCorner, 4> corners;
+    };
+    void paint_border_corners(BorderCornersParams);
+
+    // Sampling and restoring the corners are deferred to rasterization, where the pixels under them are known.
+    void sample_under_corners(BorderRadiusCornerClipper&);
+    void blit_corner_clipping(BorderRadiusCornerClipper&);
+
+    // Copies the pixels under the rect, applies the filters to them and draws them back. All lengths in the filters
+    // have to be absolute already, see resolve_filter_list().
+    void apply_backdrop_filter(Gfx::IntRect const& backdrop_region, Vector<CSS::FilterFunction> filters);
+
+    // Everything painted until the matching pop_stacking_context() is drawn into a separate bitmap first, which starts
+    // out as a copy of the pixels under destination_rect. That bitmap is then scaled from the size of the transformed
+    // destination rect to the size of the source rect, and finally drawn back at destination_rect with the opacity.
+    // The commands in between are translated so that paint_rect_location ends up at the bitmap's origin.
+    struct StackingContextParams {
+        float opacity { 1.0f };
+        Gfx::IntRect destination_rect;
+        Gfx::FloatSize source_size;
+        Gfx::FloatSize transformed_destination_size;
+        CSSPixelPoint paint_rect_location;
+        float device_pixels_per_css_pixel { 1.0f };
+    };
+    void push_stacking_context(StackingContextParams const&);
+    void pop_stacking_context();
+
+    void translate(int dx, int dy) { translate({ dx, dy }); }
+    void translate(Gfx::IntPoint delta);
+    void add_clip_rect(Gfx::IntRect const&);
+
+    Gfx::IntPoint translation() const { return state().translation; }
+    Gfx::IntRect clip_rect() const { return state().clip_rect; }
+
+    // The font only serves as the default for draw_text(), it is not recorded by itself.
+    Gfx::Font const& font() const;
+    void set_font(Gfx::Font const&);
+
+    void save();
+    void restore();
+
+    bool is_empty() const { return m_commands.is_empty(); }
+    size_t command_count() const { return m_commands.size(); }
+
+    void execute(Gfx::Painter&) const;
+
+private:
+    struct Save {
+    };
+    struct Restore {
+    };
+    struct Translate {
+        Gfx::IntPoint delta;
+    };
+    struct AddClipRect {
+        Gfx::IntRect rect;
+    };
+    struct FillRect {
+        Gfx::IntRect rect;
+        Color color;
+    };
+    struct ClearRect {
+        Gfx::IntRect rect;
+        Color color;
+    };
+    struct DrawRect {
+        Gfx::IntRect rect;
+        Color color;
+        bool rough { false };
+    };
+    struct DrawFocusRect {
+        Gfx::IntRect rect;
+        Color color;
+    };
+    struct DrawLine {
+        Gfx::IntPoint from;
+        Gfx::IntPoint to;
+        Color color;
+        int thickness { 1 };
+        Gfx::Painter::LineStyle style { Gfx::Painter::LineStyle::Solid };
+        Color alternate_color;
+    };
+    struct DrawTriangleWave {
+        Gfx::IntPoint from;
+        Gfx::IntPoint to;
+        Color color;
+        int amplitude { 0 };
+        int thickness { 1 };
+    };
+    struct DrawTriangle {
+        Gfx::IntPoint offset;
+        Vector<Gfx::IntPoint, 3> points;
+        Color color;
+    };
+    struct DrawText {
+        Gfx::IntRect rect;
+        DeprecatedString text;
+        NonnullRefPtr<Gfx::Font const> font;
+        Gfx::TextAlignment alignment;
+        Color color;
+        Gfx::TextElision elision;
+        Gfx::TextWrapping wrapping;
+    };
+    struct DrawTextRun {
+        Gfx::IntPoint baseline_start;
+        DeprecatedString text;
+        NonnullRefPtr<Gfx::Font const> font;
+        Color color;
+    };
+    struct Blit {
+        Gfx::IntPoint position;
+        NonnullRefPtr<Gfx::Bitmap const> bitmap;
+        Gfx::IntRect src_rect;
+        float opacity { 1.0f };
+    };
+    struct DrawScaledBitmap {
+        Gfx::IntRect dst_rect;
+        NonnullRefPtr<Gfx::Bitmap const> bitmap;
+        Gfx::IntRect src_rect;
+        float opacity { 1.0f };
+        Gfx::Painter::ScalingMode scaling_mode;
+    };
+    struct DrawSignedDistanceField {
+        Gfx::IntRect dst_rect;
+        Color color;
+        Gfx::GrayscaleBitmap sdf;
+        float smoothing { 0 };
+    };
+    struct FillRectWithLinearGradient {
+        Gfx::IntRect rect;
+        Vector<Gfx::ColorStop> color_stops;
+        float angle { 0 };
+        Optional<float> repeat_length;
+    };
+    struct FillRectWithConicGradient {
+        Gfx::IntRect rect;
+        Vector<Gfx::ColorStop> color_stops;
+        Gfx::IntPoint center;
+        float start_angle { 0 };
+        Optional<float> repeat_length;
+    };
+    struct FillRectWithRadialGradient {
+        Gfx::IntRect rect;
+        Vector<Gfx::ColorStop> color_stops;
+        Gfx::IntPoint center;
+        Gfx::IntSize size;
+        Optional<float> repeat_length;
+    };
+    struct FillRectWithRoundedCorners {
+        Gfx::IntRect rect;
+        Color color;
+        CornerRadius top_left;
+        CornerRadius top_right;
+        CornerRadius bottom_right;
+        CornerRadius bottom_left;
+        BlendMode blend_mode { BlendMode::Normal };
+    };
+    struct FillEllipse {
+        Gfx::IntRect rect;
+        Color color;
+    };
+    struct DrawEllipse {
+        Gfx::IntRect rect;
+        Color color;
+        int thickness { 1 };
+    };
+    struct FillPathWithColor {
+        Gfx::Path path;
+        Color color;
+        Gfx::Painter::WindingRule winding_rule;
+    };
+    struct FillPathWithPaintStyle {
+        Gfx::Path path;
+        NonnullRefPtr<Gfx::PaintStyle const> paint_style;
+        Gfx::Painter::WindingRule winding_rule;
+    };
+    struct StrokePath {
+        Gfx::Path path;
+        Color color;
+        float thickness { 1 };
+    };
+    struct DrawAntiAliasedLine {
+        Gfx::IntPoint from;
+        Gfx::IntPoint to;
+        Color color;
+        float thickness { 1 };
+        Gfx::Painter::LineStyle style { Gfx::Painter::LineStyle::Solid };
+    };
+    struct PaintFrame {
+        Gfx::IntRect rect;
+        Palette palette;
+        Gfx::FrameStyle style;
+    };
+    struct PaintProgressbar {
+        Gfx::IntRect rect;
+        Palette palette;
+        int min { 0 };
+        int max { 0 };
+        int value { 0 };
+    };
+    struct PaintBorderCorners {
+        BorderCornersParams params;
+    };
+    struct SampleUnderCorners {
+        NonnullRefPtr<BorderRadiusCornerClipper> corner_clipper;
+    };
+    struct BlitCornerClipping {
+        NonnullRefPtr<BorderRadiusCornerClipper> corner_clipper;
+    };
+    struct ApplyBackdropFilter {
+        Gfx::IntRect backdrop_region;
+        Vector<CSS::FilterFunction> filters;
+    };
+    struct PushStackingContext {
+        StackingContextParams params;
+    };
+    struct PopStackingContext {
+    };
+
+    using Command = Variant<
+        Save,
+        Restore,
+        Translate,
+        AddClipRect,
+        FillRect,
+        ClearRect,
+        DrawRect,
+        DrawFocusRect,
+        DrawLine,
+        DrawTriangleWave,
+        DrawTriangle,
+        DrawText,
+        DrawTextRun,
+        Blit,
+        DrawScaledBitmap,
+        DrawSignedDistanceField,
+        FillRectWithLinearGradient,
+        FillRectWithConicGradient,
+        FillRectWithRadialGradient,
+        FillRectWithRoundedCorners,
+        FillEllipse,
+        DrawEllipse,
+        FillPathWithColor,
+        FillPathWithPaintStyle,
+        StrokePath,
+        DrawAntiAliasedLine,
+        PaintFrame,
+        PaintProgressbar,
+        PaintBorderCorners,
+        SampleUnderCorners,
+        BlitCornerClipping,
+        ApplyBackdropFilter,
+        PushStackingContext,
+        PopStackingContext>;
+
+    struct State {
+        Gfx::IntPoint translation;
+        Gfx::IntRect clip_rect;
+        RefPtr<Gfx::Font const> font;
+    };
+    State& state() { return m_state_stack.last(); }
+    State const& state() const { return m_state_stack.last(); }
+
+    Vector<Command> m_commands;
+    Vector<State> m_state_stack;
+};
+
+class RecordingPainterStateSaver {
+public:
+    explicit RecordingPainterStateSaver(RecordingPainter& painter)
+        : m_painter(painter)
+    {
+        m_painter.save();
+    }
+
+    ~RecordingPainterStateSaver()
+    {
+        m_painter.restore();
+    }
+
+private:
+    RecordingPainter& m_painter;
+};
+
+}
@@ -5,7 +5,6 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibGfx/AntiAliasingPainter.h>
 #include <LibWeb/Layout/ImageBox.h>
 #include <LibWeb/Painting/SVGGeometryPaintable.h>
 #include <LibWeb/SVG/SVGSVGElement.h>
@@ -54,18 +53,12 @@ void SVGGeometryPaintable::paint(PaintContext& context, PaintPhase phase) const
 
     auto& geometry_element = layout_box().dom_node();
 
-    Gfx::AntiAliasingPainter painter { context.painter() };
+    auto& painter = context.painter();
     auto& svg_context = context.svg_context();
 
-    // FIXME: This should not be trucated to an int.
-    Gfx::PainterStateSaver save_painter { context.painter() };
-    auto offset = context.floored_device_point(svg_context.svg_element_position()).to_type<int>().to_type<float>();
-    painter.translate(offset);
-
     auto const* svg_element = geometry_element.first_ancestor_of_type<SVG::SVGSVGElement>();
     auto maybe_view_box = svg_element->view_box();
 
-    context.painter().add_clip_rect(context.enclosing_device_rect(absolute_rect()).to_type<int>());
     auto css_scale = context.device_pixels_per_css_pixel();
 
     auto transform = layout_box().layout_transform();
@@ -101,10 +94,23 @@ void SVGGeometryPaintable::paint(PaintContext& context, PaintPhase phase) const
         .transform = paint_transform
     };
 
+    auto stroke_color = geometry_element.stroke_color().value_or(svg_context.stroke_color());
+    auto stroke_thickness = geometry_element.stroke_width().value_or(svg_context.stroke_width()) * viewbox_scale;
+
+    RecordingPainterStateSaver save_painter { painter };
+    // Strokes are centered on the path, so they reach past the box of the geometry. Leave room for them on every side,
+    // including their anti-aliased edges.
+    auto stroke_overhang = stroke_color.alpha() > 0 ? static_cast<int>(ceilf(stroke_thickness)) + 1 : 0;
+    painter.add_clip_rect(context.enclosing_device_rect(absolute_rect()).to_type<int>().inflated(stroke_overhang * 2, stroke_overhang * 2));
+
+    // FIXME: This should not be trucated to an int.
+    auto offset = context.floored_device_point(svg_context.svg_element_position()).to_type<int>();
+    painter.translate(offset);
+
     if (auto paint_style = geometry_element.fill_paint_style(paint_context); paint_style.has_value()) {
         painter.fill_path(
             closed_path(),
-            *paint_style,
+            paint_style.release_value(),
             Gfx::Painter::WindingRule::EvenOdd);
     } else if (auto fill_color = geometry_element.fill_color().value_or(svg_context.fill_color()); fill_color.alpha() > 0) {
         painter.fill_path(
@@ -113,13 +119,8 @@ void SVGGeometryPaintable::paint(PaintContext& context, PaintPhase phase) const
             Gfx::Painter::WindingRule::EvenOdd);
     }
 
-    if (auto stroke_color = geometry_element.stroke_color().value_or(svg_context.stroke_color()); stroke_color.alpha() > 0) {
-        painter.stroke_path(
-            path,
-            stroke_color,
-            // Note: This is assuming .x_scale() == .y_scale() (which it does currently).
-            geometry_element.stroke_width().value_or(svg_context.stroke_width()) * viewbox_scale);
-    }
+    if (stroke_color.alpha() > 0)
+        painter.stroke_path(path, stroke_color, stroke_thickness);
 }
 
 }
@@ -363,7 +363,7 @@ Gfx::AffineTransform StackingContext::affine_transform_matrix() const
 
 void StackingContext::paint(PaintContext& context) const
 {
-    Gfx::PainterStateSaver saver(context.painter());
+    RecordingPainterStateSaver saver(context.painter());
     if (m_box->is_fixed_position()) {
         context.painter().translate(-context.painter().translation());
     }
@@ -383,41 +383,23 @@ void StackingContext::paint(PaintContext& context) const
         auto destination_rect = transformed_destination_rect.to_rounded<int>();
 
         // FIXME: We should find a way to scale the paintable, rather than paint into a separate bitmap,
-        // then scale it. This snippet now copies the background at the destination, then scales it down/up
+        // then scale it. When rasterized, this copies the background at the destination, then scales it down/up
         // to the size of the source (which could add some artefacts, though just scaling the bitmap already does that).
         // We need to copy the background at the destination because a bunch of our rendering effects now rely on
         // being able to sample the painter (see border radii, shadows, filters, etc).
-        CSSPixelPoint destination_clipped_fixup {};
-        auto try_get_scaled_destination_bitmap = [&]() -> ErrorOr<NonnullRefPtr<Gfx::Bitmap>> {
-            Gfx::IntRect actual_destination_rect;
-            auto bitmap = TRY(context.painter().get_region_bitmap(destination_rect, Gfx::BitmapFormat::BGRA8888, actual_destination_rect));
-            // get_region_bitmap() may clip to a smaller region if the requested rect goes outside the painter, so we need to account for that.
-            destination_clipped_fixup = CSSPixelPoint { destination_rect.location() - actual_destination_rect.location() };
-            destination_rect = actual_destination_rect;
-            if (source_rect.size() != transformed_destination_rect.size()) {
-                auto sx = static_cast<float>(source_rect.width()) / transformed_destination_rect.width();
-                auto sy = static_cast<float>(source_rect.height()) / transformed_destination_rect.height();
-                bitmap = TRY(bitmap->scaled(sx, sy));
-                destination_clipped_fixup.scale_by(sx, sy);
-            }
-            return bitmap;
+        RecordingPainter::StackingContextParams params {
+            .opacity = opacity,
+            .destination_rect = destination_rect,
+            .source_size = source_rect.size(),
+            .transformed_destination_size = transformed_destination_rect.size(),
+            .paint_rect_location = paintable_box().absolute_paint_rect().location(),
+            .device_pixels_per_css_pixel = context.device_pixels_per_css_pixel(),
         };
-
-        auto bitmap_or_error = try_get_scaled_destination_bitmap();
-        if (bitmap_or_error.is_error())
-            return;
-        auto bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
-        Gfx::Painter painter(bitmap);
-        painter.translate(context.rounded_device_point(-paintable_box().absolute_paint_rect().location() + destination_clipped_fixup).to_type<int>());
-        auto paint_context = context.clone(painter);
-        paint_internal(paint_context);
-
-        if (destination_rect.size() == bitmap->size())
-            context.painter().blit(destination_rect.location(), *bitmap, bitmap->rect(), opacity);
-        else
-            context.painter().draw_scaled_bitmap(destination_rect, *bitmap, bitmap->rect(), opacity, Gfx::Painter::ScalingMode::BilinearBlend);
+        context.painter().push_stacking_context(params);
+        paint_internal(context);
+        context.painter().pop_stacking_context();
     } else {
-        Gfx::PainterStateSaver saver(context.painter());
+        RecordingPainterStateSaver saver(context.painter());
         context.painter().translate(affine_transform.translation().to_rounded<int>());
         paint_internal(context);
     }
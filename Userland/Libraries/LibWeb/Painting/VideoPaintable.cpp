@@ -7,7 +7,6 @@
 #include <AK/Array.h>
 #include <AK/NumberFormat.h>
 #include <LibGUI/Event.h>
-#include <LibGfx/AntiAliasingPainter.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/HTML/HTMLMediaElement.h>
 #include <LibWeb/HTML/HTMLVideoElement.h>
@@ -263,7 +262,7 @@ DevicePixelRect VideoPaintable::paint_control_bar_timeline(PaintContext& context
     auto timeline_button_size = min(maximum_timeline_button_size, timeline_rect.height() / 2);
     auto timeline_button_offset_x = static_cast<DevicePixels>(round(playback_position));
 
-    Gfx::AntiAliasingPainter painter { context.painter() };
+    auto& painter = context.painter();
 
     auto playback_timelime_scrub_rect = timeline_rect;
     playback_timelime_scrub_rect.shrink(0, timeline_rect.height() - timeline_button_size / 2);
@@ -341,7 +340,7 @@ void VideoPaintable::paint_placeholder_video_controls(PaintContext& context, Dev
     auto playback_button_is_hovered = mouse_position.has_value() && control_box_rect.contains(*mouse_position);
     auto playback_button_color = control_button_color(playback_button_is_hovered);
 
-    Gfx::AntiAliasingPainter painter { context.painter() };
+    auto& painter = context.painter();
     painter.fill_ellipse(control_box_rect.to_type<int>(), control_box_color);
     context.painter().draw_triangle(playback_button_location.to_type<int>(), play_button_coordinates, playback_button_color);
 }
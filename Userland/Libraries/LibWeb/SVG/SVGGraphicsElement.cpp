@@ -42,7 +42,7 @@ void SVGGraphicsElement::parse_attribute(DeprecatedFlyString const& name, Deprec
     }
 }
 
-Optional<Gfx::PaintStyle const&> SVGGraphicsElement::fill_paint_style(SVGPaintContext const& paint_context) const
+Optional<NonnullRefPtr<Gfx::PaintStyle const>> SVGGraphicsElement::fill_paint_style(SVGPaintContext const& paint_context) const
 {
     // FIXME: This entire function is an ad-hoc hack:
     if (!layout_node())
@@ -31,19 +31,14 @@ void SVGLinearGradientElement::parse_attribute(DeprecatedFlyString const& name,
     SVGGradientElement::parse_attribute(name, value);
 
     // FIXME: Should allow for `<number-percentage> | <length>` for x1, x2, y1, y2
-    if (name == SVG::AttributeNames::x1) {
+    if (name == SVG::AttributeNames::x1)
         m_x1 = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::y1) {
+    else if (name == SVG::AttributeNames::y1)
         m_y1 = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::x2) {
+    else if (name == SVG::AttributeNames::x2)
         m_x2 = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::y2) {
+    else if (name == SVG::AttributeNames::y2)
         m_y2 = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    }
 }
 
 // https://www.w3.org/TR/SVG11/pservers.html#LinearGradientElementX1Attribute
@@ -90,7 +85,7 @@ NumberPercentage SVGLinearGradientElement::end_y() const
     return NumberPercentage::create_percentage(0);
 }
 
-Optional<Gfx::PaintStyle const&> SVGLinearGradientElement::to_gfx_paint_style(SVGPaintContext const& paint_context) const
+Optional<NonnullRefPtr<Gfx::PaintStyle const>> SVGLinearGradientElement::to_gfx_paint_style(SVGPaintContext const& paint_context) const
 {
     auto units = gradient_units();
     // FIXME: Resolve percentages properly
@@ -122,18 +117,13 @@ Optional<Gfx::PaintStyle const&> SVGLinearGradientElement::to_gfx_paint_style(SV
         };
     }
 
-    if (!m_paint_style) {
-        m_paint_style = Gfx::SVGLinearGradientPaintStyle::create(start_point, end_point)
-                            .release_value_but_fixme_should_propagate_errors();
-        // FIXME: Update stops in DOM changes:
-        add_color_stops(*m_paint_style);
-    } else {
-        m_paint_style->set_start_point(start_point);
-        m_paint_style->set_end_point(end_point);
-    }
-
-    m_paint_style->set_gradient_transform(gradient_paint_transform(paint_context));
-    return *m_paint_style;
+    // NOTE: A new paint style is created every time, as display lists keep the ones they were recorded with until they
+    //       are rasterized, possibly on another thread.
+    auto paint_style = Gfx::SVGLinearGradientPaintStyle::create(start_point, end_point)
+                           .release_value_but_fixme_should_propagate_errors();
+    add_color_stops(*paint_style);
+    paint_style->set_gradient_transform(gradient_paint_transform(paint_context));
+    return paint_style;
 }
 
 JS::NonnullGCPtr<SVGAnimatedLength> SVGLinearGradientElement::x1() const
@@ -29,25 +29,18 @@ void SVGRadialGradientElement::parse_attribute(DeprecatedFlyString const& name,
 
     // FIXME: These are <length> or <coordinate> in the spec, but all examples seem to allow percentages
     // and unitless values.
-    if (name == SVG::AttributeNames::cx) {
+    if (name == SVG::AttributeNames::cx)
         m_cx = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::cy) {
+    else if (name == SVG::AttributeNames::cy)
         m_cy = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::fx) {
+    else if (name == SVG::AttributeNames::fx)
         m_fx = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::fy) {
+    else if (name == SVG::AttributeNames::fy)
         m_fy = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::fr) {
+    else if (name == SVG::AttributeNames::fr)
         m_fr = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    } else if (name == SVG::AttributeNames::r) {
+    else if (name == SVG::AttributeNames::r)
         m_r = AttributeParser::parse_number_percentage(value);
-        m_paint_style = nullptr;
-    }
 }
 
 // https://svgwg.org/svg2-draft/pservers.html#RadialGradientElementFXAttribute
@@ -123,7 +116,7 @@ NumberPercentage SVGRadialGradientElement::end_circle_radius() const
     return NumberPercentage::create_percentage(50);
 }
 
-Optional<Gfx::PaintStyle const&> SVGRadialGradientElement::to_gfx_paint_style(SVGPaintContext const& paint_context) const
+Optional<NonnullRefPtr<Gfx::PaintStyle const>> SVGRadialGradientElement::to_gfx_paint_style(SVGPaintContext const& paint_context) const
 {
     auto units = gradient_units();
     Gfx::FloatPoint start_center;
@@ -164,19 +157,13 @@ Optional<Gfx::PaintStyle const&> SVGRadialGradientElement::to_gfx_paint_style(SV
         end_radius = end_circle_radius().resolve_relative_to(paint_context.viewport.width());
     }
 
-    if (!m_paint_style) {
-        m_paint_style = Gfx::SVGRadialGradientPaintStyle::create(start_center, start_radius, end_center, end_radius)
-                            .release_value_but_fixme_should_propagate_errors();
-        // FIXME: Update stops in DOM changes:
-        add_color_stops(*m_paint_style);
-    } else {
-        m_paint_style->set_start_center(start_center);
-        m_paint_style->set_start_radius(start_radius);
-        m_paint_style->set_end_center(end_center);
-        m_paint_style->set_end_radius(end_radius);
-    }
-    m_paint_style->set_gradient_transform(gradient_paint_transform(paint_context));
-    return *m_paint_style;
+    // NOTE: A new paint style is created every time, as display lists keep the ones they were recorded with until they
+    //       are rasterized, possibly on another thread.
+    auto paint_style = Gfx::SVGRadialGradientPaintStyle::create(start_center, start_radius, end_center, end_radius)
+                           .release_value_but_fixme_should_propagate_errors();
+    add_color_stops(*paint_style);
+    paint_style->set_gradient_transform(gradient_paint_transform(paint_context));
+    return paint_style;
 }
 
 JS::NonnullGCPtr<SVGAnimatedLength> SVGRadialGradientElement::cx() const
@@ -20,7 +20,7 @@ public:
 
     virtual void parse_attribute(DeprecatedFlyString const& name, DeprecatedString const& value) override;
 
-    virtual Optional<Gfx::PaintStyle const&> to_gfx_paint_style(SVGPaintContext const&) const override;
+    virtual Optional<NonnullRefPtr<Gfx::PaintStyle const>> to_gfx_paint_style(SVGPaintContext const&) const override;
 
     JS::NonnullGCPtr<SVGAnimatedLength> cx() const;
     JS::NonnullGCPtr<SVGAnimatedLength> cy() const;
@@ -55,8 +55,6 @@ private:
     Optional<NumberPercentage> m_fy;
     Optional<NumberPercentage> m_fr;
     Optional<NumberPercentage> m_r;
-
-    mutable RefPtr<Gfx::SVGRadialGradientPaintStyle> m_paint_style;
 };
 
 }
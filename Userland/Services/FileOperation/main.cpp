@@ -233,6 +233,28 @@ ErrorOr<int> execute_work_items(Vector<WorkItem> const& items)
             auto source_file = TRY(Core::File::open(source, Core::File::OpenMode::Read));
             // FIXME: When the file already exists, let the user choose the next action instead of renaming it by default.
             auto destination_file = TRY(open_destination_file(destination));
+
+            // Let the kernel copy the data if it can, so that it doesn't have to go through this process.
+            while (true) {
+                print_progress();
+                auto result = Core::System::copy_file_range(source_file->fd(), destination_file->fd(), 1 * MiB);
+                if (result.is_error()) {
+                    auto code = result.error().code();
+                    if (item_done != 0 || (code != EXDEV && code != EINVAL && code != ENOSYS && code != ENOTSUP)) {
+                        report_warning(DeprecatedString::formatted("Failed to copy to destination file: {}", result.error()));
+                        return result.release_error();
+                    }
+                    break;
+                }
+                if (result.value() == 0) {
+                    print_progress();
+                    return 0;
+                }
+                item_done += result.value();
+                executed_work_bytes += result.value();
+                sched_yield();
+            }
+
             auto buffer = TRY(ByteBuffer::create_zeroed(64 * KiB));
 
             while (true) {
@@ -72,4 +72,107 @@ Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_i
     return { is_animated, loop_count, bitmaps, durations };
 }
 
+Messages::ImageDecoderServer::StartDecodingImageResponse ConnectionFromClient::start_decoding_image(Optional<DeprecatedString> const& mime_type)
+{
+    auto image_id = m_next_image_id++;
+    auto image = make<StreamingImage>();
+    image->mime_type = mime_type;
+    m_streaming_images.set(image_id, move(image));
+    return image_id;
+}
+
+void ConnectionFromClient::append_encoded_data(i32 image_id, Core::AnonymousBuffer const& encoded_buffer)
+{
+    auto* image = m_streaming_images.get(image_id).value_or(nullptr);
+    if (!image || image->decoder || !encoded_buffer.is_valid()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Received encoded data for image {} that isn't being streamed", image_id);
+        return;
+    }
+
+    if (image->encoded_data.try_append(encoded_buffer.data<u8>(), encoded_buffer.size()).is_error()) {
+        fail_to_decode_image(image_id);
+        return;
+    }
+
+    // While the data is still arriving, the client is sent the size as soon as the header is in, so that it can make
+    // room for the image, and then as much of the first frame as can be decoded so far. That starts over from the
+    // beginning every time, so it is only tried again once the data has doubled, to keep this from getting quadratic.
+    if (image->encoded_data.size() < image->encoded_size_at_last_incomplete_decode * 2)
+        return;
+    image->encoded_size_at_last_incomplete_decode = image->encoded_data.size();
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_incomplete_bytes(image->encoded_data);
+    if (!decoder || decoder->size().is_empty())
+        return;
+    if (!image->did_send_size) {
+        image->did_send_size = true;
+        async_did_decode_image_size(image_id, decoder->size());
+    }
+
+    auto frame_or_error = decoder->incomplete_first_frame();
+    if (frame_or_error.is_error() || !frame_or_error.value().image)
+        return;
+    async_did_decode_incomplete_frame(image_id, frame_or_error.value().image->to_shareable_bitmap());
+}
+
+void ConnectionFromClient::finish_encoded_data(i32 image_id)
+{
+    auto* image = m_streaming_images.get(image_id).value_or(nullptr);
+    if (!image || image->decoder)
+        return;
+
+    image->decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(image->encoded_data, image->mime_type);
+    if (!image->decoder || !image->decoder->frame_count()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image {} from encoded data", image_id);
+        fail_to_decode_image(image_id);
+        return;
+    }
+
+    if (!image->did_send_size) {
+        image->did_send_size = true;
+        async_did_decode_image_size(image_id, image->decoder->size());
+    }
+    async_did_decode_image_details(image_id, image->decoder->is_animated(), image->decoder->loop_count(), image->decoder->frame_count());
+
+    // Every client starts out showing the first frame, so there's no need to wait for it to be asked for. Without it
+    // there is nothing to show at all.
+    auto first_frame_or_error = image->decoder->frame(0);
+    if (first_frame_or_error.is_error() || !first_frame_or_error.value().image) {
+        fail_to_decode_image(image_id);
+        return;
+    }
+    auto first_frame = first_frame_or_error.release_value();
+    async_did_decode_frame(image_id, 0, first_frame.image->to_shareable_bitmap(), first_frame.duration);
+}
+
+void ConnectionFromClient::decode_frame(i32 image_id, u32 frame_index)
+{
+    auto* image = m_streaming_images.get(image_id).value_or(nullptr);
+    if (!image || !image->decoder || frame_index >= image->decoder->frame_count()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Can't decode frame {} of image {}", frame_index, image_id);
+        return;
+    }
+
+    // The frames that came before are still fine, so only this one is given up on.
+    auto frame_or_error = image->decoder->frame(frame_index);
+    if (frame_or_error.is_error() || !frame_or_error.value().image) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode frame {} of image {}", frame_index, image_id);
+        async_did_fail_to_decode_frame(image_id, frame_index);
+        return;
+    }
+    auto frame = frame_or_error.release_value();
+    async_did_decode_frame(image_id, frame_index, frame.image->to_shareable_bitmap(), frame.duration);
+}
+
+void ConnectionFromClient::stop_decoding_image(i32 image_id)
+{
+    m_streaming_images.remove(image_id);
+}
+
+void ConnectionFromClient::fail_to_decode_image(i32 image_id)
+{
+    m_streaming_images.remove(image_id);
+    async_did_fail_to_decode_image(image_id);
+}
+
 }
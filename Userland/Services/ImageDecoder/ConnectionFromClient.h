@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/HashMap.h>
 #include <ImageDecoder/Forward.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
+#include <LibGfx/ImageFormats/ImageDecoder.h>
 #include <LibIPC/ConnectionFromClient.h>
 
 namespace ImageDecoder {
@@ -27,6 +29,28 @@ private:
     explicit ConnectionFromClient(NonnullOwnPtr<Core::LocalSocket>);
 
     virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Optional<DeprecatedString> const& mime_type) override;
+
+    virtual Messages::ImageDecoderServer::StartDecodingImageResponse start_decoding_image(Optional<DeprecatedString> const& mime_type) override;
+    virtual void append_encoded_data(i32 image_id, Core::AnonymousBuffer const&) override;
+    virtual void finish_encoded_data(i32 image_id) override;
+    virtual void decode_frame(i32 image_id, u32 frame_index) override;
+    virtual void stop_decoding_image(i32 image_id) override;
+
+    void fail_to_decode_image(i32 image_id);
+
+    // An image whose encoded data arrives a piece at a time, and whose frames are only decoded when the client asks
+    // for them, so that an animation never has to be held in memory all at once.
+    struct StreamingImage {
+        Optional<DeprecatedString> mime_type;
+        ByteBuffer encoded_data;
+        size_t encoded_size_at_last_incomplete_decode { 0 };
+        bool did_send_size { false };
+        // Only created once all of the encoded data has arrived.
+        RefPtr<Gfx::ImageDecoder> decoder;
+    };
+
+    HashMap<i32, NonnullOwnPtr<StreamingImage>> m_streaming_images;
+    i32 m_next_image_id { 0 };
 };
 
 }
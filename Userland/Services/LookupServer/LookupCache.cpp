@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "LookupCache.h"
+#include <AK/Debug.h>
+
+namespace LookupServer {
+
+// NOTE: How long we keep serving answers past their expiration while trying to refresh them, see RFC 8767.
+static constexpr time_t s_max_stale_time = 86400;
+// NOTE: The TTL we hand out along with stale answers, as recommended by RFC 8767 section 4.
+static constexpr u32 s_stale_answer_ttl = 30;
+// NOTE: Negative responses are cached for at most this long, as recommended by RFC 2308 section 5.
+static constexpr u32 s_max_negative_ttl = 3 * 3600;
+
+static time_t expiration_time(Answer const& answer)
+{
+    return answer.received_time() + answer.ttl();
+}
+
+LookupCache::~LookupCache()
+{
+    m_lru_list.clear();
+}
+
+Optional<LookupCache::Result> LookupCache::lookup(Name const& name, RecordType record_type)
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end())
+        return {};
+
+    auto& entry = *it->value;
+    auto now = time(nullptr);
+
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.expiration_time <= now; });
+    entry.answers.remove_all_matching([&](auto& answer) { return expiration_time(answer) + s_max_stale_time <= now; });
+    if (entry.answers.is_empty() && entry.negative_answers.is_empty()) {
+        remove_entry(entry);
+        return {};
+    }
+
+    touch(entry);
+
+    for (auto& negative_answer : entry.negative_answers) {
+        if (negative_answer.name_exists == NameExists::No || negative_answer.type == record_type) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Negative cache hit: {} ({})", name.as_string(), record_type);
+            return Result {};
+        }
+    }
+
+    Result result;
+    Vector<Answer> stale_answers;
+    for (auto& answer : entry.answers) {
+        if (answer.type() != record_type)
+            continue;
+        if (answer.has_expired()) {
+            stale_answers.empend(answer.name(), answer.type(), answer.class_code(), s_stale_answer_ttl, answer.record_data(), answer.mdns_cache_flush());
+            continue;
+        }
+        dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
+        // Ask for a refresh once an answer has less than a tenth of its original lifetime left.
+        if (expiration_time(answer) - now <= static_cast<time_t>(answer.ttl() / 10))
+            result.freshness = Freshness::NeedsPrefetch;
+        result.answers.append(answer);
+    }
+
+    if (!result.answers.is_empty())
+        return result;
+    if (stale_answers.is_empty())
+        return {};
+
+    dbgln_if(LOOKUPSERVER_DEBUG, "Serving {} stale answer(s) for {}", stale_answers.size(), name.as_string());
+    return Result { move(stale_answers), Freshness::Stale };
+}
+
+void LookupCache::put(Answer const& answer)
+{
+    if (answer.has_expired())
+        return;
+
+    auto& entry = ensure_entry(answer.name());
+
+    if (answer.mdns_cache_flush()) {
+        auto now = time(nullptr);
+
+        entry.answers.remove_all_matching([&](Answer const& other_answer) {
+            if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
+                return false;
+
+            if (other_answer.received_time() >= now - 1)
+                return false;
+
+            dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
+            return true;
+        });
+    }
+
+    // A fresh copy of a record we already know about replaces the old one.
+    entry.answers.remove_all_matching([&](Answer const& other_answer) {
+        return other_answer.type() == answer.type()
+            && other_answer.class_code() == answer.class_code()
+            && other_answer.record_data() == answer.record_data();
+    });
+
+    // Once expired, answers of this type are superseded by the new one, instead of being served as stale.
+    entry.answers.remove_all_matching([&](Answer const& other_answer) {
+        return other_answer.type() == answer.type() && other_answer.has_expired();
+    });
+
+    // The name (and this record type) clearly exists now.
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) {
+        return negative_answer.name_exists == NameExists::No || negative_answer.type == answer.type();
+    });
+
+    entry.answers.append(answer);
+}
+
+void LookupCache::put_negative(Name const& name, RecordType record_type, u32 ttl, NameExists name_exists)
+{
+    ttl = min(ttl, s_max_negative_ttl);
+    if (ttl == 0)
+        return;
+
+    auto& entry = ensure_entry(name);
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) {
+        return negative_answer.type == record_type && negative_answer.name_exists == name_exists;
+    });
+
+    // Any answers we still have for this name (or type) are now known to be outdated.
+    entry.answers.remove_all_matching([&](Answer const& answer) {
+        return name_exists == NameExists::No || answer.type() == record_type;
+    });
+
+    entry.negative_answers.append({ record_type, name_exists, time(nullptr) + ttl });
+}
+
+LookupCache::Entry& LookupCache::ensure_entry(Name const& name)
+{
+    if (auto it = m_entries.find(name); it != m_entries.end()) {
+        touch(*it->value);
+        return *it->value;
+    }
+
+    // Prevent the cache from growing too big by evicting the least recently used entry.
+    if (m_entries.size() >= m_max_entries) {
+        auto* least_recently_used = m_lru_list.last();
+        VERIFY(least_recently_used);
+        dbgln_if(LOOKUPSERVER_DEBUG, "Evicting cache entry: {}", least_recently_used->name);
+        remove_entry(*least_recently_used);
+    }
+
+    auto entry = make<Entry>();
+    entry->name = name;
+    auto& entry_ref = *entry;
+    m_lru_list.prepend(entry_ref);
+    m_entries.set(name, move(entry));
+    return entry_ref;
+}
+
+void LookupCache::touch(Entry& entry)
+{
+    m_lru_list.remove(entry);
+    m_lru_list.prepend(entry);
+}
+
+void LookupCache::remove_entry(Entry& entry)
+{
+    m_lru_list.remove(entry);
+    // NOTE: This destroys the entry, so we have to make a copy of its name first.
+    auto name = entry.name;
+    m_entries.remove(name);
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibDNS/Answer.h>
+#include <LibDNS/Name.h>
+#include <time.h>
+
+namespace LookupServer {
+
+using namespace DNS;
+
+// A bounded, least-recently-used cache of DNS answers that honors the TTL of each record,
+// caches negative responses (RFC 2308) and keeps expired answers around for a while so
+// that they can be served while being revalidated (RFC 8767).
+class LookupCache {
+public:
+    explicit LookupCache(size_t max_entries = 256)
+        : m_max_entries(max_entries)
+    {
+    }
+
+    ~LookupCache();
+
+    enum class Freshness {
+        Fresh,
+        // The answers are still valid, but are about to expire and should be refreshed.
+        NeedsPrefetch,
+        // The answers have expired and should be revalidated. They are returned with a short TTL.
+        Stale,
+    };
+
+    struct Result {
+        // Empty if the result is negative, i.e. the name or record type is known not to exist.
+        Vector<Answer> answers;
+        Freshness freshness { Freshness::Fresh };
+    };
+
+    Optional<Result> lookup(Name const&, RecordType);
+
+    void put(Answer const&);
+
+    enum class NameExists {
+        No,
+        Yes,
+    };
+    void put_negative(Name const&, RecordType, u32 ttl, NameExists);
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct NegativeAnswer {
+        RecordType type { 0 };
+        NameExists name_exists { NameExists::Yes };
+        time_t expiration_time { 0 };
+    };
+
+    struct Entry {
+        Name name;
+        Vector<Answer> answers;
+        Vector<NegativeAnswer> negative_answers;
+
+        IntrusiveListNode<Entry> list_node;
+        using List = IntrusiveList<&Entry::list_node>;
+    };
+
+    Entry& ensure_entry(Name const&);
+    void touch(Entry&);
+    void remove_entry(Entry&);
+
+    size_t m_max_entries { 0 };
+    HashMap<Name, NonnullOwnPtr<Entry>, Name::Traits> m_entries;
+    // Most recently used entries are at the front.
+    Entry::List m_lru_list;
+};
+
+}
@@ -9,13 +9,17 @@
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
-#include <AK/Random.h>
+#include <AK/IPv4Address.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/DeprecatedFile.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/System.h>
+#include <LibDNS/NameserverQuery.h>
 #include <LibDNS/Packet.h>
+#include <LibThreading/BackgroundAction.h>
 #include <limits.h>
+#include <netinet/in.h>
 #include <stdio.h>
 #include <time.h>
 #include <unistd.h>
@@ -169,172 +173,89 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
-        }
-        if (!answers.is_empty())
-            return answers;
-    }
-
-    // Fourth, look up .local names using mDNS instead of DNS nameservers.
-    if (name.as_string().ends_with(".local"sv)) {
-        answers = TRY(m_mdns->lookup(name, record_type));
-        for (auto& answer : answers)
-            put_in_cache(answer);
+    if (auto cached_answers = m_lookup_cache.lookup(name, record_type); cached_answers.has_value()) {
+        // NOTE: Answers that are stale or about to expire are served right away, and refreshed in the background.
+        if (cached_answers->freshness != LookupCache::Freshness::Fresh)
+            schedule_refresh(name, record_type);
+        for (auto& answer : cached_answers->answers)
+            add_answer(answer);
         return answers;
     }
 
-    // Fifth, ask the upstream nameservers.
-    for (auto& nameserver : m_nameservers) {
-        dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
-        bool did_get_response = false;
-        int retries = 3;
-        Vector<Answer> upstream_answers;
-        do {
-            auto upstream_answers_or_error = lookup(name, nameserver, did_get_response, record_type);
-            if (upstream_answers_or_error.is_error())
-                continue;
-            upstream_answers = upstream_answers_or_error.release_value();
-            if (did_get_response)
-                break;
-        } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers) {
-                add_answer(answer);
-                put_in_cache(answer);
-            }
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
-    }
-
-    // Sixth, fail.
-    if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
-        return Vector<Answer> {};
-    }
-
+    // Fourth, ask the network.
+    for (auto& answer : TRY(lookup_upstream(name, record_type)))
+        add_answer(answer);
     return answers;
 }
 
-ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+ErrorOr<Vector<Answer>> LookupServer::lookup_upstream(Name const& name, RecordType record_type)
 {
-    Packet request;
-    request.set_is_query();
-    request.set_id(get_random_uniform(UINT16_MAX));
-    Name name_in_question = name;
-    if (should_randomize_case == ShouldRandomizeCase::Yes)
-        name_in_question.randomize_case();
-    request.add_question({ name_in_question, record_type, RecordClass::IN, false });
-
-    auto buffer = TRY(request.to_byte_buffer());
-
-    auto udp_socket = TRY(Core::UDPSocket::connect(nameserver, 53, Time::from_seconds(1)));
-    TRY(udp_socket->set_blocking(true));
-
-    TRY(udp_socket->write_until_depleted(buffer));
-
-    u8 response_buffer[4096];
-    int nrecv = TRY(udp_socket->read_some({ response_buffer, sizeof(response_buffer) })).size();
-    if (udp_socket->is_eof())
-        return Vector<Answer> {};
-
-    did_get_response = true;
-
-    auto o_response = Packet::from_raw_packet(response_buffer, nrecv);
-    if (!o_response.has_value())
-        return Vector<Answer> {};
-
-    auto& response = o_response.value();
-
-    if (response.id() != request.id()) {
-        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
-        return Vector<Answer> {};
-    }
-
-    if (response.code() == Packet::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
-            // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
-        }
-        return Vector<Answer> {};
-    }
-
-    if (response.question_count() != request.question_count()) {
-        dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
-        return Vector<Answer> {};
-    }
-
-    // Verify the questions in our request and in their response match, ignoring case.
-    for (size_t i = 0; i < request.question_count(); ++i) {
-        auto& request_question = request.questions()[i];
-        auto& response_question = response.questions()[i];
-        bool match = request_question.class_code() == response_question.class_code()
-            && request_question.record_type() == response_question.record_type()
-            && request_question.name().as_string().equals_ignoring_ascii_case(response_question.name().as_string());
-        if (!match) {
-            dbgln("Request and response questions do not match");
-            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            return Vector<Answer> {};
-        }
-    }
-
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return Vector<Answer> {};
-    }
-
-    Vector<Answer, 8> answers;
-    for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
+    // Look up .local names using mDNS instead of DNS nameservers.
+    if (name.as_string().ends_with(".local"sv)) {
+        auto answers = TRY(m_mdns->lookup(name, record_type));
+        for (auto& answer : answers)
+            m_lookup_cache.put(answer);
+        return answers;
     }
 
-    return answers;
+    return lookup_using_nameservers(name, record_type);
 }
 
-void LookupServer::put_in_cache(Answer const& answer)
+void LookupServer::schedule_refresh(Name const& name, RecordType record_type)
 {
-    if (answer.has_expired())
+    auto is_same_refresh = [name, record_type](PendingRefresh const& refresh) {
+        return refresh.name == name && refresh.record_type == record_type;
+    };
+    if (m_pending_refreshes.first_matching(is_same_refresh).has_value())
         return;
+    m_pending_refreshes.append({ name, record_type });
 
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
+    // FIXME: mDNS lookups go through our multicast socket, which belongs to the main thread, so those still block the event loop.
+    if (name.as_string().ends_with(".local"sv)) {
+        deferred_invoke([this, name, record_type, is_same_refresh = move(is_same_refresh)] {
+            m_pending_refreshes.remove_first_matching(is_same_refresh);
+            if (auto result = lookup_upstream(name, record_type); result.is_error())
+                dbgln("LookupServer: Failed to refresh '{}': {}", name.as_string(), result.error());
+        });
+        return;
+    }
 
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
+    // NOTE: The nameservers are asked on a background thread, so the requests that keep coming in are answered from the cache
+    //       in the meantime. Only the cache update happens back on the main thread.
+    dbgln_if(LOOKUPSERVER_DEBUG, "Refreshing cache entry: {} ({})", name.as_string(), record_type);
+    (void)Threading::BackgroundAction<NameserverQueryResult>::construct(
+        [name, record_type, nameservers = m_nameservers](auto&) {
+            return query_nameservers(name, record_type, nameservers);
+        },
+        [this, name, record_type, is_same_refresh](NameserverQueryResult result) -> ErrorOr<void> {
+            m_pending_refreshes.remove_first_matching(is_same_refresh);
+            apply_nameserver_query_result(name, record_type, result);
+            return {};
+        },
+        [this, name, is_same_refresh](Error error) {
+            m_pending_refreshes.remove_first_matching(is_same_refresh);
+            dbgln("LookupServer: Failed to refresh '{}': {}", name.as_string(), error);
+        });
+}
 
-            it->value.remove_all_matching([&](Answer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
+void LookupServer::apply_nameserver_query_result(Name const& name, RecordType record_type, NameserverQueryResult const& result)
+{
+    for (auto& record : result.records)
+        m_lookup_cache.put(record);
 
-                if (other_answer.received_time() >= now - 1)
-                    return false;
+    if (!result.negative_ttl.has_value())
+        return;
+    if (result.outcome == NameserverQueryResult::Outcome::NameDoesNotExist)
+        m_lookup_cache.put_negative(name, record_type, result.negative_ttl.value(), LookupCache::NameExists::No);
+    else if (result.outcome == NameserverQueryResult::Outcome::NoAnswers)
+        m_lookup_cache.put_negative(name, record_type, result.negative_ttl.value(), LookupCache::NameExists::Yes);
+}
 
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
-    }
+ErrorOr<Vector<Answer>> LookupServer::lookup_using_nameservers(Name const& name, RecordType record_type)
+{
+    auto result = TRY(query_nameservers(name, record_type, m_nameservers));
+    apply_nameserver_query_result(name, record_type, result);
+    return move(result.answers);
 }
 
 }
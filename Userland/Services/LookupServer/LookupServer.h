@@ -8,10 +8,12 @@
 
 #include "ConnectionFromClient.h"
 #include "DNSServer.h"
+#include "LookupCache.h"
 #include "MulticastDNS.h"
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
 #include <LibDNS/Name.h>
+#include <LibDNS/NameserverQuery.h>
 #include <LibDNS/Packet.h>
 #include <LibIPC/MultiServer.h>
 
@@ -30,9 +32,16 @@ private:
     LookupServer();
 
     void load_etc_hosts();
-    void put_in_cache(Answer const&);
 
-    ErrorOr<Vector<Answer>> lookup(Name const& hostname, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    ErrorOr<Vector<Answer>> lookup_upstream(Name const&, RecordType);
+    ErrorOr<Vector<Answer>> lookup_using_nameservers(Name const&, RecordType);
+    void schedule_refresh(Name const&, RecordType);
+    void apply_nameserver_query_result(Name const&, RecordType, NameserverQueryResult const&);
+
+    struct PendingRefresh {
+        Name name;
+        RecordType record_type;
+    };
 
     OwnPtr<IPC::MultiServer<ConnectionFromClient>> m_server;
     RefPtr<DNSServer> m_dns_server;
@@ -40,7 +49,8 @@ private:
     Vector<DeprecatedString> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<Name, Vector<Answer>, Name::Traits> m_etc_hosts;
-    HashMap<Name, Vector<Answer>, Name::Traits> m_lookup_cache;
+    LookupCache m_lookup_cache;
+    Vector<PendingRefresh> m_pending_refreshes;
 };
 
 }
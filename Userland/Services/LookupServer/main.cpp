@@ -12,11 +12,11 @@
 
 ErrorOr<int> serenity_main(Main::Arguments)
 {
-    TRY(Core::System::pledge("stdio accept unix inet rpath"));
+    TRY(Core::System::pledge("stdio accept unix inet rpath thread"));
     Core::EventLoop event_loop;
     auto server = TRY(LookupServer::LookupServer::try_create());
 
-    TRY(Core::System::pledge("stdio accept inet rpath"));
+    TRY(Core::System::pledge("stdio accept inet rpath thread"));
     TRY(Core::System::unveil("/sys/kernel/net/adapters", "r"));
     TRY(Core::System::unveil("/etc/hosts", "r"));
     TRY(Core::System::unveil(nullptr, nullptr));
@@ -17,6 +17,7 @@
 #include <LibJS/Console.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/ConsoleObject.h>
+#include <LibThreading/BackgroundAction.h>
 #include <LibWeb/Bindings/MainThreadVM.h>
 #include <LibWeb/CSS/StyleComputer.h>
 #include <LibWeb/DOM/Document.h>
@@ -37,6 +38,7 @@
 #include <WebContent/PageHost.h>
 #include <WebContent/WebContentClientEndpoint.h>
 #include <pthread.h>
+#include <unistd.h>
 
 namespace WebContent {
 
@@ -46,6 +48,24 @@ ConnectionFromClient::ConnectionFromClient(NonnullOwnPtr<Core::LocalSocket> sock
 {
     m_paint_flush_timer = Web::Platform::Timer::create_single_shot(0, [this] { flush_pending_paint_requests(); });
     m_input_event_queue_timer = Web::Platform::Timer::create_single_shot(0, [this] { process_next_input_event(); });
+    create_tile_rasterizer_threads();
+}
+
+void ConnectionFromClient::create_tile_rasterizer_threads()
+{
+    // There are only so many tiles to rasterize in a frame, so there is no point in having a thread for every processor of a large machine.
+    static constexpr long max_tile_rasterizer_thread_count = 7;
+
+    // The thread that paint requests are rasterized on takes its share of the tiles as well.
+    auto thread_count = min(sysconf(_SC_NPROCESSORS_ONLN) - 1, max_tile_rasterizer_thread_count);
+    for (long i = 0; i < thread_count; ++i) {
+        auto thread = Threading::WorkerThread<Error>::create("Tile Rasterizer"sv);
+        if (thread.is_error()) {
+            dbgln("Failed to create tile rasterizer thread: {}", thread.error());
+            return;
+        }
+        m_tile_rasterizer_threads.append(thread.release_value());
+    }
 }
 
 void ConnectionFromClient::die()
@@ -161,11 +181,56 @@ void ConnectionFromClient::paint(Gfx::IntRect const& content_rect, i32 backing_s
 
 void ConnectionFromClient::flush_pending_paint_requests()
 {
-    for (auto& pending_paint : m_pending_paint_requests) {
-        m_page_host->paint(pending_paint.content_rect.to_type<Web::DevicePixels>(), *pending_paint.bitmap);
-        async_did_paint(pending_paint.content_rect, pending_paint.bitmap_id);
+    if (!m_should_rasterize_on_background_thread) {
+        for (auto& pending_paint : m_pending_paint_requests) {
+            m_page_host->paint(pending_paint.content_rect.to_type<Web::DevicePixels>(), *pending_paint.bitmap);
+            async_did_paint(pending_paint.content_rect, pending_paint.bitmap_id);
+        }
+        m_pending_paint_requests.clear();
+        return;
     }
-    m_pending_paint_requests.clear();
+
+    // The remaining requests are flushed once the one being rasterized is done.
+    if (m_paint_request_being_rasterized.has_value() || m_pending_paint_requests.is_empty())
+        return;
+
+    auto paint_request = m_pending_paint_requests.take_first();
+    auto content_rect = paint_request.content_rect.to_type<Web::DevicePixels>();
+    auto tiled_paint = make<PageHost::TiledPaint>(m_page_host->prepare_tiled_paint(content_rect));
+
+    // The tiles, their display list and the bitmap are kept alive by us until rasterization is done, so that none of
+    // them is ever destroyed on the background thread.
+    auto& bitmap = *paint_request.bitmap;
+    m_paint_request_being_rasterized = move(paint_request);
+    m_tiled_paint_being_rasterized = move(tiled_paint);
+
+    (void)Threading::BackgroundAction<Empty>::construct(
+        [&tiled_paint = *m_tiled_paint_being_rasterized, &bitmap, &tile_rasterizer_threads = m_tile_rasterizer_threads](auto&) -> ErrorOr<Empty> {
+            TRY(tiled_paint.rasterize_missing_tiles(tile_rasterizer_threads.span()));
+            tiled_paint.blit_tiles_into(bitmap);
+            return Empty {};
+        },
+        [this, strong_this = NonnullRefPtr(*this)](auto) -> ErrorOr<void> {
+            did_finish_rasterizing();
+            return {};
+        },
+        [this, strong_this = NonnullRefPtr(*this)](Error error) {
+            dbgln("Failed to rasterize display list: {}", error);
+            did_finish_rasterizing();
+        });
+}
+
+void ConnectionFromClient::did_finish_rasterizing()
+{
+    auto paint_request = m_paint_request_being_rasterized.release_value();
+    m_page_host->add_rasterized_tiles(*m_tiled_paint_being_rasterized);
+    m_tiled_paint_being_rasterized = nullptr;
+
+    if (is_open())
+        async_did_paint(paint_request.content_rect, paint_request.bitmap_id);
+
+    if (!m_pending_paint_requests.is_empty())
+        m_paint_flush_timer->start();
 }
 
 void ConnectionFromClient::process_next_input_event()
@@ -378,6 +443,10 @@ void ConnectionFromClient::debug_request(DeprecatedString const& request, Deprec
         page().top_level_browsing_context().set_needs_display(page().top_level_browsing_context().viewport_rect());
     }
 
+    if (request == "set-rasterize-on-background-thread") {
+        m_should_rasterize_on_background_thread = argument == "on";
+    }
+
     if (request == "clear-cache") {
         Web::ResourceLoader::the().clear_cache();
     }
@@ -13,11 +13,13 @@
 #include <LibIPC/ConnectionFromClient.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/Handle.h>
+#include <LibThreading/WorkerThread.h>
 #include <LibWeb/CSS/PreferredColorScheme.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/FileRequest.h>
 #include <LibWeb/Platform/Timer.h>
 #include <WebContent/Forward.h>
+#include <WebContent/PageHost.h>
 #include <WebContent/WebContentClientEndpoint.h>
 #include <WebContent/WebContentConsoleClient.h>
 #include <WebContent/WebContentServerEndpoint.h>
@@ -103,7 +105,9 @@ private:
     virtual Messages::WebContentServer::GetSelectedTextResponse get_selected_text() override;
     virtual void select_all() override;
 
+    void create_tile_rasterizer_threads();
     void flush_pending_paint_requests();
+    void did_finish_rasterizing();
 
     void report_finished_handling_input_event(bool event_was_handled);
 
@@ -116,6 +120,14 @@ private:
     Vector<PaintRequest> m_pending_paint_requests;
     RefPtr<Web::Platform::Timer> m_paint_flush_timer;
 
+    // Paint requests are put together from cached tiles on a background thread, one at a time, and the tiles that are
+    // missing are rasterized there and on the tile rasterizer threads. Otherwise, every paint request walks the
+    // paintable tree again and is rasterized right away as a whole.
+    bool m_should_rasterize_on_background_thread { true };
+    Optional<PaintRequest> m_paint_request_being_rasterized;
+    OwnPtr<PageHost::TiledPaint> m_tiled_paint_being_rasterized;
+    Vector<NonnullOwnPtr<Threading::WorkerThread<Error>>> m_tile_rasterizer_threads;
+
     HashMap<i32, NonnullRefPtr<Gfx::Bitmap>> m_backing_stores;
 
     WeakPtr<JS::Realm> m_realm;
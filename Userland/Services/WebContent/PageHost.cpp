@@ -7,9 +7,12 @@
 
 #include "PageHost.h"
 #include "ConnectionFromClient.h"
+#include <AK/AnyOf.h>
+#include <AK/Atomic.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/ShareableBitmap.h>
 #include <LibGfx/SystemTheme.h>
+#include <LibThreading/WorkerThread.h>
 #include <LibWeb/Cookie/ParsedCookie.h>
 #include <LibWeb/HTML/BrowsingContext.h>
 #include <LibWeb/Layout/Viewport.h>
@@ -36,6 +39,7 @@ PageHost::~PageHost() = default;
 void PageHost::set_has_focus(bool has_focus)
 {
     m_has_focus = has_focus;
+    discard_painted_content();
 }
 
 void PageHost::setup_palette()
@@ -63,6 +67,7 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    discard_painted_content();
     if (auto* document = page().top_level_browsing_context().active_document())
         document->invalidate_style();
 }
@@ -118,37 +123,195 @@ Gfx::Color PageHost::background_color() const
 
 void PageHost::paint(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& target)
 {
-    Gfx::Painter painter(target);
-    Gfx::IntRect bitmap_rect { {}, content_rect.size().to_type<int>() };
+    // This always walks the paintable tree again, as it is used for screenshots and painting without reuse.
+    if (auto* document = page().top_level_browsing_context().active_document())
+        document->update_layout();
+
+    record_new_display_list(content_rect)->rasterize(content_rect, target);
+}
+
+static bool paints_independently_of_scroll_position(Web::Layout::Viewport& layout_root)
+{
+    bool is_independent = true;
+    layout_root.for_each_in_inclusive_subtree_of_type<Web::Layout::Box>([&](auto& box) {
+        auto is_attached_to_viewport = box.is_fixed_position() || any_of(box.computed_values().background_layers(), [](auto& layer) {
+            return layer.attachment == Web::CSS::BackgroundAttachment::Fixed;
+        });
+        if (is_attached_to_viewport) {
+            is_independent = false;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return is_independent;
+}
 
+NonnullRefPtr<PageHost::DisplayList> PageHost::record_display_list(Web::DevicePixelRect const& content_rect)
+{
     if (auto* document = page().top_level_browsing_context().active_document())
         document->update_layout();
 
-    auto background_color = this->background_color();
+    auto is_scrolling = false;
+    if (m_display_list) {
+        if (m_display_list->recorded_rect() == content_rect)
+            return *m_display_list;
+        if (m_display_list->m_is_independent_of_scroll_position && m_display_list->recorded_rect().contains(content_rect))
+            return *m_display_list;
+        // Nothing was invalidated since the previous display list was recorded, so the page is most likely being scrolled.
+        is_scrolling = m_display_list->m_is_independent_of_scroll_position;
+    }
 
-    if (background_color.alpha() < 255)
-        painter.clear_rect(bitmap_rect, palette().base());
-    painter.fill_rect(bitmap_rect, background_color);
+    // While the page is being scrolled, record a viewport's worth of content above and below as well,
+    // so that the following frames can be rasterized from the same display list.
+    auto recorded_rect = content_rect;
+    if (is_scrolling)
+        recorded_rect.inflate(0, content_rect.height() * 2);
 
-    auto* layout_root = this->layout_root();
-    if (!layout_root) {
-        return;
+    m_display_list = record_new_display_list(recorded_rect);
+    m_tiles_are_independent_of_scroll_position = m_display_list->m_is_independent_of_scroll_position;
+    return *m_display_list;
+}
+
+PageHost::TiledPaint PageHost::prepare_tiled_paint(Web::DevicePixelRect const& content_rect)
+{
+    // Updating the layout may invalidate tiles, so it has to happen before any of them are looked up.
+    if (auto* document = page().top_level_browsing_context().active_document())
+        document->update_layout();
+
+    TiledPaint tiled_paint;
+    tiled_paint.content_rect = content_rect;
+
+    Web::DevicePixelRect missing_tiles_rect;
+    for (auto index : TileCache::indices_of_tiles_intersecting(content_rect)) {
+        if (auto bitmap = m_tile_cache.find(index)) {
+            tiled_paint.cached_tiles.append({ index, bitmap.release_nonnull() });
+            continue;
+        }
+        tiled_paint.missing_tile_indices.append(index);
+        missing_tiles_rect = missing_tiles_rect.united(TileCache::rect_of_tile(index));
     }
 
-    Web::PaintContext context(painter, palette(), device_pixels_per_css_pixel());
+    if (!tiled_paint.missing_tile_indices.is_empty())
+        tiled_paint.display_list = record_display_list(missing_tiles_rect);
+    tiled_paint.tile_cache_generation = m_tile_cache.generation();
+    return tiled_paint;
+}
+
+void PageHost::add_rasterized_tiles(TiledPaint const& tiled_paint)
+{
+    for (auto const& tile : tiled_paint.rasterized_tiles)
+        m_tile_cache.add(tile, tiled_paint.tile_cache_generation);
+    m_tile_cache.evict_tiles_far_from(tiled_paint.content_rect);
+}
+
+void PageHost::discard_painted_content()
+{
+    m_display_list = nullptr;
+    m_tile_cache.clear();
+}
+
+ErrorOr<void> PageHost::TiledPaint::rasterize_missing_tiles(Span<NonnullOwnPtr<Threading::WorkerThread<Error>>> worker_threads)
+{
+    if (missing_tile_indices.is_empty())
+        return {};
+    VERIFY(display_list);
+
+    Vector<RefPtr<Gfx::Bitmap>> bitmaps;
+    TRY(bitmaps.try_resize(missing_tile_indices.size()));
+
+    // Tiles are handed out one at a time, as some parts of a page take much longer to rasterize than others.
+    Atomic<size_t> next_tile_to_rasterize { 0 };
+    auto rasterize_tiles = [&]() -> ErrorOr<void> {
+        while (true) {
+            auto i = next_tile_to_rasterize.fetch_add(1);
+            if (i >= missing_tile_indices.size())
+                return {};
+            auto tile_rect = TileCache::rect_of_tile(missing_tile_indices[i]);
+            auto bitmap = TRY(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, tile_rect.size().to_type<int>()));
+            display_list->rasterize(tile_rect, *bitmap);
+            bitmaps[i] = move(bitmap);
+        }
+    };
+
+    auto helper_count = min(worker_threads.size(), missing_tile_indices.size() - 1);
+    for (size_t i = 0; i < helper_count; ++i) {
+        auto did_start = worker_threads[i]->start_task([&] { return rasterize_tiles(); });
+        VERIFY(did_start);
+    }
+
+    auto result = rasterize_tiles();
+    for (size_t i = 0; i < helper_count; ++i) {
+        auto task_result = worker_threads[i]->wait_until_task_is_finished();
+        if (!result.is_error() && task_result.is_error())
+            result = task_result.release_error();
+    }
+    TRY(result);
+
+    TRY(rasterized_tiles.try_ensure_capacity(missing_tile_indices.size()));
+    for (size_t i = 0; i < missing_tile_indices.size(); ++i)
+        rasterized_tiles.unchecked_append({ missing_tile_indices[i], bitmaps[i].release_nonnull() });
+    return {};
+}
+
+void PageHost::TiledPaint::blit_tiles_into(Gfx::Bitmap& target) const
+{
+    Gfx::Painter painter(target);
+    painter.add_clip_rect({ {}, content_rect.size().to_type<int>() });
+
+    auto blit_tile = [&](TileCache::Tile const& tile) {
+        auto position = TileCache::rect_of_tile(tile.index).location() - content_rect.location();
+        painter.blit(position.to_type<int>(), *tile.bitmap, tile.bitmap->rect());
+    };
+    for (auto const& tile : cached_tiles)
+        blit_tile(tile);
+    for (auto const& tile : rasterized_tiles)
+        blit_tile(tile);
+}
+
+NonnullRefPtr<PageHost::DisplayList> PageHost::record_new_display_list(Web::DevicePixelRect const& recorded_rect)
+{
+    auto display_list = adopt_ref(*new DisplayList(recorded_rect, background_color(), palette().base()));
+
+    auto* layout_root = this->layout_root();
+    if (!layout_root)
+        return display_list;
+
+    Web::PaintContext context(display_list->recording_painter(), palette(), device_pixels_per_css_pixel());
     context.set_should_show_line_box_borders(m_should_show_line_box_borders);
-    context.set_device_viewport_rect(content_rect);
+    context.set_device_viewport_rect(recorded_rect);
     context.set_has_focus(m_has_focus);
     layout_root->paint_all_phases(context);
+
+    display_list->m_is_independent_of_scroll_position = paints_independently_of_scroll_position(*layout_root);
+    return display_list;
+}
+
+void PageHost::DisplayList::rasterize(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& target) const
+{
+    Gfx::Painter painter(target);
+    Gfx::IntRect bitmap_rect { {}, content_rect.size().to_type<int>() };
+
+    if (m_background_color.alpha() < 255)
+        painter.clear_rect(bitmap_rect, m_base_color);
+    painter.fill_rect(bitmap_rect, m_background_color);
+
+    painter.add_clip_rect(bitmap_rect);
+    painter.translate((m_recorded_rect.location() - content_rect.location()).to_type<int>());
+    m_recording_painter.execute(painter);
 }
 
 void PageHost::set_viewport_rect(Web::DevicePixelRect const& rect)
 {
-    page().top_level_browsing_context().set_viewport_rect(page().device_to_css_rect(rect));
+    auto viewport_rect = page().device_to_css_rect(rect);
+    if (!m_tiles_are_independent_of_scroll_position && viewport_rect.location() != page().top_level_browsing_context().viewport_rect().location())
+        m_tile_cache.clear();
+    page().top_level_browsing_context().set_viewport_rect(viewport_rect);
 }
 
 void PageHost::page_did_invalidate(Web::CSSPixelRect const& content_rect)
 {
+    m_display_list = nullptr;
+    m_tile_cache.invalidate(page().enclosing_device_rect(content_rect));
     m_invalidation_rect = m_invalidation_rect.united(page().enclosing_device_rect(content_rect));
     if (!m_invalidation_coalescing_timer->is_active())
         m_invalidation_coalescing_timer->start();
@@ -166,6 +329,9 @@ void PageHost::page_did_request_cursor_change(Gfx::StandardCursor cursor)
 
 void PageHost::page_did_layout()
 {
+    // Layout may have moved anything on the page, not just what is in the viewport, and LibWeb doesn't tell us what
+    // moved. So unlike with invalidations, none of the tiles can be kept.
+    discard_painted_content();
     auto* layout_root = this->layout_root();
     VERIFY(layout_root);
     if (layout_root->paintable_box()->has_overflow())
@@ -7,10 +7,14 @@
 
 #pragma once
 
+#include <AK/RefCounted.h>
 #include <LibGfx/Rect.h>
+#include <LibThreading/Forward.h>
 #include <LibWeb/Page/Page.h>
+#include <LibWeb/Painting/RecordingPainter.h>
 #include <LibWeb/PixelUnits.h>
 #include <WebContent/Forward.h>
+#include <WebContent/TileCache.h>
 
 namespace WebContent {
 
@@ -29,12 +33,72 @@ public:
 
     virtual void paint(Web::DevicePixelRect const& content_rect, Gfx::Bitmap&) override;
 
+    // A recording of everything painted for part of the page, which can be rasterized on any thread. The paintable
+    // tree is only walked while recording, so rasterizing the same display list again is cheap.
+    class DisplayList : public RefCounted<DisplayList> {
+    public:
+        // Rasterizes the part of the recording that is inside content_rect into the target, which must be at least as large.
+        void rasterize(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& target) const;
+
+        Web::DevicePixelRect const& recorded_rect() const { return m_recorded_rect; }
+        Web::Painting::RecordingPainter& recording_painter() { return m_recording_painter; }
+
+    private:
+        friend class PageHost;
+
+        DisplayList(Web::DevicePixelRect const& recorded_rect, Gfx::Color background_color, Gfx::Color base_color)
+            : m_recorded_rect(recorded_rect)
+            , m_recording_painter(recorded_rect.size().to_type<int>())
+            , m_background_color(background_color)
+            , m_base_color(base_color)
+        {
+        }
+
+        Web::DevicePixelRect m_recorded_rect;
+        Web::Painting::RecordingPainter m_recording_painter;
+        Gfx::Color m_background_color;
+        Gfx::Color m_base_color;
+        // Whether the recording looks the same wherever the viewport is, so that it can be reused after scrolling.
+        bool m_is_independent_of_scroll_position { false };
+    };
+
+    // Returns a display list that covers content_rect, which is the previous one if nothing was invalidated since it was recorded.
+    NonnullRefPtr<DisplayList> record_display_list(Web::DevicePixelRect const& content_rect);
+
+    // The tiles that make up content_rect: the ones that were found in the tile cache, and a display list to rasterize
+    // the missing ones from. Nothing but the tiles and the display list is touched once it has been prepared, so the
+    // rest of the work can be done on any thread.
+    struct TiledPaint {
+        // Rasterizes the missing tiles, sharing them out between the calling thread and the worker threads.
+        ErrorOr<void> rasterize_missing_tiles(Span<NonnullOwnPtr<Threading::WorkerThread<Error>>> worker_threads);
+        void blit_tiles_into(Gfx::Bitmap& target) const;
+
+        Web::DevicePixelRect content_rect;
+        Vector<TileCache::Tile> cached_tiles;
+        Vector<Gfx::IntPoint> missing_tile_indices;
+        Vector<TileCache::Tile> rasterized_tiles;
+        RefPtr<DisplayList> display_list;
+        u64 tile_cache_generation { 0 };
+    };
+
+    TiledPaint prepare_tiled_paint(Web::DevicePixelRect const& content_rect);
+    // Adds the tiles that were rasterized for a TiledPaint to the tile cache, unless they were invalidated in the meantime.
+    void add_rasterized_tiles(TiledPaint const&);
+
     void set_palette_impl(Gfx::PaletteImpl&);
     void set_viewport_rect(Web::DevicePixelRect const&);
     void set_screen_rects(Vector<Gfx::IntRect, 4> const& rects, size_t main_screen_index) { m_screen_rect = rects[main_screen_index].to_type<Web::DevicePixels>(); }
-    void set_device_pixels_per_css_pixel(float device_pixels_per_css_pixel) { m_device_pixels_per_css_pixel = device_pixels_per_css_pixel; }
+    void set_device_pixels_per_css_pixel(float device_pixels_per_css_pixel)
+    {
+        m_device_pixels_per_css_pixel = device_pixels_per_css_pixel;
+        discard_painted_content();
+    }
     void set_preferred_color_scheme(Web::CSS::PreferredColorScheme);
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool b)
+    {
+        m_should_show_line_box_borders = b;
+        discard_painted_content();
+    }
     void set_has_focus(bool);
     void set_is_scripting_enabled(bool);
     void set_window_position(Web::DevicePixelPoint);
@@ -108,6 +172,8 @@ private:
     explicit PageHost(ConnectionFromClient&);
 
     Web::Layout::Viewport* layout_root();
+    NonnullRefPtr<DisplayList> record_new_display_list(Web::DevicePixelRect const& recorded_rect);
+    void discard_painted_content();
     void setup_palette();
 
     ConnectionFromClient& m_client;
@@ -119,6 +185,11 @@ private:
     bool m_should_show_line_box_borders { false };
     bool m_has_focus { false };
 
+    RefPtr<DisplayList> m_display_list;
+    TileCache m_tile_cache;
+    // Tiles of pages with content that is attached to the viewport are only valid for the scroll position they were rasterized at.
+    bool m_tiles_are_independent_of_scroll_position { false };
+
     RefPtr<Web::Platform::Timer> m_invalidation_coalescing_timer;
     Web::DevicePixelRect m_invalidation_rect;
     Web::CSS::PreferredColorScheme m_preferred_color_scheme { Web::CSS::PreferredColorScheme::Auto };
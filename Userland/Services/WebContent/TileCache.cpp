@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <WebContent/TileCache.h>
+
+namespace WebContent {
+
+static int tile_index_of(int coordinate)
+{
+    // Round towards negative infinity, so that the tiles left of and above the origin don't overlap the first one.
+    return coordinate >= 0 ? coordinate / TileCache::tile_size : -((-coordinate - 1) / TileCache::tile_size) - 1;
+}
+
+Web::DevicePixelRect TileCache::rect_of_tile(Gfx::IntPoint index)
+{
+    return { index.x() * tile_size, index.y() * tile_size, tile_size, tile_size };
+}
+
+Vector<Gfx::IntPoint> TileCache::indices_of_tiles_intersecting(Web::DevicePixelRect const& rect)
+{
+    Vector<Gfx::IntPoint> indices;
+    if (rect.is_empty())
+        return indices;
+
+    auto first_column = tile_index_of(rect.left().value());
+    auto last_column = tile_index_of(rect.right().value());
+    auto first_row = tile_index_of(rect.top().value());
+    auto last_row = tile_index_of(rect.bottom().value());
+
+    indices.ensure_capacity((last_column - first_column + 1) * (last_row - first_row + 1));
+    for (auto row = first_row; row <= last_row; ++row) {
+        for (auto column = first_column; column <= last_column; ++column)
+            indices.unchecked_append({ column, row });
+    }
+    return indices;
+}
+
+RefPtr<Gfx::Bitmap> TileCache::find(Gfx::IntPoint index) const
+{
+    auto it = m_tiles.find(index);
+    if (it == m_tiles.end())
+        return nullptr;
+    return it->value;
+}
+
+void TileCache::add(Tile tile, u64 generation)
+{
+    if (generation < m_oldest_checkable_generation)
+        return;
+
+    auto tile_rect = rect_of_tile(tile.index);
+    for (auto const& invalidation : m_invalidations) {
+        if (invalidation.generation > generation && invalidation.rect.intersects(tile_rect))
+            return;
+    }
+    m_tiles.set(tile.index, move(tile.bitmap));
+}
+
+void TileCache::invalidate(Web::DevicePixelRect const& rect)
+{
+    ++m_generation;
+    for (auto index : indices_of_tiles_intersecting(rect))
+        m_tiles.remove(index);
+
+    if (m_invalidations.size() == max_remembered_invalidations)
+        m_oldest_checkable_generation = m_invalidations.take_first().generation;
+    m_invalidations.append({ m_generation, rect });
+}
+
+void TileCache::clear()
+{
+    ++m_generation;
+    m_tiles.clear();
+    m_invalidations.clear();
+    m_oldest_checkable_generation = m_generation;
+}
+
+void TileCache::evict_tiles_far_from(Web::DevicePixelRect const& rect)
+{
+    // Keep a viewport's worth of tiles around in each direction, which covers scrolling back and forth.
+    auto rect_to_keep = rect.inflated(rect.width() * 2, rect.height() * 2);
+    m_tiles.remove_all_matching([&](auto index, auto&) {
+        return !rect_of_tile(index).intersects(rect_to_keep);
+    });
+}
+
+}
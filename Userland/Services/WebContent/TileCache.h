@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Point.h>
+#include <LibWeb/PixelUnits.h>
+
+namespace WebContent {
+
+// Rasterized parts of the page that are kept across frames, so that only what was invalidated has to be rasterized
+// again. The document is divided into a grid of square tiles, which are addressed by their position in that grid.
+class TileCache {
+public:
+    static constexpr int tile_size = 256;
+
+    struct Tile {
+        Gfx::IntPoint index;
+        NonnullRefPtr<Gfx::Bitmap> bitmap;
+    };
+
+    static Web::DevicePixelRect rect_of_tile(Gfx::IntPoint index);
+    static Vector<Gfx::IntPoint> indices_of_tiles_intersecting(Web::DevicePixelRect const&);
+
+    RefPtr<Gfx::Bitmap> find(Gfx::IntPoint index) const;
+
+    // The generation changes whenever tiles are invalidated. A tile that was rasterized from a display list recorded
+    // during an earlier generation is only added if nothing that was invalidated since then overlaps it.
+    u64 generation() const { return m_generation; }
+    void add(Tile, u64 generation);
+
+    void invalidate(Web::DevicePixelRect const&);
+    void clear();
+
+    // Drops the tiles that are far enough away from rect that they are unlikely to be painted again soon.
+    void evict_tiles_far_from(Web::DevicePixelRect const& rect);
+
+    size_t tile_count() const { return m_tiles.size(); }
+
+private:
+    // Only this many of the most recent invalidations are remembered. Tiles from before the oldest of them can't be
+    // checked against what was invalidated since, so they are not added at all.
+    static constexpr size_t max_remembered_invalidations = 64;
+
+    struct Invalidation {
+        u64 generation { 0 };
+        Web::DevicePixelRect rect;
+    };
+
+    HashMap<Gfx::IntPoint, NonnullRefPtr<Gfx::Bitmap>> m_tiles;
+    Vector<Invalidation> m_invalidations;
+    u64 m_generation { 0 };
+    u64 m_oldest_checkable_generation { 0 };
+};
+
+}
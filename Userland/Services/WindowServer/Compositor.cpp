@@ -18,12 +18,14 @@
 #include <AK/Memory.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TemporaryChange.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/Timer.h>
 #include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/Font/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibThreading/BackgroundAction.h>
+#include <unistd.h>
 
 namespace WindowServer {
 
@@ -69,9 +71,27 @@ Compositor::Compositor()
                                     .release_value_but_fixme_should_propagate_errors();
     m_compose_timer->start();
 
+    create_compose_threads();
     init_bitmaps();
 }
 
+void Compositor::create_compose_threads()
+{
+    // Copying window contents is bound by memory bandwidth, which a few threads already use up.
+    static constexpr long max_compose_thread_count = 3;
+
+    // The WindowServer thread blits a band of its own while the compose threads do theirs.
+    auto thread_count = min(sysconf(_SC_NPROCESSORS_ONLN) - 1, max_compose_thread_count);
+    for (long i = 0; i < thread_count; ++i) {
+        auto thread = Threading::WorkerThread<Error>::create("Compositor"sv);
+        if (thread.is_error()) {
+            dbgln("Failed to create compositor thread: {}", thread.error());
+            return;
+        }
+        m_compose_threads.append(thread.release_value());
+    }
+}
+
 Gfx::Bitmap const* Compositor::cursor_bitmap_for_screenshot(Badge<ConnectionFromClient>, Screen& screen) const
 {
     if (!m_current_cursor)
@@ -182,6 +202,10 @@ void Compositor::compose()
         return;
     }
 
+    // The coarse clock ticks too slowly to tell most frames apart.
+    Core::ElapsedTimer compose_timer { true };
+    compose_timer.start();
+
     if (m_occlusions_dirty) {
         m_occlusions_dirty = false;
         recompute_occlusions();
@@ -194,8 +218,15 @@ void Compositor::compose()
 
     bool window_stack_transition_in_progress = m_transitioning_to_window_stack != nullptr;
 
+    // A window that is entirely covered by opaque windows above it has no area left to render into.
+    auto is_fully_occluded = [](Window& window) {
+        return window.opaque_rects().is_empty() && window.transparency_rects().is_empty() && window.transparency_wallpaper_rects().is_empty();
+    };
+
     // Mark window regions as dirty that need to be re-rendered
     wm.for_each_visible_window_from_back_to_front([&](Window& window) {
+        if (is_fully_occluded(window))
+            return IterationDecision::Continue;
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect();
         auto frame_rect_on_screen = frame_rect.translated(transition_offset);
@@ -368,6 +399,8 @@ void Compositor::compose()
             // This window doesn't intersect with any screens, so there's nothing to render
             return IterationDecision::Continue;
         }
+        if (is_fully_occluded(window))
+            return IterationDecision::Continue;
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect().translated(transition_offset);
         auto window_rect = window.rect().translated(transition_offset);
@@ -376,7 +409,7 @@ void Compositor::compose()
         dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
 
         RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
+        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect, bool rect_is_opaque) {
             if (!window.is_fullscreen()) {
                 rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
                     Gfx::PainterStateSaver saver(painter);
@@ -459,6 +492,9 @@ void Compositor::compose()
                             return color;
                         });
                     }
+                } else if (rect_is_opaque && !m_compose_threads.is_empty()) {
+                    // The destination lies within the rect, which the painter is already clipped to.
+                    m_opaque_blits.append({ &screen, dst, *backing_store, dirty_rect_in_backing_coordinates });
                 } else {
                     painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
                 }
@@ -493,7 +529,7 @@ void Compositor::compose()
                     auto& back_painter = *screen->compositor_screen_data().m_back_painter;
                     Gfx::PainterStateSaver saver(back_painter);
                     back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    compose_window_rect(*screen, back_painter, screen_render_rect, true);
                 }
                 return IterationDecision::Continue;
             });
@@ -532,7 +568,7 @@ void Compositor::compose()
                     auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
                     Gfx::PainterStateSaver saver(temp_painter);
                     temp_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, temp_painter, screen_render_rect);
+                    compose_window_rect(*screen, temp_painter, screen_render_rect, false);
                 }
                 return IterationDecision::Continue;
             });
@@ -576,6 +612,8 @@ void Compositor::compose()
             return is_overlapping;
         }());
 
+        blit_opaque_windows_in_bands();
+
         if (!m_overlay_list.is_empty()) {
             // Render everything to the temporary buffer before we copy it back
             render_overlays();
@@ -617,6 +655,75 @@ void Compositor::compose()
         flush(screen);
         return IterationDecision::Continue;
     });
+
+    auto compose_microseconds = static_cast<u32>(min(compose_timer.elapsed_time().to_microseconds(), NumericLimits<u32>::max()));
+    ++m_frame_times.frame_count;
+    m_frame_times.total_microseconds += compose_microseconds;
+    m_frame_times.last_microseconds = compose_microseconds;
+    m_frame_times.max_microseconds = max(m_frame_times.max_microseconds, compose_microseconds);
+}
+
+void Compositor::blit_opaque_windows_in_bands()
+{
+    if (m_opaque_blits.is_empty())
+        return;
+
+    // Handing a band to another thread costs more than blitting a few small dirty rects, so those stay on this thread.
+    static constexpr int min_band_pixel_count = 128 * KiB;
+
+    struct Band {
+        Screen& screen;
+        Gfx::IntRect rect;
+        NonnullOwnPtr<Gfx::Painter> painter;
+    };
+    Vector<Band> bands;
+
+    // Painters reference their target bitmap, so they are created (and destroyed) on this thread only.
+    auto band_count_per_screen = static_cast<int>(m_compose_threads.size() + 1);
+    Screen::for_each([&](auto& screen) {
+        Gfx::IntRect blitted_rect;
+        for (auto& blit : m_opaque_blits) {
+            if (blit.screen == &screen)
+                blitted_rect = blitted_rect.united({ blit.position, blit.source_rect.size() });
+        }
+        if (blitted_rect.is_empty())
+            return IterationDecision::Continue;
+
+        auto band_height = max(ceil_div(blitted_rect.height(), band_count_per_screen), ceil_div(min_band_pixel_count, blitted_rect.width()));
+        for (int y = blitted_rect.y(); y < blitted_rect.y() + blitted_rect.height(); y += band_height) {
+            Gfx::IntRect band_rect { blitted_rect.x(), y, blitted_rect.width(), min(band_height, blitted_rect.y() + blitted_rect.height() - y) };
+            auto painter = make<Gfx::Painter>(*screen.compositor_screen_data().m_back_bitmap);
+            painter->translate(-screen.rect().location());
+            painter->add_clip_rect(band_rect);
+            bands.append({ screen, band_rect, move(painter) });
+        }
+        return IterationDecision::Continue;
+    });
+
+    Atomic<size_t> next_band_to_blit { 0 };
+    auto blit_bands = [&]() -> ErrorOr<void> {
+        while (true) {
+            auto i = next_band_to_blit.fetch_add(1);
+            if (i >= bands.size())
+                return {};
+            auto& band = bands[i];
+            for (auto& blit : m_opaque_blits) {
+                if (blit.screen == &band.screen && band.rect.intersects({ blit.position, blit.source_rect.size() }))
+                    band.painter->blit(blit.position, *blit.source, blit.source_rect);
+            }
+        }
+    };
+
+    auto helper_count = min(m_compose_threads.size(), bands.size() - 1);
+    for (size_t i = 0; i < helper_count; ++i) {
+        auto did_start = m_compose_threads[i]->start_task([&] { return blit_bands(); });
+        VERIFY(did_start);
+    }
+    MUST(blit_bands());
+    for (size_t i = 0; i < helper_count; ++i)
+        MUST(m_compose_threads[i]->wait_until_task_is_finished());
+
+    m_opaque_blits.clear_with_capacity();
 }
 
 void Compositor::flush(Screen& screen)
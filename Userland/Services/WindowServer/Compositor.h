@@ -8,10 +8,12 @@
 
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Font/Font.h>
+#include <LibThreading/WorkerThread.h>
 #include <WindowServer/Overlays.h>
 
 namespace WindowServer {
@@ -25,6 +27,14 @@ class Window;
 class WindowManager;
 class WindowStack;
 
+// How long composing frames has taken, for measuring the compositor from the outside.
+struct CompositorFrameTimes {
+    u64 frame_count { 0 };
+    u64 total_microseconds { 0 };
+    u32 last_microseconds { 0 };
+    u32 max_microseconds { 0 };
+};
+
 enum class WallpaperMode {
     Tile,
     Center,
@@ -183,6 +193,7 @@ public:
     void unregister_animation(Badge<Animation>, Animation&);
 
     void set_flash_flush(bool b) { m_flash_flush = b; }
+    CompositorFrameTimes const& frame_times() const { return m_frame_times; }
 
     static NonnullOwnPtr<CompositorScreenData> create_screen_data(Badge<Screen>)
     {
@@ -205,6 +216,8 @@ private:
     void recompute_occlusions();
     void change_cursor(Cursor const*);
     void flush(Screen&);
+    void create_compose_threads();
+    void blit_opaque_windows_in_bands();
     Gfx::IntPoint window_transition_offset(Window&);
     void update_animations(Screen&, Gfx::DisjointIntRectSet& flush_rects);
     void create_window_stack_switch_overlay(WindowStack&);
@@ -224,6 +237,18 @@ private:
     bool m_overlay_rects_changed { false };
     bool m_animations_running { false };
 
+    // Backing store blits into opaque window areas don't overlap anything else painted into the back buffer
+    // before the overlays, so they are collected while walking the window stack and done in bands afterwards.
+    struct OpaqueBlit {
+        Screen* screen { nullptr };
+        Gfx::IntPoint position;
+        NonnullRefPtr<Gfx::Bitmap const> source;
+        Gfx::IntRect source_rect;
+    };
+    Vector<OpaqueBlit> m_opaque_blits;
+    Vector<NonnullOwnPtr<Threading::WorkerThread<Error>>> m_compose_threads;
+    CompositorFrameTimes m_frame_times;
+
     IntrusiveList<&Overlay::m_list_node> m_overlay_list;
     Gfx::DisjointIntRectSet m_overlay_rects;
     Gfx::DisjointIntRectSet m_last_rendered_overlay_rects;
@@ -1336,6 +1336,12 @@ void ConnectionFromClient::set_flash_flush(bool enabled)
     Compositor::the().set_flash_flush(enabled);
 }
 
+Messages::WindowServer::GetCompositorFrameTimesResponse ConnectionFromClient::get_compositor_frame_times()
+{
+    auto const& frame_times = Compositor::the().frame_times();
+    return { frame_times.frame_count, frame_times.total_microseconds, frame_times.last_microseconds, frame_times.max_microseconds };
+}
+
 void ConnectionFromClient::set_window_parent_from_client(i32 client_id, i32 parent_id, i32 child_id)
 {
     auto* child_window = window_from_id(child_id);
@@ -10,9 +10,9 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
+#include <LibCore/DirectoryEntry.h>
 #include <LibCore/File.h>
-#include <LibCore/System.h>
+#include <LibFileSystem/DirectoryWalker.h>
 #include <LibMain/Main.h>
 #include <limits.h>
 #include <string.h>
@@ -34,10 +34,11 @@ struct DuOption {
     Vector<DeprecatedString> excluded_patterns;
     u64 block_size = 1024;
     size_t max_depth = SIZE_MAX;
+    size_t thread_count = 1;
 };
 
 static ErrorOr<void> parse_args(Main::Arguments arguments, Vector<DeprecatedString>& files, DuOption& du_option);
-static ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_option, size_t current_depth, bool inside_dir = false);
+static ErrorOr<void> print_space_usage(DeprecatedString const& path, DuOption const& du_option);
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -47,7 +48,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(parse_args(arguments, files, du_option));
 
     for (auto const& file : files)
-        TRY(print_space_usage(file, du_option, 0));
+        TRY(print_space_usage(file, du_option));
 
     return 0;
 }
@@ -106,6 +107,7 @@ ErrorOr<void> parse_args(Main::Arguments arguments, Vector<DeprecatedString>& fi
     args_parser.add_option(exclude_from, "Exclude files that match any pattern in file", "exclude-from", 'X', "file");
     args_parser.add_option(du_option.block_size, "Outputs file sizes as the required blocks with the given size (defaults to 1024)", "block-size", 'B', "size");
     args_parser.add_option(move(block_size_1k_option));
+    args_parser.add_option(du_option.thread_count, "Read this many directories at once", "threads", 0, "count");
     args_parser.add_positional_argument(files_to_process, "File to process", "file", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -134,29 +136,19 @@ ErrorOr<void> parse_args(Main::Arguments arguments, Vector<DeprecatedString>& fi
     return {};
 }
 
-ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_option, size_t current_depth, bool inside_dir)
+// Prints the usage of a single entry, given the total size of everything inside of it.
+static u64 print_entry_usage(FileSystem::DirectoryWalker::Entry const& entry, u64 size, DuOption const& du_option)
 {
-    u64 size = 0;
-    struct stat path_stat = TRY(Core::System::lstat(path));
-    bool const is_directory = S_ISDIR(path_stat.st_mode);
-    if (is_directory) {
-        auto di = Core::DirIterator(path, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error()) {
-            auto error = di.error();
-            outln("du: cannot read directory '{}': {}", path, error);
-            return error;
-        }
-
-        while (di.has_next()) {
-            auto const child_path = di.next_full_path();
-            size += TRY(print_space_usage(child_path, du_option, current_depth + 1, true));
-        }
-    }
+    auto const& path = entry.path;
+    auto const& path_stat = entry.stat.value();
+    auto const current_depth = entry.depth;
+    bool const is_directory = entry.type == Core::DirectoryEntry::Type::Directory;
+    bool const inside_dir = current_depth > 0;
 
     auto const basename = LexicalPath::basename(path);
     for (auto const& pattern : du_option.excluded_patterns) {
         if (basename.matches(pattern, CaseSensitivity::CaseSensitive))
-            return { 0 };
+            return 0;
     }
 
     if (!du_option.apparent_size) {
@@ -201,5 +193,48 @@ ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_
         outln("\t{}\t{}", formatted_time, path);
     }
 
-    return { size };
+    return size;
+}
+
+ErrorOr<void> print_space_usage(DeprecatedString const& path, DuOption const& du_option)
+{
+    // A directory is only printed once everything inside of it has been counted. The walk is depth-first, so these
+    // are the directories leading up to the current entry.
+    struct OpenDirectory {
+        FileSystem::DirectoryWalker::Entry entry;
+        u64 size { 0 };
+    };
+    Vector<OpenDirectory> open_directories;
+
+    auto finish_entry = [&](FileSystem::DirectoryWalker::Entry const& entry, u64 size) {
+        size = print_entry_usage(entry, size, du_option);
+        if (!open_directories.is_empty())
+            open_directories.last().size += size;
+    };
+
+    auto finish_directories_down_to_depth = [&](size_t depth) {
+        while (!open_directories.is_empty() && open_directories.last().entry.depth >= depth) {
+            auto directory = open_directories.take_last();
+            finish_entry(directory.entry, directory.size);
+        }
+    };
+
+    FileSystem::DirectoryWalker walker;
+    walker.set_thread_count(du_option.thread_count);
+    walker.set_stat_entries(FileSystem::DirectoryWalker::StatEntries::Always);
+    walker.on_entry = [&](auto const& entry) -> ErrorOr<void> {
+        finish_directories_down_to_depth(entry.depth);
+        if (entry.type == Core::DirectoryEntry::Type::Directory)
+            return open_directories.try_append({ entry, 0 });
+        finish_entry(entry, 0);
+        return {};
+    };
+    walker.on_error = [](auto const& path, Error error) -> ErrorOr<void> {
+        outln("du: cannot read '{}': {}", path, error);
+        return error;
+    };
+
+    TRY(walker.walk(path));
+    finish_directories_down_to_depth(0);
+    return {};
 }
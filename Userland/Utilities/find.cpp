@@ -10,11 +10,10 @@
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/Vector.h>
-#include <LibCore/System.h>
+#include <LibCore/DirectoryEntry.h>
+#include <LibFileSystem/DirectoryWalker.h>
 #include <LibMain/Main.h>
-#include <dirent.h>
 #include <errno.h>
-#include <fcntl.h>
 #include <grp.h>
 #include <pwd.h>
 #include <stdio.h>
@@ -41,49 +40,28 @@ template<typename... Parameters>
 struct FileData {
     // Full path to the file; either absolute or relative to cwd.
     LexicalPath full_path;
-    // The parent directory of the file.
-    int dirfd { -1 };
-    // The file's basename, relative to the directory.
-    char const* basename { nullptr };
-    // Optionally, cached information as returned by stat/lstat/fstatat.
+    // Optionally, cached information as returned by stat/lstat.
     struct stat stat {
     };
     bool stat_is_valid : 1 { false };
-    // File type as returned from readdir(), or DT_UNKNOWN.
-    unsigned char d_type { DT_UNKNOWN };
+    // File type as returned from readdir(), or Unknown.
+    Core::DirectoryEntry::Type type { Core::DirectoryEntry::Type::Unknown };
 
     const struct stat* ensure_stat()
     {
         if (stat_is_valid)
             return &stat;
 
-        int flags = g_follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW;
-        int rc = fstatat(dirfd, basename, &stat, flags);
+        auto path = full_path.string().characters();
+        int rc = g_follow_symlinks ? ::stat(path, &stat) : ::lstat(path, &stat);
         if (rc < 0) {
-            perror(full_path.string().characters());
+            perror(path);
             g_there_was_an_error = true;
             return nullptr;
         }
 
         stat_is_valid = true;
-
-        if (S_ISREG(stat.st_mode))
-            d_type = DT_REG;
-        else if (S_ISDIR(stat.st_mode))
-            d_type = DT_DIR;
-        else if (S_ISCHR(stat.st_mode))
-            d_type = DT_CHR;
-        else if (S_ISBLK(stat.st_mode))
-            d_type = DT_BLK;
-        else if (S_ISFIFO(stat.st_mode))
-            d_type = DT_FIFO;
-        else if (S_ISLNK(stat.st_mode))
-            d_type = DT_LNK;
-        else if (S_ISSOCK(stat.st_mode))
-            d_type = DT_SOCK;
-        else
-            VERIFY_NOT_REACHED();
-
+        type = Core::DirectoryEntry::type_from_stat_mode(stat.st_mode);
         return &stat;
     }
 };
@@ -123,27 +101,28 @@ private:
     {
         // First, make sure we have a type, but avoid calling
         // sys$stat() unless we need to.
-        if (file_data.d_type == DT_UNKNOWN) {
+        if (file_data.type == Core::DirectoryEntry::Type::Unknown) {
             if (file_data.ensure_stat() == nullptr)
                 return false;
         }
 
-        auto type = file_data.d_type;
+        using Type = Core::DirectoryEntry::Type;
+        auto type = file_data.type;
         switch (m_type) {
         case 'b':
-            return type == DT_BLK;
+            return type == Type::BlockDevice;
         case 'c':
-            return type == DT_CHR;
+            return type == Type::CharacterDevice;
         case 'd':
-            return type == DT_DIR;
+            return type == Type::Directory;
         case 'l':
-            return type == DT_LNK;
+            return type == Type::SymbolicLink;
         case 'p':
-            return type == DT_FIFO;
+            return type == Type::NamedPipe;
         case 'f':
-            return type == DT_REG;
+            return type == Type::File;
         case 's':
-            return type == DT_SOCK;
+            return type == Type::Socket;
         default:
             // We've verified this is a correct character before.
             VERIFY_NOT_REACHED();
@@ -488,69 +467,6 @@ static NonnullOwnPtr<Command> parse_all_commands(Vector<char*>& args)
     return make<AndCommand>(command.release_nonnull(), make<PrintCommand>());
 }
 
-static void walk_tree(FileData& root_data, Command& command)
-{
-    command.evaluate(root_data);
-
-    // We should try to read directory entries if either:
-    // * This is a directory.
-    // * This is a symlink (that could point to a directory),
-    //   and we're following symlinks.
-    // * The type is unknown, so it could be a directory.
-    switch (root_data.d_type) {
-    case DT_DIR:
-    case DT_UNKNOWN:
-        break;
-    case DT_LNK:
-        if (g_follow_symlinks)
-            break;
-        return;
-    default:
-        return;
-    }
-
-    int dirfd = openat(root_data.dirfd, root_data.basename, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
-    if (dirfd < 0) {
-        if (errno == ENOTDIR) {
-            // Above we decided to try to open this file because it could
-            // be a directory, but turns out it's not. This is fine though.
-            return;
-        }
-        perror(root_data.full_path.string().characters());
-        g_there_was_an_error = true;
-        return;
-    }
-
-    DIR* dir = fdopendir(dirfd);
-
-    while (true) {
-        errno = 0;
-        auto* dirent = readdir(dir);
-        if (!dirent)
-            break;
-
-        if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0)
-            continue;
-
-        FileData file_data {
-            root_data.full_path.append({ dirent->d_name, strlen(dirent->d_name) }),
-            dirfd,
-            dirent->d_name,
-            (struct stat) {},
-            false,
-            dirent->d_type,
-        };
-        walk_tree(file_data, command);
-    }
-
-    if (errno != 0) {
-        perror(root_data.full_path.string().characters());
-        g_there_was_an_error = true;
-    }
-
-    closedir(dir);
-}
-
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     Vector<char*> args;
@@ -558,12 +474,24 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     OwnPtr<Command> command;
     Vector<LexicalPath> paths;
+    size_t thread_count = 1;
+    bool unordered = false;
 
     while (!args.is_empty()) {
         char* raw_arg = args.take_first();
         StringView arg { raw_arg, strlen(raw_arg) };
         if (arg == "-L") {
             g_follow_symlinks = true;
+        } else if (arg == "--threads") {
+            if (args.is_empty())
+                fatal_error("--threads: requires additional arguments");
+            auto count = StringView { args.first(), strlen(args.first()) }.to_uint();
+            if (!count.has_value() || count.value() == 0)
+                fatal_error("Invalid thread count: \033[1m{}", args.first());
+            thread_count = count.value();
+            args.take_first();
+        } else if (arg == "--unordered") {
+            unordered = true;
         } else if (!arg.starts_with('-')) {
             paths.append(LexicalPath(arg));
         } else {
@@ -579,23 +507,28 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (paths.is_empty())
         paths.append(LexicalPath("."));
 
-    for (auto& path : paths) {
-        DeprecatedString dirname = path.dirname();
-        DeprecatedString basename = path.basename();
-
-        int dirfd = TRY(Core::System::open(dirname, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
-
-        FileData file_data {
-            path,
-            dirfd,
-            basename.characters(),
-            (struct stat) {},
-            false,
-            DT_UNKNOWN,
-        };
-        walk_tree(file_data, *command);
-        close(dirfd);
-    }
+    FileSystem::DirectoryWalker walker;
+    walker.set_thread_count(thread_count);
+    walker.set_order(unordered ? FileSystem::DirectoryWalker::Order::Unordered : FileSystem::DirectoryWalker::Order::DepthFirst);
+    walker.set_follow_symlinks(g_follow_symlinks ? FileSystem::DirectoryWalker::FollowSymlinks::Yes : FileSystem::DirectoryWalker::FollowSymlinks::No);
+    walker.on_entry = [&](auto const& entry) -> ErrorOr<void> {
+        FileData file_data { LexicalPath(entry.path) };
+        file_data.type = entry.type;
+        if (entry.stat.has_value()) {
+            file_data.stat = entry.stat.value();
+            file_data.stat_is_valid = true;
+        }
+        command->evaluate(file_data);
+        return {};
+    };
+    walker.on_error = [](auto const& path, Error error) -> ErrorOr<void> {
+        warnln("{}: {}", path, strerror(error.code()));
+        g_there_was_an_error = true;
+        return {};
+    };
+
+    for (auto& path : paths)
+        TRY(walker.walk(path.string()));
 
     return g_there_was_an_error ? 1 : 0;
 }
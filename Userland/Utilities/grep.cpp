@@ -13,11 +13,17 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
-#include <LibFileSystem/FileSystem.h>
+#include <LibFileSystem/DirectoryWalker.h>
 #include <LibMain/Main.h>
 #include <LibRegex/Regex.h>
+#include <LibRegex/RegexPrefilter.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 enum class BinaryFileMode {
@@ -50,34 +56,449 @@ static DeprecatedString escape_characters(StringView string, StringView characte
     return builder.to_deprecated_string();
 }
 
+struct Settings {
+    Vector<DeprecatedString> patterns;
+    Vector<DeprecatedString> files;
+    bool recursive { false };
+    bool fixed_strings { false };
+    BinaryFileMode binary_mode { BinaryFileMode::Binary };
+    bool case_insensitive { false };
+    bool line_numbers { false };
+    bool invert_match { false };
+    bool quiet_mode { false };
+    bool suppress_errors { false };
+    bool colored_output { false };
+    bool count_lines { false };
+    size_t thread_count { 1 };
+};
+
+// Output is collected in a buffer, which is written out whenever it grows past this size.
+static constexpr size_t output_flush_threshold = 64 * KiB;
+
+static size_t count_line_breaks(StringView text)
+{
+    size_t count = 0;
+    auto const* characters = text.characters_without_null_termination();
+    auto const* end = characters + text.length();
+    while (auto const* line_break = static_cast<char const*>(memchr(characters, '\n', end - characters))) {
+        ++count;
+        characters = line_break + 1;
+    }
+    return count;
+}
+
+// Finds the lines that match any of the regular expressions. A regular expression can't be used by multiple threads at once,
+// so every thread needs its own Searcher.
+template<typename Parser>
+class Searcher {
+public:
+    struct Result {
+        bool matched { false };
+        size_t matched_line_count { 0 };
+    };
+
+    using FlushOutput = Function<void(StringBuilder&)>;
+
+    Searcher(Vector<Regex<Parser>> regular_expressions, Settings const& settings)
+        : m_regular_expressions(move(regular_expressions))
+        , m_settings(settings)
+    {
+        // If every match of each regular expression contains some literal, lines that contain none of them can't match and are
+        // skipped without even looking for their line breaks.
+        if (settings.invert_match || settings.case_insensitive)
+            return;
+        for (auto& re : m_regular_expressions) {
+            auto prefilter = regex::LiteralPrefilter::try_create(re.parser_result.bytecode);
+            if (!prefilter.has_value()) {
+                m_literals.clear();
+                return;
+            }
+            m_literals.append(prefilter.release_value());
+        }
+    }
+
+    // Returns whether the line is selected, and appends what should be printed for it to the output.
+    bool search_line(StringView line, StringView filename, size_t line_number, bool print_filename, bool is_binary, Result& result, StringBuilder& output)
+    {
+        size_t last_printed_char_pos { 0 };
+        if (is_binary && m_settings.binary_mode == BinaryFileMode::Skip)
+            return false;
+
+        for (auto& re : m_regular_expressions) {
+            auto regex_result = re.match(line, PosixFlags::Global);
+            if (!(regex_result.success ^ m_settings.invert_match))
+                continue;
+
+            result.matched = true;
+            if (m_settings.quiet_mode)
+                return true;
+
+            if (m_settings.count_lines) {
+                result.matched_line_count++;
+                return true;
+            }
+
+            auto colored_output = m_settings.colored_output;
+            if (is_binary && m_settings.binary_mode == BinaryFileMode::Binary) {
+                output.appendff(colored_output ? "binary file \x1B[34m{}\x1B[0m matches\n"sv : "binary file {} matches\n"sv, filename);
+            } else {
+                if ((regex_result.matches.size() || m_settings.invert_match) && print_filename)
+                    output.appendff(colored_output ? "\x1B[34m{}:\x1B[0m"sv : "{}:"sv, filename);
+                if ((regex_result.matches.size() || m_settings.invert_match) && m_settings.line_numbers)
+                    output.appendff(colored_output ? "\x1B[35m{}:\x1B[0m"sv : "{}:"sv, line_number);
+
+                for (auto& match : regex_result.matches) {
+                    auto pre_match_length = match.global_offset - last_printed_char_pos;
+                    output.appendff(colored_output ? "{}\x1B[32m{}\x1B[0m"sv : "{}{}"sv,
+                        line.substring_view(last_printed_char_pos, pre_match_length),
+                        match.view.string_view());
+                    last_printed_char_pos = match.global_offset + match.view.length();
+                }
+                output.append(line.substring_view(last_printed_char_pos));
+                output.append('\n');
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // Searches the contents of a whole file at once. If there are literals to look for, line breaks are only searched for around them.
+    Result search_text(StringView text, StringView filename, bool print_filename, StringBuilder& output, FlushOutput const& flush_output)
+    {
+        Result result;
+
+        // Where each literal occurs next, which is only looked for again once the search has moved past it.
+        Vector<size_t> next_literal_positions;
+        auto find_literals = [&](size_t position) -> Optional<size_t> {
+            Optional<size_t> first_position;
+            for (size_t i = 0; i < m_literals.size(); ++i) {
+                if (i == next_literal_positions.size() || next_literal_positions[i] < position) {
+                    auto offset = regex::find_literal(text.bytes().slice(position), m_literals[i].literal());
+                    auto next_position = offset.has_value() ? position + *offset : NumericLimits<size_t>::max();
+                    if (i == next_literal_positions.size())
+                        next_literal_positions.append(next_position);
+                    else
+                        next_literal_positions[i] = next_position;
+                }
+                if (next_literal_positions[i] != NumericLimits<size_t>::max())
+                    first_position = min(first_position.value_or(NumericLimits<size_t>::max()), next_literal_positions[i]);
+            }
+            return first_position;
+        };
+
+        size_t position = 0;
+        size_t line_number = 1;
+        while (position < text.length()) {
+            if (!m_literals.is_empty()) {
+                auto literal_position = find_literals(position);
+                if (!literal_position.has_value())
+                    break;
+
+                auto line_start = *literal_position;
+                while (line_start > position && text[line_start - 1] != '\n')
+                    --line_start;
+                if (m_settings.line_numbers)
+                    line_number += count_line_breaks(text.substring_view(position, line_start - position));
+                position = line_start;
+            }
+
+            auto const* line_break = static_cast<char const*>(memchr(text.characters_without_null_termination() + position, '\n', text.length() - position));
+            auto line_end = line_break ? static_cast<size_t>(line_break - text.characters_without_null_termination()) : text.length();
+            auto line = text.substring_view(position, line_end - position);
+            auto is_binary = line.contains('\0');
+
+            auto matched = search_line(line, filename, line_number, print_filename, is_binary, result, output);
+            if (matched && is_binary && m_settings.binary_mode == BinaryFileMode::Binary)
+                break;
+            if (flush_output && output.length() >= output_flush_threshold)
+                flush_output(output);
+
+            position = line_end + 1;
+            ++line_number;
+        }
+
+        return result;
+    }
+
+    ErrorOr<Result> search_stream(Core::InputBufferedFile& file, StringView filename, bool print_filename, StringBuilder& output, FlushOutput const& flush_output)
+    {
+        Result result;
+        for (size_t line_number = 1; TRY(file.can_read_line()); ++line_number) {
+            Array<u8, PAGE_SIZE> buffer;
+            auto line = TRY(file.read_line(buffer));
+
+            auto is_binary = line.contains('\0');
+
+            auto matched = search_line(line, filename, line_number, print_filename, is_binary, result, output);
+            if (matched && is_binary && m_settings.binary_mode == BinaryFileMode::Binary)
+                break;
+            if (flush_output && output.length() >= output_flush_threshold)
+                flush_output(output);
+        }
+        return result;
+    }
+
+    ErrorOr<Result> search_file(StringView filename, bool print_filename, StringBuilder& output, FlushOutput const& flush_output)
+    {
+        auto file = TRY(Core::File::open(filename, Core::File::OpenMode::Read));
+        auto stat = TRY(Core::System::fstat(file->fd()));
+
+        // Files in /proc and /sys have contents despite their size of 0, so only regular files with a size are mapped.
+        RefPtr<Core::MappedFile> mapped_file;
+        if (S_ISREG(stat.st_mode) && stat.st_size != 0) {
+            auto mapped_file_or_error = Core::MappedFile::map_from_fd_and_close(TRY(Core::System::dup(file->fd())), filename);
+            if (!mapped_file_or_error.is_error())
+                mapped_file = mapped_file_or_error.release_value();
+        }
+
+        Result result;
+        if (mapped_file) {
+            result = search_text(StringView { mapped_file->bytes() }, filename, print_filename, output, flush_output);
+        } else {
+            // Other files, like pipes, are read as the lines come in.
+            auto buffered_file = TRY(Core::InputBufferedFile::create(move(file)));
+            result = TRY(search_stream(*buffered_file, filename, print_filename, output, flush_output));
+        }
+
+        if (m_settings.count_lines && !m_settings.quiet_mode) {
+            if (m_settings.files.size() >= 2)
+                output.appendff("{}:{}\n", filename, result.matched_line_count);
+            else
+                output.appendff("{}\n", result.matched_line_count);
+        }
+
+        return result;
+    }
+
+private:
+    Vector<Regex<Parser>> m_regular_expressions;
+    Vector<regex::LiteralPrefilter> m_literals;
+    Settings const& m_settings;
+};
+
+template<typename Parser>
+static Vector<Regex<Parser>> compile_patterns(Settings const& settings)
+{
+    PosixOptions options {};
+    if (settings.case_insensitive)
+        options |= PosixFlags::Insensitive;
+
+    auto special_characters = IsSame<Parser, PosixExtended> ? ere_special_characters : basic_special_characters;
+    Vector<Regex<Parser>> regular_expressions;
+    for (auto const& pattern : settings.patterns) {
+        auto escaped_pattern = settings.fixed_strings ? escape_characters(pattern, special_characters) : pattern;
+        regular_expressions.append(Regex<Parser>(escaped_pattern, options));
+    }
+    return regular_expressions;
+}
+
+static ErrorOr<void> collect_files(DeprecatedString const& root, bool user_has_specified_files, size_t thread_count, Vector<DeprecatedString>& files)
+{
+    FileSystem::DirectoryWalker walker;
+    walker.set_thread_count(thread_count);
+    walker.set_follow_symlinks(FileSystem::DirectoryWalker::FollowSymlinks::Yes);
+    walker.set_iterator_flags(Core::DirIterator::Flags::SkipDots);
+    walker.on_entry = [&](auto const& entry) -> ErrorOr<void> {
+        if (entry.type == Core::DirectoryEntry::Type::Directory)
+            return {};
+        return files.try_append(user_has_specified_files ? entry.path : entry.path.substring(root.length() + 1));
+    };
+    return walker.walk(root);
+}
+
+static void write_output(StringBuilder& output)
+{
+    out("{}", output.string_view());
+    output.clear();
+}
+
+// Searches the files on multiple threads, and prints the results of each file in order.
+template<typename Parser>
+static ErrorOr<bool> search_files_in_parallel(Vector<DeprecatedString> const& files, Settings const& settings)
+{
+    auto thread_count = min(settings.thread_count, files.size());
+    // The output of files is held back until all files before them have been printed, so don't get too far ahead.
+    auto max_files_in_flight = thread_count * 16;
+
+    struct FileResult {
+        StringBuilder output;
+        Optional<Error> error;
+        bool matched { false };
+    };
+
+    Threading::Mutex mutex;
+    Threading::ConditionVariable condition { mutex };
+    size_t next_file_to_search = 0;
+    size_t next_file_to_print = 0;
+    Vector<OwnPtr<FileResult>> results;
+    TRY(results.try_resize(files.size()));
+
+    auto search_files = [&](Searcher<Parser>& searcher) -> intptr_t {
+        while (true) {
+            size_t index;
+            {
+                Threading::MutexLocker locker(mutex);
+                while (next_file_to_search < files.size() && next_file_to_search >= next_file_to_print + max_files_in_flight)
+                    condition.wait();
+                if (next_file_to_search >= files.size())
+                    return 0;
+                index = next_file_to_search++;
+            }
+
+            auto file_result = make<FileResult>();
+            auto result = searcher.search_file(files[index], true, file_result->output, {});
+            if (result.is_error())
+                file_result->error = result.release_error();
+            else
+                file_result->matched = result.value().matched;
+
+            Threading::MutexLocker locker(mutex);
+            results[index] = move(file_result);
+            condition.broadcast();
+        }
+    };
+
+    Vector<NonnullOwnPtr<Searcher<Parser>>> searchers;
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        searchers.append(make<Searcher<Parser>>(compile_patterns<Parser>(settings), settings));
+        TRY(threads.try_append(TRY(Threading::Thread::try_create([&, &searcher = *searchers.last()] { return search_files(searcher); }, "grep"sv))));
+    }
+    for (auto& thread : threads)
+        thread->start();
+
+    bool did_match_something = false;
+    for (size_t index = 0; index < files.size(); ++index) {
+        OwnPtr<FileResult> file_result;
+        {
+            Threading::MutexLocker locker(mutex);
+            while (!results[index])
+                condition.wait();
+            file_result = move(results[index]);
+            next_file_to_print = index + 1;
+            condition.broadcast();
+        }
+
+        write_output(file_result->output);
+        if (file_result->error.has_value()) {
+            if (!settings.suppress_errors)
+                warnln("Failed with file {}: {}", files[index], *file_result->error);
+            continue;
+        }
+        did_match_something = did_match_something || file_result->matched;
+    }
+
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return did_match_something;
+}
+
+template<typename Parser>
+static ErrorOr<int> grep(Settings const& settings)
+{
+    auto regular_expressions = compile_patterns<Parser>(settings);
+    for (auto& re : regular_expressions) {
+        if (re.parser_result.error != regex::Error::NoError) {
+            warnln("regex parse error: {}", regex::get_error_string(re.parser_result.error));
+            return 1;
+        }
+    }
+
+    Searcher<Parser> searcher { move(regular_expressions), settings };
+    typename Searcher<Parser>::FlushOutput flush_output = write_output;
+    bool did_match_something = false;
+
+    if (settings.files.is_empty() && !settings.recursive) {
+        char* line = nullptr;
+        size_t line_len = 0;
+        ssize_t nread = 0;
+        ScopeGuard free_line = [line] { free(line); };
+        size_t line_number = 0;
+        typename Searcher<Parser>::Result result;
+        StringBuilder output;
+        while ((nread = getline(&line, &line_len, stdin)) != -1) {
+            VERIFY(nread > 0);
+            if (line[nread - 1] == '\n')
+                --nread;
+            // Human-readable indexes start at 1, so it's fine to increment already.
+            line_number += 1;
+            StringView line_view(line, nread);
+            bool is_binary = line_view.contains('\0');
+
+            if (is_binary && settings.binary_mode == BinaryFileMode::Skip)
+                return 1;
+
+            auto matched = searcher.search_line(line_view, "stdin"sv, line_number, false, is_binary, result, output);
+            // Lines are printed as they come in, so that grep can be used on the output of long-running programs.
+            write_output(output);
+            did_match_something = did_match_something || matched;
+            if (matched && is_binary && settings.binary_mode == BinaryFileMode::Binary)
+                break;
+        }
+
+        if (settings.count_lines && !settings.quiet_mode)
+            outln("{}", result.matched_line_count);
+    } else if (settings.recursive) {
+        Vector<DeprecatedString> files;
+        if (!settings.files.is_empty()) {
+            for (auto& filename : settings.files)
+                TRY(collect_files(filename, true, settings.thread_count, files));
+        } else {
+            TRY(collect_files(".", false, settings.thread_count, files));
+        }
+
+        if (settings.thread_count > 1 && files.size() > 1)
+            return TRY(search_files_in_parallel<Parser>(files, settings)) ? 0 : 1;
+
+        for (auto& filename : files) {
+            StringBuilder output;
+            auto result = searcher.search_file(filename, true, output, flush_output);
+            write_output(output);
+            if (result.is_error()) {
+                if (!settings.suppress_errors)
+                    warnln("Failed with file {}: {}", filename, result.release_error());
+                continue;
+            }
+            did_match_something = did_match_something || result.value().matched;
+        }
+    } else {
+        bool print_filename { settings.files.size() > 1 };
+        for (auto& filename : settings.files) {
+            StringBuilder output;
+            auto result = searcher.search_file(filename, print_filename, output, flush_output);
+            write_output(output);
+            if (result.is_error()) {
+                if (!settings.suppress_errors)
+                    warnln("Failed with file {}: {}", filename, result.release_error());
+                return 1;
+            }
+            did_match_something = did_match_something || result.value().matched;
+        }
+    }
+
+    return did_match_something ? 0 : 1;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments args)
 {
-    TRY(Core::System::pledge("stdio rpath"));
+    TRY(Core::System::pledge("stdio rpath thread"));
 
     DeprecatedString program_name = AK::LexicalPath::basename(args.strings[0]);
 
-    Vector<DeprecatedString> files;
-
-    bool recursive = (program_name == "rgrep"sv);
+    Settings settings;
+    settings.recursive = (program_name == "rgrep"sv);
+    settings.colored_output = isatty(STDOUT_FILENO);
     bool use_ere = (program_name == "egrep"sv);
-    bool fixed_strings = (program_name == "fgrep"sv);
-    Vector<DeprecatedString> patterns;
+    settings.fixed_strings = (program_name == "fgrep"sv);
     StringView pattern_file;
-    BinaryFileMode binary_mode { BinaryFileMode::Binary };
-    bool case_insensitive = false;
-    bool line_numbers = false;
-    bool invert_match = false;
-    bool quiet_mode = false;
-    bool suppress_errors = false;
-    bool colored_output = isatty(STDOUT_FILENO);
-    bool count_lines = false;
-
-    size_t matched_line_count = 0;
 
     Core::ArgsParser args_parser;
-    args_parser.add_option(recursive, "Recursively scan files", "recursive", 'r');
+    args_parser.add_option(settings.recursive, "Recursively scan files", "recursive", 'r');
     args_parser.add_option(use_ere, "Extended regular expressions", "extended-regexp", 'E');
-    args_parser.add_option(fixed_strings, "Treat pattern as a string, not a regexp", "fixed-strings", 'F');
+    args_parser.add_option(settings.fixed_strings, "Treat pattern as a string, not a regexp", "fixed-strings", 'F');
     args_parser.add_option(Core::ArgsParser::Option {
         .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
         .help_string = "Pattern",
@@ -85,7 +506,7 @@ ErrorOr<int> serenity_main(Main::Arguments args)
         .short_name = 'e',
         .value_name = "Pattern",
         .accept_value = [&](StringView str) {
-            patterns.append(str);
+            settings.patterns.append(str);
             return true;
         },
     });
@@ -100,22 +521,22 @@ ErrorOr<int> serenity_main(Main::Arguments args)
             return true;
         },
     });
-    args_parser.add_option(case_insensitive, "Make matches case-insensitive", nullptr, 'i');
-    args_parser.add_option(line_numbers, "Output line-numbers", "line-numbers", 'n');
-    args_parser.add_option(invert_match, "Select non-matching lines", "invert-match", 'v');
-    args_parser.add_option(quiet_mode, "Do not write anything to standard output", "quiet", 'q');
-    args_parser.add_option(suppress_errors, "Suppress error messages for nonexistent or unreadable files", "no-messages", 's');
+    args_parser.add_option(settings.case_insensitive, "Make matches case-insensitive", nullptr, 'i');
+    args_parser.add_option(settings.line_numbers, "Output line-numbers", "line-numbers", 'n');
+    args_parser.add_option(settings.invert_match, "Select non-matching lines", "invert-match", 'v');
+    args_parser.add_option(settings.quiet_mode, "Do not write anything to standard output", "quiet", 'q');
+    args_parser.add_option(settings.suppress_errors, "Suppress error messages for nonexistent or unreadable files", "no-messages", 's');
     args_parser.add_option(Core::ArgsParser::Option {
         .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
         .help_string = "Action to take for binary files ([binary], text, skip)",
         .long_name = "binary-mode",
         .accept_value = [&](StringView str) {
             if ("text"sv == str)
-                binary_mode = BinaryFileMode::Text;
+                settings.binary_mode = BinaryFileMode::Text;
             else if ("binary"sv == str)
-                binary_mode = BinaryFileMode::Binary;
+                settings.binary_mode = BinaryFileMode::Binary;
             else if ("skip"sv == str)
-                binary_mode = BinaryFileMode::Skip;
+                settings.binary_mode = BinaryFileMode::Skip;
             else
                 return false;
             return true;
@@ -127,7 +548,7 @@ ErrorOr<int> serenity_main(Main::Arguments args)
         .long_name = "text",
         .short_name = 'a',
         .accept_value = [&](auto) {
-            binary_mode = BinaryFileMode::Text;
+            settings.binary_mode = BinaryFileMode::Text;
             return true;
         },
     });
@@ -137,7 +558,7 @@ ErrorOr<int> serenity_main(Main::Arguments args)
         .long_name = nullptr,
         .short_name = 'I',
         .accept_value = [&](auto) {
-            binary_mode = BinaryFileMode::Skip;
+            settings.binary_mode = BinaryFileMode::Skip;
             return true;
         },
     });
@@ -149,18 +570,24 @@ ErrorOr<int> serenity_main(Main::Arguments args)
         .value_name = "WHEN",
         .accept_value = [&](StringView str) {
             if ("never"sv == str)
-                colored_output = false;
+                settings.colored_output = false;
             else if ("always"sv == str)
-                colored_output = true;
+                settings.colored_output = true;
             else if ("auto"sv != str)
                 return false;
             return true;
         },
     });
-    args_parser.add_option(count_lines, "Output line count instead of line contents", "count", 'c');
-    args_parser.add_positional_argument(files, "File(s) to process", "file", Core::ArgsParser::Required::No);
+    args_parser.add_option(settings.count_lines, "Output line count instead of line contents", "count", 'c');
+    args_parser.add_option(settings.thread_count, "Search this many files at once when scanning recursively", "threads", 0, "count");
+    args_parser.add_positional_argument(settings.files, "File(s) to process", "file", Core::ArgsParser::Required::No);
     args_parser.parse(args);
 
+    if (settings.thread_count == 0) {
+        warnln("Thread count must be at least 1");
+        return 1;
+    }
+
     if (!pattern_file.is_empty()) {
         auto file = TRY(Core::File::open(pattern_file, Core::File::OpenMode::Read));
         auto buffered_file = TRY(Core::InputBufferedFile::create(move(file)));
@@ -171,182 +598,15 @@ ErrorOr<int> serenity_main(Main::Arguments args)
             // should be ignored.
             if (next_pattern.is_empty() && buffered_file->is_eof())
                 break;
-            patterns.append(next_pattern.to_deprecated_string());
+            settings.patterns.append(next_pattern.to_deprecated_string());
         }
     }
 
     // mock grep behavior: if -e is omitted, use first positional argument as pattern
-    if (patterns.size() == 0 && files.size())
-        patterns.append(files.take_first());
-
-    auto user_has_specified_files = !files.is_empty();
-    auto user_specified_multiple_files = files.size() >= 2;
-
-    PosixOptions options {};
-    if (case_insensitive)
-        options |= PosixFlags::Insensitive;
-
-    auto grep_logic = [&](auto&& regular_expressions) {
-        for (auto& re : regular_expressions) {
-            if (re.parser_result.error != regex::Error::NoError) {
-                warnln("regex parse error: {}", regex::get_error_string(re.parser_result.error));
-                return 1;
-            }
-        }
-
-        auto matches = [&](StringView str, StringView filename, size_t line_number, bool print_filename, bool is_binary) {
-            size_t last_printed_char_pos { 0 };
-            if (is_binary && binary_mode == BinaryFileMode::Skip)
-                return false;
+    if (settings.patterns.size() == 0 && settings.files.size())
+        settings.patterns.append(settings.files.take_first());
 
-            for (auto& re : regular_expressions) {
-                auto result = re.match(str, PosixFlags::Global);
-                if (!(result.success ^ invert_match))
-                    continue;
-
-                if (quiet_mode)
-                    return true;
-
-                if (count_lines) {
-                    matched_line_count++;
-                    return true;
-                }
-
-                if (is_binary && binary_mode == BinaryFileMode::Binary) {
-                    outln(colored_output ? "binary file \x1B[34m{}\x1B[0m matches"sv : "binary file {} matches"sv, filename);
-                } else {
-                    if ((result.matches.size() || invert_match) && print_filename)
-                        out(colored_output ? "\x1B[34m{}:\x1B[0m"sv : "{}:"sv, filename);
-                    if ((result.matches.size() || invert_match) && line_numbers)
-                        out(colored_output ? "\x1B[35m{}:\x1B[0m"sv : "{}:"sv, line_number);
-
-                    for (auto& match : result.matches) {
-                        auto pre_match_length = match.global_offset - last_printed_char_pos;
-                        out(colored_output ? "{}\x1B[32m{}\x1B[0m"sv : "{}{}"sv,
-                            pre_match_length > 0 ? StringView(&str[last_printed_char_pos], pre_match_length) : ""sv,
-                            match.view.to_deprecated_string());
-                        last_printed_char_pos = match.global_offset + match.view.length();
-                    }
-                    auto remaining_length = str.length() - last_printed_char_pos;
-                    outln("{}", remaining_length > 0 ? StringView(&str[last_printed_char_pos], remaining_length) : ""sv);
-                }
-
-                return true;
-            }
-
-            return false;
-        };
-
-        bool did_match_something = false;
-
-        auto handle_file = [&matches, binary_mode, count_lines, quiet_mode,
-                               user_specified_multiple_files, &matched_line_count, &did_match_something](StringView filename, bool print_filename) -> ErrorOr<void> {
-            auto file = TRY(Core::File::open(filename, Core::File::OpenMode::Read));
-            auto buffered_file = TRY(Core::InputBufferedFile::create(move(file)));
-
-            for (size_t line_number = 1; TRY(buffered_file->can_read_line()); ++line_number) {
-                Array<u8, PAGE_SIZE> buffer;
-                auto line = TRY(buffered_file->read_line(buffer));
-
-                auto is_binary = line.contains('\0');
-
-                auto matched = matches(line, filename, line_number, print_filename, is_binary);
-                did_match_something = did_match_something || matched;
-                if (matched && is_binary && binary_mode == BinaryFileMode::Binary)
-                    break;
-            }
-
-            if (count_lines && !quiet_mode) {
-                if (user_specified_multiple_files)
-                    outln("{}:{}", filename, matched_line_count);
-                else
-                    outln("{}", matched_line_count);
-                matched_line_count = 0;
-            }
-
-            return {};
-        };
-
-        auto add_directory = [&handle_file, user_has_specified_files, suppress_errors](DeprecatedString base, Optional<DeprecatedString> recursive, auto handle_directory) -> void {
-            Core::DirIterator it(recursive.value_or(base), Core::DirIterator::Flags::SkipDots);
-            while (it.has_next()) {
-                auto path = it.next_full_path();
-                if (!FileSystem::is_directory(path)) {
-                    auto key = user_has_specified_files ? path.view() : path.substring_view(base.length() + 1, path.length() - base.length() - 1);
-                    if (auto result = handle_file(key, true); result.is_error() && !suppress_errors)
-                        warnln("Failed with file {}: {}", key, result.release_error());
-
-                } else {
-                    handle_directory(base, path, handle_directory);
-                }
-            }
-        };
-
-        if (!files.size() && !recursive) {
-            char* line = nullptr;
-            size_t line_len = 0;
-            ssize_t nread = 0;
-            ScopeGuard free_line = [line] { free(line); };
-            size_t line_number = 0;
-            while ((nread = getline(&line, &line_len, stdin)) != -1) {
-                VERIFY(nread > 0);
-                if (line[nread - 1] == '\n')
-                    --nread;
-                // Human-readable indexes start at 1, so it's fine to increment already.
-                line_number += 1;
-                StringView line_view(line, nread);
-                bool is_binary = line_view.contains('\0');
-
-                if (is_binary && binary_mode == BinaryFileMode::Skip)
-                    return 1;
-
-                auto matched = matches(line_view, "stdin"sv, line_number, false, is_binary);
-                did_match_something = did_match_something || matched;
-                if (matched && is_binary && binary_mode == BinaryFileMode::Binary)
-                    break;
-            }
-
-            if (count_lines && !quiet_mode)
-                outln("{}", matched_line_count);
-        } else {
-            if (recursive) {
-                if (user_has_specified_files) {
-                    for (auto& filename : files) {
-                        add_directory(filename, {}, add_directory);
-                    }
-                } else {
-                    add_directory(".", {}, add_directory);
-                }
-
-            } else {
-                bool print_filename { files.size() > 1 };
-                for (auto& filename : files) {
-                    auto result = handle_file(filename, print_filename);
-                    if (result.is_error()) {
-                        if (!suppress_errors)
-                            warnln("Failed with file {}: {}", filename, result.release_error());
-                        return 1;
-                    }
-                }
-            }
-        }
-
-        return did_match_something ? 0 : 1;
-    };
-
-    if (use_ere) {
-        Vector<Regex<PosixExtended>> regular_expressions;
-        for (auto pattern : patterns) {
-            auto escaped_pattern = (fixed_strings) ? escape_characters(pattern, ere_special_characters) : pattern;
-            regular_expressions.append(Regex<PosixExtended>(escaped_pattern, options));
-        }
-        return grep_logic(regular_expressions);
-    }
-
-    Vector<Regex<PosixBasic>> regular_expressions;
-    for (auto pattern : patterns) {
-        auto escaped_pattern = (fixed_strings) ? escape_characters(pattern, basic_special_characters) : pattern;
-        regular_expressions.append(Regex<PosixBasic>(escaped_pattern, options));
-    }
-    return grep_logic(regular_expressions);
+    if (use_ere)
+        return grep<PosixExtended>(settings);
+    return grep<PosixBasic>(settings);
 }
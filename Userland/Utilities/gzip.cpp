@@ -18,17 +18,24 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    size_t thread_count { 1 };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(thread_count, "Compress using this many threads", "threads", 'p', "count");
     args_parser.add_positional_argument(filenames, "Files", "FILES");
     args_parser.parse(arguments);
 
     if (write_to_stdout)
         keep_input_files = true;
 
+    if (thread_count == 0) {
+        warnln("Thread count must be at least 1");
+        return 1;
+    }
+
     for (auto const& input_filename : filenames) {
         DeprecatedString output_filename;
         if (decompress) {
@@ -46,7 +53,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (decompress)
             TRY(Compress::GzipDecompressor::decompress_file(input_filename, move(output_stream)));
         else
-            TRY(Compress::GzipCompressor::compress_file(input_filename, move(output_stream)));
+            TRY(Compress::GzipCompressor::compress_file(input_filename, move(output_stream), thread_count));
 
         if (!keep_input_files) {
             TRY(Core::System::unlink(input_filename));
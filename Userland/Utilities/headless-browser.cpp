@@ -11,11 +11,14 @@
 #include <AK/LexicalPath.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Platform.h>
+#include <AK/QuickSort.h>
 #include <AK/String.h>
 #include <AK/URL.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DeprecatedFile.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
 #include <LibCore/Timer.h>
@@ -78,13 +81,70 @@ public:
         return String::from_deprecated_string(client().dump_layout_tree());
     }
 
+    // Scrolls through the whole page one step at a time, painting every frame into a backing store and timing how long
+    // each paint takes until WebContent reports it as done.
+    ErrorOr<void> benchmark_scrolling(Gfx::IntSize window_size, int scroll_step, bool rasterize_on_background_thread, Function<void(Vector<Time>)> on_complete)
+    {
+        if (!m_scroll_benchmark_backing_store) {
+            m_scroll_benchmark_backing_store = TRY(Gfx::Bitmap::create_shareable(Gfx::BitmapFormat::BGRx8888, window_size));
+            client().async_add_backing_store(scroll_benchmark_backing_store_id, m_scroll_benchmark_backing_store->to_shareable_bitmap());
+        }
+
+        debug_request("set-rasterize-on-background-thread", rasterize_on_background_thread ? "on" : "off");
+
+        m_scroll_benchmark_window_size = window_size;
+        m_scroll_benchmark_step = scroll_step;
+        m_scroll_benchmark_offset = 0;
+        m_scroll_benchmark_frame_times.clear();
+        m_on_scroll_benchmark_complete = move(on_complete);
+        paint_next_scroll_benchmark_frame();
+        return {};
+    }
+
     Function<void(const URL&)> on_load_finish;
 
 private:
     HeadlessWebContentView() = default;
 
-    void notify_server_did_layout(Badge<WebView::WebContentClient>, Gfx::IntSize) override { }
-    void notify_server_did_paint(Badge<WebView::WebContentClient>, i32) override { }
+    void paint_next_scroll_benchmark_frame()
+    {
+        Gfx::IntRect viewport_rect { { 0, m_scroll_benchmark_offset }, m_scroll_benchmark_window_size };
+        client().async_set_viewport_rect(viewport_rect);
+        m_scroll_benchmark_frame_timer = Core::ElapsedTimer::start_new();
+        client().async_paint(viewport_rect, scroll_benchmark_backing_store_id);
+    }
+
+    void notify_server_did_layout(Badge<WebView::WebContentClient>, Gfx::IntSize content_size) override
+    {
+        m_content_size = content_size;
+    }
+
+    void notify_server_did_paint(Badge<WebView::WebContentClient>, i32 bitmap_id) override
+    {
+        if (bitmap_id != scroll_benchmark_backing_store_id || !m_on_scroll_benchmark_complete)
+            return;
+
+        m_scroll_benchmark_frame_times.append(m_scroll_benchmark_frame_timer.elapsed_time());
+
+        m_scroll_benchmark_offset += m_scroll_benchmark_step;
+        if (m_scroll_benchmark_offset + m_scroll_benchmark_window_size.height() > m_content_size.height()) {
+            auto on_complete = move(m_on_scroll_benchmark_complete);
+            on_complete(move(m_scroll_benchmark_frame_times));
+            return;
+        }
+        paint_next_scroll_benchmark_frame();
+    }
+
+    static constexpr i32 scroll_benchmark_backing_store_id = 1;
+    RefPtr<Gfx::Bitmap> m_scroll_benchmark_backing_store;
+    Gfx::IntSize m_scroll_benchmark_window_size;
+    int m_scroll_benchmark_step { 0 };
+    int m_scroll_benchmark_offset { 0 };
+    Core::ElapsedTimer m_scroll_benchmark_frame_timer;
+    Vector<Time> m_scroll_benchmark_frame_times;
+    Function<void(Vector<Time>)> m_on_scroll_benchmark_complete;
+    Gfx::IntSize m_content_size;
+
     void notify_server_did_invalidate_content_rect(Badge<WebView::WebContentClient>, Gfx::IntRect const&) override { }
     void notify_server_did_change_selection(Badge<WebView::WebContentClient>) override { }
     void notify_server_did_request_cursor_change(Badge<WebView::WebContentClient>, Gfx::StandardCursor) override { }
@@ -156,6 +216,51 @@ private:
     void create_client(WebView::EnableCallgrindProfiling) override { }
 };
 
+static void print_frame_times(StringView label, Vector<Time> frame_times)
+{
+    if (frame_times.is_empty()) {
+        outln("{}: No frames were painted", label);
+        return;
+    }
+
+    quick_sort(frame_times);
+
+    auto to_milliseconds = [](Time time) {
+        return static_cast<double>(time.to_microseconds()) / 1000.0;
+    };
+
+    double total = 0;
+    for (auto frame_time : frame_times)
+        total += to_milliseconds(frame_time);
+
+    outln("{}: {} frames, mean {:.2} ms, median {:.2} ms, 95th percentile {:.2} ms, worst {:.2} ms",
+        label,
+        frame_times.size(),
+        total / frame_times.size(),
+        to_milliseconds(frame_times[frame_times.size() / 2]),
+        to_milliseconds(frame_times[frame_times.size() * 95 / 100]),
+        to_milliseconds(frame_times.last()));
+}
+
+static void benchmark_scrolling_and_exit(Core::EventLoop& event_loop, HeadlessWebContentView& view, Gfx::IntSize window_size, int scroll_step)
+{
+    auto benchmark = [&event_loop, &view, window_size, scroll_step](bool rasterize_on_background_thread, Function<void(Vector<Time>)> on_complete) {
+        if (auto result = view.benchmark_scrolling(window_size, scroll_step, rasterize_on_background_thread, move(on_complete)); result.is_error()) {
+            warnln("Failed to start benchmark: {}", result.error());
+            event_loop.quit(1);
+        }
+    };
+
+    benchmark(false, [&event_loop, benchmark](auto frame_times) {
+        print_frame_times("Painting every frame"sv, move(frame_times));
+
+        benchmark(true, [&event_loop](auto frame_times) {
+            print_frame_times("Reusing display lists, rasterized on a background thread"sv, move(frame_times));
+            event_loop.quit(0);
+        });
+    });
+}
+
 static ErrorOr<NonnullRefPtr<Core::Timer>> load_page_for_screenshot_and_exit(Core::EventLoop& event_loop, HeadlessWebContentView& view, int screenshot_timeout)
 {
     // FIXME: Allow passing the output path as an argument.
@@ -211,6 +316,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     StringView web_driver_ipc_path;
     bool dump_layout_tree = false;
     bool is_layout_test_mode = false;
+    int benchmark_scroll_step = 0;
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("This utility runs the Browser in headless mode.");
@@ -219,6 +325,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(resources_folder, "Path of the base resources folder (defaults to /res)", "resources", 'r', "resources-root-path");
     args_parser.add_option(web_driver_ipc_path, "Path to the WebDriver IPC socket", "webdriver-ipc-path", 0, "path");
     args_parser.add_option(is_layout_test_mode, "Enable layout test mode", "layout-test-mode", 0);
+    args_parser.add_option(benchmark_scroll_step, "Time the painting of every frame while scrolling through the page [n] pixels at a time, then exit", "benchmark-scrolling", 0, "n");
     args_parser.add_positional_argument(url, "URL to open", "url", Core::ArgsParser::Required::Yes);
     args_parser.parse(arguments);
 
@@ -247,6 +354,10 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
             event_loop.quit(0);
         };
+    } else if (benchmark_scroll_step > 0) {
+        view->on_load_finish = [&](auto const&) {
+            benchmark_scrolling_and_exit(event_loop, *view, window_size, benchmark_scroll_step);
+        };
     } else if (web_driver_ipc_path.is_empty()) {
         timer = TRY(load_page_for_screenshot_and_exit(event_loop, *view, screenshot_timeout));
     }
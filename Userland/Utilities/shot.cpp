@@ -150,7 +150,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 0;
     }
 
-    auto encoded_bitmap_or_error = Gfx::PNGWriter::encode(*bitmap);
+    Gfx::PNGWriter::Options options;
+    options.thread_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    auto encoded_bitmap_or_error = Gfx::PNGWriter::encode(*bitmap, options);
     if (encoded_bitmap_or_error.is_error()) {
         warnln("Failed to encode PNG");
         return 1;
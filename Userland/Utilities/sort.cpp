@@ -5,15 +5,23 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BinaryHeap.h>
 #include <AK/CharacterTypes.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
 #include <AK/QuickSort.h>
+#include <AK/Queue.h>
+#include <AK/ScopeGuard.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+#include <stdlib.h>
+#include <string.h>
 
 struct Line {
     StringView key;
@@ -58,45 +66,436 @@ struct Options {
     bool reverse { false };
     StringView separator { "\0", 1 };
     Vector<DeprecatedString> files;
+    // If this is non-zero, the input is sorted in parts of about this size, which are written to temporary files and merged.
+    size_t buffer_size { 0 };
+    size_t thread_count { 1 };
 };
 
-static ErrorOr<void> load_file(Options options, StringView filename, Vector<Line>& lines, HashTable<Line>& seen)
+// FIXME: Unlimited line length
+static constexpr size_t max_line_length = 4096;
+
+// The number of sorted runs that are merged at once. If there are more, they are merged in multiple passes.
+static constexpr size_t max_merge_width = 64;
+
+static Line make_line(Options const& options, DeprecatedString line)
+{
+    StringView key = line;
+    if (options.key_field != 0) {
+        auto split = (options.separator[0])
+            ? line.split_view(options.separator[0])
+            : line.split_view(is_ascii_space);
+        if (options.key_field - 1 >= split.size()) {
+            key = ""sv;
+        } else {
+            key = split[options.key_field - 1];
+        }
+    }
+
+    return { key, key.to_int().value_or(0), line, options.numeric };
+}
+
+static ErrorOr<void> load_file(Options const& options, StringView filename, Function<ErrorOr<void>(Line)> const& on_line)
 {
     auto file = TRY(Core::InputBufferedFile::create(
         TRY(Core::File::open_file_or_standard_stream(filename, Core::File::OpenMode::Read))));
 
-    // FIXME: Unlimited line length
-    auto buffer = TRY(ByteBuffer::create_uninitialized(4096));
+    auto buffer = TRY(ByteBuffer::create_uninitialized(max_line_length));
     while (TRY(file->can_read_line())) {
         DeprecatedString line = TRY(file->read_line(buffer));
+        TRY(on_line(make_line(options, move(line))));
+    }
+
+    return {};
+}
+
+static ErrorOr<void> load_files(Options const& options, Function<ErrorOr<void>(Line)> const& on_line)
+{
+    if (options.files.size() == 0)
+        return load_file(options, "-"sv, on_line);
+
+    for (auto& file : options.files)
+        TRY(load_file(options, file, on_line));
+    return {};
+}
+
+static bool comes_before(Line const& a, Line const& b, bool reverse)
+{
+    return reverse ? b < a : a < b;
+}
+
+// A part of the input that has been sorted on its own. It's either kept in memory, or has been written to a temporary file.
+struct Run {
+    Vector<Line> lines;
+    OwnPtr<Core::InputBufferedFile> file;
+};
+
+// Temporary files are unlinked right away, so that they go away by themselves once they're closed.
+static ErrorOr<int> create_temporary_file()
+{
+    auto const* directory = getenv("TMPDIR");
+    auto path = DeprecatedString::formatted("{}/sort.XXXXXX", directory ? directory : "/tmp");
+    Vector<char> pattern;
+    TRY(pattern.try_append(path.characters(), path.length() + 1));
+
+    auto fd = TRY(Core::System::mkstemp(pattern));
+    ArmedScopeGuard close_fd = [fd] { (void)Core::System::close(fd); };
+    TRY(Core::System::unlink({ pattern.data(), path.length() }));
+    close_fd.disarm();
+    return fd;
+}
+
+template<typename Callback>
+static ErrorOr<Run> write_run_to_temporary_file(Callback write_lines)
+{
+    auto fd = TRY(create_temporary_file());
+    ArmedScopeGuard close_fd = [fd] { (void)Core::System::close(fd); };
+    {
+        auto file = TRY(Core::File::adopt_fd(fd, Core::File::OpenMode::Write, Core::File::ShouldCloseFileDescriptor::No));
+        auto stream = TRY(Core::OutputBufferedFile::create(move(file), 64 * KiB));
+        TRY(write_lines(*stream));
+        TRY(stream->flush_buffer());
+    }
+    TRY(Core::System::lseek(fd, 0, SEEK_SET));
+
+    close_fd.disarm();
+    auto file = TRY(Core::File::adopt_fd(fd, Core::File::OpenMode::Read));
+    return Run { {}, TRY(Core::InputBufferedFile::create(move(file))) };
+}
+
+static ErrorOr<void> write_line(Stream& stream, Line const& line)
+{
+    TRY(stream.write_until_depleted(line.line.bytes()));
+    TRY(stream.write_value<u8>('\n'));
+    return {};
+}
+
+static ErrorOr<Run> sort_run(Vector<Line> lines, Options const& options)
+{
+    quick_sort(lines, [reverse = options.reverse](auto& a, auto& b) { return comes_before(a, b, reverse); });
+    if (options.buffer_size == 0)
+        return Run { move(lines), {} };
+
+    return write_run_to_temporary_file([&](Stream& stream) -> ErrorOr<void> {
+        for (auto& line : lines)
+            TRY(write_line(stream, line));
+        return {};
+    });
+}
+
+// Sorts the parts of the input as they are read, on worker threads if there are multiple threads.
+class RunSorter {
+public:
+    explicit RunSorter(Options const& options)
+        : m_options(options)
+    {
+    }
+
+    // Reading the input may fail before finish() is reached, and the workers have to be stopped in that case too.
+    ~RunSorter()
+    {
+        stop_workers();
+    }
+
+    ErrorOr<void> start()
+    {
+        if (m_options.thread_count == 1)
+            return {};
+
+        Vector<NonnullRefPtr<Threading::Thread>> threads;
+        for (size_t i = 0; i < m_options.thread_count; ++i)
+            TRY(threads.try_append(TRY(Threading::Thread::try_create([this] { return sort_runs(); }, "sort"sv))));
+        m_threads = move(threads);
+        for (auto& thread : m_threads)
+            thread->start();
+        return {};
+    }
+
+    ErrorOr<void> add(Vector<Line> lines)
+    {
+        if (m_threads.is_empty())
+            return m_runs.try_append(TRY(sort_run(move(lines), m_options)));
+
+        Threading::MutexLocker locker(m_mutex);
+        // Don't read any further ahead than the workers can keep up with, so that at most one part per thread is waiting
+        // to be sorted or being sorted at any time.
+        while (m_unfinished_run_count >= m_options.thread_count && !m_error.has_value())
+            m_condition.wait();
+        if (m_error.has_value())
+            return Error::copy(*m_error);
+
+        m_pending_runs.enqueue({ m_runs.size(), move(lines) });
+        TRY(m_runs.try_append({}));
+        ++m_unfinished_run_count;
+        m_condition.broadcast();
+        return {};
+    }
+
+    ErrorOr<Vector<Run>> finish()
+    {
+        stop_workers();
+
+        if (m_error.has_value())
+            return m_error.release_value();
+        return move(m_runs);
+    }
+
+private:
+    struct PendingRun {
+        size_t index { 0 };
+        Vector<Line> lines;
+    };
+
+    // Lets the workers sort the parts that are still pending, and waits for them to exit.
+    void stop_workers()
+    {
+        if (m_threads.is_empty())
+            return;
+        {
+            Threading::MutexLocker locker(m_mutex);
+            m_done = true;
+            m_condition.broadcast();
+        }
+        for (auto& thread : m_threads)
+            (void)thread->join();
+        m_threads.clear();
+    }
 
-        StringView key = line;
-        if (options.key_field != 0) {
-            auto split = (options.separator[0])
-                ? line.split_view(options.separator[0])
-                : line.split_view(is_ascii_space);
-            if (options.key_field - 1 >= split.size()) {
-                key = ""sv;
-            } else {
-                key = split[options.key_field - 1];
+    intptr_t sort_runs()
+    {
+        while (true) {
+            PendingRun pending_run;
+            {
+                Threading::MutexLocker locker(m_mutex);
+                while (m_pending_runs.is_empty() && !m_done)
+                    m_condition.wait();
+                if (m_pending_runs.is_empty())
+                    return 0;
+                pending_run = m_pending_runs.dequeue();
             }
+
+            auto run = sort_run(move(pending_run.lines), m_options);
+
+            Threading::MutexLocker locker(m_mutex);
+            if (run.is_error())
+                m_error = run.release_error();
+            else
+                m_runs[pending_run.index] = run.release_value();
+            --m_unfinished_run_count;
+            m_condition.broadcast();
         }
+    }
 
-        Line l = { key, key.to_int().value_or(0), line, options.numeric };
+    Options const& m_options;
 
-        if (!options.unique || !seen.contains(l)) {
-            lines.append(l);
-            if (options.unique)
-                seen.set(l);
+    Threading::Mutex m_mutex;
+    Threading::ConditionVariable m_condition { m_mutex };
+    Queue<PendingRun> m_pending_runs;
+    Vector<Run> m_runs;
+    size_t m_unfinished_run_count { 0 };
+    Optional<Error> m_error;
+    bool m_done { false };
+
+    // NOTE: Declared last, so that the threads are gone before anything they use is destroyed.
+    Vector<NonnullRefPtr<Threading::Thread>> m_threads;
+};
+
+class RunReader {
+public:
+    RunReader(Run& run, Options const& options)
+        : m_run(run)
+        , m_options(options)
+    {
+    }
+
+    ErrorOr<Optional<Line>> next()
+    {
+        if (!m_run.file) {
+            if (m_index >= m_run.lines.size())
+                return Optional<Line> {};
+            return move(m_run.lines[m_index++]);
+        }
+
+        if (!TRY(m_run.file->can_read_line()))
+            return Optional<Line> {};
+        if (m_buffer.is_empty())
+            m_buffer = TRY(ByteBuffer::create_uninitialized(max_line_length));
+        DeprecatedString line = TRY(m_run.file->read_line(m_buffer));
+        return make_line(m_options, move(line));
+    }
+
+private:
+    Run& m_run;
+    Options const& m_options;
+    size_t m_index { 0 };
+    ByteBuffer m_buffer;
+};
+
+struct MergeKey {
+    Line line;
+    size_t run_index { 0 };
+    bool reverse { false };
+
+    // Lines with equal keys are taken from the earlier part of the input first, so that -u keeps the first one like it
+    // does when sorting in memory.
+    int compare(MergeKey const& other) const
+    {
+        if (comes_before(line, other.line, reverse))
+            return -1;
+        if (comes_before(other.line, line, reverse))
+            return 1;
+        if (run_index != other.run_index)
+            return run_index < other.run_index ? -1 : 1;
+        return 0;
+    }
+
+    bool operator<(MergeKey const& other) const { return compare(other) < 0; }
+    bool operator<=(MergeKey const& other) const { return compare(other) <= 0; }
+    bool operator>=(MergeKey const& other) const { return compare(other) >= 0; }
+};
+
+static ErrorOr<void> merge_runs(Span<Run> runs, Options const& options, Function<ErrorOr<void>(Line const&)> const& on_line)
+{
+    VERIFY(runs.size() <= max_merge_width);
+
+    Vector<RunReader> readers;
+    BinaryHeap<MergeKey, size_t, max_merge_width> heap;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        TRY(readers.try_empend(runs[i], options));
+        if (auto line = TRY(readers[i].next()); line.has_value())
+            heap.insert({ line.release_value(), i, options.reverse }, i);
+    }
+
+    Optional<Line> previous_line;
+    while (!heap.is_empty()) {
+        auto line = heap.peek_min_key().line;
+        auto index = heap.pop_min();
+        if (auto next_line = TRY(readers[index].next()); next_line.has_value())
+            heap.insert({ next_line.release_value(), index, options.reverse }, index);
+
+        if (options.unique) {
+            if (previous_line.has_value() && *previous_line == line)
+                continue;
+            previous_line = line;
         }
+        TRY(on_line(line));
     }
 
     return {};
 }
 
+static ErrorOr<void> sort_in_runs(Options const& options)
+{
+    RunSorter sorter { options };
+    TRY(sorter.start());
+
+    if (options.buffer_size == 0) {
+        // Everything has to be read to know how to split it evenly between the threads.
+        Vector<Line> lines;
+        HashTable<Line> seen;
+        TRY(load_files(options, [&](Line line) -> ErrorOr<void> {
+            if (!options.unique || !seen.contains(line)) {
+                if (options.unique)
+                    seen.set(line);
+                TRY(lines.try_append(move(line)));
+            }
+            return {};
+        }));
+
+        auto run_count = min(options.thread_count, max_merge_width);
+        auto lines_per_run = ceil_div(lines.size(), run_count);
+        for (size_t start = 0; start < lines.size(); start += lines_per_run) {
+            Vector<Line> run_lines;
+            auto end = min(start + lines_per_run, lines.size());
+            TRY(run_lines.try_ensure_capacity(end - start));
+            for (size_t i = start; i < end; ++i)
+                run_lines.unchecked_append(move(lines[i]));
+            TRY(sorter.add(move(run_lines)));
+        }
+    } else {
+        // The part that is being read is held in memory, as well as one part per thread.
+        auto run_size_limit = options.buffer_size / (options.thread_count + 1);
+        Vector<Line> lines;
+        HashTable<Line> seen;
+        size_t run_size = 0;
+        TRY(load_files(options, [&](Line line) -> ErrorOr<void> {
+            // Duplicates in different parts are left for the merge to remove.
+            if (options.unique) {
+                if (seen.contains(line))
+                    return {};
+                seen.set(line);
+            }
+            run_size += line.line.length() + sizeof(Line);
+            TRY(lines.try_append(move(line)));
+
+            if (run_size >= run_size_limit) {
+                seen.clear();
+                run_size = 0;
+                TRY(sorter.add(move(lines)));
+                lines = {};
+            }
+            return {};
+        }));
+        if (!lines.is_empty())
+            TRY(sorter.add(move(lines)));
+    }
+
+    auto runs = TRY(sorter.finish());
+
+    // Merge groups of runs into bigger ones until they can all be merged at once.
+    while (runs.size() > max_merge_width) {
+        Vector<Run> merged_runs;
+        for (size_t start = 0; start < runs.size(); start += max_merge_width) {
+            auto group = runs.span().slice(start, min(max_merge_width, runs.size() - start));
+            TRY(merged_runs.try_append(TRY(write_run_to_temporary_file([&](Stream& stream) {
+                return merge_runs(group, options, [&](Line const& line) { return write_line(stream, line); });
+            }))));
+        }
+        runs = move(merged_runs);
+    }
+
+    return merge_runs(runs, options, [](Line const& line) -> ErrorOr<void> {
+        outln("{}", line.line);
+        return {};
+    });
+}
+
+// Accepts a size in bytes with a b, K, M or G suffix, or in KiB without one.
+static Optional<size_t> parse_buffer_size(StringView string)
+{
+    if (string.is_empty())
+        return {};
+
+    size_t multiplier = KiB;
+    switch (string[string.length() - 1]) {
+    case 'b':
+        multiplier = 1;
+        break;
+    case 'K':
+        multiplier = KiB;
+        break;
+    case 'M':
+        multiplier = MiB;
+        break;
+    case 'G':
+        multiplier = GiB;
+        break;
+    default:
+        if (!is_ascii_digit(string[string.length() - 1]))
+            return {};
+        break;
+    }
+    if (!is_ascii_digit(string[string.length() - 1]))
+        string = string.substring_view(0, string.length() - 1);
+
+    auto number = string.to_uint<size_t>();
+    if (!number.has_value() || *number == 0 || Checked<size_t>::multiplication_would_overflow(*number, multiplier))
+        return {};
+    return *number * multiplier;
+}
+
 ErrorOr<int> serenity_main([[maybe_unused]] Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath thread"));
 
     Options options;
 
@@ -106,19 +505,49 @@ ErrorOr<int> serenity_main([[maybe_unused]] Main::Arguments arguments)
     args_parser.add_option(options.numeric, "treat the key field as a number", "numeric", 'n');
     args_parser.add_option(options.separator, "The separator to split fields by", "sep", 't', "char");
     args_parser.add_option(options.reverse, "Sort in reverse order", "reverse", 'r');
+    args_parser.add_option(Core::ArgsParser::Option {
+        .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
+        .help_string = "Sort parts of about this much memory at a time and merge them through temporary files",
+        .long_name = "buffer-size",
+        .short_name = 'S',
+        .value_name = "size",
+        .accept_value = [&](StringView str) {
+            auto buffer_size = parse_buffer_size(str);
+            if (!buffer_size.has_value())
+                return false;
+            options.buffer_size = *buffer_size;
+            return true;
+        },
+    });
+    args_parser.add_option(options.thread_count, "Sort using this many threads", "parallel", 0, "count");
     args_parser.add_positional_argument(options.files, "Files to sort", "file", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
+    if (options.thread_count == 0) {
+        warnln("Thread count must be at least 1");
+        return 1;
+    }
+
+    if (options.buffer_size != 0 || options.thread_count > 1) {
+        if (options.buffer_size == 0)
+            TRY(Core::System::pledge("stdio rpath thread"));
+        TRY(sort_in_runs(options));
+        return 0;
+    }
+
+    TRY(Core::System::pledge("stdio rpath"));
+
     Vector<Line> lines;
     HashTable<Line> seen;
 
-    if (options.files.size() == 0) {
-        TRY(load_file(options, "-"sv, lines, seen));
-    } else {
-        for (auto& file : options.files) {
-            TRY(load_file(options, file, lines, seen));
+    TRY(load_files(options, [&](Line line) -> ErrorOr<void> {
+        if (!options.unique || !seen.contains(line)) {
+            lines.append(line);
+            if (options.unique)
+                seen.set(line);
         }
-    }
+        return {};
+    }));
 
     quick_sort(lines);
 
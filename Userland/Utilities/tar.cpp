@@ -5,6 +5,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/HashMap.h>
 #include <AK/LexicalPath.h>
 #include <AK/Span.h>
 #include <AK/Vector.h>
@@ -19,6 +20,8 @@
 #include <LibCore/System.h>
 #include <LibFileSystem/FileSystem.h>
 #include <LibMain/Main.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -26,6 +29,189 @@
 
 constexpr size_t buffer_size = 4096;
 
+// With paths given, only the members at or below one of them are listed or extracted.
+static bool is_selected(DeprecatedString const& member_path, Vector<DeprecatedString> const& paths)
+{
+    if (paths.is_empty())
+        return true;
+
+    auto canonical_member_path = LexicalPath::canonicalized_path(member_path);
+    for (auto const& path : paths) {
+        auto canonical_path = LexicalPath::canonicalized_path(path);
+        if (canonical_member_path == canonical_path || canonical_member_path.starts_with(DeprecatedString::formatted("{}/", canonical_path)))
+            return true;
+    }
+    return false;
+}
+
+static bool is_regular_file(StringView path)
+{
+    if (path.is_empty() || path == "-"sv)
+        return false;
+    auto stat = Core::System::stat(path);
+    return !stat.is_error() && S_ISREG(stat.value().st_mode);
+}
+
+// Creates everything but the contents of a member. For regular files, the file to write the contents to is returned.
+static ErrorOr<OwnPtr<Core::File>> create_member(Archive::TarMember const& member)
+{
+    auto const& header = member.header;
+    DeprecatedString absolute_path = Core::DeprecatedFile::absolute_path(member.path);
+    auto parent_path = LexicalPath(absolute_path).parent();
+    auto header_mode = TRY(header.mode());
+
+    switch (header.type_flag()) {
+    case Archive::TarFileType::NormalFile:
+    case Archive::TarFileType::AlternateNormalFile: {
+        MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+
+        int fd = TRY(Core::System::open(absolute_path, O_CREAT | O_WRONLY, header_mode));
+        auto file = TRY(Core::File::adopt_fd(fd, Core::File::OpenMode::Write));
+        // Give the file its final size right away, which also cuts off what is left of a longer file that was there.
+        TRY(file->truncate(TRY(header.size())));
+        return OwnPtr<Core::File> { move(file) };
+    }
+    case Archive::TarFileType::SymLink: {
+        MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+
+        TRY(Core::System::symlink(header.link_name(), absolute_path));
+        return nullptr;
+    }
+    case Archive::TarFileType::Directory: {
+        MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+
+        auto result_or_error = Core::System::mkdir(absolute_path, header_mode);
+        if (result_or_error.is_error() && result_or_error.error().code() != EEXIST)
+            return result_or_error.release_error();
+        return nullptr;
+    }
+    default:
+        // FIXME: Implement other file types
+        warnln("file type '{}' of {} is not yet supported", (char)header.type_flag(), header.filename());
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static ErrorOr<void> copy_member_contents(Core::File& archive, Archive::TarMember const& member, Core::File& file)
+{
+    TRY(archive.seek(member.content_offset, SeekMode::SetPosition));
+    size_t remaining = TRY(member.header.size());
+
+    // Have the kernel copy the contents if it can, and fall back to copying them through a buffer otherwise.
+    while (remaining > 0) {
+        auto copied = Core::System::copy_file_range(archive.fd(), file.fd(), remaining);
+        if (copied.is_error()) {
+            auto code = copied.error().code();
+            if (code == EXDEV || code == EINVAL || code == ENOSYS || code == ENOTSUP || code == EOPNOTSUPP)
+                break;
+            return copied.release_error();
+        }
+        if (copied.value() == 0)
+            return Error::from_string_literal("Archive ended in the middle of a member");
+        remaining -= copied.value();
+    }
+
+    Array<u8, buffer_size> buffer;
+    while (remaining > 0) {
+        auto slice = TRY(archive.read_some(buffer.span().trim(remaining)));
+        if (slice.is_empty())
+            return Error::from_string_literal("Archive ended in the middle of a member");
+        TRY(file.write_until_depleted(slice));
+        remaining -= slice.size();
+    }
+    return {};
+}
+
+// Copies the contents of regular files straight out of an uncompressed archive, several files at a time.
+static ErrorOr<void> extract_files(StringView archive_file, Vector<Archive::TarMember const*> const& files, size_t thread_count)
+{
+    Threading::Mutex mutex;
+    size_t next_file = 0;
+    Optional<Error> first_error;
+
+    auto extract_next_files = [&]() -> ErrorOr<void> {
+        auto archive = TRY(Core::File::open(archive_file, Core::File::OpenMode::Read));
+        while (true) {
+            Archive::TarMember const* member;
+            {
+                Threading::MutexLocker locker(mutex);
+                if (first_error.has_value() || next_file >= files.size())
+                    return {};
+                member = files[next_file++];
+            }
+
+            auto file = TRY(create_member(*member));
+            TRY(copy_member_contents(*archive, *member, *file));
+        }
+    };
+
+    auto extract_next_files_or_record_error = [&]() -> intptr_t {
+        auto result = extract_next_files();
+        if (result.is_error()) {
+            Threading::MutexLocker locker(mutex);
+            if (!first_error.has_value())
+                first_error = result.release_error();
+        }
+        return 0;
+    };
+
+    if (thread_count <= 1 || files.size() <= 1) {
+        extract_next_files_or_record_error();
+    } else {
+        Vector<NonnullRefPtr<Threading::Thread>> threads;
+        for (size_t i = 0; i < min(thread_count, files.size()); ++i)
+            TRY(threads.try_append(TRY(Threading::Thread::try_create([&] { return extract_next_files_or_record_error(); }, "tar"sv))));
+        for (auto& thread : threads)
+            thread->start();
+        for (auto& thread : threads)
+            (void)thread->join();
+    }
+
+    if (first_error.has_value())
+        return first_error.release_value();
+    return {};
+}
+
+// Members of an uncompressed archive can be read at any offset, so regular files are collected and extracted several
+// at a time, while everything else is created in archive order.
+static ErrorOr<void> extract_indexed_members(StringView archive_file, Vector<Archive::TarMember> const& members, Vector<DeprecatedString> const& paths, bool verbose, size_t thread_count)
+{
+    Vector<Archive::TarMember const*> files;
+    HashMap<DeprecatedString, size_t> file_indices;
+
+    for (auto const& member : members) {
+        if (!is_selected(member.path, paths))
+            continue;
+
+        if (verbose)
+            outln("{}", member.path);
+
+        auto type = member.header.type_flag();
+        if (type == Archive::TarFileType::NormalFile || type == Archive::TarFileType::AlternateNormalFile) {
+            // A file that is in the archive more than once is extracted from its last copy.
+            if (auto index = file_indices.get(member.path); index.has_value()) {
+                files[*index] = &member;
+            } else {
+                file_indices.set(member.path, files.size());
+                TRY(files.try_append(&member));
+            }
+            continue;
+        }
+
+        // NOTE: The files that come before a symlink have to be written before it is created, just like when extracting
+        //       sequentially. Otherwise, a file "x/f" followed by a symlink "x" pointing somewhere else would be written
+        //       through that symlink, outside of the directory we are extracting to.
+        if (type == Archive::TarFileType::SymLink) {
+            TRY(extract_files(archive_file, files, thread_count));
+            files.clear_with_capacity();
+            file_indices.clear();
+        }
+        (void)TRY(create_member(member));
+    }
+
+    return extract_files(archive_file, files, thread_count);
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     bool create = false;
@@ -36,6 +222,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool lzma = false;
     bool xz = false;
     bool no_auto_compress = false;
+    size_t thread_count = 1;
     StringView archive_file;
     bool dereference;
     StringView directory;
@@ -53,6 +240,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(directory, "Directory to extract to/create from", "directory", 'C', "DIRECTORY");
     args_parser.add_option(archive_file, "Archive file", "file", 'f', "FILE");
     args_parser.add_option(dereference, "Follow symlinks", "dereference", 'h');
+    args_parser.add_option(thread_count, "Extract this many files at once from uncompressed archives", "threads", 0, "count");
     args_parser.add_positional_argument(paths, "Paths", "PATHS", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -76,6 +264,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         NonnullOwnPtr<Stream> input_stream = TRY(Core::InputBufferedFile::create(TRY(Core::File::open_file_or_standard_stream(archive_file, Core::File::OpenMode::Read))));
 
+        bool is_compressed = gzip || lzma || xz;
+
         if (gzip)
             input_stream = make<Compress::GzipDecompressor>(move(input_stream));
 
@@ -87,131 +277,33 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         auto tar_stream = TRY(Archive::TarInputStream::construct(move(input_stream)));
 
-        HashMap<DeprecatedString, DeprecatedString> global_overrides;
-        HashMap<DeprecatedString, DeprecatedString> local_overrides;
-
-        auto get_override = [&](StringView key) -> Optional<DeprecatedString> {
-            Optional<DeprecatedString> maybe_local = local_overrides.get(key);
-
-            if (maybe_local.has_value())
-                return maybe_local;
-
-            Optional<DeprecatedString> maybe_global = global_overrides.get(key);
-
-            if (maybe_global.has_value())
-                return maybe_global;
-
-            return {};
-        };
-
-        while (!tar_stream->finished()) {
-            Archive::TarFileHeader const& header = tar_stream->header();
-
-            // Handle meta-entries earlier to avoid consuming the file content stream.
-            if (header.content_is_like_extended_header()) {
-                switch (header.type_flag()) {
-                case Archive::TarFileType::GlobalExtendedHeader: {
-                    TRY(tar_stream->for_each_extended_header([&](StringView key, StringView value) {
-                        if (value.length() == 0)
-                            global_overrides.remove(key);
-                        else
-                            global_overrides.set(key, value);
-                    }));
-                    break;
-                }
-                case Archive::TarFileType::ExtendedHeader: {
-                    TRY(tar_stream->for_each_extended_header([&](StringView key, StringView value) {
-                        local_overrides.set(key, value);
-                    }));
-                    break;
-                }
-                default:
-                    warnln("Unknown extended header type '{}' of {}", (char)header.type_flag(), header.filename());
-                    VERIFY_NOT_REACHED();
-                }
-
-                TRY(tar_stream->advance());
-                continue;
-            }
-
-            Archive::TarFileStream file_stream = tar_stream->file_contents();
-
-            // Handle other header types that don't just have an effect on extraction.
-            switch (header.type_flag()) {
-            case Archive::TarFileType::LongName: {
-                StringBuilder long_name;
-
-                Array<u8, buffer_size> buffer;
-
-                while (!file_stream.is_eof()) {
-                    auto slice = TRY(file_stream.read_some(buffer));
-                    long_name.append(reinterpret_cast<char*>(slice.data()), slice.size());
-                }
-
-                local_overrides.set("path", long_name.to_deprecated_string());
-                TRY(tar_stream->advance());
-                continue;
-            }
-            default:
-                // None of the relevant headers, so continue as normal.
-                break;
-            }
+        if (extract && !is_compressed && is_regular_file(archive_file)) {
+            auto members = TRY(tar_stream->read_member_index());
+            TRY(extract_indexed_members(archive_file, members, paths, verbose, thread_count));
+            return 0;
+        }
 
-            LexicalPath path = LexicalPath(header.filename());
-            if (!header.prefix().is_empty())
-                path = path.prepend(header.prefix());
-            DeprecatedString filename = get_override("path"sv).value_or(path.string());
+        TRY(tar_stream->for_each_member([&](Archive::TarMember const& member, Archive::TarFileStream& file_stream) -> ErrorOr<void> {
+            if (!is_selected(member.path, paths))
+                return {};
 
             if (list || verbose)
-                outln("{}", filename);
-
-            if (extract) {
-                DeprecatedString absolute_path = Core::DeprecatedFile::absolute_path(filename);
-                auto parent_path = LexicalPath(absolute_path).parent();
-                auto header_mode = TRY(header.mode());
-
-                switch (header.type_flag()) {
-                case Archive::TarFileType::NormalFile:
-                case Archive::TarFileType::AlternateNormalFile: {
-                    MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
-
-                    int fd = TRY(Core::System::open(absolute_path, O_CREAT | O_WRONLY, header_mode));
-
-                    Array<u8, buffer_size> buffer;
-                    while (!file_stream.is_eof()) {
-                        auto slice = TRY(file_stream.read_some(buffer));
-                        TRY(Core::System::write(fd, slice));
-                    }
+                outln("{}", member.path);
 
-                    TRY(Core::System::close(fd));
-                    break;
-                }
-                case Archive::TarFileType::SymLink: {
-                    MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+            if (!extract)
+                return {};
 
-                    TRY(Core::System::symlink(header.link_name(), absolute_path));
-                    break;
-                }
-                case Archive::TarFileType::Directory: {
-                    MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+            auto file = TRY(create_member(member));
+            if (!file)
+                return {};
 
-                    auto result_or_error = Core::System::mkdir(absolute_path, header_mode);
-                    if (result_or_error.is_error() && result_or_error.error().code() != EEXIST)
-                        return result_or_error.release_error();
-                    break;
-                }
-                default:
-                    // FIXME: Implement other file types
-                    warnln("file type '{}' of {} is not yet supported", (char)header.type_flag(), header.filename());
-                    VERIFY_NOT_REACHED();
-                }
+            Array<u8, buffer_size> buffer;
+            while (!file_stream.is_eof()) {
+                auto slice = TRY(file_stream.read_some(buffer));
+                TRY(file->write_until_depleted(slice));
             }
-
-            // Non-global headers should be cleared after every file.
-            local_overrides.clear();
-
-            TRY(tar_stream->advance());
-        }
+            return {};
+        }));
 
         return 0;
     }
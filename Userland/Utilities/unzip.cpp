@@ -5,18 +5,22 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/BitStream.h>
 #include <AK/DOSPackedTime.h>
+#include <AK/MemoryStream.h>
 #include <AK/NumberFormat.h>
 #include <AK/StringUtils.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/DeprecatedFile.h>
 #include <LibCore/Directory.h>
+#include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibFileSystem/FileSystem.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <sys/stat.h>
 
 static ErrorOr<void> adjust_modification_time(Archive::ZipMember const& zip_member)
@@ -31,10 +35,44 @@ static ErrorOr<void> adjust_modification_time(Archive::ZipMember const& zip_memb
     return Core::System::utime(zip_member.name, buf);
 }
 
-static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
+// Decompresses a member straight into its output file, which has already been extended to the member's full size.
+static ErrorOr<void> decompress_zip_member(Archive::ZipMember const& zip_member, Core::File& file, Crypto::Checksum::CRC32& checksum)
+{
+    switch (zip_member.compression_method) {
+    case Archive::ZipCompressionMethod::Store: {
+        TRY(file.write_until_depleted(zip_member.compressed_data));
+        checksum.update(zip_member.compressed_data);
+        return {};
+    }
+    case Archive::ZipCompressionMethod::Deflate: {
+        FixedMemoryStream compressed_stream { zip_member.compressed_data };
+        LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(compressed_stream) };
+        auto decompressor = TRY(Compress::DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
+
+        auto buffer = TRY(ByteBuffer::create_uninitialized(64 * KiB));
+        size_t decompressed_size = 0;
+        while (!decompressor->is_eof()) {
+            auto slice = TRY(decompressor->read_some(buffer));
+            decompressed_size += slice.size();
+            if (decompressed_size > zip_member.uncompressed_size)
+                break;
+            TRY(file.write_until_depleted(slice));
+            checksum.update(slice);
+        }
+        if (decompressed_size != zip_member.uncompressed_size)
+            return Error::from_string_literal("Decompressed size does not match");
+        return {};
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static bool unpack_zip_member(Archive::ZipMember const& zip_member, bool quiet)
 {
     if (zip_member.is_directory) {
-        if (auto maybe_error = Core::System::mkdir(zip_member.name, 0755); maybe_error.is_error()) {
+        // The directory may already have been created for a file inside of it.
+        if (auto maybe_error = Core::Directory::create(zip_member.name.to_deprecated_string(), Core::Directory::CreateDirectories::Yes); maybe_error.is_error()) {
             warnln("Failed to create directory '{}': {}", zip_member.name, maybe_error.error());
             return false;
         }
@@ -43,44 +81,25 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
         return true;
     }
     MUST(Core::Directory::create(LexicalPath(zip_member.name.to_deprecated_string()).parent(), Core::Directory::CreateDirectories::Yes));
-    auto new_file = Core::DeprecatedFile::construct(zip_member.name.to_deprecated_string());
-    if (!new_file->open(Core::OpenMode::WriteOnly)) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
+    auto new_file_or_error = Core::File::open(zip_member.name, Core::File::OpenMode::Write);
+    if (new_file_or_error.is_error()) {
+        warnln("Can't write file {}: {}", zip_member.name, new_file_or_error.error());
         return false;
     }
+    auto new_file = new_file_or_error.release_value();
 
     if (!quiet)
         outln(" extracting: {}", zip_member.name);
 
-    Crypto::Checksum::CRC32 checksum;
-    switch (zip_member.compression_method) {
-    case Archive::ZipCompressionMethod::Store: {
-        if (!new_file->write(zip_member.compressed_data.data(), zip_member.compressed_data.size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
-            return false;
-        }
-        checksum.update({ zip_member.compressed_data.data(), zip_member.compressed_data.size() });
-        break;
-    }
-    case Archive::ZipCompressionMethod::Deflate: {
-        auto decompressed_data = Compress::DeflateDecompressor::decompress_all(zip_member.compressed_data);
-        if (decompressed_data.is_error()) {
-            warnln("Failed decompressing file {}: {}", zip_member.name, decompressed_data.error());
-            return false;
-        }
-        if (decompressed_data.value().size() != zip_member.uncompressed_size) {
-            warnln("Failed decompressing file {}", zip_member.name);
-            return false;
-        }
-        if (!new_file->write(decompressed_data.value().data(), decompressed_data.value().size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
-            return false;
-        }
-        checksum.update({ decompressed_data.value().data(), decompressed_data.value().size() });
-        break;
+    if (auto maybe_error = new_file->truncate(zip_member.uncompressed_size); maybe_error.is_error()) {
+        warnln("Can't write file contents in {}: {}", zip_member.name, maybe_error.error());
+        return false;
     }
-    default:
-        VERIFY_NOT_REACHED();
+
+    Crypto::Checksum::CRC32 checksum;
+    if (auto maybe_error = decompress_zip_member(zip_member, *new_file, checksum); maybe_error.is_error()) {
+        warnln("Failed decompressing file {}: {}", zip_member.name, maybe_error.error());
+        return false;
     }
 
     if (adjust_modification_time(zip_member).is_error()) {
@@ -88,10 +107,7 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
         return false;
     }
 
-    if (!new_file->close()) {
-        warnln("Can't close file {}: {}", zip_member.name, new_file->error_string());
-        return false;
-    }
+    new_file->close();
 
     if (checksum.digest() != zip_member.crc32) {
         warnln("Failed decompressing file {}: CRC32 mismatch", zip_member.name);
@@ -102,16 +118,56 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
     return true;
 }
 
+// Members are handed out in order, so the progress output stays in archive order. Once a member fails, no new ones
+// are started.
+static ErrorOr<bool> unpack_zip_members_in_parallel(Vector<Archive::ZipMember> const& zip_members, size_t thread_count, bool quiet)
+{
+    Threading::Mutex mutex;
+    size_t next_member = 0;
+    bool success = true;
+
+    auto unpack_members = [&]() -> intptr_t {
+        while (true) {
+            Archive::ZipMember const* zip_member;
+            {
+                Threading::MutexLocker locker(mutex);
+                if (!success || next_member >= zip_members.size())
+                    return 0;
+                zip_member = &zip_members[next_member++];
+                if (!quiet)
+                    outln(" extracting: {}", zip_member->name);
+            }
+
+            if (!unpack_zip_member(*zip_member, true)) {
+                Threading::MutexLocker locker(mutex);
+                success = false;
+            }
+        }
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < min(thread_count, zip_members.size()); ++i)
+        TRY(threads.try_append(TRY(Threading::Thread::try_create([&] { return unpack_members(); }, "unzip"sv))));
+    for (auto& thread : threads)
+        thread->start();
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return success;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     StringView zip_file_path;
     bool quiet { false };
     StringView output_directory_path;
     Vector<StringView> file_filters;
+    size_t thread_count = 1;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(output_directory_path, "Directory to receive the archive content", "output-directory", 'd', "path");
     args_parser.add_option(quiet, "Be less verbose", "quiet", 'q');
+    args_parser.add_option(thread_count, "Extract this many files at once", "threads", 0, "count");
     args_parser.add_positional_argument(zip_file_path, "File to unzip", "path", Core::ArgsParser::Required::Yes);
     args_parser.add_positional_argument(file_filters, "Files or filters in the archive to extract", "files", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
@@ -142,9 +198,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         TRY(Core::System::chdir(output_directory_path));
     }
 
-    Vector<Archive::ZipMember> zip_directories;
-
-    auto success = TRY(zip_file->for_each_member([&](auto zip_member) {
+    // The central directory lists every member up front, so all of them can be looked at before extracting anything.
+    Vector<Archive::ZipMember> zip_members;
+    TRY(zip_file->for_each_member([&](auto zip_member) {
         bool keep_file = false;
 
         if (!file_filters.is_empty()) {
@@ -160,26 +216,36 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             keep_file = true;
         }
 
-        if (keep_file) {
-            if (!unpack_zip_member(zip_member, quiet))
-                return IterationDecision::Break;
-            if (zip_member.is_directory)
-                zip_directories.append(zip_member);
-        }
+        if (keep_file)
+            zip_members.append(zip_member);
 
         return IterationDecision::Continue;
     }));
 
+    bool success = true;
+    if (thread_count > 1) {
+        success = TRY(unpack_zip_members_in_parallel(zip_members, thread_count, quiet));
+    } else {
+        for (auto const& zip_member : zip_members) {
+            if (!unpack_zip_member(zip_member, quiet)) {
+                success = false;
+                break;
+            }
+        }
+    }
+
     if (!success) {
         return 1;
     }
 
-    for (auto& directory : zip_directories) {
-        if (adjust_modification_time(directory).is_error()) {
-            warnln("Failed setting modification time for directory {}", directory.name);
+    for (auto const& zip_member : zip_members) {
+        if (!zip_member.is_directory)
+            continue;
+        if (adjust_modification_time(zip_member).is_error()) {
+            warnln("Failed setting modification time for directory {}", zip_member.name);
             return 1;
         }
     }
 
-    return success ? 0 : 1;
+    return 0;
 }
@@ -13,11 +13,21 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     auto app = TRY(GUI::Application::create(arguments));
 
     int flash_flush = -1;
+    bool show_frame_times = false;
     Core::ArgsParser args_parser;
     args_parser.add_option(flash_flush, "Flash flush (repaint) rectangles", "flash-flush", 'f', "0/1");
+    args_parser.add_option(show_frame_times, "Show how long the compositor took to compose frames", "frame-times", 't');
     args_parser.parse(arguments);
 
     if (flash_flush != -1)
         GUI::ConnectionToWindowServer::the().async_set_flash_flush(flash_flush);
+
+    if (show_frame_times) {
+        auto frame_times = GUI::ConnectionToWindowServer::the().get_compositor_frame_times();
+        auto frame_count = frame_times.frame_count();
+        auto average_microseconds = frame_count > 0 ? frame_times.total_microseconds() / frame_count : 0;
+        outln("Frames composed: {}", frame_count);
+        outln("Average: {} us, last: {} us, slowest: {} us", average_microseconds, frame_times.last_microseconds(), frame_times.max_microseconds());
+    }
     return 0;
 }
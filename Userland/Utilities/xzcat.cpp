@@ -12,15 +12,30 @@
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("rpath stdio"));
+    TRY(Core::System::pledge("rpath stdio thread"));
 
     StringView filename;
+    size_t thread_count { 1 };
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("Decompress and print an XZ archive");
+    args_parser.add_option(thread_count, "Decompress using this many threads (only for files, not standard input)", "threads", 'T', "count");
     args_parser.add_positional_argument(filename, "File to decompress", "file");
     args_parser.parse(arguments);
 
+    if (thread_count == 0) {
+        warnln("Thread count must be at least 1");
+        return 1;
+    }
+
+    // Decompressing in parallel requires locating the blocks using the index at the end of the input, so the input has to be seekable.
+    if (thread_count > 1 && !filename.is_empty() && filename != "-"sv) {
+        auto file = TRY(Core::File::open(filename, Core::File::OpenMode::Read));
+        auto standard_output = TRY(Core::File::standard_output());
+        TRY(Compress::XzDecompressor::decompress_in_parallel(*file, *standard_output, thread_count));
+        return 0;
+    }
+
     auto file = TRY(Core::File::open_file_or_standard_stream(filename, Core::File::OpenMode::Read));
     auto buffered_file = TRY(Core::InputBufferedFile::create(move(file)));
     auto stream = TRY(Compress::XzDecompressor::create(move(buffered_file)));